@@ -0,0 +1,274 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for the benchmark harness used by the performance tests. Each benchmark is calibrated
+///         so that a sample runs for a minimum time, warmed up, and then sampled a number of times. The
+///         statistics of the samples are printed and written to a JSON file.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_BENCHMARK_HPP
+#define FTL_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Prevents the compiler from optimizing away the computation of a value, by making the value
+///             appear to be used (and memory to be read and written) by the inline assembly
+/// @param[in]  value   The value which must be computed
+/// @tparam     T       The type of the value
+// ----------------------------------------------------------------------------------------------------------
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Prevents the compiler from assuming that memory is not read or written, so that stores to
+///             memory (for example the result of an expression) are not removed
+// ----------------------------------------------------------------------------------------------------------
+inline void clobber_memory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Result
+/// @brief      The samples and the statistics of a benchmark -- all times are in nanoseconds per iteration
+// ----------------------------------------------------------------------------------------------------------
+struct Result {
+    std::string         name;               //!< The name of the benchmark
+    std::string         group;              //!< The group which the benchmark belongs to
+    size_t              items;              //!< The number of items (elements) processed per iteration
+    size_t              bytes;              //!< The number of bytes read and written per iteration
+    size_t              iterations;         //!< The number of iterations in each sample
+    std::vector<double> samples;            //!< The time per iteration of each sample
+    double              min;                //!< The minimum time per iteration
+    double              median;             //!< The median time per iteration
+    double              mean;               //!< The mean time per iteration
+    double              stddev;             //!< The standard deviation of the time per iteration
+
+    // Computes the statistics from the samples
+    void summarize()
+    {
+        std::vector<double> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+        const size_t n = sorted.size();
+
+        min    = sorted.front();
+        median = n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+        mean   = 0.0;
+        for (auto sample : sorted) mean += sample;
+        mean  /= n;
+        stddev = 0.0;
+        for (auto sample : sorted) stddev += (sample - mean) * (sample - mean);
+        stddev = n > 1 ? std::sqrt(stddev / (n - 1)) : 0.0;
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      Runner
+/// @brief      Runs benchmarks and collects the results. The options are given on the command line:
+///                 --json <file>           : The file to write the results to (default results.json)
+///                 --repetitions <n>       : The number of samples of each benchmark (default 15)
+///                 --min-time <ms>         : The minimum time of a sample, in milliseconds (default 20)
+///                 --filter <text>         : Only run benchmarks whose name contains the text
+///                 --max-bytes <n>         : Skip benchmarks which use more memory (default 1 GiB)
+///                 --help                  : Prints the usage
+// ----------------------------------------------------------------------------------------------------------
+class Runner {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- parses the command line options, and prints the usage and exits if they are
+    ///             malformed (an unknown option or a missing or invalid value)
+    /// @param[in]  argc    The number of command line arguments
+    /// @param[in]  argv    The command line arguments
+    // ------------------------------------------------------------------------------------------------------
+    Runner(int argc, char** argv)
+    : _json("results.json"), _repetitions(15), _warmup(3), _min_time(0.02), _max_bytes(size_t(1) << 30)
+    {
+        for (int i = 1; i < argc; i += 2) {
+            if (!std::strcmp(argv[i], "--help")) usage(argv[0], nullptr);
+            if (i + 1 == argc) usage(argv[0], "missing value for option", argv[i]);
+
+            const char* value = argv[i + 1];
+            if      (!std::strcmp(argv[i], "--json"))           _json        = value;
+            else if (!std::strcmp(argv[i], "--repetitions"))    _repetitions = parse_size(argv[0], argv[i], value, 1);
+            else if (!std::strcmp(argv[i], "--min-time"))       _min_time    = parse_time(argv[0], argv[i], value);
+            else if (!std::strcmp(argv[i], "--filter"))         _filter      = value;
+            else if (!std::strcmp(argv[i], "--max-bytes"))      _max_bytes   = parse_size(argv[0], argv[i], value, 0);
+            else usage(argv[0], "unknown option", argv[i]);
+        }
+        std::printf("%-52s %14s %14s %10s %12s\n", "benchmark", "median (ns)", "min (ns)", "cv (%)", "GB/s");
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if a benchmark will be run, so that the setup of skipped benchmarks can be avoided
+    /// @param[in]  name        The name of the benchmark
+    /// @param[in]  memory      The memory used by the benchmark, in bytes
+    /// @return     True if the benchmark will be run
+    // ------------------------------------------------------------------------------------------------------
+    bool enabled(const std::string& name, size_t memory) const
+    {
+        return memory <= _max_bytes && (_filter.empty() || name.find(_filter) != std::string::npos);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Runs a benchmark -- the number of iterations in a sample is doubled until the sample takes
+    ///             at least the minimum time, then warm-up samples are run and discarded, and then the samples
+    ///             are taken
+    /// @param[in]  group       The group which the benchmark belongs to
+    /// @param[in]  name        The name of the benchmark
+    /// @param[in]  items       The number of items processed by an iteration
+    /// @param[in]  bytes       The number of bytes read and written by an iteration
+    /// @param[in]  function    The function to benchmark (one iteration)
+    /// @tparam     Function    The type of the function
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Function>
+    void run(const std::string& group, const std::string& name, size_t items, size_t bytes, Function&& function)
+    {
+        if (!enabled(name, 0)) return;
+
+        Result result;
+        result.group = group; result.name = name; result.items = items; result.bytes = bytes;
+
+        size_t iterations = 1;
+        while (sample(function, iterations) < _min_time && iterations < (size_t(1) << 30)) iterations *= 2;
+        for (size_t i = 0; i < _warmup; ++i) sample(function, iterations);
+        for (size_t i = 0; i < _repetitions; ++i)
+            result.samples.push_back(sample(function, iterations) * 1e9 / iterations);
+
+        result.iterations = iterations;
+        result.summarize();
+        std::printf("%-52s %14.1f %14.1f %10.2f %12.2f\n", name.c_str(), result.median, result.min,
+                    100.0 * result.stddev / result.mean, bytes / result.median);
+        std::fflush(stdout);
+        _results.push_back(result);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Writes the results to the JSON file
+    /// @param[in]  context     Extra (string) properties of the run, as a list of (key, value) pairs
+    // ------------------------------------------------------------------------------------------------------
+    void write(const std::vector<std::pair<std::string, std::string>>& context) const
+    {
+        std::ofstream out(_json);
+        char date[32];
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n"
+            << "    \"repetitions\": " << _repetitions << ",\n"
+            << "    \"min_time_ms\": " << _min_time * 1000.0;
+        for (const auto& property : context)
+            out << ",\n    \"" << property.first << "\": \"" << property.second << "\"";
+        out << "\n  },\n  \"benchmarks\": [";
+
+        for (size_t i = 0; i < _results.size(); ++i) {
+            const Result& r = _results[i];
+            out << (i ? "," : "") << "\n    {\n"
+                << "      \"name\": \"" << r.name << "\",\n"
+                << "      \"group\": \"" << r.group << "\",\n"
+                << "      \"items\": " << r.items << ",\n"
+                << "      \"bytes\": " << r.bytes << ",\n"
+                << "      \"iterations\": " << r.iterations << ",\n"
+                << "      \"min_ns\": " << r.min << ",\n"
+                << "      \"median_ns\": " << r.median << ",\n"
+                << "      \"mean_ns\": " << r.mean << ",\n"
+                << "      \"stddev_ns\": " << r.stddev << ",\n"
+                << "      \"items_per_second\": " << r.items * 1e9 / r.median << ",\n"
+                << "      \"bytes_per_second\": " << r.bytes * 1e9 / r.median << ",\n"
+                << "      \"samples_ns\": [";
+            for (size_t s = 0; s < r.samples.size(); ++s) out << (s ? ", " : "") << r.samples[s];
+            out << "]\n    }";
+        }
+        out << "\n  ]\n}\n";
+        std::cout << "Results written to " << _json << "\n";
+    }
+private:
+    std::string         _json;              //!< The file to write the results to
+    std::string         _filter;            //!< Only benchmarks which contain the filter are run
+    size_t              _repetitions;       //!< The number of samples of each benchmark
+    size_t              _warmup;            //!< The number of warm-up samples of each benchmark
+    double              _min_time;          //!< The minimum time of a sample in seconds
+    size_t              _max_bytes;         //!< The maximum memory of a benchmark
+    std::vector<Result> _results;           //!< The results of the benchmarks which have been run
+
+    // Prints the usage (and an error, if there is one) and exits -- successfully only if there is no error
+    [[noreturn]] static void usage(const char* program, const char* error, const char* argument = "")
+    {
+        if (error != nullptr) std::cerr << program << ": " << error << " " << argument << "\n";
+        (error != nullptr ? std::cerr : std::cout)
+            << "usage: " << program << " [--json <file>] [--repetitions <n>] [--min-time <ms>]"
+            << " [--filter <text>] [--max-bytes <n>]\n";
+        std::exit(error != nullptr ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+
+    // Parses a non-negative integer option which must be at least a minimum
+    static size_t parse_size(const char* program, const char* option, const char* value, size_t minimum)
+    {
+        char* end = nullptr;
+        const unsigned long long result = std::strtoull(value, &end, 10);
+        if (*value == '\0' || *value == '-' || *end != '\0' || result < minimum)
+            usage(program, "invalid value for option", option);
+        return static_cast<size_t>(result);
+    }
+
+    // Parses a time option in milliseconds, returning the time in seconds
+    static double parse_time(const char* program, const char* option, const char* value)
+    {
+        char* end = nullptr;
+        const double result = std::strtod(value, &end);
+        if (*value == '\0' || *end != '\0' || !(result >= 0.0)) usage(program, "invalid value for option", option);
+        return result / 1000.0;
+    }
+
+    // Times a number of iterations of a function, in seconds
+    template <typename Function>
+    static double sample(Function& function, size_t iterations)
+    {
+        const auto start = clock::now();
+        for (size_t i = 0; i < iterations; ++i) function();
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+};
+
+}               // End namespace bench
+#endif          // FTL_BENCHMARK_HPP
@@ -0,0 +1,341 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   benchmarks.cpp
+/// @brief  Benchmarks which compare the static and dynamic index mappers, element access of static and
+///         dynamic tensors, and the evaluation of expressions of different depths for static and dynamic
+///         tensors with sizes from L1 resident to far larger than the last level cache, and the elementary
+///         functions (accurate and fast) against loops of the standard library functions, random
+///         initialization against the standard library generators, walks of tiled and column-major
+///         layouts, and blocked permutes against assigning permuted views
+// ----------------------------------------------------------------------------------------------------------
+
+#include "benchmark.hpp"
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/permute.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t num_indices = 4096;            // The number of (random) index sets per iteration
+
+// Sizes of the dimensions of the tensors for the mapping and access benchmarks
+constexpr size_t d0 = 200, d1 = 3000, d2 = 7, d3 = 20, d4 = 2, d5 = 12;
+
+using static_layout = ftl::StaticLayout<ftl::ColumnMajor, d0, d1, d2, d3, d4, d5>;
+
+// Random indices which are only known at runtime, so that the mapping can not be computed at compile time
+struct Indices {
+    Indices() : values(num_indices)
+    {
+        std::mt19937 generator(5489u);
+        for (auto& index : values) {
+            index = {{ generator() % d0, generator() % d1, generator() % d2,
+                       generator() % d3, generator() % d4, generator() % d5 }};
+        }
+    }
+    std::vector<std::array<size_t, 6>> values;
+};
+
+void mapper_benchmarks(bench::Runner& runner)
+{
+    const Indices indices;
+    const ftl::DynamicLayout dynamic_layout({d0, d1, d2, d3, d4, d5});
+
+    runner.run("mapper", "mapper/static", num_indices, 0, [&]()
+    {
+        size_t sum = 0;
+        for (const auto& i : indices.values)
+            sum += ftl::StaticMapper::indices_to_index<static_layout>(i[0], i[1], i[2], i[3], i[4], i[5]);
+        bench::do_not_optimize(sum);
+    });
+
+    runner.run("mapper", "mapper/dynamic", num_indices, 0, [&]()
+    {
+        size_t sum = 0;
+        for (const auto& i : indices.values)
+            sum += ftl::DynamicMapper::indices_to_index(dynamic_layout, i[0], i[1], i[2], i[3], i[4], i[5]);
+        bench::do_not_optimize(sum);
+    });
+}
+
+void access_benchmarks(bench::Runner& runner)
+{
+    // Small enough that the random accesses are (mostly) cache resident, so the mapping dominates
+    constexpr size_t rows = 64, cols = 48;
+    const Indices indices;
+
+    std::unique_ptr<ftl::StaticTensorCpu<float, rows, cols>> S(new ftl::StaticTensorCpu<float, rows, cols>);
+    ftl::DynamicTensorCpu<float> D({rows, cols});
+    std::unique_ptr<std::array<float, rows * cols>> A(new std::array<float, rows * cols>);
+    for (size_t i = 0; i < rows * cols; ++i) (*S)[i] = D[i] = (*A)[i] = static_cast<float>(i % 17);
+
+    const size_t bytes = num_indices * sizeof(float);
+    runner.run("access", "access/std_array", num_indices, bytes, [&]()
+    {
+        float sum = 0.f;
+        for (const auto& i : indices.values) sum += (*A)[i[0] % rows + rows * (i[1] % cols)];
+        bench::do_not_optimize(sum);
+    });
+
+    runner.run("access", "access/static_tensor", num_indices, bytes, [&]()
+    {
+        float sum = 0.f;
+        for (const auto& i : indices.values) sum += (*S)(i[0] % rows, i[1] % cols);
+        bench::do_not_optimize(sum);
+    });
+
+    runner.run("access", "access/dynamic_tensor", num_indices, bytes, [&]()
+    {
+        float sum = 0.f;
+        for (const auto& i : indices.values) sum += D(i[0] % rows, i[1] % cols);
+        bench::do_not_optimize(sum);
+    });
+}
+
+// Evaluates an expression of the given depth (the number of binary operations) into the result
+template <size_t Depth>
+struct Expression;
+
+template <> struct Expression<1> {
+    template <typename T> static void evaluate(T& r, const T& a, const T& b, const T&, const T&, const T&)
+    { r = a + b; }
+};
+template <> struct Expression<2> {
+    template <typename T> static void evaluate(T& r, const T& a, const T& b, const T& c, const T&, const T&)
+    { r = a + b - c; }
+};
+template <> struct Expression<3> {
+    template <typename T> static void evaluate(T& r, const T& a, const T& b, const T& c, const T& d, const T&)
+    { r = a + b - c + d; }
+};
+template <> struct Expression<4> {
+    template <typename T> static void evaluate(T& r, const T& a, const T& b, const T& c, const T& d, const T& e)
+    { r = a + b - c + d - e; }
+};
+
+// Runs the expression benchmark of a depth for a tensor type
+template <size_t Depth, typename Tensor, typename Factory>
+void expression_benchmark(bench::Runner& runner, const std::string& kind, const std::string& level,
+                          size_t size, Factory make_tensor)
+{
+    const std::string name = "expression/" + kind + "/depth_" + std::to_string(Depth) + "/" + level;
+    const size_t memory = (Depth + 2) * size * sizeof(float);
+    if (!runner.enabled(name, memory)) return;
+
+    // Only the result and the Depth + 1 operands which the expression reads are allocated, the other operands
+    // refer to the last one (and are not read)
+    std::vector<std::unique_ptr<Tensor>> tensors;
+    for (size_t t = 0; t < Depth + 2; ++t) {
+        tensors.emplace_back(make_tensor());
+        for (size_t i = 0; i < size; ++i) (*tensors[t])[i] = static_cast<float>((i + t) % 31);
+    }
+    const auto operand = [&tensors](size_t t) -> const Tensor& { return *tensors[std::min(t, Depth + 1)]; };
+
+    runner.run("expression", name, size, memory, [&]()
+    {
+        Expression<Depth>::evaluate(*tensors[0], operand(1), operand(2), operand(3), operand(4), operand(5));
+        bench::do_not_optimize((*tensors[0])[size - 1]);
+        bench::clobber_memory();
+    });
+}
+
+template <size_t Size>
+void expression_benchmarks(bench::Runner& runner, const std::string& level)
+{
+    using static_tensor  = ftl::StaticTensorCpu<float, Size>;
+    using dynamic_tensor = ftl::DynamicTensorCpu<float>;
+
+    auto make_static  = []() { return new static_tensor; };
+    auto make_dynamic = []() { return new dynamic_tensor({Size}); };
+
+    expression_benchmark<1, static_tensor >(runner, "static" , level, Size, make_static );
+    expression_benchmark<1, dynamic_tensor>(runner, "dynamic", level, Size, make_dynamic);
+    expression_benchmark<2, static_tensor >(runner, "static" , level, Size, make_static );
+    expression_benchmark<2, dynamic_tensor>(runner, "dynamic", level, Size, make_dynamic);
+    expression_benchmark<3, static_tensor >(runner, "static" , level, Size, make_static );
+    expression_benchmark<3, dynamic_tensor>(runner, "dynamic", level, Size, make_dynamic);
+    expression_benchmark<4, static_tensor >(runner, "static" , level, Size, make_static );
+    expression_benchmark<4, dynamic_tensor>(runner, "dynamic", level, Size, make_dynamic);
+}
+
+// Runs a benchmark of an elementwise function of a tensor
+template <typename Function>
+void math_benchmark(bench::Runner& runner, const std::string& name, const ftl::DynamicTensorCpu<float>& x,
+                    ftl::DynamicTensorCpu<float>& result, Function function)
+{
+    const size_t size = x.size();
+    if (!runner.enabled(name, 2 * size * sizeof(float))) return;
+
+    runner.run("math", name, size, 2 * size * sizeof(float), [&]()
+    {
+        function();
+        bench::do_not_optimize(result[size - 1]);
+        bench::clobber_memory();
+    });
+}
+
+// Compares the elementary functions (accurate and fast) to a loop of the standard library functions, with a
+// size which fits in L2 so that the computation (rather than the memory) is measured
+void math_benchmarks(bench::Runner& runner)
+{
+    const size_t size = size_t(1) << 15;
+    ftl::DynamicTensorCpu<float> x({size}), r({size});
+    for (size_t i = 0; i < size; ++i) x[i] = -10.f + 20.f * static_cast<float>(i) / size;
+
+    math_benchmark(runner, "math/exp/accurate", x, r, [&]() { r = ftl::exp(x); });
+    math_benchmark(runner, "math/exp/fast"    , x, r, [&]() { r = ftl::exp(x, ftl::fast_math); });
+    math_benchmark(runner, "math/exp/std"     , x, r, [&]() 
+    { 
+        for (size_t i = 0; i < size; ++i) r[i] = std::exp(x[i]); 
+    });
+    math_benchmark(runner, "math/tanh/accurate", x, r, [&]() { r = ftl::tanh(x); });
+    math_benchmark(runner, "math/tanh/fast"    , x, r, [&]() { r = ftl::tanh(x, ftl::fast_math); });
+    math_benchmark(runner, "math/tanh/std"     , x, r, [&]() 
+    { 
+        for (size_t i = 0; i < size; ++i) r[i] = std::tanh(x[i]); 
+    });
+}
+
+// Evaluates an expression of small static tensors (as used by geometry kernels) many times per run, with
+// each result depending on the previous one so that the evaluations can't be hoisted out of the loop
+template <size_t... Sizes>
+void small_benchmark(bench::Runner& runner, const std::string& shape)
+{
+    using tensor = ftl::TensorInterface<ftl::TensorTraits<float, ftl::CPU, Sizes...>>;
+    const size_t      repetitions = 1024;
+    const std::string name        = "small/" + shape;
+    if (!runner.enabled(name, 4 * sizeof(tensor))) return;
+
+    tensor a, b, r;
+    for (size_t i = 0; i < a.size(); ++i) { a[i] = 1.f + i; b[i] = 0.5f; }
+
+    runner.run("small", name, repetitions * a.size(), 3 * sizeof(tensor), [&]()
+    {
+        for (size_t i = 0; i < r.size(); ++i) r[i] = 0.f;
+        for (size_t k = 0; k < repetitions; ++k) {
+            r = a - r * b;
+            bench::clobber_memory();
+        }
+        bench::do_not_optimize(r[0]);
+    });
+}
+
+void small_benchmarks(bench::Runner& runner)
+{
+    small_benchmark<3, 3>(runner, "3x3");
+    small_benchmark<4, 4>(runner, "4x4");
+    small_benchmark<3, 3, 3>(runner, "3x3x3");
+}
+
+// Compares filling a tensor with uniform values with the counter-based generator (in parallel, with the
+// thread pool) to a sequential fill with the standard library generator and distribution
+void random_benchmarks(bench::Runner& runner)
+{
+    const size_t size = size_t(1) << 24;
+    if (!runner.enabled("random/", size * sizeof(float))) return;
+    ftl::DynamicTensorCpu<float> A({size});
+
+    runner.run("random", "random/initialize/uniform", size, size * sizeof(float), [&]()
+    {
+        A.initialize(ftl::Uniform<float>(0.f, 1.f), 5489u);
+        bench::do_not_optimize(A[size - 1]);
+        bench::clobber_memory();
+    });
+
+    runner.run("random", "random/std/uniform", size, size * sizeof(float), [&]()
+    {
+        std::mt19937                          generator(5489u);
+        std::uniform_real_distribution<float> distribution(0.f, 1.f);
+        for (size_t i = 0; i < size; ++i) A[i] = distribution(generator);
+        bench::do_not_optimize(A[size - 1]);
+        bench::clobber_memory();
+    });
+}
+
+// Walks along the second dimension of a tensor with a layout (each row in turn), which is a strided walk
+// for column-major tensors but stays in the same tiles (and pages) for tiled tensors
+template <typename Layout>
+void layout_benchmark(bench::Runner& runner, const std::string& kind, Layout layout)
+{
+    const size_t      size = 4096;
+    const std::string name = "layout/" + kind + "/second_dimension";
+    if (!runner.enabled(name, size * size * sizeof(float))) return;
+
+    ftl::DynamicTensorCpu<float> A({size, size}, layout);
+    A = ftl::DynamicTensorCpu<float>({size, size}) * 0.f + 1.f;
+
+    runner.run("layout", name, size * size, size * size * sizeof(float), [&]()
+    {
+        float sum = 0.f;
+        for (size_t i = 0; i < size; ++i)
+            for (size_t j = 0; j < size; ++j) sum += A(i, j);
+        bench::do_not_optimize(sum);
+    });
+}
+
+void layout_benchmarks(bench::Runner& runner)
+{
+    layout_benchmark(runner, "column_major", ftl::ColumnMajor());
+    layout_benchmark(runner, "tiled"       , ftl::Tiled<16, 16>());
+    layout_benchmark(runner, "morton_tiled", ftl::MortonTiled<16, 16>());
+}
+
+// Compares transposing a tensor with the blocked permute to assigning the permuted view, element by element
+void permute_benchmarks(bench::Runner& runner)
+{
+    const size_t size = 4096, bytes = 2 * size * size * sizeof(float);
+    if (!runner.enabled("permute/", bytes)) return;
+
+    ftl::DynamicTensorCpu<float> A({size, size}), B({size, size});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i % 31);
+
+    runner.run("permute", "permute/copy", size * size, bytes, [&]()
+    {
+        B = ftl::permute(A, {1, 0});
+        bench::do_not_optimize(B[size - 1]);
+        bench::clobber_memory();
+    });
+
+    runner.run("permute", "permute/view", size * size, bytes, [&]()
+    {
+        B = ftl::permuted(A, {1, 0});
+        bench::do_not_optimize(B[size - 1]);
+        bench::clobber_memory();
+    });
+}
+
+}               // End unnamed namespace
+
+int main(int argc, char** argv)
+{
+    bench::Runner runner(argc, argv);
+
+    mapper_benchmarks(runner);
+    access_benchmarks(runner);
+
+    // Sizes (in floats) which fit in L1, in L2, in the last level cache, and which are far larger than it
+    expression_benchmarks<(size_t(1) << 10)>(runner, "l1");
+    expression_benchmarks<(size_t(1) << 15)>(runner, "l2");
+    expression_benchmarks<(size_t(1) << 20)>(runner, "llc");
+    expression_benchmarks<(size_t(1) << 24)>(runner, "dram");
+
+    math_benchmarks(runner);
+    small_benchmarks(runner);
+    random_benchmarks(runner);
+    layout_benchmarks(runner);
+    permute_benchmarks(runner);
+
+    runner.write({
+        { "compiler"    , __VERSION__                                                       },
+        { "simd_width"  , std::to_string(ftl::simd::Packet<float>::size)                    },
+        { "threads"     , std::to_string(ftl::ThreadPool::instance().num_threads())         }
+    });
+}
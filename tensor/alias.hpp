@@ -0,0 +1,215 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for alias analysis of assignments. When an expression is evaluated into the memory of
+///         a tensor (or view) which the expression also reads, the evaluation is only correct without a
+///         temporary buffer if every element which is read from the destination memory is read at the same
+///         (logical) index as it is written -- for example A = A + B. Each tensor and view describes the
+///         memory which it refers to with a MemoryFootprint, and each expression checks its tensors against
+///         the footprint of the destination.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_ALIAS_HPP
+#define FTL_ALIAS_HPP
+
+#include "layout.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace ftl {
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticDimSizes
+/// @brief      The dimension sizes of a static shape in the dimension container of static tensors, which is
+///             built at compile time so that static tensors and expressions don't need to store (or fill) it
+/// @tparam     Container   The type of the dimension container
+/// @tparam     Sizes       The list of sizes (a SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Container, typename Sizes>
+struct StaticDimSizes;
+
+template <typename Container, size_t... Sizes>
+struct StaticDimSizes<Container, SizeList<Sizes...>> { static constexpr Container values = {{ Sizes... }}; };
+
+template <typename Container, size_t... Sizes>
+constexpr Container StaticDimSizes<Container, SizeList<Sizes...>>::values;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      MemoryFootprint
+/// @brief      Describes the memory of a tensor or a view -- the address of the first element, the range of
+///             addresses which the elements span, and the mapping of the (logical) indices to the memory. The
+///             sizes and strides are not copied, so the footprint must not outlive the layout it is made from.
+// ----------------------------------------------------------------------------------------------------------
+class MemoryFootprint {
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- sets the memory and the mapping of the elements
+    /// @param[in]  data        A pointer to the first element
+    /// @param[in]  rank        The number of dimensions
+    /// @param[in]  sizes       The sizes of the dimensions
+    /// @param[in]  strides     The strides of the dimensions
+    /// @param[in]  contiguous  If the elements are stored contiguously in column-major order
+    /// @tparam     Dtype       The type of the elements
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Dtype>
+    MemoryFootprint(const Dtype* data, size_t rank, const size_t* sizes, const size_t* strides, bool contiguous)
+    : _data(data), _rank(rank), _sizes(sizes), _strides(strides), _tiling(nullptr), _contiguous(contiguous), 
+      _ordered(true), _size(1)
+    {
+        size_t last = 0;
+        for (size_t i = 0; i < rank; ++i) { _size *= sizes[i]; last += (sizes[i] - 1) * strides[i]; }
+        _first = reinterpret_cast<const char*>(data);
+        _last  = _size == 0 ? _first : reinterpret_cast<const char*>(data + last + 1);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor for tiled memory -- the mapping is only known to be the same as that of another
+    ///             footprint if both come from the same tiling
+    /// @param[in]  data            A pointer to the first element
+    /// @param[in]  rank            The number of dimensions
+    /// @param[in]  sizes           The sizes of the dimensions
+    /// @param[in]  storage_size    The number of elements which the memory holds
+    /// @param[in]  tiling          The mapping of the tiled layout, which identifies it
+    /// @tparam     Dtype           The type of the elements
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Dtype>
+    MemoryFootprint(const Dtype* data, size_t rank, const size_t* sizes, size_t storage_size, 
+                    const TileDimension* tiling)
+    : _data(data), _rank(rank), _sizes(sizes), _strides(nullptr), _tiling(tiling), _contiguous(false), 
+      _ordered(true), _size(1)
+    {
+        for (size_t i = 0; i < rank; ++i) _size *= sizes[i];
+        _first = reinterpret_cast<const char*>(data);
+        _last  = reinterpret_cast<const char*>(data + storage_size);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the memory spanned by two footprints overlaps
+    /// @param[in]  other   The other footprint
+    /// @return     True if any address is spanned by both footprints
+    // ------------------------------------------------------------------------------------------------------
+    inline bool overlaps(const MemoryFootprint& other) const
+    {
+        return _first < other._last && other._first < _last;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if two footprints map each (logical) index to the same address
+    /// @param[in]  other   The other footprint
+    /// @return     True if the mappings of the footprints are the same
+    // ------------------------------------------------------------------------------------------------------
+    inline bool same_mapping(const MemoryFootprint& other) const
+    {
+        if (!_ordered || !other._ordered)                 return false;
+        if (_data != other._data || _size != other._size) return false;
+        if (_contiguous && other._contiguous)             return true;
+        if (_tiling != nullptr || other._tiling != nullptr) return _tiling == other._tiling;
+        if (_rank != other._rank)                         return false;
+        for (size_t i = 0; i < _rank; ++i) {
+            if (_sizes[i] != other._sizes[i] || (_sizes[i] != 1 && _strides[i] != other._strides[i]))
+                return false;
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the memory of this footprint can be written while the memory of another footprint
+    ///             is read (by index), which is the case if the memory does not overlap or if the mappings of
+    ///             the indices are the same
+    /// @param[in]  read    The footprint which is read
+    /// @return     True if a temporary buffer is required
+    // ------------------------------------------------------------------------------------------------------
+    inline bool conflicts(const MemoryFootprint& read) const { return overlaps(read) && !same_mapping(read); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets a footprint of the same memory which is written in a different order to the (logical)
+    ///             indices of the elements which are read -- for example by a reduction, where each element
+    ///             which is written depends on many elements -- so that any overlap is a conflict
+    /// @return     The footprint with no mapping of the indices
+    // ------------------------------------------------------------------------------------------------------
+    inline MemoryFootprint unordered() const 
+    { 
+        MemoryFootprint footprint(*this);
+        footprint._ordered = false;
+        return footprint;
+    }
+private:
+    const void*     _data;          //!< The address of the first element
+    size_t          _rank;          //!< The number of dimensions
+    const size_t*   _sizes;         //!< The sizes of the dimensions
+    const size_t*   _strides;       //!< The strides of the dimensions
+    const void*     _tiling;        //!< The mapping of a tiled layout, or nullptr
+    bool            _contiguous;    //!< If the elements are contiguous in column-major order
+    bool            _ordered;       //!< If the elements are written in the order of their indices
+    size_t          _size;          //!< The number of elements
+    const char*     _first;         //!< The lowest address of the elements
+    const char*     _last;          //!< The address after the highest address of the elements
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates the footprint of data with a dynamic layout
+/// @param[in]  data    A pointer to the first element
+/// @param[in]  layout  The layout of the data
+/// @tparam     Dtype   The type of the elements
+/// @return     The footprint of the data
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+inline MemoryFootprint make_footprint(const Dtype* data, const DynamicLayout& layout)
+{
+    if (layout.tiled())
+        return MemoryFootprint(data, layout.dim_sizes().size(), layout.dim_sizes().data(), layout.storage_size(),
+                               layout.tiles().data());
+    return MemoryFootprint(data, layout.dim_sizes().size(), layout.dim_sizes().data(), layout.strides().data(),
+                           layout.contiguous());
+}
+
+// Strided static layouts
+template <typename Layout, typename Dtype>
+inline MemoryFootprint make_footprint(const Dtype* data, std::false_type /* tiled */)
+{
+    return MemoryFootprint(data, Layout::sizes::size, SizeArray<typename Layout::sizes>::values,
+                           SizeArray<typename Layout::strides>::values, Layout::contiguous);
+}
+
+// Tiled static layouts
+template <typename Layout, typename Dtype>
+inline MemoryFootprint make_footprint(const Dtype* data, std::true_type /* tiled */)
+{
+    return MemoryFootprint(data, Layout::sizes::size, SizeArray<typename Layout::sizes>::values, 
+                           Layout::storage_size, Layout::tiles);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates the footprint of data with a static layout
+/// @param[in]  data    A pointer to the first element
+/// @tparam     Layout  The (static) layout of the data
+/// @tparam     Dtype   The type of the elements
+/// @return     The footprint of the data
+// ----------------------------------------------------------------------------------------------------------
+template <typename Layout, typename Dtype>
+inline MemoryFootprint make_footprint(const Dtype* data)
+{
+    return make_footprint<Layout>(data, std::integral_constant<bool, Layout::tiled>());
+}
+
+}               // End namespace detail
+}               // End namespace ftl
+#endif          // FTL_ALIAS_HPP
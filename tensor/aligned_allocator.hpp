@@ -0,0 +1,156 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for an allocator which aligns the memory it allocates to a given boundary, so that
+///         tensor data can be loaded and stored with aligned vector instructions.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_ALIGNED_ALLOCATOR_HPP
+#define FTL_ALIGNED_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(_WIN32)
+    #include <malloc.h>
+#endif
+
+namespace ftl {
+
+// The default alignment (in bytes) of tensor data -- a cache line, which is also the width of the widest
+// (AVX-512) vector registers
+static constexpr size_t default_alignment = 64;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      AlignedAllocator
+/// @brief      Standard library compatible allocator which aligns all allocations to a boundary
+/// @tparam     Dtype       The type of data to allocate
+/// @tparam     Alignment   The alignment of the allocated memory in bytes -- must be a power of 2 which is at
+///                         least the alignment of a pointer
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, size_t Alignment = default_alignment>
+class AlignedAllocator {
+public:
+    static_assert((Alignment & (Alignment - 1)) == 0   , "Alignment must be a power of 2"             );
+    static_assert(Alignment >= sizeof(void*)           , "Alignment must be at least that of a pointer");
+
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using value_type        = Dtype;
+    using pointer           = Dtype*;
+    using const_pointer     = const Dtype*;
+    using reference         = Dtype&;
+    using const_reference   = const Dtype&;
+    using size_type         = size_t;
+    using difference_type   = ptrdiff_t;
+    // ------------------------------------------------------------------------------------------------------
+
+    static constexpr size_t alignment = Alignment;          //!< The alignment of the allocations
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @struct     rebind
+    /// @brief      Gets the type of the allocator for another data type, with the same alignment
+    /// @tparam     Other   The other data type
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Other>
+    struct rebind { using other = AlignedAllocator<Other, Alignment>; };
+
+    AlignedAllocator() noexcept {}
+
+    template <typename Other>
+    AlignedAllocator(const AlignedAllocator<Other, Alignment>&) noexcept {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Allocates aligned memory for a number of elements
+    /// @param[in]  num_elements    The number of elements to allocate memory for
+    /// @return     A pointer to the aligned memory
+    // ------------------------------------------------------------------------------------------------------
+    pointer allocate(size_type num_elements)
+    {
+        if (num_elements == 0) return nullptr;
+        if (num_elements > std::numeric_limits<size_type>::max() / sizeof(Dtype)) throw std::bad_alloc();
+
+        void* memory = nullptr;
+#if defined(_WIN32)
+        memory = _aligned_malloc(num_elements * sizeof(Dtype), Alignment);
+#else
+        if (posix_memalign(&memory, Alignment, num_elements * sizeof(Dtype)) != 0) memory = nullptr;
+#endif
+        if (memory == nullptr) throw std::bad_alloc();
+        return static_cast<pointer>(memory);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Default-initializes an element, rather than value-initializing it, so that containers which
+    ///             are sized (but not filled) leave the memory untouched for whatever writes it first -- the
+    ///             parallel evaluators then place the pages near the threads which use them
+    /// @param[in]  memory  A pointer to the memory for the element
+    /// @tparam     U       The type of the element
+    // ------------------------------------------------------------------------------------------------------
+    template <typename U>
+    void construct(U* memory) noexcept(std::is_nothrow_default_constructible<U>::value)
+    {
+        ::new (static_cast<void*>(memory)) U;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructs an element from arguments
+    /// @param[in]  memory  A pointer to the memory for the element
+    /// @param[in]  args    The arguments for the constructor of the element
+    /// @tparam     U       The type of the element
+    /// @tparam     Args    The types of the arguments
+    // ------------------------------------------------------------------------------------------------------
+    template <typename U, typename... Args>
+    void construct(U* memory, Args&&... args)
+    {
+        ::new (static_cast<void*>(memory)) U(std::forward<Args>(args)...);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Frees memory allocated by the allocator
+    /// @param[in]  memory  A pointer to the memory to free
+    // ------------------------------------------------------------------------------------------------------
+    void deallocate(pointer memory, size_type) noexcept
+    {
+#if defined(_WIN32)
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+};
+
+// Aligned allocators are stateless, so any two with the same alignment can free each other's memory
+template <typename T1, typename T2, size_t Alignment>
+inline bool operator==(const AlignedAllocator<T1, Alignment>&, const AlignedAllocator<T2, Alignment>&)
+{
+    return true;
+}
+
+template <typename T1, typename T2, size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T1, Alignment>&, const AlignedAllocator<T2, Alignment>&)
+{
+    return false;
+}
+
+}               // End namespace ftl
+#endif          // FTL_ALIGNED_ALLOCATOR_HPP
@@ -0,0 +1,378 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for broadcasting the operands of elementwise operations for tensor library. Two shapes
+///         can be broadcast together if each pair of dimension sizes is equal or one of them is 1, where the
+///         missing (trailing) dimensions of the shape with the lower rank have a size of 1 -- so a tensor of
+///         size (n) is the same as a tensor of size (n, 1, 1) and can be used with a tensor of size (n, m, k).
+///         The elements of an operand are read with a stride of 0 along the dimensions which it is broadcast
+///         along, so the broadcast operand is never expanded in memory.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_BROADCAST_HPP
+#define FTL_BROADCAST_HPP
+
+#include "alias.hpp"
+#include "simd.hpp"
+#include "tensor_traits.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ftl {
+namespace detail {
+
+// ---------------------------------------------- STATIC SHAPES ---------------------------------------------
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     BroadcastSizes
+/// @brief      Broadcasts two compile time lists of dimension sizes together
+/// @tparam     S1      The first list of sizes
+/// @tparam     S2      The second list of sizes
+// ----------------------------------------------------------------------------------------------------------
+template <typename S1, typename S2>
+struct BroadcastSizes;
+
+template <size_t... S2>
+struct BroadcastSizes<SizeList<>, SizeList<S2...>> {
+    static constexpr bool valid = true;
+    using type                  = SizeList<S2...>;
+};
+
+template <size_t F1, size_t... R1>
+struct BroadcastSizes<SizeList<F1, R1...>, SizeList<>> {
+    static constexpr bool valid = true;
+    using type                  = SizeList<F1, R1...>;
+};
+
+template <size_t F1, size_t... R1, size_t F2, size_t... R2>
+struct BroadcastSizes<SizeList<F1, R1...>, SizeList<F2, R2...>> {
+private:
+    using rest = BroadcastSizes<SizeList<R1...>, SizeList<R2...>>;
+
+    template <size_t Value, typename List> struct Prepend;
+    template <size_t Value, size_t... Values>
+    struct Prepend<Value, SizeList<Values...>> { using type = SizeList<Value, Values...>; };
+public:
+    static constexpr bool valid = (F1 == F2 || F1 == 1 || F2 == 1) && rest::valid;
+    using type                  = typename Prepend<F1 == 1 ? F2 : F1, typename rest::type>::type;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     RebindSizes
+/// @brief      Gets static tensor traits with the same data type and device as other static traits, but with
+///             different dimension sizes
+/// @tparam     Traits  The static traits
+/// @tparam     Sizes   The dimension sizes of the new traits (a SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Traits, typename Sizes>
+struct RebindSizes;
+
+template <typename Dtype, device DeviceType, size_t... OldSizes, size_t... Sizes>
+struct RebindSizes<TensorTraits<Dtype, DeviceType, OldSizes...>, SizeList<Sizes...>> {
+    using type = TensorTraits<Dtype, DeviceType, Sizes...>;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     BroadcastTraits
+/// @brief      Gets the traits of the result of an elementwise operation on two expressions, which has the
+///             data type of the first expression. If both shapes are static the result has the (static)
+///             broadcast shape, and shapes which can't be broadcast together don't compile. If only one shape
+///             is static the result has that shape (so the dynamic expression must broadcast to it, which is
+///             checked once at runtime), and if neither is static the result is dynamic.
+/// @tparam     T1      The traits of the first expression
+/// @tparam     T2      The traits of the second expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename T1, typename T2, bool Static1 = StaticSizes<T1>::is_static,
+                                    bool Static2 = StaticSizes<T2>::is_static>
+struct BroadcastTraits {
+    using type = T1;
+};
+
+template <typename T1, typename T2>
+struct BroadcastTraits<T1, T2, false, true> {
+    using type = typename RebindSizes<T1, typename StaticSizes<T2>::type>::type;
+};
+
+template <typename T1, typename T2>
+struct BroadcastTraits<T1, T2, true, true> {
+private:
+    using sizes = BroadcastSizes<typename StaticSizes<T1>::type, typename StaticSizes<T2>::type>;
+    static_assert(sizes::valid, "Can't broadcast expressions whose dimension sizes are different and not 1");
+public:
+    using type = typename RebindSizes<T1, typename sizes::type>::type;
+};
+
+// --------------------------------------------- RUNTIME SHAPES ---------------------------------------------
+
+// Gets the size of a dimension of a shape, where the dimensions past the rank have a size of 1
+template <typename Container>
+inline size_t dim_size(const Container& dim_sizes, size_t rank, size_t dim)
+{
+    return dim < rank ? dim_sizes[dim] : 1;
+}
+
+// Gets the size of a dimension of two shapes broadcast together
+inline size_t broadcast_size(size_t x, size_t y)
+{
+    if (x == y || y == 1) return x;
+    if (x == 1)           return y;
+    throw std::invalid_argument("ftl : can't broadcast dimensions of sizes " + std::to_string(x) +
+                                " and " + std::to_string(y));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Checks that a shape can be broadcast to another shape (without changing the other shape)
+/// @param[in]  from        The dimension sizes of the shape to broadcast
+/// @param[in]  from_rank   The rank of the shape to broadcast
+/// @param[in]  to          The dimension sizes of the shape to broadcast to
+/// @param[in]  to_rank     The rank of the shape to broadcast to
+/// @return     If the shape can be broadcast to the other shape
+// ----------------------------------------------------------------------------------------------------------
+template <typename From, typename To>
+inline bool broadcasts_to(const From& from, size_t from_rank, const To& to, size_t to_rank)
+{
+    const size_t rank = from_rank > to_rank ? from_rank : to_rank;
+    for (size_t i = 0; i < rank; ++i) {
+        const size_t size = dim_size(from, from_rank, i);
+        if (size != 1 && size != dim_size(to, to_rank, i)) return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      BroadcastShape
+/// @brief      The shape of the result of an elementwise operation on two expressions, which is checked when
+///             it's created. If the shape is dynamic it's only stored if it's different to the shape of the
+///             first expression, so that operations without broadcasting don't allocate.
+/// @tparam     Traits  The traits of the result
+// ----------------------------------------------------------------------------------------------------------
+template <typename Traits, bool Static = StaticSizes<Traits>::is_static>
+class BroadcastShape;
+
+// Static shape -- the expressions must broadcast to the shape, which is checked at compile time if both of
+// them are static, and otherwise once at runtime (when the operation is created). The rank and size are
+// compile time constants, so loops over the result have static trip counts.
+template <typename Traits>
+class BroadcastShape<Traits, true> {
+public:
+    using dim_container = typename Traits::dim_container;
+    using sizes         = typename StaticSizes<Traits>::type;
+
+    template <typename E1, typename E2>
+    BroadcastShape(const E1& x, const E2& y)
+    {
+        check(x, std::integral_constant<bool, StaticSizes<typename E1::traits>::is_static>());
+        check(y, std::integral_constant<bool, StaticSizes<typename E2::traits>::is_static>());
+    }
+
+    template <typename Container>
+    constexpr const dim_container& dim_sizes(const Container&) const 
+    { 
+        return StaticDimSizes<dim_container, sizes>::values; 
+    }
+
+    constexpr size_t rank() const { return sizes::size; }
+    constexpr size_t size() const { return product(0); }
+private:
+    // Static expressions were checked at compile time
+    template <typename Expression>
+    void check(const Expression&, std::true_type) const {}
+
+    template <typename Expression>
+    void check(const Expression& expression, std::false_type) const
+    {
+        if (!broadcasts_to(expression.dim_sizes(), expression.rank(), SizeArray<sizes>::values, sizes::size))
+            throw std::invalid_argument("ftl : can't broadcast an expression to the static dimension sizes of "
+                                        "the expression it's used with");
+    }
+
+    static constexpr size_t product(size_t i)
+    {
+        return i < sizes::size ? SizeArray<sizes>::values[i] * product(i + 1) : 1;
+    }
+};
+
+// Dynamic shape -- the shape of the first expression unless the second expression has a larger size
+template <typename Traits>
+class BroadcastShape<Traits, false> {
+public:
+    using dim_container = typename Traits::dim_container;
+
+    template <typename E1, typename E2>
+    BroadcastShape(const E1& x, const E2& y)
+    : _rank(x.rank() > y.rank() ? x.rank() : y.rank()), _size(1), _stored(false)
+    {
+        for (size_t i = 0; i < _rank; ++i) {
+            const size_t size = broadcast_size(dim_size(x.dim_sizes(), x.rank(), i),
+                                               dim_size(y.dim_sizes(), y.rank(), i));
+            _stored = _stored || i >= x.rank() || size != x.dim_sizes()[i];
+            _size  *= size;
+        }
+        if (_stored) {
+            _dim_sizes.resize(_rank);
+            for (size_t i = 0; i < _rank; ++i)
+                _dim_sizes[i] = broadcast_size(dim_size(x.dim_sizes(), x.rank(), i),
+                                               dim_size(y.dim_sizes(), y.rank(), i));
+        }
+    }
+
+    // Gets the dimension sizes, given the dimension sizes of the first expression
+    inline const dim_container& dim_sizes(const dim_container& x) const { return _stored ? _dim_sizes : x; }
+
+    inline size_t rank() const { return _rank; }
+    inline size_t size() const { return _size; }
+private:
+    dim_container   _dim_sizes;         //!< The dimension sizes of the result, if different to the first
+    size_t          _rank;              //!< The rank of the result
+    size_t          _size;              //!< The number of elements of the result
+    bool            _stored;            //!< If the dimension sizes are stored
+};
+
+// ------------------------------------------------- MAPS ---------------------------------------------------
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IdentityMap
+/// @brief      Maps the indices of the result of an operation to the indices of an operand which has the same
+///             (static) shape as the result, which is known at compile time so costs nothing
+// ----------------------------------------------------------------------------------------------------------
+struct IdentityMap {
+    template <typename E1, typename E2>
+    IdentityMap(const E1&, const E2&) {}
+
+    static constexpr bool identity() { return true; }
+
+    inline size_t operator()(size_t i) const { return i; }
+
+    template <typename P, typename Expression>
+    inline typename P::type packet(const Expression& expression, size_t i) const { return expression.packet(i); }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      BroadcastMap
+/// @brief      Maps the (column-major) indices of the result of an operation to the indices of an operand
+///             which is broadcast to the shape of the result. The dimensions of the result are merged where
+///             the operand is broadcast along (or contiguous along) consecutive dimensions, so that most
+///             broadcasts (a vector along any dimension of a tensor) need one or two divisions per index, and
+///             packets are loaded directly (or splatted) from the operand unless they span the first merged
+///             dimension. If the operand isn't broadcast the map is the identity and nothing is allocated.
+// ----------------------------------------------------------------------------------------------------------
+class BroadcastMap {
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Creates the map for an operand and the result of an operation
+    /// @param[in] operand     The operand of the operation
+    /// @param[in] result      The result of the operation, whose shape the operand is broadcast to
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Operand, typename Result>
+    BroadcastMap(const Operand& operand, const Result& result) : _identity(true)
+    {
+        const size_t rank = result.rank();
+        for (size_t i = 0; i < rank; ++i) {
+            if (dim_size(operand.dim_sizes(), operand.rank(), i) != result.dim_sizes()[i]) _identity = false;
+        }
+        if (_identity) return;
+
+        size_t stride = 1;
+        for (size_t i = 0; i < rank; ++i) {
+            const size_t size           = result.dim_sizes()[i];
+            const size_t operand_stride = dim_size(operand.dim_sizes(), operand.rank(), i) == 1 ? 0 : stride;
+            stride *= dim_size(operand.dim_sizes(), operand.rank(), i);
+            if (size == 1) continue;
+
+            // Merge with the previous dimension if both are broadcast, or both are contiguous in the operand
+            if (!_sizes.empty() && ((operand_stride == 0 && _strides.back() == 0) ||
+                                    (operand_stride != 0 && operand_stride == _strides.back() * _sizes.back()))) {
+                _sizes.back() *= size;
+            } else {
+                _sizes.push_back(size);
+                _strides.push_back(operand_stride);
+            }
+        }
+        if (_sizes.empty()) { _sizes.push_back(1); _strides.push_back(0); }
+    }
+
+    inline bool identity() const { return _identity; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Maps the index of an element of the result to the index of the element of the operand
+    /// @param[in] i   The index of the element of the result
+    /// @return    The index of the element of the operand
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t operator()(size_t i) const
+    {
+        if (_identity) return i;
+
+        size_t index = 0;
+        for (size_t d = 0; d < _sizes.size(); ++d) {
+            index += (i % _sizes[d]) * _strides[d];
+            i     /= _sizes[d];
+        }
+        return index;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the packet of the operand for the packet of the result starting at an index
+    /// @param[in] expression  The operand
+    /// @param[in] i           The index of the first element of the packet of the result
+    /// @tparam    P           The packet type
+    /// @tparam    Expression  The type of the operand
+    /// @return    The packet of the operand
+    // ------------------------------------------------------------------------------------------------------
+    template <typename P, typename Expression>
+    inline typename P::type packet(const Expression& expression, size_t i) const
+    {
+        if (_identity) return expression.packet(i);
+
+        // The packet is within a run of the first (merged) dimension
+        if (i % _sizes[0] + P::size <= _sizes[0]) {
+            if (_strides[0] == 1) return expression.packet((*this)(i));
+            if (_strides[0] == 0) return P::set1(expression[(*this)(i)]);
+        }
+        alignas(64) typename P::data_type elements[P::size];
+        for (size_t j = 0; j < P::size; ++j) elements[j] = expression[(*this)(i + j)];
+        return P::load(elements);
+    }
+private:
+    bool                _identity;      //!< If the operand has the same shape as the result
+    std::vector<size_t> _sizes;         //!< The sizes of the merged dimensions of the result
+    std::vector<size_t> _strides;       //!< The strides of the operand for the merged dimensions
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     OperandMap
+/// @brief      Gets the map for an operand of an operation -- the identity if the shapes of the operand and
+///             the result are static and the same, otherwise a map which is created at runtime
+/// @tparam     OperandTraits   The traits of the operand
+/// @tparam     ResultTraits    The traits of the result
+// ----------------------------------------------------------------------------------------------------------
+template <typename OperandTraits, typename ResultTraits>
+struct OperandMap {
+    using type = typename std::conditional<
+                    StaticSizes<OperandTraits>::is_static &&
+                    std::is_same<typename StaticSizes<OperandTraits>::type,
+                                 typename StaticSizes<ResultTraits>::type>::value,
+                    IdentityMap, BroadcastMap>::type;
+};
+
+}               // End namespace detail
+}               // End namespace ftl
+#endif          // FTL_BROADCAST_HPP
@@ -0,0 +1,351 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for the evaluation of tensor expressions into contiguous memory. Expressions which
+///         support packet access are evaluated one packet (vector register) at a time with a scalar loop
+///         for the remaining elements, other expressions are evaluated element by element. Large expressions
+///         are split into contiguous chunks which are evaluated by the library's thread pool, while small
+///         expressions with a static size are evaluated with loops which are unrolled at compile time.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_EVALUATOR_HPP
+#define FTL_EVALUATOR_HPP
+
+#include "layout.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace ftl {
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Evaluator
+/// @brief      Evaluates an expression over a range of elements [begin, end), writing the results to contiguous
+///             memory where out points to the destination of the element begin.
+/// @tparam     Vectorize   If the packet interface of the expression should be used
+// ----------------------------------------------------------------------------------------------------------
+template <bool Vectorize>
+struct Evaluator;
+
+// Scalar case -- for expressions which don't have the same data type as the destination
+template <>
+struct Evaluator<false> {
+    template <typename Dtype, typename Expression>
+    static inline void evaluate(Dtype* out, const Expression& expression, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i) out[i - begin] = expression[i];
+    }
+};
+
+// Vectorized case -- scalar head until the output is aligned for packet stores, then the packet loop,
+// and then a scalar tail for the elements which do not fill a packet
+template <>
+struct Evaluator<true> {
+    template <typename Dtype, typename Expression>
+    static inline void evaluate(Dtype* out, const Expression& expression, size_t begin, size_t end)
+    {
+        using packet = simd::Packet<Dtype>;
+
+        size_t i = begin;
+
+        // Peel elements until the stores are aligned, if the output can be aligned at all
+        if (reinterpret_cast<uintptr_t>(out) % sizeof(Dtype) == 0) {
+            while (i < end && reinterpret_cast<uintptr_t>(out + (i - begin)) % simd::PacketAlignment<Dtype>::value) {
+                out[i - begin] = expression[i]; ++i;
+            }
+            for (; i + packet::size <= end; i += packet::size) 
+                packet::store(out + (i - begin), expression.packet(i));
+        } else {
+            for (; i + packet::size <= end; i += packet::size) 
+                packet::storeu(out + (i - begin), expression.packet(i));
+        }
+        for (; i < end; ++i) out[i - begin] = expression[i];
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     CanVectorize
+/// @brief      Determines if an expression can be evaluated using packets for a given output data type
+/// @tparam     Dtype       The data type of the output
+/// @tparam     Expression  The expression to evaluate
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Expression>
+struct CanVectorize {
+    static constexpr bool value = Expression::vectorizable                                     &&
+                                  std::is_same<Dtype, typename Expression::data_type>::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     UnrolledEvaluator
+/// @brief      Evaluates all the elements of an expression with a static size into contiguous memory, with
+///             the loops over the packets and the remaining elements unrolled at compile time
+/// @tparam     Vectorize   If the packet interface of the expression should be used
+// ----------------------------------------------------------------------------------------------------------
+template <bool Vectorize>
+struct UnrolledEvaluator;
+
+// Scalar case -- each element is evaluated by a separate statement
+template <>
+struct UnrolledEvaluator<false> {
+    template <size_t Size, typename Dtype, typename Expression>
+    static inline void evaluate(Dtype* out, const Expression& expression)
+    {
+        elements(out, expression, typename IndexRange<0, Size>::type());
+    }
+
+    template <typename Dtype, typename Expression, size_t... Indices>
+    static inline void elements(Dtype* out, const Expression& expression, SizeList<Indices...>)
+    {
+        using expand = int[];
+        (void)out;                                      // Unused when there are no indices
+        (void)expand{ 0, (out[Indices] = expression[Indices], 0)... };
+    }
+};
+
+// Vectorized case -- the packets and then the elements which do not fill a packet (the output of a static
+// tensor is not aligned for packets)
+template <>
+struct UnrolledEvaluator<true> {
+    template <size_t Size, typename Dtype, typename Expression>
+    static inline void evaluate(Dtype* out, const Expression& expression)
+    {
+        constexpr size_t packets = Size / simd::Packet<Dtype>::size;
+        packet_elements(out, expression, typename IndexRange<0, packets>::type());
+        UnrolledEvaluator<false>::elements(out, expression,
+                                           typename IndexRange<packets * simd::Packet<Dtype>::size, Size>::type());
+    }
+
+    template <typename Dtype, typename Expression, size_t... Packets>
+    static inline void packet_elements(Dtype* out, const Expression& expression, SizeList<Packets...>)
+    {
+        using packet = simd::Packet<Dtype>;
+        using expand = int[];
+        (void)out;                                      // Unused when there are no packets
+        (void)expand{ 0, (packet::storeu(out + Packets * packet::size, 
+                                         expression.packet(Packets * packet::size)), 0)... };
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      The largest static size for which the evaluation is unrolled -- large enough for small fixed
+///             size tensors (3x3, 4x4, 3x3x3), small enough that the unrolled code stays in the instruction cache
+// ----------------------------------------------------------------------------------------------------------
+static constexpr size_t max_unrolled_size = 64;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates the elements [begin, end) of an expression into contiguous memory where out points to
+///             the destination of the element begin, using the packet interface when the expression supports 
+///             it and all of its tensors are contiguous in memory
+/// @param[in]  out         A pointer to the destination of the element begin
+/// @param[in]  expression  The expression to evaluate
+/// @param[in]  begin       The index of the first element to evaluate
+/// @param[in]  end         The index of the element after the last element to evaluate
+/// @tparam     Dtype       The type of data in the output
+/// @tparam     Expression  The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Expression>
+inline void evaluate_range(Dtype* out, const Expression& expression, size_t begin, size_t end)
+{
+    if (expression.contiguous())
+        Evaluator<CanVectorize<Dtype, Expression>::value>::evaluate(out, expression, begin, end);
+    else 
+        Evaluator<false>::evaluate(out, expression, begin, end);
+}
+
+}           // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates the elements [begin, end) of an expression into contiguous memory, using the packet
+///             interface when the expression supports it and all of its tensors are contiguous in memory
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The expression to evaluate
+/// @param[in]  begin       The index of the first element to evaluate
+/// @param[in]  end         The index of the element after the last element to evaluate
+/// @tparam     Dtype       The type of data in the output
+/// @tparam     Expression  The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Expression>
+inline void evaluate(Dtype* out, const Expression& expression, size_t begin, size_t end)
+{
+    detail::evaluate_range(out + begin, expression, begin, end);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates all the elements of an expression into contiguous memory. The elements are split
+///             into contiguous chunks which are evaluated in parallel by the library's thread pool, unless
+///             there are too few elements for the pool's grain size, in which case they are evaluated serially.
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The expression to evaluate
+/// @param[in]  size        The number of elements to evaluate
+/// @tparam     Dtype       The type of data in the output
+/// @tparam     Expression  The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Expression>
+inline void evaluate(Dtype* out, const Expression& expression, size_t size)
+{
+    // Chunk boundaries are on multiples of 64 bytes so that threads don't write to the same cache line
+    const size_t alignment = 64 / sizeof(Dtype) > 0 ? 64 / sizeof(Dtype) : 1;
+    
+    ThreadPool::instance().parallel_for(0, size, [out, &expression] (size_t begin, size_t end) 
+    {
+        evaluate(out, expression, begin, end);
+    }, alignment);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates all the elements of an expression with a size which is known at compile time (and
+///             no larger than detail::max_unrolled_size) into contiguous memory, with the loops unrolled and
+///             without the thread pool, so that small fixed size tensors have no loop or dispatch overhead.
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The expression to evaluate
+/// @tparam     Size        The number of elements to evaluate
+/// @tparam     Dtype       The type of data in the output
+/// @tparam     Expression  The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Size, typename Dtype, typename Expression>
+inline void evaluate_unrolled(Dtype* out, const Expression& expression)
+{
+    static_assert(Size <= detail::max_unrolled_size, "Only small expressions can be evaluated unrolled");
+    using evaluator = detail::UnrolledEvaluator<detail::CanVectorize<Dtype, Expression>::value>;
+    if (expression.contiguous())
+        evaluator::template evaluate<Size>(out, expression);
+    else 
+        detail::UnrolledEvaluator<false>::template evaluate<Size>(out, expression);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates all the elements of an expression into memory which is not contiguous (for example
+///             a view of a tensor), where the memory offset of each element is given by a layout. The elements
+///             are evaluated one run of the first dimension at a time, so that the layout only needs to be used 
+///             once per run, and runs with a unit stride use the packet interface. As for contiguous memory, 
+///             large expressions are evaluated in parallel.
+/// @param[in]  out             A pointer to the memory to write the results to
+/// @param[in]  layout          The layout of the memory, which must provide offset(linear_index)
+/// @param[in]  expression      The expression to evaluate
+/// @param[in]  size            The number of elements to evaluate
+/// @param[in]  inner_size      The size of the first dimension of the layout
+/// @param[in]  inner_stride    The stride of the first dimension of the layout
+/// @tparam     Dtype           The type of data in the output
+/// @tparam     Layout          The type of the layout
+/// @tparam     Expression      The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Layout, typename Expression>
+inline void evaluate(Dtype*             out         , 
+                     const Layout&      layout      , 
+                     const Expression&  expression  , 
+                     size_t             size        , 
+                     size_t             inner_size  , 
+                     size_t             inner_stride)
+{
+    if (size == 0) return;
+    
+    const size_t alignment = 64 / sizeof(Dtype) > 0 ? 64 / sizeof(Dtype) : 1;
+    
+    ThreadPool::instance().parallel_for(0, size, 
+        [out, &layout, &expression, inner_size, inner_stride] (size_t begin, size_t end) 
+        {
+            size_t i = begin;
+            while (i < end) {
+                const size_t run_end = (i / inner_size + 1) * inner_size < end 
+                                     ? (i / inner_size + 1) * inner_size : end;
+                Dtype* run = out + layout.offset(i);
+                
+                if (inner_stride == 1) {
+                    detail::evaluate_range(run, expression, i, run_end);
+                } else {
+                    for (size_t j = i; j < run_end; ++j, run += inner_stride) *run = expression[j];
+                }
+                i = run_end;
+            }
+        }, alignment);
+}
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates all the elements of an expression into memory with a tiled layout, one tile at a
+///             time, so that the elements of a tile (which are close together in memory) are written together.
+///             In a tile, the elements of each run of the first dimension are consecutive both in memory and
+///             in the logical order, so the runs use the packet interface. Tiles are evaluated in parallel.
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The expression to evaluate
+/// @param[in]  rank        The number of dimensions
+/// @param[in]  sizes       The sizes of the dimensions
+/// @param[in]  tiles       The mapping of each dimension of the tiled layout
+/// @param[in]  morton      If the tiles are in Morton order
+/// @tparam     Dtype       The type of data in the output
+/// @tparam     Expression  The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Expression>
+inline void evaluate_into_tiles(Dtype*                  out         ,
+                                const Expression&       expression  ,
+                                size_t                  rank        ,
+                                const size_t*           sizes       ,
+                                const TileDimension*    tiles       ,
+                                bool                    morton      )
+{
+    size_t num_tiles = 1, tile_size = 1;
+    for (size_t i = 0; i < rank; ++i) {
+        num_tiles *= (sizes[i] + (size_t(1) << tiles[i].shift) - 1) >> tiles[i].shift;
+        tile_size <<= tiles[i].shift;
+    }
+    if (num_tiles == 0) return;
+
+    const size_t grain = ThreadPool::instance().grain_size() / tile_size;
+    ThreadPool::instance().parallel_for(0, num_tiles, 
+        [out, &expression, rank, sizes, tiles, morton] (size_t begin, size_t end)
+        {
+            std::vector<size_t> first(rank), extent(rank), index(rank);
+            for (size_t t = begin; t < end; ++t) {
+                // The first element and the number of elements of the tile in each dimension
+                size_t tile = t, tile_offset = 0;
+                for (size_t i = 0; i < rank; ++i) {
+                    const size_t size = size_t(1) << tiles[i].shift;
+                    const size_t grid = (sizes[i] + size - 1) / size;
+                    first[i]     = (tile % grid) * size;
+                    extent[i]    = std::min(size, sizes[i] - first[i]);
+                    index[i]     = 0;
+                    tile_offset += detail::tile_offset(tiles[i], morton, first[i]);
+                    tile        /= grid;
+                }
+
+                // Each run of the first dimension, iterating over the other dimensions of the tile
+                size_t i = 0;
+                do {
+                    size_t linear = 0, offset = tile_offset, stride = 1;
+                    for (size_t j = 0; j < rank; ++j) {
+                        linear += (first[j] + index[j]) * stride;
+                        offset += index[j] * tiles[j].stride;
+                        stride *= sizes[j];
+                    }
+                    evaluate_range(out + offset, expression, linear, linear + extent[0]);
+                    for (i = 1; i < rank && ++index[i] == extent[i]; ++i) index[i] = 0;
+                } while (i < rank);
+            }
+        }, 1, grain > 0 ? grain : 1);
+}
+
+}               // End namespace detail
+}               // End namespace ftl
+#endif          // FTL_EVALUATOR_HPP
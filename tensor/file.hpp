@@ -0,0 +1,146 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for the positional file input and output used by file tensors and serialization.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_FILE_HPP
+#define FTL_FILE_HPP
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @enum       FileMode
+/// @brief      How a file is opened
+// ----------------------------------------------------------------------------------------------------------
+enum class FileMode {
+    read,                       //!< An existing file is read only
+    update,                     //!< An existing file is read and written
+    create                      //!< A new file is created (an existing file is truncated), read and written
+};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      File
+/// @brief      Owns a file descriptor and reads and writes bytes at absolute offsets, so that different
+///             parts of the file can be read and written from different threads at the same time
+// ----------------------------------------------------------------------------------------------------------
+class File {
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- opens the file
+    /// @param[in]  path    The path of the file
+    /// @param[in]  mode    How to open the file
+    // ------------------------------------------------------------------------------------------------------
+    File(const std::string& path, FileMode mode)
+    : _fd(::open(path.c_str(), mode == FileMode::read   ? O_RDONLY :
+                               mode == FileMode::update ? O_RDWR   : O_RDWR | O_CREAT | O_TRUNC, 0644))
+    {
+        if (_fd < 0) error("can't open " + path);
+    }
+
+    File(const File& other)            = delete;
+    File& operator=(const File& other) = delete;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Destructor -- closes the file
+    // ------------------------------------------------------------------------------------------------------
+    ~File() { ::close(_fd); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the size of the file
+    /// @return     The number of bytes in the file
+    // ------------------------------------------------------------------------------------------------------
+    size_t bytes() const
+    {
+        struct stat status;
+        if (::fstat(_fd, &status) != 0) error("can't get the size of the file");
+        return static_cast<size_t>(status.st_size);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Sets the size of the file -- the bytes which are added are zero, and aren't allocated on
+    ///             the disk until they are written (for filesystems which support sparse files)
+    /// @param[in]  bytes   The number of bytes in the file
+    // ------------------------------------------------------------------------------------------------------
+    void resize(size_t bytes) const
+    {
+        if (::ftruncate(_fd, static_cast<off_t>(bytes)) != 0) error("can't set the size of the file");
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Reads bytes from the file
+    /// @param[out] data    Where to put the bytes
+    /// @param[in]  bytes   The number of bytes to read
+    /// @param[in]  offset  The offset of the first byte in the file
+    // ------------------------------------------------------------------------------------------------------
+    void read(void* data, size_t bytes, size_t offset) const
+    {
+        char* position = static_cast<char*>(data);
+        while (bytes > 0) {
+            const ssize_t count = ::pread(_fd, position, bytes, static_cast<off_t>(offset));
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) error("can't read the file");
+            position += count; offset += count; bytes -= count;
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Writes bytes to the file
+    /// @param[in]  data    The bytes to write
+    /// @param[in]  bytes   The number of bytes to write
+    /// @param[in]  offset  The offset in the file of the first byte
+    // ------------------------------------------------------------------------------------------------------
+    void write(const void* data, size_t bytes, size_t offset) const
+    {
+        const char* position = static_cast<const char*>(data);
+        while (bytes > 0) {
+            const ssize_t count = ::pwrite(_fd, position, bytes, static_cast<off_t>(offset));
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) error("can't write the file");
+            position += count; offset += count; bytes -= count;
+        }
+    }
+private:
+    int _fd;                    //!< The file descriptor
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Throws an error with the description of errno
+    /// @param[in]  message     What failed
+    // ------------------------------------------------------------------------------------------------------
+    static void error(const std::string& message)
+    {
+        throw std::runtime_error("ftl::File : " + message + " (" + std::strerror(errno) + ")");
+    }
+};
+
+}               // End namespace detail
+
+}               // End namespace ftl
+#endif          // FTL_FILE_HPP
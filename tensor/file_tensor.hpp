@@ -0,0 +1,379 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for tensors whose data is stored in a file, and which are evaluated a tile at a time.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_FILE_TENSOR_HPP
+#define FTL_FILE_TENSOR_HPP
+
+#include "file.hpp"
+#include "layout.hpp"
+#include "tensor_dynamic_cpu.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      FileTensor
+/// @brief      A tensor whose (column-major) data is stored in a file rather than in memory, so it can be
+///             larger than the memory of the machine. The data is split into tiles along the last dimension,
+///             each of which is a contiguous part of the file holding a number of whole slabs (all the
+///             elements with the same index in the last dimension). Tiles are read into (and written from)
+///             ordinary dynamic tensors, so any expression can be used on a tile, including broadcasting
+///             in-memory tensors over the other dimensions. The file holds the elements only -- the
+///             dimension sizes are given when the file is opened.
+/// @tparam     DT      The type of the data
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT>
+class FileTensor {
+public:
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using tile_type         = DynamicTensorCpu<DT>;
+    using data_container    = typename tile_type::data_container;
+    using dim_container     = typename tile_type::dim_container;
+    using data_type         = typename tile_type::data_type;
+    using size_type         = typename tile_type::size_type;
+    // ------------------------------------------------------------------------------------------------------
+
+    static constexpr size_type default_tile_bytes = size_type(1) << 26;    //!< 64 MiB tiles by default
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- opens the file of the tensor. An existing file must have exactly the number
+    ///             of bytes given by the dimension sizes, while a created file has all its elements zero.
+    /// @param[in]  path        The path of the file
+    /// @param[in]  dim_sizes   The sizes of the dimensions of the tensor
+    /// @param[in]  mode        How to open the file
+    /// @param[in]  tile_bytes  The largest number of bytes of a tile -- a tile always has at least one slab
+    // ------------------------------------------------------------------------------------------------------
+    FileTensor(const std::string&   path                                ,
+               dim_container        dim_sizes                           ,
+               FileMode             mode        = FileMode::read        ,
+               size_type            tile_bytes  = default_tile_bytes    );
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the rank (number of dimensions) of the tensor
+    /// @return     The rank of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type rank() const { return _dim_sizes.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the size (total number of elements) of the tensor
+    /// @return     The number of elements in the tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type size() const { return _slab_size * _dim_sizes.back(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the sizes of the dimensions of the tensor
+    /// @return     The sizes of the dimensions of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _dim_sizes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the mode in which the file was opened
+    /// @return     The mode of the file
+    // ------------------------------------------------------------------------------------------------------
+    inline FileMode mode() const { return _mode; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of slabs in a tile (the last tile may have fewer)
+    /// @return     The number of indices of the last dimension in a tile
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type tile_slabs() const { return _tile_slabs; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of tiles of the tensor
+    /// @return     The number of tiles
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type num_tiles() const { return (_dim_sizes.back() + _tile_slabs - 1) / _tile_slabs; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the dimension sizes of a number of slabs, which are those of the tensor with the
+    ///             size of the last dimension replaced by the number of slabs
+    /// @param[in]  slabs   The number of slabs
+    /// @return     The dimension sizes of the slabs
+    // ------------------------------------------------------------------------------------------------------
+    dim_container slab_dim_sizes(size_type slabs) const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the dimension sizes of a tile
+    /// @param[in]  tile    The index of the tile
+    /// @return     The dimension sizes of the tile
+    // ------------------------------------------------------------------------------------------------------
+    inline dim_container tile_dim_sizes(size_type tile) const { return slab_dim_sizes(slabs_in_tile(tile)); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Reads a tile from the file into memory
+    /// @param[in]  tile    The index of the tile
+    /// @return     A (column-major) tensor with the elements of the tile
+    // ------------------------------------------------------------------------------------------------------
+    tile_type read_tile(size_type tile) const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression into a tile of the file
+    /// @param[in]  tile        The index of the tile
+    /// @param[in]  expression  The expression to evaluate, which must have the dimension sizes of the tile
+    /// @tparam     Expression  The type of the expression
+    /// @tparam     Traits      The tensor traits of the expression
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression, typename Traits>
+    void write_tile(size_type tile, const TensorExpression<Expression, Traits>& expression);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Reads a range of slabs from the file, reusing the memory of a container
+    /// @param[in]  first   The index (in the last dimension) of the first slab
+    /// @param[in]  slabs   The number of slabs to read
+    /// @param[out] data    The container for the elements, which is resized to hold the slabs
+    // ------------------------------------------------------------------------------------------------------
+    void read_slabs(size_type first, size_type slabs, data_container& data) const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Writes a range of slabs to the file
+    /// @param[in]  first   The index (in the last dimension) of the first slab
+    /// @param[in]  slabs   The number of slabs to write
+    /// @param[in]  data    The (column-major) elements of the slabs
+    // ------------------------------------------------------------------------------------------------------
+    void write_slabs(size_type first, size_type slabs, const data_type* data) const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of slabs in a tile
+    /// @param[in]  tile    The index of the tile
+    /// @return     The number of slabs in the tile
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type slabs_in_tile(size_type tile) const
+    {
+        return std::min(_tile_slabs, _dim_sizes.back() - tile * _tile_slabs);
+    }
+private:
+    detail::File    _file;              //!< The file holding the data
+    dim_container   _dim_sizes;         //!< The sizes of the dimensions
+    FileMode        _mode;              //!< How the file was opened
+    size_type       _slab_size;         //!< The number of elements in a slab
+    size_type       _tile_slabs;        //!< The number of slabs in a tile
+};
+
+// ---------------------------------------------- IMPLEMENTATIONS -------------------------------------------
+
+template <typename DT>
+constexpr typename FileTensor<DT>::size_type FileTensor<DT>::default_tile_bytes;
+
+template <typename DT>
+FileTensor<DT>::FileTensor(const std::string& path, dim_container dim_sizes, FileMode mode, size_type tile_bytes)
+: _file(path, mode), _dim_sizes(std::move(dim_sizes)), _mode(mode)
+{
+    if (_dim_sizes.empty())
+        throw std::invalid_argument("ftl::FileTensor : a file tensor must have at least one dimension");
+
+    _slab_size  = std::accumulate(_dim_sizes.begin(), _dim_sizes.end() - 1, size_type(1),
+                                  std::multiplies<size_type>());
+    _tile_slabs = std::max(std::min(tile_bytes / std::max(_slab_size * sizeof(data_type), size_type(1)),
+                                    _dim_sizes.back()), size_type(1));
+
+    const size_type bytes = size() * sizeof(data_type);
+    if (mode == FileMode::create)
+        _file.resize(bytes);
+    else if (_file.bytes() != bytes)
+        throw std::invalid_argument("ftl::FileTensor : the size of " + path + " doesn't match the dimension sizes");
+}
+
+template <typename DT>
+typename FileTensor<DT>::dim_container FileTensor<DT>::slab_dim_sizes(size_type slabs) const
+{
+    dim_container dim_sizes(_dim_sizes);
+    dim_sizes.back() = slabs;
+    return dim_sizes;
+}
+
+template <typename DT>
+typename FileTensor<DT>::tile_type FileTensor<DT>::read_tile(size_type tile) const
+{
+    if (tile >= num_tiles()) throw std::out_of_range("ftl::FileTensor::read_tile : tile index out of range");
+    data_container data;
+    read_slabs(tile * _tile_slabs, slabs_in_tile(tile), data);
+    return tile_type(tile_dim_sizes(tile), std::move(data));
+}
+
+template <typename DT> template <typename E, typename T>
+void FileTensor<DT>::write_tile(size_type tile, const TensorExpression<E, T>& expression)
+{
+    if (tile >= num_tiles()) throw std::out_of_range("ftl::FileTensor::write_tile : tile index out of range");
+    const tile_type result(expression);
+    if (result.dim_sizes() != tile_dim_sizes(tile))
+        throw std::invalid_argument("ftl::FileTensor::write_tile : expression has different dimension sizes to the tile");
+    write_slabs(tile * _tile_slabs, slabs_in_tile(tile), result.data().data());
+}
+
+template <typename DT>
+void FileTensor<DT>::read_slabs(size_type first, size_type slabs, data_container& data) const
+{
+    data.resize(slabs * _slab_size);
+    _file.read(data.data(), data.size() * sizeof(data_type), first * _slab_size * sizeof(data_type));
+}
+
+template <typename DT>
+void FileTensor<DT>::write_slabs(size_type first, size_type slabs, const data_type* data) const
+{
+    if (_mode == FileMode::read) throw std::logic_error("ftl::FileTensor : can't write a file opened to read");
+    _file.write(data, slabs * _slab_size * sizeof(data_type), first * _slab_size * sizeof(data_type));
+}
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     TileBuffer
+/// @brief      The memory of the tiles of an input of a tiled evaluation -- the tile which is being used
+///             and the next tile, which is read while the current one is used
+/// @tparam     FileTensorType  The type of the file tensor which is read
+// ----------------------------------------------------------------------------------------------------------
+template <typename FileTensorType>
+struct TileBuffer {
+    using tile_type         = typename FileTensorType::tile_type;
+    using data_container    = typename FileTensorType::data_container;
+    using size_type         = typename FileTensorType::size_type;
+
+    const FileTensorType&   file;           //!< The file which is read
+    data_container          next;           //!< The elements of the next tile
+    tile_type               current;        //!< The tile which is used
+
+    explicit TileBuffer(const FileTensorType& f) : file(f), current(f.rank()) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Reads the next tile
+    /// @param[in]  first   The index of the first slab of the tile
+    /// @param[in]  slabs   The number of slabs in the tile
+    // ------------------------------------------------------------------------------------------------------
+    void fetch(size_type first, size_type slabs) { file.read_slabs(first, slabs, next); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Makes the next tile the current tile, and the memory of the current tile the memory for
+    ///             the next one, so no memory is allocated once the first two tiles have been read
+    /// @param[in]  slabs   The number of slabs in the next tile
+    // ------------------------------------------------------------------------------------------------------
+    void advance(size_type slabs)
+    {
+        data_container used = current.release();
+        current.adopt(file.slab_dim_sizes(slabs), std::move(next));
+        next = std::move(used);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reads the next tile of each input
+// ----------------------------------------------------------------------------------------------------------
+template <typename Buffers, size_t... I>
+void fetch_tiles(Buffers& buffers, size_t first, size_t slabs, SizeList<I...>)
+{
+    int expand[] = { 0, (std::get<I>(buffers).fetch(first, slabs), 0)... };
+    (void)expand;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Makes the next tile of each input the current tile
+// ----------------------------------------------------------------------------------------------------------
+template <typename Buffers, size_t... I>
+void advance_tiles(Buffers& buffers, size_t slabs, SizeList<I...>)
+{
+    int expand[] = { 0, (std::get<I>(buffers).advance(slabs), 0)... };
+    (void)expand;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Calls the function of a tiled evaluation with the current tile of each input
+// ----------------------------------------------------------------------------------------------------------
+template <typename Function, typename Buffers, size_t... I>
+auto apply_tiles(Function& function, Buffers& buffers, SizeList<I...>)
+-> decltype(function(std::get<I>(buffers).current...))
+{
+    return function(std::get<I>(buffers).current...);
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates a function of file tensors into a file tensor, one tile at a time. For each tile of
+///             the output the function is called with the tiles of the inputs which have the same slabs,
+///             as (column-major) dynamic tensors, and returns the expression (or tensor) for the tile of the
+///             output, for example
+///
+///             ftl::evaluate_tiled(C, [&bias] (const Tile& a, const Tile& b) { return a * b + bias; }, A, B);
+///
+///             The next tile of each input is read while the current one is evaluated, and each tile of the
+///             output is written while the next one is evaluated, so at most two tiles of each input and of
+///             the output are in memory. The output may also be an input.
+/// @param[in]  out         The tensor to evaluate into, which must be writable
+/// @param[in]  function    The function which gives the expression for a tile of the output
+/// @param[in]  inputs      The file tensors whose tiles are passed to the function, which must have the
+///                         dimension sizes of the output
+/// @tparam     DT          The data type of the output
+/// @tparam     Function    The type of the function
+/// @tparam     Inputs      The types of the inputs (each a FileTensor of any data type)
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT, typename Function, typename... Inputs>
+void evaluate_tiled(FileTensor<DT>& out, Function function, const Inputs&... inputs)
+{
+    using size_type     = typename FileTensor<DT>::size_type;
+    using tile_type     = typename FileTensor<DT>::tile_type;
+    using indices       = typename detail::IndexRange<0, sizeof...(Inputs)>::type;
+
+    const bool same_sizes[] = { true, (inputs.dim_sizes() == out.dim_sizes())... };
+    for (const bool same : same_sizes)
+        if (!same) throw std::invalid_argument("ftl::evaluate_tiled : inputs have different dimension sizes to the output");
+    if (out.mode() == FileMode::read)
+        throw std::invalid_argument("ftl::evaluate_tiled : the output must be opened to write");
+
+    const size_type tiles = out.num_tiles(), slabs = out.tile_slabs();
+    std::tuple<detail::TileBuffer<Inputs>...>   buffers{ detail::TileBuffer<Inputs>(inputs)... };
+    tile_type                                   results[2] = { tile_type(out.rank()), tile_type(out.rank()) };
+    std::future<void>                           reading, writing;
+
+    detail::fetch_tiles(buffers, 0, out.slabs_in_tile(0), indices());
+    for (size_type tile = 0; tile < tiles; ++tile) {
+        detail::advance_tiles(buffers, out.slabs_in_tile(tile), indices());
+        if (tile + 1 < tiles) {
+            reading = std::async(std::launch::async, [&buffers, &out, tile, slabs] () {
+                detail::fetch_tiles(buffers, (tile + 1) * slabs, out.slabs_in_tile(tile + 1), indices());
+            });
+        }
+
+        // The other result is being written, so this one is free
+        tile_type& result = results[tile % 2];
+        result = detail::apply_tiles(function, buffers, indices());
+        if (result.dim_sizes() != out.tile_dim_sizes(tile))
+            throw std::invalid_argument("ftl::evaluate_tiled : function gives different dimension sizes to the tile");
+
+        if (writing.valid()) writing.get();
+        writing = std::async(std::launch::async, [&out, &result, tile, slabs] () {
+            out.write_slabs(tile * slabs, out.slabs_in_tile(tile), result.data().data());
+        });
+        if (reading.valid()) reading.get();
+    }
+    if (writing.valid()) writing.get();
+}
+
+}               // End namespace ftl
+#endif          // FTL_FILE_TENSOR_HPP
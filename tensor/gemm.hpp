@@ -0,0 +1,314 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for the cache-blocked matrix multiplication engine which is used for tensor
+///         contractions. The operands are packed into contiguous panels which fit in the caches, and the
+///         product of the panels is computed by a register-tiled micro-kernel which uses the simd packets.
+///         The columns (or rows) of the result are split between the threads of the library's thread pool.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_GEMM_HPP
+#define FTL_GEMM_HPP
+
+#include "aligned_allocator.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <vector>
+
+namespace ftl {
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     GemmBlocking
+/// @brief      The register tile (mr x nr) and the cache blocks (mc x kc of the first operand in L2, kc x nc
+///             of the second operand in L3, and kc x nr of the second operand in L1) for a data type
+/// @tparam     Dtype   The type of data of the operands
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct GemmBlocking {
+    using packet = simd::Packet<Dtype>;
+
+    // Two packets of rows and as many columns as there are registers for the accumulators
+    static constexpr size_t mr = packet::size > 1 ? 2 * packet::size : 4;
+#if defined(FTL_SIMD_AVX512)
+    static constexpr size_t nr = packet::size > 1 ? 8 : 4;
+#else
+    static constexpr size_t nr = packet::size > 1 ? 6 : 4;
+#endif
+    static constexpr size_t kc = 256;
+    static constexpr size_t mc = (128 + mr - 1) / mr * mr;
+    static constexpr size_t nc = (2048 + nr - 1) / nr * nr;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      GemmOperand
+/// @brief      Maps an expression to a matrix for the multiplication -- the element (i, k) of the matrix is
+///             the element of the expression with (column-major) index outer[i] + inner[k], so the outer
+///             (free) and inner (contracted) dimensions of a tensor can be any of its dimensions.
+/// @tparam     Expression  The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename Expression>
+class GemmOperand {
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- sets the expression and the index tables
+    /// @param[in]  expression  The expression which holds the elements
+    /// @param[in]  outer       The index offset of each row of the matrix
+    /// @param[in]  inner       The index offset of each column of the matrix
+    // ------------------------------------------------------------------------------------------------------
+    GemmOperand(const Expression& expression, std::vector<size_t> outer, std::vector<size_t> inner)
+    : _expression(expression), _outer(std::move(outer)), _inner(std::move(inner)) {}
+
+    inline size_t outer_size() const { return _outer.size(); }
+    inline size_t inner_size() const { return _inner.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Packs a block of the matrix into panels of a given number of rows -- the panel p holds the
+    ///             elements (p * Rows + r, k) at p * Rows * inner + k * Rows + r, where rows past the end of
+    ///             the block are filled with zeros
+    /// @param[out] out             The memory for the packed panels
+    /// @param[in]  outer_start     The first row of the block
+    /// @param[in]  outer_count     The number of rows in the block
+    /// @param[in]  inner_start     The first column of the block
+    /// @param[in]  inner_count     The number of columns in the block
+    /// @tparam     Rows            The number of rows in a panel
+    /// @tparam     Dtype           The type of the data
+    // ------------------------------------------------------------------------------------------------------
+    template <size_t Rows, typename Dtype>
+    void pack(Dtype* out, size_t outer_start, size_t outer_count, size_t inner_start, size_t inner_count) const
+    {
+        for (size_t p = 0; p < outer_count; p += Rows) {
+            const size_t rows = outer_count - p < Rows ? outer_count - p : Rows;
+            const size_t* outer = _outer.data() + outer_start + p;
+            for (size_t k = 0; k < inner_count; ++k) {
+                const size_t inner = _inner[inner_start + k];
+                for (size_t r = 0; r < rows; ++r) out[r] = _expression[outer[r] + inner];
+                for (size_t r = rows; r < Rows; ++r) out[r] = Dtype(0);
+                out += Rows;
+            }
+        }
+    }
+private:
+    const Expression&       _expression;    //!< The expression which holds the elements
+    std::vector<size_t>     _outer;         //!< The index offset of each row
+    std::vector<size_t>     _inner;         //!< The index offset of each column
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     GemmKernel
+/// @brief      Register-tiled micro-kernel which computes an mr x nr tile of the result from a panel of each
+///             operand, keeping the whole tile in registers for the loop over the inner dimension
+/// @tparam     Dtype   The type of data of the operands
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct GemmKernel {
+    using packet        = simd::Packet<Dtype>;
+    using packet_type   = typename packet::type;
+    using blocking      = GemmBlocking<Dtype>;
+
+    static constexpr size_t mr = blocking::mr;
+    static constexpr size_t nr = blocking::nr;
+    static constexpr size_t pm = mr / packet::size;     //!< Number of packets in a column of the tile
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Computes the tile C = A * B (or C += A * B when accumulating)
+    /// @param[in]  depth       The size of the inner dimension of the panels
+    /// @param[in]  a           The packed panel of the first operand (mr rows)
+    /// @param[in]  b           The packed panel of the second operand (nr columns)
+    /// @param[out] c           The top left element of the tile of the result
+    /// @param[in]  ldc         The stride between the columns of the result
+    /// @param[in]  rows        The number of valid rows in the tile
+    /// @param[in]  cols        The number of valid columns in the tile
+    /// @param[in]  accumulate  If the product must be added to the result rather than overwrite it
+    // ------------------------------------------------------------------------------------------------------
+    static void run(size_t depth, const Dtype* a, const Dtype* b, Dtype* c, size_t ldc,
+                    size_t rows, size_t cols, bool accumulate)
+    {
+        packet_type acc[pm][nr];
+        for (size_t i = 0; i < pm; ++i)
+            for (size_t j = 0; j < nr; ++j) acc[i][j] = packet::set1(Dtype(0));
+
+        for (size_t k = 0; k < depth; ++k, a += mr, b += nr) {
+            packet_type av[pm];
+            for (size_t i = 0; i < pm; ++i) av[i] = packet::load(a + i * packet::size);
+            for (size_t j = 0; j < nr; ++j) {
+                const packet_type bv = packet::set1(b[j]);
+                for (size_t i = 0; i < pm; ++i) acc[i][j] = packet::fmadd(av[i], bv, acc[i][j]);
+            }
+        }
+
+        if (rows == mr && cols == nr) {
+            for (size_t j = 0; j < nr; ++j) {
+                for (size_t i = 0; i < pm; ++i) {
+                    Dtype* out = c + j * ldc + i * packet::size;
+                    packet::storeu(out, accumulate ? packet::add(packet::loadu(out), acc[i][j]) : acc[i][j]);
+                }
+            }
+        } else {
+            // Edge tile -- write the tile to memory and then copy the valid part
+            alignas(default_alignment) Dtype tile[mr * nr];
+            for (size_t j = 0; j < nr; ++j)
+                for (size_t i = 0; i < pm; ++i) packet::store(tile + j * mr + i * packet::size, acc[i][j]);
+            for (size_t j = 0; j < cols; ++j) {
+                for (size_t i = 0; i < rows; ++i)
+                    c[j * ldc + i] = accumulate ? c[j * ldc + i] + tile[j * mr + i] : tile[j * mr + i];
+            }
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      GemmBuffer
+/// @brief      Aligned, uninitialized memory for packed panels, which each thread keeps and grows as needed, so
+///             that the panels are not allocated (or zeroed) for every block -- packing writes every element
+///             before it is read
+/// @tparam     Dtype   The type of the data
+/// @tparam     Slot    Identifies the buffer, so that a thread can hold a buffer for each operand
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, size_t Slot>
+class GemmBuffer {
+public:
+    GemmBuffer() : _data(nullptr), _capacity(0) {}
+    ~GemmBuffer() { if (_data != nullptr) AlignedAllocator<Dtype>().deallocate(_data, _capacity); }
+
+    GemmBuffer(const GemmBuffer&)               = delete;
+    GemmBuffer& operator=(const GemmBuffer&)    = delete;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the buffer of the calling thread with space for at least a number of elements
+    /// @param[in]  num_elements    The number of elements required
+    /// @return     A pointer to the (uninitialized) memory
+    // ------------------------------------------------------------------------------------------------------
+    static Dtype* get(size_t num_elements)
+    {
+        static thread_local GemmBuffer buffer;
+        if (num_elements > buffer._capacity) {
+            AlignedAllocator<Dtype> allocator;
+            if (buffer._data != nullptr) allocator.deallocate(buffer._data, buffer._capacity);
+            buffer._data     = nullptr;
+            buffer._capacity = 0;
+            buffer._data     = allocator.allocate(num_elements);
+            buffer._capacity = num_elements;
+        }
+        return buffer._data;
+    }
+private:
+    Dtype*  _data;          //!< The memory of the buffer
+    size_t  _capacity;      //!< The number of elements the memory has space for
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the block [row_start, row_end) x [col_start, col_end) of C = A * B^T on the calling
+///             thread, where C is column-major and A and B are (rows x depth) and (cols x depth) operands
+/// @param[out] c           The result
+/// @param[in]  ldc         The stride between the columns of the result
+/// @param[in]  a           The first operand
+/// @param[in]  b           The second operand
+/// @param[in]  row_start   The first row of the block
+/// @param[in]  row_end     The row after the last row of the block
+/// @param[in]  col_start   The first column of the block
+/// @param[in]  col_end     The column after the last column of the block
+/// @tparam     Dtype       The type of the data
+/// @tparam     EA          The type of the expression of the first operand
+/// @tparam     EB          The type of the expression of the second operand
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename EA, typename EB>
+void gemm_block(Dtype* c, size_t ldc, const GemmOperand<EA>& a, const GemmOperand<EB>& b,
+                size_t row_start, size_t row_end, size_t col_start, size_t col_end)
+{
+    using blocking  = GemmBlocking<Dtype>;
+    using kernel    = GemmKernel<Dtype>;
+
+    // The panels are padded to whole register tiles, and are only as large as the block needs
+    const size_t depth = a.inner_size();
+    const size_t kmax  = depth < blocking::kc ? depth : blocking::kc;
+    const size_t mmax  = row_end - row_start < blocking::mc ? row_end - row_start : blocking::mc;
+    const size_t nmax  = col_end - col_start < blocking::nc ? col_end - col_start : blocking::nc;
+    Dtype* a_packed = GemmBuffer<Dtype, 0>::get((mmax + blocking::mr - 1) / blocking::mr * blocking::mr * kmax);
+    Dtype* b_packed = GemmBuffer<Dtype, 1>::get((nmax + blocking::nr - 1) / blocking::nr * blocking::nr * kmax);
+
+    for (size_t jc = col_start; jc < col_end; jc += blocking::nc) {
+        const size_t nb = col_end - jc < blocking::nc ? col_end - jc : blocking::nc;
+
+        for (size_t pc = 0; pc < depth; pc += blocking::kc) {
+            const size_t kb = depth - pc < blocking::kc ? depth - pc : blocking::kc;
+            b.template pack<blocking::nr>(b_packed, jc, nb, pc, kb);
+
+            for (size_t ic = row_start; ic < row_end; ic += blocking::mc) {
+                const size_t mb = row_end - ic < blocking::mc ? row_end - ic : blocking::mc;
+                a.template pack<blocking::mr>(a_packed, ic, mb, pc, kb);
+
+                for (size_t jr = 0; jr < nb; jr += blocking::nr) {
+                    for (size_t ir = 0; ir < mb; ir += blocking::mr) {
+                        kernel::run(kb, a_packed + ir * kb, b_packed + jr * kb,
+                                    c + (ic + ir) + (jc + jr) * ldc, ldc                            ,
+                                    mb - ir < blocking::mr ? mb - ir : blocking::mr                 ,
+                                    nb - jr < blocking::nr ? nb - jr : blocking::nr                 ,
+                                    pc > 0                                                          );
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes C = A * B^T, where C is a column-major (rows x cols) matrix, and A and B are (rows x
+///             depth) and (cols x depth) operands. The larger of the dimensions of C is split between the
+///             threads of the library's thread pool, with each thread packing its own panels.
+/// @param[out] c       The result, with space for rows * cols elements
+/// @param[in]  a       The first operand
+/// @param[in]  b       The second operand
+/// @tparam     Dtype   The type of the data
+/// @tparam     EA      The type of the expression of the first operand
+/// @tparam     EB      The type of the expression of the second operand
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename EA, typename EB>
+void gemm(Dtype* c, const GemmOperand<EA>& a, const GemmOperand<EB>& b)
+{
+    using blocking = GemmBlocking<Dtype>;
+
+    const size_t rows  = a.outer_size(), cols = b.outer_size(), depth = a.inner_size();
+    if (rows == 0 || cols == 0) return;
+    if (depth == 0) {
+        for (size_t i = 0; i < rows * cols; ++i) c[i] = Dtype(0);
+        return;
+    }
+
+    // The grain of the pool is in elements (operations), so scale it by the work for each row or column
+    ThreadPool& pool = ThreadPool::instance();
+    if (cols >= rows) {
+        const size_t grain = pool.grain_size() / (rows * depth) > 0 ? pool.grain_size() / (rows * depth) : 1;
+        pool.parallel_for(0, cols, [c, rows, &a, &b] (size_t begin, size_t end)
+        {
+            gemm_block(c, rows, a, b, 0, rows, begin, end);
+        }, blocking::nr, grain);
+    } else {
+        const size_t grain = pool.grain_size() / (cols * depth) > 0 ? pool.grain_size() / (cols * depth) : 1;
+        pool.parallel_for(0, rows, [c, rows, cols, &a, &b] (size_t begin, size_t end)
+        {
+            gemm_block(c, rows, a, b, begin, end, 0, cols);
+        }, blocking::mr, grain);
+    }
+}
+
+}               // End namespace detail
+}               // End namespace ftl
+#endif          // FTL_GEMM_HPP
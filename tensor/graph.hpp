@@ -0,0 +1,588 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for computation graphs of elementwise operations, which are recorded at runtime,
+///         optimized, and compiled into a plan which is evaluated many times.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_GRAPH_HPP
+#define FTL_GRAPH_HPP
+
+#include "aligned_allocator.hpp"
+#include "simd.hpp"
+#include "tensor_dynamic_cpu.hpp"
+#include "tensor_elementwise.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// NOTE : Expressions built from tensors are trees whose types are known at compile time, so a subexpression
+//        which appears twice is evaluated twice. A Graph instead records the operations on its symbols at
+//        runtime as a DAG, and compiling the graph:
+//
+//          - removes the nodes which the outputs don't use
+//          - folds operations on constants, and removes identities (x + 0, x * 1, x / 1, -(-x))
+//          - merges identical nodes (common subexpressions), including commuted additions and products
+//          - assigns each remaining operation a buffer of a block of elements, reusing the buffers of
+//            values which are no longer used
+//
+//        The plan evaluates every operation of the graph for one block of elements before the next block, so
+//        all the operations are fused into a single pass over memory, and each shared value is computed once
+//        per element. Blocks are split between the threads of the pool.
+namespace ftl {
+
+template <typename Dtype> class Graph;
+template <typename Dtype> class CompiledGraph;
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @enum       GraphOp
+/// @brief      The operation of a node of a graph
+// ----------------------------------------------------------------------------------------------------------
+enum class GraphOp {
+    input, constant,                                                        // Leaves
+    add, subtract, multiply, divide, minimum, maximum, pow,                 // Binary operations
+    negate, abs, sqrt, exp, log, tanh, sigmoid                              // Unary operations
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Checks if an operation has two operands
+/// @param[in]  op  The operation
+/// @return     True if the operation is binary
+// ----------------------------------------------------------------------------------------------------------
+inline bool is_binary(GraphOp op) { return op >= GraphOp::add && op <= GraphOp::pow; }
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     GraphNode
+/// @brief      A node of a graph -- an input, a constant, or an operation on other nodes
+/// @tparam     Dtype   The data type of the graph
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct GraphNode {
+    static constexpr size_t none = std::numeric_limits<size_t>::max();
+
+    GraphOp op;             //!< The operation
+    size_t  x;              //!< The first operand, or the index of an input
+    size_t  y;              //!< The second operand, for binary operations
+    Dtype   value;          //!< The value of a constant
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Applies an operation to blocks of elements, a packet at a time -- the output may be one of
+///             the operands, since each element is read before it is written
+/// @param[in]  x       The first operand
+/// @param[in]  y       The second operand (unused for unary operations)
+/// @param[out] out     The results
+/// @param[in]  size    The number of elements
+/// @tparam     Op      The operation (see tensor_elementwise.hpp)
+/// @tparam     Dtype   The data type of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename Op, typename Dtype>
+void graph_kernel(const Dtype* x, const Dtype* y, Dtype* out, size_t size, std::true_type /* binary */)
+{
+    using packet = simd::Packet<Dtype>;
+    using scalar = simd::ScalarPacket<Dtype>;
+    size_t i = 0;
+    for (; i + packet::size <= size; i += packet::size)
+        packet::storeu(out + i, Op::template apply<packet>(packet::loadu(x + i), packet::loadu(y + i)));
+    for (; i < size; ++i) out[i] = Op::template apply<scalar>(x[i], y[i]);
+}
+
+template <typename Op, typename Dtype>
+void graph_kernel(const Dtype* x, const Dtype*, Dtype* out, size_t size, std::false_type /* binary */)
+{
+    using packet = simd::Packet<Dtype>;
+    using scalar = simd::ScalarPacket<Dtype>;
+    size_t i = 0;
+    for (; i + packet::size <= size; i += packet::size)
+        packet::storeu(out + i, Op::template apply<packet>(packet::loadu(x + i)));
+    for (; i < size; ++i) out[i] = Op::template apply<scalar>(x[i]);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Applies an operation of a graph to blocks of elements
+/// @param[in]  op      The operation
+/// @param[in]  x       The first operand
+/// @param[in]  y       The second operand (unused for unary operations)
+/// @param[out] out     The results
+/// @param[in]  size    The number of elements
+/// @tparam     Dtype   The data type of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+void apply_graph_op(GraphOp op, const Dtype* x, const Dtype* y, Dtype* out, size_t size)
+{
+    using accurate = simd::Accurate;
+    switch (op) {
+        case GraphOp::add:      graph_kernel<AddOp>(x, y, out, size, std::true_type());                 break;
+        case GraphOp::subtract: graph_kernel<SubtractOp>(x, y, out, size, std::true_type());            break;
+        case GraphOp::multiply: graph_kernel<MultiplyOp>(x, y, out, size, std::true_type());            break;
+        case GraphOp::divide:   graph_kernel<DivideOp>(x, y, out, size, std::true_type());              break;
+        case GraphOp::minimum:  graph_kernel<MinimumOp>(x, y, out, size, std::true_type());             break;
+        case GraphOp::maximum:  graph_kernel<MaximumOp>(x, y, out, size, std::true_type());             break;
+        case GraphOp::pow:      graph_kernel<PowOp<accurate>>(x, y, out, size, std::true_type());       break;
+        case GraphOp::negate:   graph_kernel<NegateOp>(x, y, out, size, std::false_type());             break;
+        case GraphOp::abs:      graph_kernel<AbsOp>(x, y, out, size, std::false_type());                break;
+        case GraphOp::sqrt:     graph_kernel<SqrtOp>(x, y, out, size, std::false_type());               break;
+        case GraphOp::exp:      graph_kernel<ExpOp<accurate>>(x, y, out, size, std::false_type());      break;
+        case GraphOp::log:      graph_kernel<LogOp<accurate>>(x, y, out, size, std::false_type());      break;
+        case GraphOp::tanh:     graph_kernel<TanhOp<accurate>>(x, y, out, size, std::false_type());     break;
+        case GraphOp::sigmoid:  graph_kernel<SigmoidOp<accurate>>(x, y, out, size, std::false_type());  break;
+        default: throw std::logic_error("ftl::Graph : leaves can't be applied");
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     GraphInstruction
+/// @brief      An operation of a compiled graph, on the buffers (slots) of its operands and its result
+// ----------------------------------------------------------------------------------------------------------
+struct GraphInstruction {
+    GraphOp op;             //!< The operation
+    size_t  out;            //!< The slot of the result
+    size_t  x;              //!< The slot of the first operand
+    size_t  y;              //!< The slot of the second operand (the first operand for unary operations)
+};
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      Symbol
+/// @brief      A value of a graph -- an input, a constant, or the result of operations on other symbols.
+///             Operations on symbols add nodes to their graph, which must outlive the symbols.
+/// @tparam     Dtype   The data type of the graph
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+class Symbol {
+public:
+    using data_type = Dtype;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- refers to a node of a graph
+    /// @param[in]  graph   The graph of the node
+    /// @param[in]  node    The index of the node
+    // ------------------------------------------------------------------------------------------------------
+    Symbol(Graph<Dtype>& graph, size_t node) : _graph(&graph), _node(node) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the graph of the symbol
+    /// @return     A reference to the graph
+    // ------------------------------------------------------------------------------------------------------
+    Graph<Dtype>& graph() const { return *_graph; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the index of the node of the symbol in the graph
+    /// @return     The index of the node
+    // ------------------------------------------------------------------------------------------------------
+    size_t node() const { return _node; }
+private:
+    Graph<Dtype>*   _graph;         //!< The graph of the symbol
+    size_t          _node;          //!< The index of the node of the symbol
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      Graph
+/// @brief      Records operations on symbols, for example
+///
+///             ftl::Graph<float> graph;
+///             auto x = graph.input(), y = graph.input();
+///             auto h = ftl::tanh(x * y + 1.f);
+///             auto f = graph.compile({ h * 2.f + h, ftl::sigmoid(x * y + 1.f) });
+///
+///             f({ X, Y }) then evaluates both outputs for the tensors X and Y, computing x * y + 1 and
+///             its tanh once for each element.
+/// @tparam     Dtype   The data type of the graph (float or double)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+class Graph {
+public:
+    using data_type = Dtype;
+    using node_type = detail::GraphNode<Dtype>;
+
+    static_assert(std::is_floating_point<Dtype>::value, "Graphs are for floating point types");
+
+    Graph()                              = default;
+    Graph(const Graph& other)            = delete;
+    Graph& operator=(const Graph& other) = delete;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Adds an input to the graph -- the inputs are given to the compiled graph in the order in
+    ///             which they are added
+    /// @return     The symbol of the input
+    // ------------------------------------------------------------------------------------------------------
+    Symbol<Dtype> input() { return add({ detail::GraphOp::input, _num_inputs++, node_type::none, Dtype(0) }); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Adds a constant to the graph, which has the value for every element
+    /// @param[in]  value   The value of the constant
+    /// @return     The symbol of the constant
+    // ------------------------------------------------------------------------------------------------------
+    Symbol<Dtype> constant(Dtype value)
+    {
+        return add({ detail::GraphOp::constant, node_type::none, node_type::none, value });
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Adds an operation to the graph
+    /// @param[in]  op  The operation
+    /// @param[in]  x   The first operand
+    /// @param[in]  y   The second operand, for binary operations
+    /// @return     The symbol of the result of the operation
+    // ------------------------------------------------------------------------------------------------------
+    Symbol<Dtype> apply(detail::GraphOp op, const Symbol<Dtype>& x, const Symbol<Dtype>& y)
+    {
+        if (&x.graph() != this || &y.graph() != this)
+            throw std::invalid_argument("ftl::Graph : symbols of different graphs can't be used together");
+        return add({ op, x.node(), y.node(), Dtype(0) });
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of inputs of the graph
+    /// @return     The number of inputs
+    // ------------------------------------------------------------------------------------------------------
+    size_t num_inputs() const { return _num_inputs; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the nodes which have been recorded
+    /// @return     The nodes of the graph, each after its operands
+    // ------------------------------------------------------------------------------------------------------
+    const std::vector<node_type>& nodes() const { return _nodes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Optimizes the graph (see the note at the top of the file) and compiles it into a plan
+    /// @param[in]  outputs     The symbols which are evaluated by the plan
+    /// @return     The plan, which is independent of the graph
+    // ------------------------------------------------------------------------------------------------------
+    CompiledGraph<Dtype> compile(const std::vector<Symbol<Dtype>>& outputs) const;
+private:
+    std::vector<node_type>  _nodes;             //!< The nodes, each after its operands
+    size_t                  _num_inputs = 0;    //!< The number of inputs
+
+    Symbol<Dtype> add(const node_type& node)
+    {
+        _nodes.push_back(node);
+        return Symbol<Dtype>(*this, _nodes.size() - 1);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      CompiledGraph
+/// @brief      The plan of an optimized graph, which evaluates the outputs of the graph for tensors given for
+///             its inputs. All the inputs must have the same dimension sizes, which the outputs get.
+/// @tparam     Dtype   The data type of the graph
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+class CompiledGraph {
+public:
+    using data_type     = Dtype;
+    using tensor_type   = DynamicTensorCpu<Dtype>;
+    using inputs_type   = std::vector<std::reference_wrapper<const tensor_type>>;
+    using outputs_type  = std::vector<std::reference_wrapper<tensor_type>>;
+
+    static constexpr size_t block_size = 256;      //!< The number of elements evaluated at a time
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- the plan is created by Graph::compile
+    // ------------------------------------------------------------------------------------------------------
+    CompiledGraph(size_t                                    num_inputs  ,
+                  std::vector<std::pair<size_t, Dtype>>     constants   ,
+                  std::vector<detail::GraphInstruction>     instructions,
+                  std::vector<size_t>                       outputs     ,
+                  size_t                                    num_slots   )
+    : _num_inputs(num_inputs)               , _constants(std::move(constants)),
+      _instructions(std::move(instructions)), _outputs(std::move(outputs))    , _num_slots(num_slots) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of operations which are evaluated for each element
+    /// @return     The number of operations after the optimization of the graph
+    // ------------------------------------------------------------------------------------------------------
+    size_t num_instructions() const { return _instructions.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of buffers of a block of elements used by the plan, for the inputs, the
+    ///             constants and the results of the operations
+    /// @return     The number of buffers
+    // ------------------------------------------------------------------------------------------------------
+    size_t num_slots() const { return _num_slots; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates the outputs of the graph into tensors, which are resized if they don't have the
+    ///             dimension sizes of the inputs. An output may be one of the inputs.
+    /// @param[in]  inputs      The (contiguous) tensors for the inputs of the graph
+    /// @param[out] outputs     The tensors for the outputs of the graph
+    // ------------------------------------------------------------------------------------------------------
+    void run(const inputs_type& inputs, const outputs_type& outputs) const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates the outputs of the graph into new tensors
+    /// @param[in]  inputs      The (contiguous) tensors for the inputs of the graph
+    /// @return     A tensor for each output of the graph
+    // ------------------------------------------------------------------------------------------------------
+    std::vector<tensor_type> operator()(const inputs_type& inputs) const
+    {
+        std::vector<tensor_type> results(_outputs.size(), tensor_type(1));
+        run(inputs, outputs_type(results.begin(), results.end()));
+        return results;
+    }
+private:
+    size_t                                  _num_inputs;    //!< The number of inputs (the first slots)
+    std::vector<std::pair<size_t, Dtype>>   _constants;     //!< The slot and the value of each constant
+    std::vector<detail::GraphInstruction>   _instructions;  //!< The operations, in the order of evaluation
+    std::vector<size_t>                     _outputs;       //!< The slot of each output
+    size_t                                  _num_slots;     //!< The number of slots
+};
+
+// ---------------------------------------------- IMPLEMENTATIONS -------------------------------------------
+
+template <typename Dtype>
+constexpr size_t CompiledGraph<Dtype>::block_size;
+
+template <typename Dtype>
+CompiledGraph<Dtype> Graph<Dtype>::compile(const std::vector<Symbol<Dtype>>& outputs) const
+{
+    using detail::GraphOp;
+    const size_t none = node_type::none;
+
+    // Mark the nodes which the outputs use
+    std::vector<bool> used(_nodes.size(), false);
+    for (const auto& output : outputs) {
+        if (&output.graph() != this)
+            throw std::invalid_argument("ftl::Graph::compile : output of another graph");
+        used[output.node()] = true;
+    }
+    for (size_t i = _nodes.size(); i-- > 0;) {
+        if (!used[i] || _nodes[i].op == GraphOp::input || _nodes[i].op == GraphOp::constant) continue;
+        used[_nodes[i].x] = true;
+        if (detail::is_binary(_nodes[i].op)) used[_nodes[i].y] = true;
+    }
+
+    // Fold constants, remove identities and merge identical nodes, by numbering the values of the nodes
+    using key_type = std::tuple<GraphOp, size_t, size_t, std::uint64_t>;
+    std::vector<node_type>          nodes;
+    std::vector<size_t>             number(_nodes.size(), none);
+    std::map<key_type, size_t>      numbers;
+    auto is_constant = [&] (size_t n, Dtype value)
+    {
+        return nodes[n].op == GraphOp::constant && nodes[n].value == value;
+    };
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        if (!used[i]) continue;
+        node_type node = _nodes[i];
+        if (node.op != GraphOp::input && node.op != GraphOp::constant) {
+            const bool binary = detail::is_binary(node.op);
+            node.x = number[node.x];
+            node.y = binary ? number[node.y] : none;
+
+            if (nodes[node.x].op == GraphOp::constant && (!binary || nodes[node.y].op == GraphOp::constant)) {
+                Dtype value;
+                detail::apply_graph_op(node.op, &nodes[node.x].value, binary ? &nodes[node.y].value : nullptr,
+                                       &value, 1);
+                node = { GraphOp::constant, none, none, value };
+            } else if (((node.op == GraphOp::add || node.op == GraphOp::subtract) && is_constant(node.y, 0)) ||
+                       ((node.op == GraphOp::multiply || node.op == GraphOp::divide) && is_constant(node.y, 1))) {
+                number[i] = node.x; continue;
+            } else if ((node.op == GraphOp::add && is_constant(node.x, 0)) ||
+                       (node.op == GraphOp::multiply && is_constant(node.x, 1))) {
+                number[i] = node.y; continue;
+            } else if (node.op == GraphOp::negate && nodes[node.x].op == GraphOp::negate) {
+                number[i] = nodes[node.x].x; continue;
+            } else if ((node.op == GraphOp::add || node.op == GraphOp::multiply) && node.y < node.x) {
+                std::swap(node.x, node.y);
+            }
+        }
+
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &node.value, sizeof(Dtype));
+        const key_type key(node.op, node.x, node.y, node.op == GraphOp::constant ? bits : 0);
+        const auto found = numbers.find(key);
+        if (found != numbers.end()) {
+            number[i] = found->second;
+        } else {
+            number[i] = numbers[key] = nodes.size();
+            nodes.push_back(node);
+        }
+    }
+
+    // Find the last operation which uses each node -- outputs are used after all of them -- and remove the
+    // nodes which are no longer used after the identities were removed
+    std::vector<size_t> last_use(nodes.size(), 0);
+    std::vector<bool>   live(nodes.size(), false);
+    for (const auto& output : outputs) live[number[output.node()]] = true;
+    for (size_t n = nodes.size(); n-- > 0;) {
+        if (!live[n] || nodes[n].op == GraphOp::input || nodes[n].op == GraphOp::constant) continue;
+        live[nodes[n].x] = true;
+        if (detail::is_binary(nodes[n].op)) live[nodes[n].y] = true;
+    }
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        if (!live[n] || nodes[n].op == GraphOp::input || nodes[n].op == GraphOp::constant) continue;
+        last_use[nodes[n].x] = n;
+        if (detail::is_binary(nodes[n].op)) last_use[nodes[n].y] = n;
+    }
+    for (const auto& output : outputs) last_use[number[output.node()]] = none;
+
+    // Inputs have the first slots, then the constants, then the results of the operations, which reuse the
+    // slots of results which are no longer used
+    std::vector<size_t>                     slot(nodes.size(), none), free_slots;
+    std::vector<std::pair<size_t, Dtype>>   constants;
+    std::vector<detail::GraphInstruction>   instructions;
+    size_t num_slots = _num_inputs;
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        if (nodes[n].op == GraphOp::input)    slot[n] = nodes[n].x;
+        if (nodes[n].op == GraphOp::constant && live[n]) {
+            slot[n] = num_slots++;
+            constants.emplace_back(slot[n], nodes[n].value);
+        }
+    }
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        const node_type& node = nodes[n];
+        if (!live[n] || node.op == GraphOp::input || node.op == GraphOp::constant) continue;
+        const bool binary = detail::is_binary(node.op);
+
+        // Operands which aren't used again free their slots first, so the result can be written in place
+        for (const size_t operand : { node.x, binary ? node.y : none }) {
+            if (operand == none || last_use[operand] != n) continue;
+            if (nodes[operand].op == GraphOp::input || nodes[operand].op == GraphOp::constant) continue;
+            if (std::find(free_slots.begin(), free_slots.end(), slot[operand]) == free_slots.end())
+                free_slots.push_back(slot[operand]);
+        }
+        if (free_slots.empty()) {
+            slot[n] = num_slots++;
+        } else {
+            slot[n] = free_slots.back();
+            free_slots.pop_back();
+        }
+        instructions.push_back({ node.op, slot[n], slot[node.x], binary ? slot[node.y] : slot[node.x] });
+    }
+
+    std::vector<size_t> output_slots;
+    for (const auto& output : outputs) output_slots.push_back(slot[number[output.node()]]);
+    return CompiledGraph<Dtype>(_num_inputs, std::move(constants), std::move(instructions),
+                                std::move(output_slots), num_slots);
+}
+
+template <typename Dtype>
+void CompiledGraph<Dtype>::run(const inputs_type& inputs, const outputs_type& outputs) const
+{
+    if (inputs.size() != _num_inputs || _num_inputs == 0)
+        throw std::invalid_argument("ftl::CompiledGraph : wrong number of inputs (at least one is needed)");
+    if (outputs.size() != _outputs.size())
+        throw std::invalid_argument("ftl::CompiledGraph : wrong number of outputs");
+
+    const tensor_type& first = inputs.front().get();
+    std::vector<const Dtype*> input_data;
+    for (const tensor_type& input : inputs) {
+        if (input.dim_sizes() != first.dim_sizes())
+            throw std::invalid_argument("ftl::CompiledGraph : inputs have different dimension sizes");
+        if (!input.contiguous())
+            throw std::invalid_argument("ftl::CompiledGraph : inputs must be contiguous");
+        input_data.push_back(input.data().data());
+    }
+
+    // The results are written into the memory of the outputs, unless an output is also an input, in which
+    // case it gets new memory once all the results are computed
+    using data_container = typename tensor_type::data_container;
+    const size_t size = first.size();
+    std::vector<data_container> results;
+    for (tensor_type& output : outputs) {
+        bool is_input = false;
+        for (const tensor_type& input : inputs) is_input |= &input == &output;
+        results.push_back(is_input || !output.contiguous() ? data_container() : output.release());
+        if (results.back().size() != size) results.back() = data_container(size);
+    }
+
+    ThreadPool::instance().parallel_for(0, size, [&] (size_t begin, size_t end)
+    {
+        // The slots of the constants are filled once, those of the operations are reused for each block
+        std::vector<Dtype, AlignedAllocator<Dtype>> memory((_num_slots - _num_inputs) * block_size);
+        std::vector<const Dtype*> slots(_num_slots, nullptr);
+        auto scratch = [&] (size_t slot) { return memory.data() + (slot - _num_inputs) * block_size; };
+        for (size_t slot = _num_inputs; slot < _num_slots; ++slot) slots[slot] = scratch(slot);
+        for (const auto& constant : _constants)
+            std::fill(scratch(constant.first), scratch(constant.first) + block_size, constant.second);
+
+        for (size_t block = begin; block < end; block += block_size) {
+            const size_t elements = std::min(block_size, end - block);
+            for (size_t input = 0; input < _num_inputs; ++input) slots[input] = input_data[input] + block;
+            for (const auto& instruction : _instructions)
+                detail::apply_graph_op(instruction.op, slots[instruction.x], slots[instruction.y],
+                                       scratch(instruction.out), elements);
+            for (size_t output = 0; output < _outputs.size(); ++output)
+                std::copy(slots[_outputs[output]], slots[_outputs[output]] + elements,
+                          results[output].data() + block);
+        }
+    }, block_size);
+
+    for (size_t output = 0; output < outputs.size(); ++output)
+        outputs[output].get().adopt(first.dim_sizes(), std::move(results[output]));
+}
+
+// ------------------------------------------ OPERATIONS ON SYMBOLS -----------------------------------------
+
+#define FTL_GRAPH_BINARY_OPERATION(NAME, OP)                                                                \
+template <typename Dtype>                                                                                   \
+Symbol<Dtype> NAME(const Symbol<Dtype>& x, const Symbol<Dtype>& y)                                          \
+{                                                                                                           \
+    return x.graph().apply(detail::GraphOp::OP, x, y);                                                      \
+}                                                                                                           \
+template <typename Dtype>                                                                                   \
+Symbol<Dtype> NAME(const Symbol<Dtype>& x, const typename Symbol<Dtype>::data_type y)                       \
+{                                                                                                           \
+    return x.graph().apply(detail::GraphOp::OP, x, x.graph().constant(y));                                 \
+}                                                                                                           \
+template <typename Dtype>                                                                                   \
+Symbol<Dtype> NAME(const typename Symbol<Dtype>::data_type x, const Symbol<Dtype>& y)                       \
+{                                                                                                           \
+    return y.graph().apply(detail::GraphOp::OP, y.graph().constant(x), y);                                 \
+}
+
+#define FTL_GRAPH_UNARY_OPERATION(NAME, OP)                                                                 \
+template <typename Dtype>                                                                                   \
+Symbol<Dtype> NAME(const Symbol<Dtype>& x)                                                                  \
+{                                                                                                           \
+    return x.graph().apply(detail::GraphOp::OP, x, x);                                                      \
+}
+
+FTL_GRAPH_BINARY_OPERATION(operator+, add)
+FTL_GRAPH_BINARY_OPERATION(operator-, subtract)
+FTL_GRAPH_BINARY_OPERATION(operator*, multiply)
+FTL_GRAPH_BINARY_OPERATION(operator/, divide)
+FTL_GRAPH_BINARY_OPERATION(minimum  , minimum)
+FTL_GRAPH_BINARY_OPERATION(maximum  , maximum)
+FTL_GRAPH_BINARY_OPERATION(pow      , pow)
+FTL_GRAPH_UNARY_OPERATION(operator- , negate)
+FTL_GRAPH_UNARY_OPERATION(abs       , abs)
+FTL_GRAPH_UNARY_OPERATION(sqrt      , sqrt)
+FTL_GRAPH_UNARY_OPERATION(exp       , exp)
+FTL_GRAPH_UNARY_OPERATION(log       , log)
+FTL_GRAPH_UNARY_OPERATION(tanh      , tanh)
+FTL_GRAPH_UNARY_OPERATION(sigmoid   , sigmoid)
+
+#undef FTL_GRAPH_BINARY_OPERATION
+#undef FTL_GRAPH_UNARY_OPERATION
+
+}               // End namespace ftl
+#endif          // FTL_GRAPH_HPP
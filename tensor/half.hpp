@@ -0,0 +1,276 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for 16 bit floating point storage types -- IEEE half precision (half) and bfloat16 --
+///         which store elements in half the memory of floats, but which are converted to floats for any
+///         arithmetic. Conversions of single elements round to nearest even, and bulk conversions of
+///         contiguous elements use the F16C instructions (for half) or integer shifts (for bfloat16) when
+///         they are available. Reductions and contractions of the 16 bit types accumulate in floats, which
+///         the Accumulator trait gives.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_HALF_HPP
+#define FTL_HALF_HPP
+
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ftl {
+namespace detail {
+
+inline std::uint32_t float_bits(const float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bits_float(const std::uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Converts a float to the bits of the nearest half (ties to even), where values which are too
+///             large are infinite and NaNs stay (quiet) NaNs. Results which are subnormal halves are rounded
+///             by adding a magic number, so that the floating point unit does the rounding.
+/// @param[in]  value   The value to convert
+/// @return     The bits of the half
+// ----------------------------------------------------------------------------------------------------------
+inline std::uint16_t float_to_half(const float value)
+{
+#if defined(FTL_SIMD_F16C)
+    return static_cast<std::uint16_t>(_cvtss_sh(value, 0));
+#else
+    std::uint32_t       bits = float_bits(value);
+    const std::uint32_t sign = bits & 0x80000000u;
+    std::uint32_t       result;
+
+    bits ^= sign;
+    if (bits >= 0x47800000u) {                                  // 2^16 and larger, infinity and NaN
+        result = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+    } else if (bits < 0x38800000u) {                            // Subnormal halves (and zero)
+        result = float_bits(bits_float(bits) + 0.5f) - float_bits(0.5f);
+    } else {
+        const std::uint32_t odd = (bits >> 13) & 1u;
+        result = (bits + 0xC8000FFFu + odd) >> 13;             // Rebias the exponent and round to even
+    }
+    return static_cast<std::uint16_t>(result | (sign >> 16));
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Converts the bits of a half to a float, which is exact
+/// @param[in]  bits    The bits of the half
+/// @return     The value of the half
+// ----------------------------------------------------------------------------------------------------------
+inline float half_to_float(const std::uint16_t bits)
+{
+#if defined(FTL_SIMD_F16C)
+    return _cvtsh_ss(bits);
+#else
+    std::uint32_t       result   = static_cast<std::uint32_t>(bits & 0x7FFFu) << 13;
+    const std::uint32_t exponent = result & 0x0F800000u;
+
+    result += 0x38000000u;                                      // Rebias the exponent
+    if (exponent == 0x0F800000u) {                              // Infinity and NaN
+        result += 0x38000000u;
+    } else if (exponent == 0) {                                 // Subnormal halves (and zero) are normalized
+        result = float_bits(bits_float(result + 0x00800000u) - bits_float(0x38800000u));
+    }
+    return bits_float(result | static_cast<std::uint32_t>(bits & 0x8000u) << 16);
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Converts a float to the bits of the nearest bfloat16 (ties to even) -- the upper half of the
+///             float's bits after rounding, with NaNs kept quiet so that rounding can't make them infinite
+/// @param[in]  value   The value to convert
+/// @return     The bits of the bfloat16
+// ----------------------------------------------------------------------------------------------------------
+inline std::uint16_t float_to_bfloat16(const float value)
+{
+    const std::uint32_t bits = float_bits(value);
+    if ((bits & 0x7FFFFFFFu) > 0x7F800000u) return static_cast<std::uint16_t>((bits >> 16) | 0x0040u);
+    return static_cast<std::uint16_t>((bits + 0x7FFFu + ((bits >> 16) & 1u)) >> 16);
+}
+
+inline float bfloat16_to_float(const std::uint16_t bits)
+{
+    return bits_float(static_cast<std::uint32_t>(bits) << 16);
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     half
+/// @brief      IEEE 754 half precision (binary16) storage type -- 1 sign bit, 5 exponent bits and 10 mantissa
+///             bits. It converts implicitly to and from float, so arithmetic on halves is done in floats and
+///             rounded when the result is stored. Default initialization leaves the bits uninitialized, like
+///             the built in types.
+// ----------------------------------------------------------------------------------------------------------
+struct half {
+    std::uint16_t bits;                                         //!< The bits of the value
+
+    half() = default;
+    half(const float value) : bits(detail::float_to_half(value)) {}
+
+    inline operator float() const { return detail::half_to_float(bits); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a half from its bits
+    /// @param[in]  bits    The bits of the half
+    /// @return     The half with the bits
+    // ------------------------------------------------------------------------------------------------------
+    static inline half from_bits(const std::uint16_t bits) { half h; h.bits = bits; return h; }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     bfloat16
+/// @brief      Brain floating point storage type -- the upper 16 bits of a float, so it has the range of a
+///             float with 8 bits of precision. Like half, it converts implicitly to and from float.
+// ----------------------------------------------------------------------------------------------------------
+struct bfloat16 {
+    std::uint16_t bits;                                         //!< The bits of the value
+
+    bfloat16() = default;
+    bfloat16(const float value) : bits(detail::float_to_bfloat16(value)) {}
+
+    inline operator float() const { return detail::bfloat16_to_float(bits); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a bfloat16 from its bits
+    /// @param[in]  bits    The bits of the bfloat16
+    /// @return     The bfloat16 with the bits
+    // ------------------------------------------------------------------------------------------------------
+    static inline bfloat16 from_bits(const std::uint16_t bits) { bfloat16 b; b.bits = bits; return b; }
+};
+
+// Negation only flips the sign bit, and keeps the type (so that the result isn't ambiguously float or half)
+inline half     operator-(const half x)     { return half::from_bits(x.bits ^ 0x8000u);     }
+inline bfloat16 operator-(const bfloat16 x) { return bfloat16::from_bits(x.bits ^ 0x8000u); }
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Accumulator
+/// @brief      Gets the type which reductions and contractions of a data type accumulate in -- floats for the
+///             16 bit floating point types, and the data type itself otherwise
+/// @tparam     Dtype   The type of the data
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct Accumulator {
+    using type = Dtype;
+};
+
+template <> struct Accumulator<half>        { using type = float; };
+template <> struct Accumulator<bfloat16>    { using type = float; };
+
+}               // End namespace detail
+
+namespace simd {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Converts contiguous elements from one type to another, which is vectorized for conversions
+///             between floats and the 16 bit floating point types
+/// @param[in]  in      A pointer to the elements to convert
+/// @param[out] out     A pointer to the memory for the converted elements
+/// @param[in]  n       The number of elements to convert
+/// @tparam     From    The type to convert from
+/// @tparam     To      The type to convert to
+// ----------------------------------------------------------------------------------------------------------
+template <typename From, typename To>
+inline void convert(const From* in, To* out, const size_t n)
+{
+    for (size_t i = 0; i < n; ++i) out[i] = static_cast<To>(in[i]);
+}
+
+inline void convert(const half* in, float* out, const size_t n)
+{
+    size_t i = 0;
+#if defined(FTL_SIMD_F16C) && defined(FTL_SIMD_AVX512)
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(out + i, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i))));
+#endif
+#if defined(FTL_SIMD_F16C)
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+#endif
+    for (; i < n; ++i) out[i] = in[i];
+}
+
+inline void convert(const float* in, half* out, const size_t n)
+{
+    size_t i = 0;
+#if defined(FTL_SIMD_F16C) && defined(FTL_SIMD_AVX512)
+    for (; i + 16 <= n; i += 16)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm512_cvtps_ph(_mm512_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+#if defined(FTL_SIMD_F16C)
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+    for (; i < n; ++i) out[i] = in[i];
+}
+
+inline void convert(const bfloat16* in, float* out, const size_t n)
+{
+    size_t i = 0;
+#if defined(FTL_SIMD_AVX2)
+    for (; i + 8 <= n; i += 8) {
+        const __m256i bits = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16)));
+    }
+#endif
+    for (; i < n; ++i) out[i] = in[i];
+}
+
+inline void convert(const float* in, bfloat16* out, const size_t n)
+{
+    size_t i = 0;
+#if defined(FTL_SIMD_AVX2)
+    // Rounds each half of 16 elements as the scalar conversion does (with NaNs kept quiet), and then packs
+    // the upper halves of the 32 bit lanes, which packus interleaves by 128 bit lane
+    const auto round = [] (const __m256 x)
+    {
+        const __m256i bits    = _mm256_castps_si256(x);
+        const __m256i odd     = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+        const __m256i rounded = _mm256_srli_epi32(
+            _mm256_add_epi32(bits, _mm256_add_epi32(odd, _mm256_set1_epi32(0x7FFF))), 16);
+        const __m256i quiet   = _mm256_or_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x0040));
+        return _mm256_blendv_epi8(rounded, quiet, _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q)));
+    };
+    for (; i + 16 <= n; i += 16) {
+        const __m256i packed = _mm256_packus_epi32(round(_mm256_loadu_ps(in + i)), round(_mm256_loadu_ps(in + i + 8)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+#endif
+    for (; i < n; ++i) out[i] = in[i];
+}
+
+}               // End namespace simd
+}               // End namespace ftl
+#endif          // FTL_HALF_HPP
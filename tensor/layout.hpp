@@ -0,0 +1,867 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for tensor layouts, which describe how the elements of a tensor are arranged in memory
+///         by storing the stride of each dimension. Static layouts compute the strides at compile time from
+///         the dimension sizes, dynamic layouts compute them once when the tensor is created, so that mapping
+///         indices to a memory offset is a dot product of the indices and the strides. Tiled layouts store
+///         the elements in blocks, where the offset is a sum of a function of each index.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_LAYOUT_HPP
+#define FTL_LAYOUT_HPP
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__BMI2__) && defined(__x86_64__) && !defined(FTL_NO_SIMD)
+    #include <immintrin.h>
+#endif
+
+// NOTE : The elements of a tensor are always indexed (by operator[] and by expressions) in the logical order
+//        of the elements, which is column-major order -- the first index is the fastest changing. The
+//        layout only changes where each element is stored in memory, so tensors with different layouts can
+//        be used in the same expression.
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     LayoutPolicy
+/// @brief      Base class for layout policies, so that layouts can be found in a list of policies
+// ----------------------------------------------------------------------------------------------------------
+struct LayoutPolicy {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ColumnMajor
+/// @brief      Layout where the first dimension is contiguous in memory (the default layout)
+// ----------------------------------------------------------------------------------------------------------
+struct ColumnMajor : LayoutPolicy {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     RowMajor
+/// @brief      Layout where the last dimension is contiguous in memory
+// ----------------------------------------------------------------------------------------------------------
+struct RowMajor : LayoutPolicy {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Tiled
+/// @brief      Layout where the elements are stored in tiles (blocks) with fixed sizes, so that elements which
+///             are close along any dimension are close in memory. The elements of a tile are stored in
+///             column-major order, and the tiles are stored in column-major order of their indices. Tiles at
+///             the end of a dimension are padded to the full tile size.
+/// @tparam     TileSizes   The size of the tiles in each dimension (powers of 2) -- dimensions after the last
+///                         tile size have tiles of size 1
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... TileSizes>
+struct Tiled : LayoutPolicy {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     MortonTiled
+/// @brief      Tiled layout where the tiles are stored in Z-order (Morton order) -- the bits of the indices of
+///             the tile in each dimension are interleaved -- so that tiles which are close along any
+///             dimension are also close in memory, at every scale. The memory is padded up to the tiles which
+///             the Z-order curve passes through.
+/// @tparam     TileSizes   The size of the tiles in each dimension (powers of 2) -- dimensions after the last
+///                         tile size have tiles of size 1
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... TileSizes>
+struct MortonTiled : LayoutPolicy {};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     SizeList
+/// @brief      A compile time list of sizes
+/// @tparam     Values  The values in the list
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... Values>
+struct SizeList { static constexpr size_t size = sizeof...(Values); };
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     SizeArray
+/// @brief      Array with the values of a compile time list of sizes, which has static storage so that it can
+///             be referred to by a pointer
+/// @tparam     Sizes   The list of sizes (a SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Sizes>
+struct SizeArray;
+
+template <size_t... Sizes>
+struct SizeArray<SizeList<Sizes...>> { static constexpr size_t values[sizeof...(Sizes)] = { Sizes... }; };
+
+template <size_t... Sizes>
+constexpr size_t SizeArray<SizeList<Sizes...>>::values[sizeof...(Sizes)];
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IndexRange
+/// @brief      Gets the list of indices [Begin, End) at compile time, so that a loop over the indices can be
+///             unrolled with a pack expansion
+/// @tparam     Begin   The first index
+/// @tparam     End     The index after the last index
+/// @tparam     Indices The indices which have been generated
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Begin, size_t End, size_t... Indices>
+struct IndexRange : IndexRange<Begin, End - 1, End - 1, Indices...> {};
+
+template <size_t Begin, size_t... Indices>
+struct IndexRange<Begin, Begin, Indices...> { using type = SizeList<Indices...>; };
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ColumnMajorStrides
+/// @brief      Computes the strides of a column-major layout at compile time -- the stride of a dimension is
+///             the product of the sizes of all the dimensions before it
+/// @tparam     Product     The product of the sizes of the dimensions which have been processed
+/// @tparam     Result      The strides which have been computed
+/// @tparam     Sizes       The sizes of the dimensions which still need to be processed
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Product, typename Result, size_t... Sizes>
+struct ColumnMajorStrides { using type = Result; };
+
+template <size_t Product, size_t... Strides, size_t SF, size_t... SR>
+struct ColumnMajorStrides<Product, SizeList<Strides...>, SF, SR...>
+: ColumnMajorStrides<Product * SF, SizeList<Strides..., Product>, SR...> {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     RowMajorStrides
+/// @brief      Computes the strides of a row-major layout at compile time -- the stride of a dimension is
+///             the product of the sizes of all the dimensions after it
+/// @tparam     Sizes   The sizes of the dimensions
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... Sizes>
+struct RowMajorStrides {
+    static constexpr size_t product = 1;
+    using type                      = SizeList<>;
+};
+
+template <size_t SF, size_t... SR>
+struct RowMajorStrides<SF, SR...> {
+private:
+    template <size_t Value, typename List> struct Prepend;
+    template <size_t Value, size_t... Values>
+    struct Prepend<Value, SizeList<Values...>> { using type = SizeList<Value, Values...>; };
+public:
+    static constexpr size_t product = SF * RowMajorStrides<SR...>::product;
+    using type = typename Prepend<RowMajorStrides<SR...>::product,
+                                  typename RowMajorStrides<SR...>::type>::type;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticOffset
+/// @brief      Computes the memory offset of an element at compile time (when the indices are constant) as
+///             the dot product of the indices and the strides
+/// @tparam     Strides     The strides of the dimensions
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... Strides>
+struct StaticOffset {
+    static constexpr size_t offset() { return 0; }
+};
+
+template <size_t SF, size_t... SR>
+struct StaticOffset<SF, SR...> {
+    template <typename IF, typename... IR>
+    static constexpr size_t offset(IF index_first, IR... indices_rest)
+    {
+        return SF * static_cast<size_t>(index_first) + StaticOffset<SR...>::offset(indices_rest...);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticLinearOffset
+/// @brief      Computes the memory offset of the element with a given (logical, column-major) linear index
+/// @tparam     Sizes       The sizes of the dimensions
+/// @tparam     Strides     The strides of the dimensions
+// ----------------------------------------------------------------------------------------------------------
+template <typename Sizes, typename Strides>
+struct StaticLinearOffset {
+    static constexpr size_t offset(size_t) { return 0; }
+};
+
+template <size_t DF, size_t... DR, size_t SF, size_t... SR>
+struct StaticLinearOffset<SizeList<DF, DR...>, SizeList<SF, SR...>> {
+    static constexpr size_t offset(size_t linear_index)
+    {
+        return (linear_index % DF) * SF
+             + StaticLinearOffset<SizeList<DR...>, SizeList<SR...>>::offset(linear_index / DF);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IsDense
+/// @brief      Determines at compile time if strides are those of a dense column-major layout (the strides of
+///             dimensions with a size of 1 don't matter)
+/// @tparam     Expected    The stride which the next dimension must have
+/// @tparam     Sizes       The sizes of the dimensions
+/// @tparam     Strides     The strides of the dimensions
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Expected, typename Sizes, typename Strides>
+struct IsDense { static constexpr bool value = true; };
+
+template <size_t Expected, size_t DF, size_t... DR, size_t SF, size_t... SR>
+struct IsDense<Expected, SizeList<DF, DR...>, SizeList<SF, SR...>> {
+    static constexpr bool value = (DF == 1 || SF == Expected)                                 &&
+                                  IsDense<Expected * DF, SizeList<DR...>, SizeList<SR...>>::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Product
+/// @brief      Computes the product of a list of sizes at compile time
+/// @tparam     Sizes   The sizes to compute the product of
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... Sizes>
+struct Product { static constexpr size_t value = 1; };
+
+template <size_t SF, size_t... SR>
+struct Product<SF, SR...> { static constexpr size_t value = SF * Product<SR...>::value; };
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Sum
+/// @brief      Computes the sum of a list of sizes at compile time
+/// @tparam     Sizes   The sizes to compute the sum of
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... Sizes>
+struct Sum { static constexpr size_t value = 0; };
+
+template <size_t SF, size_t... SR>
+struct Sum<SF, SR...> { static constexpr size_t value = SF + Sum<SR...>::value; };
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     PadSizes
+/// @brief      Appends sizes of 1 to a list of sizes until it has a given number of sizes
+/// @tparam     Count   The number of sizes which the list must have
+/// @tparam     Sizes   The list of sizes (a SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Count, typename Sizes, bool Done = (Sizes::size >= Count)>
+struct PadSizes { using type = Sizes; };
+
+template <size_t Count, size_t... Sizes>
+struct PadSizes<Count, SizeList<Sizes...>, false> : PadSizes<Count, SizeList<Sizes..., 1>> {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the base 2 logarithm of a value, rounded down (or up)
+/// @param[in]  value   The value, which must be at least 1
+/// @return     The logarithm of the value
+// ----------------------------------------------------------------------------------------------------------
+constexpr size_t floor_log2(size_t value) { return value <= 1 ? 0 : 1 + floor_log2(value / 2); }
+constexpr size_t ceil_log2(size_t value)  { return value <= 1 ? 0 : 1 + floor_log2(value - 1); }
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Deposits the low bits of a value at the positions of the set bits of a mask, from the lowest
+///             position up (the parallel bit deposit operation)
+/// @param[in]  value   The value with the bits to deposit
+/// @param[in]  mask    The positions of the bits
+/// @return     The deposited bits
+// ----------------------------------------------------------------------------------------------------------
+constexpr size_t deposit_bits(size_t value, size_t mask)
+{
+    return mask == 0 ? 0
+                     : ((value & 1) ? (mask & (~mask + 1)) : 0) | deposit_bits(value >> 1, mask & (mask - 1));
+}
+
+// Runtime version, which uses the bmi2 instruction when it is available
+inline size_t scatter_bits(size_t value, size_t mask)
+{
+#if defined(__BMI2__) && defined(__x86_64__) && !defined(FTL_NO_SIMD)
+    return _pdep_u64(value, mask);
+#else
+    size_t bits = 0;
+    for (size_t bit = 1; mask != 0; mask &= mask - 1, bit <<= 1)
+        if (value & bit) bits |= mask & (~mask + 1);
+    return bits;
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Counts the dimensions which have more than a number of bits in the indices of their tiles
+/// @param[in]  bits    The number of bits of the tile indices of each dimension
+/// @param[in]  rank    The number of dimensions to check
+/// @param[in]  level   The number of bits
+/// @return     The number of dimensions with more bits than level
+// ----------------------------------------------------------------------------------------------------------
+constexpr size_t count_wider(const size_t* bits, size_t rank, size_t level)
+{
+    return rank == 0 ? 0 : (bits[0] > level ? 1 : 0) + count_wider(bits + 1, rank - 1, level);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the position in a Morton code of the bits of the tile indices with a given significance
+///             -- bit b of each dimension (which has it) follows all the lower bits of all the dimensions
+/// @param[in]  bits    The number of bits of the tile indices of each dimension
+/// @param[in]  rank    The number of dimensions
+/// @param[in]  level   The significance of the bits
+/// @return     The position of bit level of the first dimension which has it
+// ----------------------------------------------------------------------------------------------------------
+constexpr size_t level_position(const size_t* bits, size_t rank, size_t level)
+{
+    return level == 0 ? 0 : level_position(bits, rank, level - 1) + count_wider(bits, rank, level - 1);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the positions in a Morton code of the bits [level, bits[dim]) of the tile index of a
+///             dimension, so that the code is the sum of the tile indices deposited into their masks
+/// @param[in]  bits    The number of bits of the tile indices of each dimension
+/// @param[in]  rank    The number of dimensions
+/// @param[in]  dim     The dimension
+/// @param[in]  level   The first bit
+/// @return     The mask of the positions of the bits
+// ----------------------------------------------------------------------------------------------------------
+constexpr size_t morton_mask(const size_t* bits, size_t rank, size_t dim, size_t level)
+{
+    return level >= bits[dim] 
+        ? 0 
+        : (size_t(1) << (level_position(bits, rank, level) + count_wider(bits, dim, level))) |
+          morton_mask(bits, rank, dim, level + 1);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     TileDimension
+/// @brief      The mapping of the indices of one dimension of a tiled layout to memory offsets, which is the
+///             offset in the tile plus the offset of the tile
+// ----------------------------------------------------------------------------------------------------------
+struct TileDimension {
+    size_t  shift;          //!< The base 2 logarithm of the tile size
+    size_t  stride;         //!< The stride of the dimension in a tile
+    size_t  offset;         //!< The offset between tiles, or the mask of the tile index for Morton order
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the memory offset of an index of one dimension of a tiled layout
+/// @param[in]  tile    The mapping of the dimension
+/// @param[in]  morton  If the tiles are in Morton order
+/// @param[in]  index   The index in the dimension
+/// @return     The part of the memory offset of an element which depends on the index
+// ----------------------------------------------------------------------------------------------------------
+constexpr size_t tile_offset(const TileDimension& tile, bool morton, size_t index)
+{
+    return (index & ((size_t(1) << tile.shift) - 1)) * tile.stride
+         + (morton ? deposit_bits(index >> tile.shift, tile.offset) : (index >> tile.shift) * tile.offset);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the memory offset of the element with given indices in a tiled layout
+/// @param[in]  tiles       The mapping of each dimension
+/// @param[in]  morton      If the tiles are in Morton order
+/// @param[in]  index_first The index of the element in the first dimension
+/// @param[in]  indices_rest The indices of the element in the other dimensions
+/// @return     The memory offset of the element
+// ----------------------------------------------------------------------------------------------------------
+constexpr size_t tiled_offset(const TileDimension*, bool) { return 0; }
+
+template <typename IF, typename... IR>
+constexpr size_t tiled_offset(const TileDimension* tiles, bool morton, IF index_first, IR... indices_rest)
+{
+    return tile_offset(*tiles, morton, static_cast<size_t>(index_first))
+         + tiled_offset(tiles + 1, morton, indices_rest...);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the memory offset of the element with a (logical, column-major) linear index in a tiled
+///             layout
+/// @param[in]  sizes           The sizes of the dimensions
+/// @param[in]  tiles           The mapping of each dimension
+/// @param[in]  rank            The number of dimensions
+/// @param[in]  morton          If the tiles are in Morton order
+/// @param[in]  linear_index    The index of the element
+/// @return     The memory offset of the element
+// ----------------------------------------------------------------------------------------------------------
+constexpr size_t tiled_linear_offset(const size_t* sizes, const TileDimension* tiles, size_t rank, bool morton,
+                                     size_t linear_index)
+{
+    return rank == 0 ? 0 
+                     : tile_offset(*tiles, morton, linear_index % *sizes) 
+                     + tiled_linear_offset(sizes + 1, tiles + 1, rank - 1, morton, linear_index / *sizes);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     LayoutStrides
+/// @brief      Gets the compile time strides for a layout policy
+/// @tparam     Layout  The layout policy
+/// @tparam     Sizes   The sizes of the dimensions
+// ----------------------------------------------------------------------------------------------------------
+template <typename Layout, size_t... Sizes>
+struct LayoutStrides;
+
+template <size_t... Sizes>
+struct LayoutStrides<ColumnMajor, Sizes...> { using type = typename ColumnMajorStrides<1, SizeList<>, Sizes...>::type; };
+
+template <size_t... Sizes>
+struct LayoutStrides<RowMajor, Sizes...> { using type = typename RowMajorStrides<Sizes...>::type; };
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StridedLayout
+/// @brief      Layout with dimension sizes and strides which are both known at compile time, for example the
+///             layout of a view of a static tensor.
+/// @tparam     Sizes       The sizes of the dimensions (a detail::SizeList)
+/// @tparam     Strides     The strides of the dimensions (a detail::SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Sizes, typename Strides>
+struct StridedLayout;
+
+template <size_t... Sizes, size_t... Strides>
+struct StridedLayout<detail::SizeList<Sizes...>, detail::SizeList<Strides...>> {
+    static_assert(sizeof...(Sizes) == sizeof...(Strides), "Layout must have a stride for each dimension");
+    
+    using sizes     = detail::SizeList<Sizes...>;
+    using strides   = detail::SizeList<Strides...>;
+    
+    // The total number of elements in the layout
+    static constexpr size_t num_elements = detail::Product<Sizes...>::value;
+    
+    // If the logical and memory orders of the elements are the same
+    static constexpr bool contiguous = detail::IsDense<1, sizes, strides>::value;
+
+    // Strided layouts aren't tiled
+    static constexpr bool tiled = false;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the memory offset of the element with a given (logical) linear index
+    /// @param[in]  linear_index    The index of the element in column-major order
+    /// @return     The memory offset of the element
+    // ------------------------------------------------------------------------------------------------------
+    static constexpr size_t offset(size_t linear_index)
+    {
+        return contiguous ? linear_index : detail::StaticLinearOffset<sizes, strides>::offset(linear_index);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticLayout
+/// @brief      Layout of a tensor with dimension sizes known at compile time -- all the strides are computed
+///             at compile time.
+/// @tparam     Layout  The layout policy (ColumnMajor or RowMajor)
+/// @tparam     Sizes   The sizes of the dimensions
+// ----------------------------------------------------------------------------------------------------------
+template <typename Layout, size_t... Sizes>
+struct StaticLayout : StridedLayout<detail::SizeList<Sizes...>                                 , 
+                                    typename detail::LayoutStrides<Layout, Sizes...>::type     > {
+    using policy    = Layout;
+
+    // The number of elements which the memory for the layout must hold
+    static constexpr size_t storage_size = detail::Product<Sizes...>::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     TiledLayout
+/// @brief      Layout with dimension sizes and tile sizes which are known at compile time -- the mapping of
+///             each dimension is computed at compile time. The strides are those of the elements in a tile.
+/// @tparam     Morton  If the tiles are stored in Morton order (otherwise in column-major order)
+/// @tparam     Sizes   The sizes of the dimensions (a detail::SizeList)
+/// @tparam     Tiles   The sizes of the tiles, which are powers of 2 (a detail::SizeList)
+/// @tparam     Dims    The indices of the dimensions (a detail::SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <bool Morton, typename Sizes, typename Tiles, 
+          typename Dims = typename detail::IndexRange<0, Sizes::size>::type>
+struct TiledLayout;
+
+template <bool Morton, size_t... Sizes, size_t... Tiles, size_t... Dims>
+struct TiledLayout<Morton, detail::SizeList<Sizes...>, detail::SizeList<Tiles...>, detail::SizeList<Dims...>> {
+    static_assert(sizeof...(Sizes) == sizeof...(Tiles), "Layout must have a tile size for each dimension");
+    static_assert(detail::Product<(Tiles != 0 && (Tiles & (Tiles - 1)) == 0)...>::value,
+                  "Tile sizes must be powers of 2");
+
+    using sizes         = detail::SizeList<Sizes...>;
+    using tile_sizes    = detail::SizeList<Tiles...>;
+    using strides       = typename detail::ColumnMajorStrides<1, detail::SizeList<>, Tiles...>::type;
+    using grid_sizes    = detail::SizeList<((Sizes + Tiles - 1) / Tiles)...>;
+    using grid_bits     = detail::SizeList<detail::ceil_log2((Sizes + Tiles - 1) / Tiles)...>;
+    using grid_strides  = typename detail::ColumnMajorStrides<detail::Product<Tiles...>::value, 
+                                                              detail::SizeList<>, 
+                                                              ((Sizes + Tiles - 1) / Tiles)...>::type;
+
+    // The total number of elements in the layout
+    static constexpr size_t num_elements = detail::Product<Sizes...>::value;
+
+    // The elements of a tile are contiguous, but not the elements of the layout
+    static constexpr bool contiguous = false;
+    static constexpr bool tiled      = true;
+    static constexpr bool morton     = Morton;
+
+    // The mapping of each dimension
+    static constexpr detail::TileDimension tiles[sizeof...(Sizes)] = {{ 
+        detail::floor_log2(Tiles), 
+        detail::SizeArray<strides>::values[Dims],
+        Morton ? detail::morton_mask(detail::SizeArray<grid_bits>::values, sizeof...(Sizes), Dims, 0) 
+                    << detail::floor_log2(detail::Product<Tiles...>::value)
+               : detail::SizeArray<grid_strides>::values[Dims]
+    }...};
+
+    // The number of elements which the memory for the layout must hold -- up to the end of the last tile
+    static constexpr size_t storage_size = detail::Product<Tiles...>::value * (Morton 
+        ? 1 + detail::Sum<detail::deposit_bits((Sizes + Tiles - 1) / Tiles - 1, 
+                                               detail::morton_mask(detail::SizeArray<grid_bits>::values,
+                                                                   sizeof...(Sizes), Dims, 0))...>::value
+        : detail::Product<((Sizes + Tiles - 1) / Tiles)...>::value);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the memory offset of the element with a given (logical) linear index
+    /// @param[in]  linear_index    The index of the element in column-major order
+    /// @return     The memory offset of the element
+    // ------------------------------------------------------------------------------------------------------
+    static constexpr size_t offset(size_t linear_index)
+    {
+        return detail::tiled_linear_offset(detail::SizeArray<sizes>::values, tiles, sizeof...(Sizes), Morton,
+                                           linear_index);
+    }
+};
+
+template <bool Morton, size_t... Sizes, size_t... Tiles, size_t... Dims>
+constexpr detail::TileDimension 
+TiledLayout<Morton, detail::SizeList<Sizes...>, detail::SizeList<Tiles...>, detail::SizeList<Dims...>>::tiles[];
+
+template <size_t... TileSizes, size_t... Sizes>
+struct StaticLayout<Tiled<TileSizes...>, Sizes...> 
+: TiledLayout<false, detail::SizeList<Sizes...>, 
+              typename detail::PadSizes<sizeof...(Sizes), detail::SizeList<TileSizes...>>::type> {
+    static_assert(sizeof...(TileSizes) <= sizeof...(Sizes), "Layout has more tile sizes than dimensions");
+    using policy    = Tiled<TileSizes...>;
+};
+
+template <size_t... TileSizes, size_t... Sizes>
+struct StaticLayout<MortonTiled<TileSizes...>, Sizes...> 
+: TiledLayout<true, detail::SizeList<Sizes...>, 
+              typename detail::PadSizes<sizeof...(Sizes), detail::SizeList<TileSizes...>>::type> {
+    static_assert(sizeof...(TileSizes) <= sizeof...(Sizes), "Layout has more tile sizes than dimensions");
+    using policy    = MortonTiled<TileSizes...>;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      DynamicLayout
+/// @brief      Layout of a tensor with dimension sizes which are only known at runtime. The layout stores the
+///             size and the stride of each dimension, where the strides are computed when the layout is
+///             created for column-major and row-major layouts, or can be given explicitly. Tiled layouts
+///             also store the mapping of each dimension, and their strides are those of a tile.
+// ----------------------------------------------------------------------------------------------------------
+class DynamicLayout {
+public:
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using size_type         = size_t;
+    using dim_container     = std::vector<size_type>;
+    using stride_container  = std::vector<size_type>;
+    // ------------------------------------------------------------------------------------------------------
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor for a layout with a given rank, where all the dimensions have size 0
+    /// @param[in]  rank    The rank of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    explicit DynamicLayout(size_type rank = 0)
+    : _dim_sizes(rank, 0), _strides(rank, 0), _size(0), _contiguous(true) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor for a column-major layout which takes the container of the dimension sizes
+    /// @param[in]  dim_sizes   The sizes of the dimensions, which are moved into the layout
+    // ------------------------------------------------------------------------------------------------------
+    DynamicLayout(dim_container&& dim_sizes, ColumnMajor = ColumnMajor())
+    : _dim_sizes(std::move(dim_sizes)), _strides(_dim_sizes.size()), _contiguous(true)
+    {
+        _size = 1;
+        for (size_type i = 0; i < _dim_sizes.size(); ++i) { _strides[i] = _size; _size *= _dim_sizes[i]; }
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor for a column-major layout
+    /// @param[in]  dim_sizes   The sizes of the dimensions
+    /// @tparam     Container   The type of the container of the dimension sizes
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Container, typename = decltype(std::declval<const Container&>().begin())>
+    DynamicLayout(const Container& dim_sizes, ColumnMajor = ColumnMajor())
+    : _dim_sizes(dim_sizes.begin(), dim_sizes.end()), _strides(_dim_sizes.size()), _contiguous(true)
+    {
+        _size = 1;
+        for (size_type i = 0; i < _dim_sizes.size(); ++i) { _strides[i] = _size; _size *= _dim_sizes[i]; }
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor for a row-major layout
+    /// @param[in]  dim_sizes   The sizes of the dimensions
+    /// @tparam     Container   The type of the container of the dimension sizes
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Container, typename = decltype(std::declval<const Container&>().begin())>
+    DynamicLayout(const Container& dim_sizes, RowMajor)
+    : _dim_sizes(dim_sizes.begin(), dim_sizes.end()), _strides(_dim_sizes.size())
+    {
+        _size = 1;
+        for (size_type i = _dim_sizes.size(); i-- > 0; ) { _strides[i] = _size; _size *= _dim_sizes[i]; }
+        _contiguous = check_contiguous();
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor for a layout with arbitrary strides (for example to use data with padding, or
+    ///             data which is a part of a larger tensor)
+    /// @param[in]  dim_sizes   The sizes of the dimensions
+    /// @param[in]  strides     The stride (in elements) of each of the dimensions
+    /// @tparam     Container   The type of the container of the dimension sizes and strides
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Container, typename = decltype(std::declval<const Container&>().begin())>
+    DynamicLayout(const Container& dim_sizes, const Container& strides)
+    : _dim_sizes(dim_sizes.begin(), dim_sizes.end()), _strides(strides.begin(), strides.end())
+    {
+        _size = 1;
+        for (auto size : _dim_sizes) _size *= size;
+        _contiguous = check_contiguous();
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor for a tiled layout, with the tiles in column-major order
+    /// @param[in]  dim_sizes   The sizes of the dimensions
+    /// @tparam     Container   The type of the container of the dimension sizes
+    /// @tparam     TileSizes   The sizes of the tiles
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Container, size_t... TileSizes, 
+              typename = decltype(std::declval<const Container&>().begin())>
+    DynamicLayout(const Container& dim_sizes, Tiled<TileSizes...>)
+    : _dim_sizes(dim_sizes.begin(), dim_sizes.end())
+    {
+        make_tiles(std::initializer_list<size_type>{ TileSizes... }, false);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor for a tiled layout, with the tiles in Morton order
+    /// @param[in]  dim_sizes   The sizes of the dimensions
+    /// @tparam     Container   The type of the container of the dimension sizes
+    /// @tparam     TileSizes   The sizes of the tiles
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Container, size_t... TileSizes, 
+              typename = decltype(std::declval<const Container&>().begin())>
+    DynamicLayout(const Container& dim_sizes, MortonTiled<TileSizes...>)
+    : _dim_sizes(dim_sizes.begin(), dim_sizes.end())
+    {
+        make_tiles(std::initializer_list<size_type>{ TileSizes... }, true);
+    }
+
+    DynamicLayout(const DynamicLayout& other)            = default;
+    DynamicLayout& operator=(const DynamicLayout& other) = default;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Move constructor -- the other layout is left with rank 0 and no elements
+    /// @param[in]  other   The layout to move
+    // ------------------------------------------------------------------------------------------------------
+    DynamicLayout(DynamicLayout&& other) noexcept
+    : _dim_sizes(std::move(other._dim_sizes)), _strides(std::move(other._strides)), 
+      _size(other._size), _contiguous(other._contiguous), _tiles(std::move(other._tiles)), _morton(other._morton)
+    {
+        other.reset();
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Move assignment -- the other layout is left with rank 0 and no elements
+    /// @param[in]  other   The layout to move
+    /// @return     A reference to this layout
+    // ------------------------------------------------------------------------------------------------------
+    DynamicLayout& operator=(DynamicLayout&& other) noexcept
+    {
+        if (this != &other) {
+            _dim_sizes  = std::move(other._dim_sizes);
+            _strides    = std::move(other._strides);
+            _size       = other._size;
+            _contiguous = other._contiguous;
+            _tiles      = std::move(other._tiles);
+            _morton     = other._morton;
+            other.reset();
+        }
+        return *this;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the sizes of the dimensions
+    /// @return     A constant reference to the sizes of the dimensions
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _dim_sizes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the strides of the dimensions
+    /// @return     A constant reference to the strides of the dimensions
+    // ------------------------------------------------------------------------------------------------------
+    inline const stride_container& strides() const { return _strides; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the total number of elements described by the layout
+    /// @return     The product of the sizes of the dimensions
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type size() const { return _size; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of elements which the memory for the layout must hold -- this is larger
+    ///             than size() if the strides leave gaps between the elements
+    /// @return     One more than the largest offset of the layout
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type storage_size() const
+    {
+        if (_size == 0) return 0;
+        if (tiled()) {
+            // Up to the end of the tile of the last element -- tile offsets increase with the tile indices
+            size_type last = 0, tile_size = 1;
+            for (size_type i = 0; i < _dim_sizes.size(); ++i) {
+                last      += tile_offset(i, (_dim_sizes[i] - 1) >> _tiles[i].shift << _tiles[i].shift);
+                tile_size <<= _tiles[i].shift;
+            }
+            return last + tile_size;
+        }
+        size_type last = 0;
+        for (size_type i = 0; i < _dim_sizes.size(); ++i) last += (_dim_sizes[i] - 1) * _strides[i];
+        return last + 1;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the logical and the memory orders of the elements are the same, in which case the
+    ///             linear index of an element is its memory offset
+    /// @return     True if the layout is a dense column-major layout
+    // ------------------------------------------------------------------------------------------------------
+    inline bool contiguous() const { return _contiguous; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the elements are stored in tiles
+    /// @return     True if the layout is tiled
+    // ------------------------------------------------------------------------------------------------------
+    inline bool tiled() const { return !_tiles.empty(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the tiles of a tiled layout are stored in Morton order
+    /// @return     True if the tiles are in Morton order
+    // ------------------------------------------------------------------------------------------------------
+    inline bool morton() const { return _morton; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the mapping of each dimension of a tiled layout
+    /// @return     The mappings, which are empty if the layout isn't tiled
+    // ------------------------------------------------------------------------------------------------------
+    inline const std::vector<detail::TileDimension>& tiles() const { return _tiles; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the memory offset of an index of one dimension of a tiled layout
+    /// @param[in]  dim     The dimension
+    /// @param[in]  index   The index in the dimension
+    /// @return     The part of the memory offset of an element which depends on the index
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type tile_offset(size_type dim, size_type index) const
+    {
+        const detail::TileDimension& tile = _tiles[dim];
+        const size_type tile_index = index >> tile.shift;
+        return (index - (tile_index << tile.shift)) * tile.stride
+             + (_morton ? detail::scatter_bits(tile_index, tile.offset) : tile_index * tile.offset);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the memory offset of the element with a given (logical) linear index
+    /// @param[in]  linear_index    The index of the element in column-major order
+    /// @return     The memory offset of the element
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type offset(size_type linear_index) const
+    {
+        if (_contiguous) return linear_index;
+        size_type offset = 0;
+        if (tiled()) {
+            for (size_type i = 0; i < _dim_sizes.size(); ++i) {
+                offset       += tile_offset(i, linear_index % _dim_sizes[i]);
+                linear_index /= _dim_sizes[i];
+            }
+            return offset;
+        }
+        for (size_type i = 0; i < _dim_sizes.size(); ++i) {
+            offset       += (linear_index % _dim_sizes[i]) * _strides[i];
+            linear_index /= _dim_sizes[i];
+        }
+        return offset;
+    }
+private:
+    dim_container       _dim_sizes;         //!< The sizes of the dimensions
+    stride_container    _strides;           //!< The strides of the dimensions
+    size_type           _size;              //!< The total number of elements
+    bool                _contiguous;        //!< If the layout is dense and column-major
+
+    std::vector<detail::TileDimension>  _tiles;             //!< The mapping of each dimension, if tiled
+    bool                                _morton = false;    //!< If the tiles are in Morton order
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Resets the layout to rank 0 with no elements (the state of a moved-from layout)
+    // ------------------------------------------------------------------------------------------------------
+    void reset() noexcept
+    {
+        _dim_sizes.clear();
+        _strides.clear();
+        _tiles.clear();
+        _size       = 0;
+        _contiguous = true;
+        _morton     = false;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Computes the mapping of each dimension of a tiled layout
+    /// @param[in]  tile_sizes  The sizes of the tiles (powers of 2), dimensions after the last have size 1
+    /// @param[in]  morton      If the tiles are in Morton order
+    // ------------------------------------------------------------------------------------------------------
+    void make_tiles(std::initializer_list<size_type> tile_sizes, bool morton)
+    {
+        const size_type rank = _dim_sizes.size();
+        if (tile_sizes.size() > rank)
+            throw std::invalid_argument("ftl::DynamicLayout : more tile sizes than dimensions");
+
+        _strides.resize(rank);
+        _tiles.resize(rank);
+        _contiguous = false;
+        _morton     = morton;
+        _size       = 1;
+        size_type tile_size = 1;
+        for (size_type i = 0; i < rank; ++i) {
+            const size_type tile = i < tile_sizes.size() ? tile_sizes.begin()[i] : 1;
+            if (tile == 0 || (tile & (tile - 1)) != 0)
+                throw std::invalid_argument("ftl::DynamicLayout : tile sizes must be powers of 2");
+            _tiles[i].shift  = detail::floor_log2(tile);
+            _tiles[i].stride = _strides[i] = tile_size;
+            tile_size *= tile;
+            _size     *= _dim_sizes[i];
+        }
+
+        // Offsets of the tiles, or the positions of the bits of the tile indices in the Morton code
+        std::vector<size_type> grid_bits(rank);
+        size_type grid_stride = tile_size;
+        for (size_type i = 0; i < rank; ++i) {
+            const size_type tile      = size_type(1) << _tiles[i].shift;
+            const size_type grid_size = (_dim_sizes[i] + tile - 1) / tile;
+            grid_bits[i]      = detail::ceil_log2(grid_size);
+            _tiles[i].offset  = grid_stride;
+            grid_stride      *= grid_size;
+        }
+        if (morton) {
+            for (size_type i = 0; i < rank; ++i)
+                _tiles[i].offset = detail::morton_mask(grid_bits.data(), rank, i, 0) << detail::floor_log2(tile_size);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the strides are those of a dense column-major layout (strides of dimensions with
+    ///             a size of 1 don't matter)
+    /// @return     True if the layout is a dense column-major layout
+    // ------------------------------------------------------------------------------------------------------
+    bool check_contiguous() const
+    {
+        size_type expected = 1;
+        for (size_type i = 0; i < _dim_sizes.size(); ++i) {
+            if (_dim_sizes[i] != 1 && _strides[i] != expected) return false;
+            expected *= _dim_sizes[i];
+        }
+        return true;
+    }
+};
+
+}               // End namespace ftl
+#endif          // FTL_LAYOUT_HPP
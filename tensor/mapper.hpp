@@ -1,7 +1,7 @@
 // ----------------------------------------------------------------------------------------------------------
 /// @file   Header file for mapper related classes and variables for mapping linear indices to multiple 
 ///         dimensions and from mapping multiple dimensions to a linear index etc for both static and dynamic 
-///         containers
+///         containers, using the strides of the layout of the container
 // ----------------------------------------------------------------------------------------------------------
 
 /*
@@ -28,11 +28,10 @@
 #ifndef FTL_MAPPER_HPP
 #define FTL_MAPPER_HPP
 
-#include <nano/nano.hpp>
+#include "layout.hpp"
 
 #include <type_traits>
 #include <utility>
-#include <numeric>
 
 namespace ftl {
     
@@ -40,81 +39,88 @@ namespace detail {
 
 // ----------------------------------------------------------------------------------------------------------
 /// @struct     MapToIndexStatic
-/// @brief      Takes a list of indices and a list of dimension sizes, and determines the offset of an
-///             element given by the indices, in contiguous memory
-/// @tparam     DimSizes    The sizes of each of the dimensions
-/// @tparam     Indices     The value of the element in each of the indices
+/// @brief      Takes a list of indices and a list of strides (known at compile time), and determines the 
+///             offset of an element given by the indices, in contiguous memory
+/// @tparam     Strides     The strides of each of the dimensions
 // ----------------------------------------------------------------------------------------------------------
-template <typename DimSizes, typename... Indices>
+template <typename Strides>
 struct MapToIndexStatic;
 
-// Recursive case
-template <typename DimSizes, typename IF, typename... IR>
-struct MapToIndexStatic<DimSizes, IF, IR...>
-{
-    // On each iteration the product of the size of all previous dimensions must be calculated
-    // to determine the memory offset of this dimension, so determine the stopping index
-    using end_index = typename std::conditional<
-                        DimSizes::size - sizeof...(IR) == 1                     ,
-                        typename nano::size_t<0>                                ,
-                        typename nano::size_t<DimSizes::size - sizeof...(IR) - 2>>::type;
-    
-    // The product sum of the previous dimensions (previous iterations) so if we are on iteration
-    // 3 then this is the product of the size of dimension 0 and 1
-    static constexpr size_t dim_product_sum = nano::accumulate<DimSizes, 0, end_index::value, 1>::result;
-    
-    // The offset calculation 
-    static constexpr size_t offset(size_t current_offset, IF&& index_first, IR&&... indices_rest) 
-    {
-        // Recursively call until the terminating case 
-        // If first iteration use index_first as offset
-        // if other iteration, add mult with prev products
-        return DimSizes::size - sizeof...(IR) == 1 
-             ? MapToIndexStatic<DimSizes, IR...>::offset(current_offset + index_first                  , 
-                                                         std::forward<IR>(indices_rest)...             ) 
-             : MapToIndexStatic<DimSizes, IR...>::offset(current_offset + index_first * dim_product_sum, 
-                                                         std::forward<IR>(indices_rest)...             );
+template <size_t... Strides>
+struct MapToIndexStatic<SizeList<Strides...>> {
+    template <typename... Indices>
+    static constexpr size_t offset(Indices... indices) 
+    { 
+        return StaticOffset<Strides...>::offset(indices...); 
     }
 };
 
-// Terminating (base) case
-template <typename DimSizes>
-struct MapToIndexStatic<DimSizes>
-{
-    // Just need to return the result here
-    static constexpr size_t offset(size_t current_offset) { return current_offset; }
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     MapLayoutStatic
+/// @brief      Determines the offset of an element given by its indices in a static layout, which is either
+///             strided or tiled
+/// @tparam     Layout  The static layout
+/// @tparam     Tiled   If the layout is tiled
+// ----------------------------------------------------------------------------------------------------------
+template <typename Layout, bool Tiled = Layout::tiled>
+struct MapLayoutStatic {
+    template <typename... Indices>
+    static constexpr size_t offset(Indices... indices) 
+    { 
+        return MapToIndexStatic<typename Layout::strides>::offset(indices...); 
+    }
 };
 
-// Dynamic implementation
+template <typename Layout>
+struct MapLayoutStatic<Layout, true> {
+    template <typename... Indices>
+    static constexpr size_t offset(Indices... indices) 
+    { 
+        return tiled_offset(Layout::tiles, Layout::morton, indices...); 
+    }
+};
+
+// Dynamic implementation -- terminating case
 template <size_t Iteration, typename Container>
-size_t MapToIndexDynamic(const Container& dim_sizes       ,
-                         size_t           current_offset  )
+inline size_t MapToIndexDynamic(const Container&, size_t current_offset)
 {
     return current_offset;
 }
 
+// Dynamic implementation -- the iteration is known at compile time, so the loop over the indices is 
+// unrolled and the offset is the dot product of the indices and the (precomputed) strides
 template <size_t Iteration, typename Container, typename IF, typename... IR>
-size_t MapToIndexDynamic(const Container& dim_sizes       , 
-                         size_t           current_offset  , 
-                         IF               index_first     , 
-                         IR...            indices_rest    )
+inline size_t MapToIndexDynamic(const Container& strides         , 
+                                size_t           current_offset  , 
+                                IF               index_first     , 
+                                IR...            indices_rest    )
+{
+    return MapToIndexDynamic<Iteration + 1>(strides                                             , 
+                                            current_offset + strides[Iteration] * index_first   , 
+                                            indices_rest...                                     );
+}
+
+// Dynamic implementation for tiled layouts -- the offset is the sum of the offsets of each index
+template <size_t Iteration>
+inline size_t MapToTileDynamic(const DynamicLayout&, size_t current_offset)
 {
-    size_t num_indices = sizeof...(IR);
-    current_offset += std::accumulate(dim_sizes.begin()                 ,
-                                      dim_sizes.end() - num_indices - 1 ,
-                                      1                                 ,
-                                      std::multiplies<size_t>()         ) * index_first;
-    // Keep iterating
-    return MapToIndexDynamic<Iteration + 1>(dim_sizes, current_offset, indices_rest...);
+    return current_offset;
+}
+
+template <size_t Iteration, typename IF, typename... IR>
+inline size_t MapToTileDynamic(const DynamicLayout& layout, size_t current_offset, IF index_first, 
+                               IR... indices_rest)
+{
+    return MapToTileDynamic<Iteration + 1>(layout, current_offset + layout.tile_offset(Iteration, index_first),
+                                           indices_rest...);
 }
 
 }           // End namespace detail
 
 // ----------------------------------------------------------------------------------------------------------
 /// @struct     StaticMapper
-/// @brief      Interface which provides static mapping (uses TMP to determine some of the mapping variables 
-///             at compile time for improved performance) from indices to a single offset index and from an 
-///             index offset to a list of indices
+/// @brief      Interface which provides static mapping (uses TMP to determine the strides at compile time for 
+///             improved performance) from indices to a single offset index
 // ----------------------------------------------------------------------------------------------------------
 struct StaticMapper {
 
@@ -124,28 +130,43 @@ struct StaticMapper {
 ///             multi-dimensional space 
 /// @param[in]  index_first     The index of the element in the first dimension 
 /// @param[in]  indices_rest    The indices of the element in the other dimensions
-/// @tparam     DimSizes        The list of dimension sizes for the multi-dimensional space
+/// @tparam     Layout          The static layout (ftl::StaticLayout) of the multi-dimensional space
 /// @tparam     IF              The type of index_first
 /// @tparam     IR              The types of indices_rest
 // ----------------------------------------------------------------------------------------------------------
-template <typename DimSizes, typename IF, typename... IR>
+template <typename Layout, typename IF, typename... IR>
 static constexpr size_t indices_to_index(IF&& index_first, IR&&... indices_rest)
 {
-    return detail::MapToIndexStatic<DimSizes, IF, IR...>::offset(0                                   , 
-                                                                    std::forward<IF>(index_first)       , 
-                                                                    std::forward<IR>(indices_rest)...   );
+    return detail::MapLayoutStatic<Layout>::offset(std::forward<IF>(index_first)       , 
+                                                   std::forward<IR>(indices_rest)...   );
 }
 
 };
 
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     DynamicMapper
+/// @brief      Interface which provides dynamic mapping from indices to a single offset index, using strides 
+///             which are computed when the layout of a tensor is created
+// ----------------------------------------------------------------------------------------------------------
 struct DynamicMapper {
   
-template <typename Container, typename IF, typename... IR>
-static size_t indices_to_index(const Container&     dim_sizes   ,  
-                               IF                   index_first ,
-                               IR...                indices_rest)
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Maps any number of indices which represent the location of an index in a multi-dimensional
+///             space, to a singe index offset in the memory which is representing that multi-dimensional 
+///             space 
+/// @param[in]  layout          The layout of the multi-dimensional space
+/// @param[in]  index_first     The index of the element in the first dimension 
+/// @param[in]  indices_rest    The indices of the element in the other dimensions
+/// @tparam     IF              The type of index_first
+/// @tparam     IR              The types of indices_rest
+// ----------------------------------------------------------------------------------------------------------
+template <typename IF, typename... IR>
+static inline size_t indices_to_index(const DynamicLayout&  layout      ,  
+                                      IF                    index_first ,
+                                      IR...                 indices_rest)
 {
-    return detail::MapToIndexDynamic<1>(dim_sizes, index_first, indices_rest...);
+    return layout.tiled() ? detail::MapToTileDynamic<0>(layout, 0, index_first, indices_rest...)
+                          : detail::MapToIndexDynamic<0>(layout.strides().data(), 0, index_first, indices_rest...);
 }
 
 };
@@ -0,0 +1,458 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for permuting the dimensions of tensors, either lazily (as views) or by copying the
+///         elements into a new tensor with a blocked traversal.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_PERMUTE_HPP
+#define FTL_PERMUTE_HPP
+
+#include "simd.hpp"
+#include "tensor_dynamic_cpu.hpp"
+#include "tensor_static_cpu.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// NOTE : A permutation gives, for each dimension of the result, the dimension of the tensor which it is, so
+//        permuting a 2 x 3 x 4 tensor with { 2, 0, 1 } gives a 4 x 2 x 3 tensor, with R(k, i, j) = A(i, j, k).
+//        This is the order used by numpy.transpose.
+namespace ftl {
+namespace detail {
+
+static constexpr size_t permute_block = 32;     //!< Rows and columns of the blocks which are transposed
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Count
+/// @brief      Gets the number of times that a value is in a list
+/// @tparam     Value   The value to count
+/// @tparam     List    The list of values
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Value, typename List>
+struct Count;
+
+template <size_t Value, size_t... List>
+struct Count<Value, SizeList<List...>> : Sum<(Value == List)...> {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IsPermutation
+/// @brief      Checks that a list of dimensions holds each dimension of a tensor of a rank once only
+/// @tparam     Rank    The rank of the tensor
+/// @tparam     Order   The dimensions of the tensor in the order of the permutation
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Rank, size_t... Order>
+struct IsPermutation {
+    static constexpr bool value = sizeof...(Order) == Rank                                  &&
+                                  Product<(Order < Rank)...>::value == 1                    &&
+                                  Product<(Count<Order, SizeList<Order...>>::value == 1)...>::value == 1;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticPermutation
+/// @brief      Gets the types of a view of a tensor with a static layout with its dimensions permuted, and of
+///             a tensor which holds the permuted elements
+/// @tparam     DT          The type of the data of the tensor
+/// @tparam     Element     The type of the elements of the view (const DT for constant views)
+/// @tparam     Layout      The static layout of the tensor
+/// @tparam     Order       The dimensions of the tensor in the order of the permutation
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT, typename Element, typename Layout, size_t... Order>
+struct StaticPermutation {
+    static_assert(IsPermutation<Layout::sizes::size, Order...>::value,
+                  "ftl::permute : The order must hold each dimension of the tensor once");
+    static_assert(!Layout::tiled, "ftl::permute : The dimensions of tiled tensors can't be permuted");
+
+    using sizes     = SizeList<SizeArray<typename Layout::sizes>::values[Order]...>;
+    using strides   = SizeList<SizeArray<typename Layout::strides>::values[Order]...>;
+
+    template <typename Sizes> struct Types;
+    template <size_t... Sizes>
+    struct Types<SizeList<Sizes...>> {
+        using view      = TensorView<TensorTraits<DT, CPU, Sizes...>, Element, strides>;
+        using tensor    = TensorInterface<TensorTraits<DT, CPU, Sizes...>>;
+    };
+
+    using view_type     = typename Types<sizes>::view;
+    using tensor_type   = typename Types<sizes>::tensor;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Checks that a permutation holds each dimension of a tensor once only
+/// @param[in]  order   The dimensions of the tensor in the order of the permutation
+/// @param[in]  rank    The rank of the tensor
+// ----------------------------------------------------------------------------------------------------------
+inline void check_permutation(const std::vector<size_t>& order, size_t rank)
+{
+    std::vector<bool> found(rank, false);
+    if (order.size() != rank)
+        throw std::invalid_argument("ftl::permute : The order must have an element for each dimension");
+    for (const size_t dim : order) {
+        if (dim >= rank || found[dim])
+            throw std::invalid_argument("ftl::permute : The order must hold each dimension of the tensor once");
+        found[dim] = true;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the layout of the elements of a strided layout with its dimensions permuted
+/// @param[in]  layout  The layout to permute, which can't be tiled
+/// @param[in]  order   The dimensions of the layout in the order of the permutation
+/// @return     The permuted layout, which refers to the same memory
+// ----------------------------------------------------------------------------------------------------------
+inline DynamicLayout permuted_layout(const DynamicLayout& layout, const std::vector<size_t>& order)
+{
+    if (layout.tiled())
+        throw std::invalid_argument("ftl::permute : The dimensions of tiled tensors can't be permuted");
+    check_permutation(order, layout.dim_sizes().size());
+
+    std::vector<size_t> sizes(order.size()), strides(order.size());
+    for (size_t d = 0; d < order.size(); ++d) {
+        sizes[d]   = layout.dim_sizes()[order[d]];
+        strides[d] = layout.strides()[order[d]];
+    }
+    return DynamicLayout(sizes, strides);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     PermuteOuter
+/// @brief      The dimensions of a permutation which aren't traversed by the inner loops of the copy, and
+///             the offsets (in the input and the output) of each of their elements
+// ----------------------------------------------------------------------------------------------------------
+struct PermuteOuter {
+    std::vector<size_t> sizes;          //!< The size of each outer dimension
+    std::vector<size_t> in_strides;     //!< The stride of each outer dimension in the input
+    std::vector<size_t> out_strides;    //!< The stride of each outer dimension in the output
+    size_t              count = 1;      //!< The number of outer elements
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Adds a dimension
+    // ------------------------------------------------------------------------------------------------------
+    void add(size_t size, size_t in_stride, size_t out_stride)
+    {
+        sizes.push_back(size); in_strides.push_back(in_stride); out_strides.push_back(out_stride);
+        count *= size;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the offsets of an outer element, with the first outer dimension the fastest
+    /// @param[in]  index       The (column-major) index of the outer element
+    /// @param[out] in_offset   The offset of the element in the input
+    /// @param[out] out_offset  The offset of the element in the output
+    // ------------------------------------------------------------------------------------------------------
+    void offsets(size_t index, size_t& in_offset, size_t& out_offset) const
+    {
+        in_offset = out_offset = 0;
+        for (size_t d = 0; d < sizes.size(); ++d) {
+            const size_t i = index % sizes[d];
+            index /= sizes[d];
+            in_offset  += i * in_strides[d];
+            out_offset += i * out_strides[d];
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Transposes a block of rows x cols elements, a Transpose<Dtype>::size square at a time, with the
+///             elements which don't fill a square copied one at a time
+/// @param[in]  in          The first element of the block in the input, in which rows are contiguous
+/// @param[in]  in_stride   The stride between the rows of the input
+/// @param[out] out         The first element of the block in the output, in which columns are contiguous
+/// @param[in]  out_stride  The stride between the columns of the output
+/// @param[in]  rows        The number of rows in the block
+/// @param[in]  cols        The number of columns in the block
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+void transpose_block(const Dtype* in, size_t in_stride, Dtype* out, size_t out_stride, size_t rows, size_t cols)
+{
+    constexpr size_t square = simd::Transpose<Dtype>::size;
+    const size_t full_rows = rows - rows % square, full_cols = cols - cols % square;
+
+    for (size_t j = 0; j < full_cols; j += square) {
+        for (size_t i = 0; i < full_rows; i += square)
+            simd::Transpose<Dtype>::apply(in + i * in_stride + j, in_stride, out + j * out_stride + i, out_stride);
+        for (size_t jj = j; jj < j + square; ++jj)
+            for (size_t i = full_rows; i < rows; ++i) out[jj * out_stride + i] = in[i * in_stride + jj];
+    }
+    for (size_t j = full_cols; j < cols; ++j)
+        for (size_t i = 0; i < rows; ++i) out[j * out_stride + i] = in[i * in_stride + j];
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Copies the elements of a strided tensor into contiguous (column-major) memory, in the order
+///             of the dimensions of the output. Dimensions of size 1 are dropped and dimensions which are
+///             contiguous in both the input and the output are merged, after which:
+///
+///               - If the first dimension is contiguous in the input, each run of it is copied.
+///               - If another dimension (q) is contiguous in the input, the first dimension and q form a
+///                 matrix which is transposed in blocks which fit in the L1 cache, each of which is
+///                 transposed a square of registers at a time (see simd::Transpose).
+///               - Otherwise, each run of the first dimension is gathered from the input.
+///
+///             The runs or blocks are shared between the threads of the pool.
+/// @param[in]  in          The first element of the input
+/// @param[in]  dim_sizes   The size of each dimension of the output
+/// @param[in]  in_strides  The stride in the input of each dimension of the output
+/// @param[out] out         The memory for the output, which must hold the product of the sizes
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+void permute_copy(const Dtype* in, const std::vector<size_t>& dim_sizes, const std::vector<size_t>& in_strides,
+                  Dtype* out)
+{
+    std::vector<size_t> sizes, strides;
+    for (size_t d = 0; d < dim_sizes.size(); ++d) {
+        if (dim_sizes[d] == 0) return;
+        if (dim_sizes[d] == 1) continue;
+        if (!sizes.empty() && in_strides[d] == strides.back() * sizes.back()) {
+            sizes.back() *= dim_sizes[d];
+        } else {
+            sizes.push_back(dim_sizes[d]); strides.push_back(in_strides[d]);
+        }
+    }
+    if (sizes.empty()) { *out = *in; return; }
+
+    size_t q = 0, out_stride = sizes[0];
+    PermuteOuter outer;
+    for (size_t d = 1; d < sizes.size(); out_stride *= sizes[d++]) {
+        if (strides[0] != 1 && q == 0 && strides[d] == 1)
+            q = d;
+        else
+            outer.add(sizes[d], strides[d], out_stride);
+    }
+    const size_t rows = sizes[0], row_stride = strides[0];
+    auto& pool = ThreadPool::instance();
+
+    if (q == 0) {
+        // Runs of the first dimension, which are copied if they are contiguous and gathered if they aren't
+        pool.parallel_for(0, outer.count, [&] (size_t begin, size_t end)
+        {
+            size_t in_offset, out_offset;
+            for (size_t r = begin; r < end; ++r) {
+                outer.offsets(r, in_offset, out_offset);
+                if (row_stride == 1) {
+                    std::memcpy(out + out_offset, in + in_offset, rows * sizeof(Dtype));
+                } else {
+                    for (size_t i = 0; i < rows; ++i) out[out_offset + i] = in[in_offset + i * row_stride];
+                }
+            }
+        }, 1, std::max<size_t>(pool.grain_size() / rows, 1));
+        return;
+    }
+
+    // Blocks of the matrix of the first dimension (rows of which are strided in the input) and dimension q
+    // (which is contiguous in the input), for each element of the other dimensions
+    size_t col_stride = 1;
+    for (size_t d = 0; d < q; ++d) col_stride *= sizes[d];
+    const size_t cols       = sizes[q];
+    const size_t row_blocks = (rows + permute_block - 1) / permute_block;
+    const size_t col_blocks = (cols + permute_block - 1) / permute_block;
+    const size_t blocks     = row_blocks * col_blocks;
+
+    pool.parallel_for(0, outer.count * blocks, [&] (size_t begin, size_t end)
+    {
+        size_t in_offset, out_offset;
+        for (size_t w = begin; w < end; ++w) {
+            outer.offsets(w / blocks, in_offset, out_offset);
+            const size_t i = (w % blocks % row_blocks) * permute_block;
+            const size_t j = (w % blocks / row_blocks) * permute_block;
+            transpose_block(in + in_offset + i * row_stride + j, row_stride, out + out_offset + j * col_stride + i,
+                            col_stride, std::min(permute_block, rows - i), std::min(permute_block, cols - j));
+        }
+    }, 1, std::max<size_t>(pool.grain_size() / (permute_block * permute_block), 1));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Copies the elements of a tensor or a view with a dynamic layout into a new tensor, with its
+///             dimensions permuted
+/// @param[in]  data    The first element of the tensor or view
+/// @param[in]  layout  The layout of the tensor or view
+/// @param[in]  order   The dimensions of the tensor in the order of the permutation
+/// @return     A new tensor with the permuted elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+DynamicTensorCpu<Dtype> permute_dynamic(const Dtype* data, const DynamicLayout& layout,
+                                        const std::vector<size_t>& order)
+{
+    const DynamicLayout permuted = permuted_layout(layout, order);
+    typename DynamicTensorCpu<Dtype>::data_container elements(permuted.size());
+    permute_copy(data, permuted.dim_sizes(), permuted.strides(), elements.data());
+    return DynamicTensorCpu<Dtype>(permuted.dim_sizes(), std::move(elements));
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates a view of a tensor with its dimensions permuted, which refers to the data of the tensor
+///             (no data is copied), for example:
+///
+///             ftl::permuted(A, {1, 0}) = B;     // Assigns the transpose of B to A
+/// @param[in]  x       The tensor to permute, which can't be tiled
+/// @param[in]  order   The dimensions of the tensor in the order of the permutation
+/// @tparam     DT      The type of the data of the tensor
+/// @return     A view of the tensor with its dimensions permuted
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT>
+typename TensorInterface<TensorTraits<DT, CPU>>::view_type
+permuted(TensorInterface<TensorTraits<DT, CPU>>& x, const std::vector<size_t>& order)
+{
+    using view_type = typename TensorInterface<TensorTraits<DT, CPU>>::view_type;
+    return view_type(x.size() > 0 ? &x[0] : nullptr, detail::permuted_layout(x.layout(), order));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates a view of a constant tensor with its dimensions permuted, which can't be assigned to
+/// @param[in]  x       The tensor to permute, which can't be tiled
+/// @param[in]  order   The dimensions of the tensor in the order of the permutation
+/// @tparam     DT      The type of the data of the tensor
+/// @return     A constant view of the tensor with its dimensions permuted
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT>
+typename TensorInterface<TensorTraits<DT, CPU>>::const_view_type
+permuted(const TensorInterface<TensorTraits<DT, CPU>>& x, const std::vector<size_t>& order)
+{
+    using view_type = typename TensorInterface<TensorTraits<DT, CPU>>::const_view_type;
+    return view_type(x.data().data(), detail::permuted_layout(x.layout(), order));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates a view of a view with its dimensions permuted, which refers to the same data
+/// @param[in]  x       The view to permute
+/// @param[in]  order   The dimensions of the view in the order of the permutation
+/// @tparam     DT      The type of the data of the view
+/// @tparam     Element The type of the elements of the view
+/// @return     A view with the dimensions of the view permuted
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT, typename Element>
+TensorView<TensorTraits<DT, CPU>, Element>
+permuted(const TensorView<TensorTraits<DT, CPU>, Element>& x, const std::vector<size_t>& order)
+{
+    return TensorView<TensorTraits<DT, CPU>, Element>(x.data(), detail::permuted_layout(x.layout(), order));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates a view of a static tensor with its dimensions permuted, for which the permutation is
+///             checked and the sizes and strides are computed at compile time, for example:
+///
+///             auto V = ftl::permuted<2, 0, 1>(A);
+/// @param[in]  x       The tensor to permute, which can't be tiled
+/// @tparam     Order   The dimensions of the tensor in the order of the permutation
+/// @tparam     DT      The type of the data of the tensor
+/// @tparam     SF      The size of the first dimension of the tensor
+/// @tparam     SR      The sizes of the other dimensions of the tensor
+/// @return     A view of the tensor with its dimensions permuted
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... Order, typename DT, size_t SF, size_t... SR>
+typename detail::StaticPermutation<typename StaticTensorCpu<DT, SF, SR...>::data_type    ,
+                                   typename StaticTensorCpu<DT, SF, SR...>::data_type    ,
+                                   typename StaticTensorCpu<DT, SF, SR...>::layout_type  , Order...>::view_type
+permuted(TensorInterface<TensorTraits<DT, CPU, SF, SR...>>& x)
+{
+    using tensor_type = StaticTensorCpu<DT, SF, SR...>;
+    using permutation = detail::StaticPermutation<typename tensor_type::data_type  ,
+                                                  typename tensor_type::data_type  ,
+                                                  typename tensor_type::layout_type, Order...>;
+    return typename permutation::view_type(x.data().data());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates a view of a constant static tensor with its dimensions permuted
+/// @param[in]  x       The tensor to permute, which can't be tiled
+/// @tparam     Order   The dimensions of the tensor in the order of the permutation
+/// @tparam     DT      The type of the data of the tensor
+/// @tparam     SF      The size of the first dimension of the tensor
+/// @tparam     SR      The sizes of the other dimensions of the tensor
+/// @return     A constant view of the tensor with its dimensions permuted
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... Order, typename DT, size_t SF, size_t... SR>
+typename detail::StaticPermutation<typename StaticTensorCpu<DT, SF, SR...>::data_type          ,
+                                   const typename StaticTensorCpu<DT, SF, SR...>::data_type    ,
+                                   typename StaticTensorCpu<DT, SF, SR...>::layout_type        , Order...>::view_type
+permuted(const TensorInterface<TensorTraits<DT, CPU, SF, SR...>>& x)
+{
+    using tensor_type = StaticTensorCpu<DT, SF, SR...>;
+    using permutation = detail::StaticPermutation<typename tensor_type::data_type        ,
+                                                  const typename tensor_type::data_type  ,
+                                                  typename tensor_type::layout_type      , Order...>;
+    return typename permutation::view_type(x.data().data());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Copies the elements of a tensor into a new tensor with its dimensions permuted, for example:
+///
+///             ftl::DynamicTensorCpu<float> B = ftl::permute(A, {2, 0, 1});
+/// @param[in]  x       The tensor to permute, which can't be tiled
+/// @param[in]  order   The dimensions of the tensor in the order of the permutation
+/// @tparam     DT      The type of the data of the tensor
+/// @return     A new (column-major) tensor with the permuted elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT>
+DynamicTensorCpu<typename TensorInterface<TensorTraits<DT, CPU>>::data_type>
+permute(const TensorInterface<TensorTraits<DT, CPU>>& x, const std::vector<size_t>& order)
+{
+    return detail::permute_dynamic(x.data().data(), x.layout(), order);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Copies the elements of a view into a new tensor with its dimensions permuted
+/// @param[in]  x       The view to permute
+/// @param[in]  order   The dimensions of the view in the order of the permutation
+/// @tparam     DT      The type of the data of the view
+/// @tparam     Element The type of the elements of the view
+/// @return     A new (column-major) tensor with the permuted elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT, typename Element>
+DynamicTensorCpu<DT> permute(const TensorView<TensorTraits<DT, CPU>, Element>& x, const std::vector<size_t>& order)
+{
+    return detail::permute_dynamic<DT>(x.data(), x.layout(), order);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Copies the elements of a static tensor into a new static tensor with its dimensions permuted
+/// @param[in]  x       The tensor to permute, which can't be tiled
+/// @tparam     Order   The dimensions of the tensor in the order of the permutation
+/// @tparam     DT      The type of the data of the tensor
+/// @tparam     SF      The size of the first dimension of the tensor
+/// @tparam     SR      The sizes of the other dimensions of the tensor
+/// @return     A new (column-major) static tensor with the permuted elements
+// ----------------------------------------------------------------------------------------------------------
+template <size_t... Order, typename DT, size_t SF, size_t... SR>
+typename detail::StaticPermutation<typename StaticTensorCpu<DT, SF, SR...>::data_type    ,
+                                   typename StaticTensorCpu<DT, SF, SR...>::data_type    ,
+                                   typename StaticTensorCpu<DT, SF, SR...>::layout_type  , Order...>::tensor_type
+permute(const TensorInterface<TensorTraits<DT, CPU, SF, SR...>>& x)
+{
+    using tensor_type = StaticTensorCpu<DT, SF, SR...>;
+    using permutation = detail::StaticPermutation<typename tensor_type::data_type  ,
+                                                  typename tensor_type::data_type  ,
+                                                  typename tensor_type::layout_type, Order...>;
+    const auto sizes   = detail::ToArray<typename permutation::sizes>::array();
+    const auto strides = detail::ToArray<typename permutation::strides>::array();
+
+    typename permutation::tensor_type result;
+    detail::permute_copy(x.data().data(), std::vector<size_t>(sizes.begin(), sizes.end()),
+                         std::vector<size_t>(strides.begin(), strides.end()), result.data().data());
+    return result;
+}
+
+}               // End namespace ftl
+
+#endif          // FTL_PERMUTE_HPP
@@ -0,0 +1,186 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for tensor policies, which allow the parameters of the storage of a tensor (such as
+///         the allocator for a dynamic tensor) to be specified along with the data type.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_POLICIES_HPP
+#define FTL_POLICIES_HPP
+
+#include "aligned_allocator.hpp"
+#include "layout.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// NOTE : The dimension sizes of the tensor traits and containers are a variadic list of size_t's, so there
+//        is no place for extra type parameters after them. Policies are therefore given with the data type
+//        by wrapping it in ftl::Policies, for example:
+//
+//          ftl::TensorTraits<ftl::Policies<float, MyPoolAllocator<float>>, ftl::CPU>
+//
+//        and everything which uses the traits gets the data type and the policies from detail::PolicyTraits.
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Policies
+/// @brief      Wraps a data type with a list of policies for the tensor -- any policy which is not given
+///             takes its default value.
+/// @tparam     Dtype       The type of data used by the tensor
+/// @tparam     PolicyList  The policies for the tensor, currently:
+///                         - An allocator (any type which meets the standard library allocator requirements)
+///                           which is used for the data of dynamic tensors
+///                         - A layout (ftl::ColumnMajor or ftl::RowMajor) for static tensors, dynamic tensors
+///                           choose their layout at runtime
+///                         - A storage policy (ftl::InlineStorage, ftl::HeapStorage or ftl::AutomaticStorage)
+///                           for static tensors, dynamic tensors always store their data on the heap
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename... PolicyList>
+struct Policies {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StoragePolicy
+/// @brief      Base class for storage policies, which choose where the data of a static tensor is stored --
+///             the shape, strides and mapping of the tensor are known at compile time either way
+// ----------------------------------------------------------------------------------------------------------
+struct StoragePolicy {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     InlineStorage
+/// @brief      Stores the data of a static tensor in the tensor (in a std::array)
+// ----------------------------------------------------------------------------------------------------------
+struct InlineStorage : StoragePolicy {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     HeapStorage
+/// @brief      Stores the data of a static tensor in a heap buffer (from the allocator policy, so aligned by
+///             default) which is owned by the tensor, so that large static tensors don't overflow the stack
+// ----------------------------------------------------------------------------------------------------------
+struct HeapStorage : StoragePolicy {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     AutomaticStorage
+/// @brief      Uses InlineStorage for static tensors with at most FTL_MAX_INLINE_BYTES of data, and
+///             HeapStorage for larger static tensors (the default storage policy)
+// ----------------------------------------------------------------------------------------------------------
+struct AutomaticStorage : StoragePolicy {};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IsAllocator
+/// @brief      Determines if a type is an allocator (has a value_type and an allocate function)
+/// @tparam     Type    The type to check
+// ----------------------------------------------------------------------------------------------------------
+template <typename Type>
+struct IsAllocator {
+private:
+    template <typename T>
+    static auto check(int) -> decltype(std::declval<T&>().allocate(size_t(1)),
+                                       std::declval<typename T::value_type*>()    ,
+                                       std::true_type()                           );
+    template <typename T>
+    static std::false_type check(...);
+public:
+    static constexpr bool value = decltype(check<Type>(0))::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IsLayout
+/// @brief      Determines if a type is a layout policy
+/// @tparam     Type    The type to check
+// ----------------------------------------------------------------------------------------------------------
+template <typename Type>
+struct IsLayout {
+    static constexpr bool value = std::is_base_of<LayoutPolicy, Type>::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IsStorage
+/// @brief      Determines if a type is a storage policy
+/// @tparam     Type    The type to check
+// ----------------------------------------------------------------------------------------------------------
+template <typename Type>
+struct IsStorage {
+    static constexpr bool value = std::is_base_of<StoragePolicy, Type>::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     FindPolicy
+/// @brief      Finds the first policy in a list of policies which satisfies a predicate
+/// @tparam     Predicate   The predicate which the policy must satisfy
+/// @tparam     Default     The type to use if no policy satisfies the predicate
+/// @tparam     PolicyList  The list of policies to search
+// ----------------------------------------------------------------------------------------------------------
+template <template <typename> class Predicate, typename Default, typename... PolicyList>
+struct FindPolicy { using type = Default; };
+
+template <template <typename> class Predicate, typename Default, typename PF, typename... PR>
+struct FindPolicy<Predicate, Default, PF, PR...> {
+    using type = typename std::conditional<Predicate<PF>::value                             ,
+                                           PF                                               ,
+                                           typename FindPolicy<Predicate, Default, PR...>::type
+                                          >::type;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     PolicyTraits
+/// @brief      Gets the data type and the policies from a data type which may have been wrapped with
+///             policies
+/// @tparam     Dtype   The (possibly wrapped) data type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct PolicyTraits {
+    using data_type         = Dtype;
+    using allocator_type    = AlignedAllocator<Dtype>;
+    using layout_policy     = ColumnMajor;
+    using storage_policy    = AutomaticStorage;
+};
+
+template <typename Dtype, typename... PolicyList>
+struct PolicyTraits<Policies<Dtype, PolicyList...>> {
+    using data_type         = Dtype;
+    using allocator_type    = typename std::allocator_traits<
+                                typename FindPolicy<IsAllocator, AlignedAllocator<Dtype>, PolicyList...>::type
+                                >::template rebind_alloc<Dtype>;
+    using layout_policy     = typename FindPolicy<IsLayout, ColumnMajor, PolicyList...>::type;
+    using storage_policy    = typename FindPolicy<IsStorage, AutomaticStorage, PolicyList...>::type;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     WithAllocator
+/// @brief      Wraps a data type with an allocator policy, unless the allocator is the default allocator, in
+///             which case the data type is not wrapped (so that tensors with the default allocator have the
+///             same type as tensors declared without one)
+/// @tparam     Dtype       The data type
+/// @tparam     Allocator   The allocator to use
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Allocator>
+struct WithAllocator {
+    using type = typename std::conditional<std::is_same<Allocator, AlignedAllocator<Dtype>>::value ,
+                                           Dtype                                                    ,
+                                           Policies<Dtype, Allocator>                               >::type;
+};
+
+}               // End namespace detail
+}               // End namespace ftl
+#endif          // FTL_POLICIES_HPP
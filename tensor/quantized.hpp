@@ -0,0 +1,929 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for quantized tensors, which store 8 bit integers (int8_t or uint8_t) q for values
+///         scale * (q - zero_point), with a single scale and zero point for the whole tensor or one for each
+///         index of one of its dimensions (per-axis). Expressions are quantized and dequantized with lazy
+///         expression nodes, so elementwise operations on quantized tensors are fused into a single pass,
+///         and contractions of quantized tensors multiply the 8 bit integers and accumulate in 32 bit integers.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_QUANTIZED_HPP
+#define FTL_QUANTIZED_HPP
+
+#include "simd.hpp"
+#include "tensor_cast.hpp"
+#include "tensor_contraction.hpp"
+#include "tensor_dynamic_cpu.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// NOTE : Values are quantized as q = clamp(round(x / scale) + zero_point) (rounding to nearest even, and with
+//        NaNs clamped to the minimum), with the division done as a multiplication by the inverse of the scale
+//        so that the scalar and vectorized conversions give the same results.
+//
+//        Contractions use the identity sum (a - za)(b - zb) = sum ab - zb sum a - za sum b + n za zb, so the
+//        kernel only computes the products of the integers. The first operand is packed as unsigned and the
+//        second as signed integers (shifting by 128 where the types differ), which is the form of the VNNI
+//        dot product instruction (vpdpbusd). Without VNNI the elements are packed as 16 bit integers for
+//        pmaddwd, rather than as bytes for pmaddubsw, which saturates the sums of pairs of products.
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      The axis of a quantization with a single scale and zero point for the whole tensor
+// ----------------------------------------------------------------------------------------------------------
+static constexpr size_t per_tensor = static_cast<size_t>(-1);
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Quantization
+/// @brief      The scales and zero points of a quantization, and the mapping from the (column-major) index of
+///             an element to its channel -- the index of the quantized axis, or 0 for a per-tensor quantization
+// ----------------------------------------------------------------------------------------------------------
+struct Quantization {
+    size_t                      axis;           //!< The quantized axis (or per_tensor)
+    size_t                      inner;          //!< The number of elements before the axis
+    std::vector<float>          scales;         //!< The scale of each channel
+    std::vector<float>          inverses;       //!< The inverse of the scale of each channel
+    std::vector<std::int32_t>   zero_points;    //!< The zero point of each channel
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- checks the parameters for a tensor with given dimension sizes, and throws
+    ///             std::invalid_argument if the axis is out of range, if there isn't a scale and a zero point
+    ///             for each channel, if a scale is not positive and finite, or if a zero point can't be stored
+    /// @param[in]  dim_sizes   The sizes of the dimensions of the tensor
+    /// @param[in]  axis        The quantized axis (or per_tensor)
+    /// @param[in]  scales      The scale of each channel
+    /// @param[in]  zero_points The zero point of each channel
+    /// @param[in]  min         The minimum of the quantized type
+    /// @param[in]  max         The maximum of the quantized type
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Container>
+    Quantization(const Container& dim_sizes, size_t axis, std::vector<float> scales,
+                 std::vector<std::int32_t> zero_points, std::int32_t min, std::int32_t max)
+    : axis(axis), inner(1), scales(std::move(scales)), zero_points(std::move(zero_points))
+    {
+        const size_t rank     = dim_sizes.size();
+        size_t       channels = 1;
+        if (axis != per_tensor) {
+            if (axis >= rank) throw std::invalid_argument("ftl::quantize : axis " + std::to_string(axis) +
+                                                          " out of range for rank " + std::to_string(rank));
+            for (size_t d = 0; d < axis; ++d) inner *= dim_sizes[d];
+            channels = dim_sizes[axis];
+        }
+        if (this->scales.size() != channels || this->zero_points.size() != channels)
+            throw std::invalid_argument("ftl::quantize : need " + std::to_string(channels) +
+                                        " scales and zero points");
+        for (size_t c = 0; c < channels; ++c) {
+            if (!(this->scales[c] > 0.f) || !std::isfinite(this->scales[c]))
+                throw std::invalid_argument("ftl::quantize : scales must be positive and finite");
+            if (this->zero_points[c] < min || this->zero_points[c] > max)
+                throw std::invalid_argument("ftl::quantize : zero point out of range of the quantized type");
+            inverses.push_back(1.f / this->scales[c]);
+        }
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the channel of an element
+    /// @param[in]  i   The (column-major) index of the element
+    /// @return     The channel of the element
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t channel(size_t i) const { return scales.size() == 1 ? 0 : (i / inner) % scales.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of elements from an element which are in the same channel
+    /// @param[in]  i       The (column-major) index of the first element
+    /// @param[in]  end     The index of the element after the last element
+    /// @return     The number of elements from i (to at most end) which are in the same channel as i
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t run(size_t i, size_t end) const
+    {
+        return scales.size() == 1 ? end - i : std::min(end - i, inner - i % inner);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     QuantizedBytes
+/// @brief      The operations on registers of signed or unsigned bytes which depend on the signedness --
+///             widening to 32 bit integers, and packing 16 bit integers with saturation
+/// @tparam     Qtype   The quantized type (int8_t or uint8_t)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+struct QuantizedBytes;
+
+template <>
+struct QuantizedBytes<std::int8_t> {
+#if defined(FTL_SIMD_AVX2)
+    static inline __m256i widen(const __m128i x)                { return _mm256_cvtepi8_epi32(x);   }
+    static inline __m256i pack(const __m256i x, const __m256i y) { return _mm256_packs_epi16(x, y); }
+#endif
+#if defined(FTL_SIMD_AVX512)
+    static inline __m512i widen16(const __m128i x)              { return _mm512_cvtepi8_epi32(x);   }
+#endif
+};
+
+template <>
+struct QuantizedBytes<std::uint8_t> {
+#if defined(FTL_SIMD_AVX2)
+    static inline __m256i widen(const __m128i x)                { return _mm256_cvtepu8_epi32(x);   }
+    static inline __m256i pack(const __m256i x, const __m256i y) { return _mm256_packus_epi16(x, y); }
+#endif
+#if defined(FTL_SIMD_AVX512)
+    static inline __m512i widen16(const __m128i x)              { return _mm512_cvtepu8_epi32(x);   }
+#endif
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Quantizes a value
+/// @param[in]  x           The value to quantize
+/// @param[in]  inverse     The inverse of the scale
+/// @param[in]  zero_point  The zero point
+/// @tparam     Qtype       The quantized type
+/// @return     The quantized value
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+inline Qtype quantize_value(const float x, const float inverse, const std::int32_t zero_point)
+{
+    constexpr float min = static_cast<float>(std::numeric_limits<Qtype>::min());
+    constexpr float max = static_cast<float>(std::numeric_limits<Qtype>::max());
+
+    float value = x * inverse + static_cast<float>(zero_point);
+    value = value > min ? value : min;
+    value = value < max ? value : max;
+    return static_cast<Qtype>(static_cast<std::int32_t>(std::nearbyint(value)));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Quantizes contiguous values which have the same scale and zero point
+/// @param[in]  in          A pointer to the values to quantize
+/// @param[out] out         A pointer to the memory for the quantized values
+/// @param[in]  n           The number of values
+/// @param[in]  inverse     The inverse of the scale
+/// @param[in]  zero_point  The zero point
+/// @tparam     Qtype       The quantized type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+void quantize_block(const float* in, Qtype* out, const size_t n, const float inverse, const std::int32_t zero_point)
+{
+    size_t i = 0;
+#if defined(FTL_SIMD_AVX512)
+    {
+        const __m512 s  = _mm512_set1_ps(inverse), z = _mm512_set1_ps(static_cast<float>(zero_point));
+        const __m512 lo = _mm512_set1_ps(static_cast<float>(std::numeric_limits<Qtype>::min()));
+        const __m512 hi = _mm512_set1_ps(static_cast<float>(std::numeric_limits<Qtype>::max()));
+        for (; i + 16 <= n; i += 16) {
+            const __m512 v = _mm512_min_ps(_mm512_max_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(in + i), s), z),
+                                                         lo), hi);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm512_cvtepi32_epi8(_mm512_cvtps_epi32(v)));
+        }
+    }
+#elif defined(FTL_SIMD_AVX2)
+    {
+        const __m256 s  = _mm256_set1_ps(inverse), z = _mm256_set1_ps(static_cast<float>(zero_point));
+        const __m256 lo = _mm256_set1_ps(static_cast<float>(std::numeric_limits<Qtype>::min()));
+        const __m256 hi = _mm256_set1_ps(static_cast<float>(std::numeric_limits<Qtype>::max()));
+        const auto   convert = [&] (const float* x)
+        {
+            const __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(x), s), z),
+                                                         lo), hi);
+            return _mm256_cvtps_epi32(v);
+        };
+        // The packs interleave the 128 bit lanes, so the 32 bit groups are put back in order at the end
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        for (; i + 32 <= n; i += 32) {
+            const __m256i ab = _mm256_packs_epi32(convert(in + i     ), convert(in + i + 8 ));
+            const __m256i cd = _mm256_packs_epi32(convert(in + i + 16), convert(in + i + 24));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                _mm256_permutevar8x32_epi32(QuantizedBytes<Qtype>::pack(ab, cd), order));
+        }
+    }
+#endif
+    for (; i < n; ++i) out[i] = quantize_value<Qtype>(in[i], inverse, zero_point);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Dequantizes contiguous values which have the same scale and zero point
+/// @param[in]  in          A pointer to the quantized values
+/// @param[out] out         A pointer to the memory for the values
+/// @param[in]  n           The number of values
+/// @param[in]  scale       The scale
+/// @param[in]  zero_point  The zero point
+/// @tparam     Qtype       The quantized type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+void dequantize_block(const Qtype* in, float* out, const size_t n, const float scale, const std::int32_t zero_point)
+{
+    size_t i = 0;
+    const float zero = static_cast<float>(zero_point);
+#if defined(FTL_SIMD_AVX512)
+    for (; i + 16 <= n; i += 16) {
+        const __m512 v = _mm512_cvtepi32_ps(
+            QuantizedBytes<Qtype>::widen16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_sub_ps(v, _mm512_set1_ps(zero)), _mm512_set1_ps(scale)));
+    }
+#endif
+#if defined(FTL_SIMD_AVX2)
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_cvtepi32_ps(
+            QuantizedBytes<Qtype>::widen(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i))));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_sub_ps(v, _mm256_set1_ps(zero)), _mm256_set1_ps(scale)));
+    }
+#endif
+    for (; i < n; ++i) out[i] = (static_cast<float>(in[i]) - zero) * scale;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Dequantizes the elements [begin, end) of quantized data, one run of each channel at a time
+/// @param[in]  data            A pointer to the quantized data
+/// @param[in]  quantization    The quantization of the data
+/// @param[in]  begin           The index of the first element
+/// @param[in]  end             The index of the element after the last element
+/// @param[out] out             A pointer to the destination of the element begin
+/// @tparam     Qtype           The quantized type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+void dequantize_range(const Qtype* data, const Quantization& quantization, size_t begin, size_t end, float* out)
+{
+    for (size_t i = begin; i < end; ) {
+        const size_t c = quantization.channel(i), n = quantization.run(i, end);
+        dequantize_block(data + i, out + (i - begin), n, quantization.scales[c], quantization.zero_points[c]);
+        i += n;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets a quantization of values between a minimum and a maximum, which are extended to include
+///             zero -- symmetric (with a zero point of 0) for int8_t, and asymmetric for uint8_t
+/// @param[in]  min         The minimum value
+/// @param[in]  max         The maximum value
+/// @param[out] scale       The scale of the quantization
+/// @param[out] zero_point  The zero point of the quantization
+/// @tparam     Qtype       The quantized type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+void calibrate(float min, float max, float& scale, std::int32_t& zero_point)
+{
+    if (!std::isfinite(min) || !std::isfinite(max))
+        throw std::invalid_argument("ftl::QuantizedTensorCpu : can't quantize values which aren't finite");
+
+    min = std::min(min, 0.f); max = std::max(max, 0.f);
+    if (std::is_signed<Qtype>::value) {
+        scale      = std::max(-min, max) / static_cast<float>(std::numeric_limits<Qtype>::max());
+        zero_point = 0;
+    } else {
+        scale      = (max - min) / static_cast<float>(std::numeric_limits<Qtype>::max());
+        zero_point = scale > 0.f ? static_cast<std::int32_t>(std::nearbyint(-min / scale)) : 0;
+        zero_point = std::min(zero_point, static_cast<std::int32_t>(std::numeric_limits<Qtype>::max()));
+    }
+    if (!(scale > 0.f)) scale = 1.f;
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      TensorQuantize
+/// @brief      Expression class for quantizing the elements of an expression. Evaluating it into contiguous
+///             memory converts the expression to floats a block at a time, and quantizes each block with
+///             vector instructions.
+/// @tparam     E       The expression to quantize
+/// @tparam     T       The traits of the expression
+/// @tparam     Qtype   The quantized type (int8_t or uint8_t)
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Qtype>
+class TensorQuantize : public TensorExpression<TensorQuantize<E, T, Qtype>,
+                                               typename detail::CastTraits<T, Qtype>::type> {
+public:
+    using traits            = typename detail::CastTraits<T, Qtype>::type;
+    using dim_container     = typename traits::dim_container;
+    using size_type         = typename traits::size_type;
+    using data_type         = typename traits::data_type;
+    using packet_type       = typename simd::Packet<data_type>::type;
+
+    static constexpr bool vectorizable = false;
+private:
+    typename detail::ExpressionStorage<E>::type _x;             //!< Expression to quantize
+    detail::Quantization                        _quantization;  //!< The quantization of the elements
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Sets the expression to quantize and the quantization
+    /// @param[in] x               The expression to quantize
+    /// @param[in] quantization    The quantization (checked for the expression)
+    // ------------------------------------------------------------------------------------------------------
+    TensorQuantize(const TensorExpression<E, T>& x, detail::Quantization quantization)
+    : _x(static_cast<const E&>(x)), _quantization(std::move(quantization)) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the expression which is quantized
+    /// @return    A constant reference to the expression which is quantized
+    // ------------------------------------------------------------------------------------------------------
+    inline const E& source() const { return _x; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the quantization of the elements
+    /// @return    A constant reference to the quantization
+    // ------------------------------------------------------------------------------------------------------
+    inline const detail::Quantization& quantization() const { return _quantization; }
+
+    inline const dim_container& dim_sizes() const { return _x.dim_sizes(); }
+    inline const size_type size() const { return _x.size(); }
+    inline const size_type rank() const { return _x.rank(); }
+    inline bool contiguous() const { return _x.contiguous(); }
+    inline bool aliases(const detail::MemoryFootprint& target) const { return _x.aliases(target); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Quantizes an element of the expression
+    /// @param[in] i   The index of the element
+    /// @return    The quantized element
+    // ------------------------------------------------------------------------------------------------------
+    inline data_type operator[](size_type i) const
+    {
+        const size_t c = _quantization.channel(i);
+        return detail::quantize_value<data_type>(static_cast<float>(_x[i]), _quantization.inverses[c],
+                                                 _quantization.zero_points[c]);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates the elements [begin, end) of a quantization into contiguous memory, a block of
+///             elements at a time (see evaluate in evaluator.hpp)
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The quantization to evaluate
+/// @param[in]  begin       The index of the first element to evaluate
+/// @param[in]  end         The index of the element after the last element to evaluate
+/// @tparam     E           The type of the expression which is quantized
+/// @tparam     T           The traits of the expression which is quantized
+/// @tparam     Qtype       The quantized type
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Qtype>
+void evaluate(Qtype* out, const TensorQuantize<E, T, Qtype>& expression, size_t begin, size_t end)
+{
+    const detail::Quantization& quantization = expression.quantization();
+
+    float buffer[detail::cast_block];
+    for (size_t block = begin; block < end; block += detail::cast_block) {
+        const size_t count = std::min(detail::cast_block, end - block);
+        detail::evaluate_range(buffer, expression.source(), block, block + count);
+        for (size_t i = block; i < block + count; ) {
+            const size_t c = quantization.channel(i), n = quantization.run(i, block + count);
+            detail::quantize_block(buffer + (i - block), out + i, n, quantization.inverses[c],
+                                   quantization.zero_points[c]);
+            i += n;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      QuantizedTensorCpu
+/// @brief      Tensor of 8 bit integers which represent the values scale * (q - zero_point), where the scale
+///             and zero point are either the same for all the elements or depend on the index of one axis.
+///             The integers are stored in a dynamic tensor (column-major), and expressions of quantized tensors
+///             use the values through ftl::dequantize.
+/// @tparam     Qtype   The quantized type (int8_t or uint8_t)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+class QuantizedTensorCpu {
+    static_assert(std::is_same<Qtype, std::int8_t>::value || std::is_same<Qtype, std::uint8_t>::value,
+                  "Quantized tensors store int8_t or uint8_t");
+public:
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using data_type     = Qtype;
+    using tensor_type   = DynamicTensorCpu<Qtype>;
+    using dim_container = typename tensor_type::dim_container;
+    using size_type     = typename tensor_type::size_type;
+    // ------------------------------------------------------------------------------------------------------
+private:
+    static constexpr std::int32_t min_value = std::numeric_limits<Qtype>::min();
+    static constexpr std::int32_t max_value = std::numeric_limits<Qtype>::max();
+
+    tensor_type             _values;        //!< The quantized values
+    detail::Quantization    _quantization;  //!< The scales and zero points
+
+    // Creates a (column-major) tensor for the values, which are not initialized
+    template <typename Container>
+    static tensor_type make_values(const Container& dim_sizes)
+    {
+        DynamicLayout layout(std::vector<size_t>(dim_sizes.begin(), dim_sizes.end()));
+        typename tensor_type::data_container data(layout.size());
+        return tensor_type(layout, std::move(data));
+    }
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- creates a quantized tensor with a scale and zero point for all the elements,
+    ///             whose values are not initialized
+    /// @param[in]  dim_sizes   The sizes of the dimensions
+    /// @param[in]  scale       The scale of the values
+    /// @param[in]  zero_point  The integer which represents zero
+    // ------------------------------------------------------------------------------------------------------
+    QuantizedTensorCpu(const dim_container& dim_sizes, float scale, std::int32_t zero_point = 0)
+    : _values(make_values(dim_sizes)), _quantization(dim_sizes, per_tensor, {scale}, {zero_point}, min_value, max_value) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- creates a quantized tensor with a scale and zero point for each index of an
+    ///             axis, whose values are not initialized
+    /// @param[in]  dim_sizes   The sizes of the dimensions
+    /// @param[in]  axis        The quantized axis
+    /// @param[in]  scales      The scale for each index of the axis
+    /// @param[in]  zero_points The zero point for each index of the axis
+    // ------------------------------------------------------------------------------------------------------
+    QuantizedTensorCpu(const dim_container& dim_sizes, size_t axis, std::vector<float> scales,
+                       std::vector<std::int32_t> zero_points)
+    : _values(make_values(dim_sizes)),
+      _quantization(dim_sizes, axis, std::move(scales), std::move(zero_points), min_value, max_value) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- quantizes an expression, choosing the scales and zero points from the range
+    ///             of its values (symmetric for int8_t, asymmetric for uint8_t), either for the whole tensor
+    ///             or for each index of an axis
+    /// @param[in]  x       The expression to quantize
+    /// @param[in]  axis    The axis to quantize for each index of, or per_tensor
+    /// @tparam     E       The type of the expression
+    /// @tparam     T       The traits of the expression
+    // ------------------------------------------------------------------------------------------------------
+    template <typename E, typename T>
+    explicit QuantizedTensorCpu(const TensorExpression<E, T>& x, size_t axis = per_tensor);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- evaluates a quantization of an expression (ftl::quantize)
+    /// @param[in]  x       The quantization to evaluate
+    /// @tparam     E       The type of the quantized expression
+    /// @tparam     T       The traits of the quantized expression
+    // ------------------------------------------------------------------------------------------------------
+    template <typename E, typename T>
+    QuantizedTensorCpu(const TensorQuantize<E, T, Qtype>& x)
+    : _values(x), _quantization(x.quantization()) {}
+
+    inline size_type rank() const { return _values.rank(); }
+    inline size_type size() const { return _values.size(); }
+    inline size_t size(const int dim) const { return _values.size(dim); }
+    inline const dim_container& dim_sizes() const { return _values.dim_sizes(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets a quantized element
+    /// @param[in]  i   The (column-major) index of the element
+    /// @return     A reference to the quantized element
+    // ------------------------------------------------------------------------------------------------------
+    inline Qtype& operator[](size_type i) { return _values[i]; }
+    inline Qtype  operator[](size_type i) const { return _values[i]; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the tensor of quantized values
+    /// @return     A constant reference to the quantized values
+    // ------------------------------------------------------------------------------------------------------
+    inline const tensor_type& values() const { return _values; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the quantized axis
+    /// @return     The quantized axis, or per_tensor if the quantization is for the whole tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t axis() const { return _quantization.axis; }
+
+    inline const std::vector<float>& scales() const { return _quantization.scales; }
+    inline const std::vector<std::int32_t>& zero_points() const { return _quantization.zero_points; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the scales, zero points and the channel of each element
+    /// @return     A constant reference to the quantization
+    // ------------------------------------------------------------------------------------------------------
+    inline const detail::Quantization& quantization() const { return _quantization; }
+};
+
+template <typename Qtype> template <typename E, typename T>
+QuantizedTensorCpu<Qtype>::QuantizedTensorCpu(const TensorExpression<E, T>& x, size_t axis)
+: _values(make_values(x.dim_sizes())), _quantization(x.dim_sizes(), per_tensor, {1.f}, {0}, min_value, max_value)
+{
+    // The expression is evaluated once, and the range of each channel found from the values
+    const DynamicTensorCpu<float> source = cast<float>(x);
+    const float*                  data   = source.data().data();
+
+    const size_t channels = axis == per_tensor ? 1 : (axis < rank() ? size(axis) : 0);
+    std::vector<float>        scales(channels, 1.f);
+    std::vector<std::int32_t> zero_points(channels, 0);
+    if (channels > 0) {
+        std::vector<float> mins(channels, std::numeric_limits<float>::max()), maxs(channels, -mins[0]);
+        const detail::Quantization ranges(dim_sizes(), axis, scales, zero_points, min_value, max_value);
+        for (size_t i = 0; i < source.size(); ) {
+            const size_t c = ranges.channel(i), n = ranges.run(i, source.size());
+            for (size_t k = i; k < i + n; ++k) {
+                mins[c] = std::min(mins[c], data[k]); maxs[c] = std::max(maxs[c], data[k]);
+            }
+            i += n;
+        }
+        for (size_t c = 0; c < channels; ++c) detail::calibrate<Qtype>(mins[c], maxs[c], scales[c], zero_points[c]);
+    }
+    _quantization = detail::Quantization(dim_sizes(), axis, std::move(scales), std::move(zero_points),
+                                         min_value, max_value);
+    _values       = TensorQuantize<DynamicTensorCpu<float>, typename DynamicTensorCpu<float>::traits, Qtype>(
+                        source, _quantization);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      TensorDequantize
+/// @brief      Expression class for the (float) values of a quantized tensor, which are computed a packet at
+///             a time, so dequantized tensors can be used in any vectorized expression
+/// @tparam     Qtype   The quantized type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+class TensorDequantize : public TensorExpression<TensorDequantize<Qtype>, TensorTraits<float, CPU>> {
+public:
+    using traits            = TensorTraits<float, CPU>;
+    using dim_container     = typename traits::dim_container;
+    using size_type         = typename traits::size_type;
+    using data_type         = typename traits::data_type;
+    using packet_type       = typename simd::Packet<data_type>::type;
+
+    static constexpr bool vectorizable = true;
+private:
+    const QuantizedTensorCpu<Qtype>& _x;    //!< The quantized tensor
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Sets the quantized tensor
+    /// @param[in] x       The quantized tensor
+    // ------------------------------------------------------------------------------------------------------
+    TensorDequantize(const QuantizedTensorCpu<Qtype>& x) : _x(x) {}
+
+    inline const QuantizedTensorCpu<Qtype>& source() const { return _x; }
+    inline const dim_container& dim_sizes() const { return _x.dim_sizes(); }
+    inline size_type size() const { return _x.size(); }
+    inline size_type rank() const { return _x.rank(); }
+    inline bool contiguous() const { return true; }
+    inline bool aliases(const detail::MemoryFootprint& target) const { return _x.values().aliases(target); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Dequantizes an element
+    /// @param[in] i   The index of the element
+    /// @return    The value of the element
+    // ------------------------------------------------------------------------------------------------------
+    inline data_type operator[](size_type i) const
+    {
+        const detail::Quantization& quantization = _x.quantization();
+        const size_t c = quantization.channel(i);
+        return (static_cast<float>(_x[i]) - static_cast<float>(quantization.zero_points[c])) * quantization.scales[c];
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Dequantizes a packet of elements
+    /// @param[in] i   The index of the first element in the packet
+    /// @return    The packet of values
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const
+    {
+        using packet = simd::Packet<data_type>;
+
+        data_type result[packet::size];
+        detail::dequantize_range(_x.values().data().data(), _x.quantization(), i, i + packet::size, result);
+        return packet::loadu(result);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates the elements [begin, end) of a dequantized tensor into contiguous memory, a run of
+///             each channel at a time (see evaluate in evaluator.hpp)
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The dequantized tensor
+/// @param[in]  begin       The index of the first element to evaluate
+/// @param[in]  end         The index of the element after the last element to evaluate
+/// @tparam     Qtype       The quantized type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+inline void evaluate(float* out, const TensorDequantize<Qtype>& expression, size_t begin, size_t end)
+{
+    detail::dequantize_range(expression.source().values().data().data(), expression.source().quantization(),
+                             begin, end, out + begin);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Quantizes an expression with a scale and zero point for all the elements, lazily -- for example
+///             QuantizedTensorCpu<int8_t> Q = ftl::quantize<int8_t>(A, 0.05f)
+/// @param[in]  x           The expression to quantize
+/// @param[in]  scale       The scale of the quantization
+/// @param[in]  zero_point  The integer which represents zero
+/// @tparam     Qtype       The quantized type (int8_t or uint8_t)
+/// @tparam     E           The type of the expression
+/// @tparam     T           The traits of the expression
+/// @return     An expression with the quantized elements of x
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype, typename E, typename T>
+TensorQuantize<E, T, Qtype> quantize(const TensorExpression<E, T>& x, float scale, std::int32_t zero_point = 0)
+{
+    return TensorQuantize<E, T, Qtype>(x, detail::Quantization(x.dim_sizes(), per_tensor, {scale}, {zero_point},
+                                                               std::numeric_limits<Qtype>::min(),
+                                                               std::numeric_limits<Qtype>::max()));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Quantizes an expression with a scale and zero point for each index of an axis, lazily
+/// @param[in]  x           The expression to quantize
+/// @param[in]  axis        The quantized axis
+/// @param[in]  scales      The scale for each index of the axis
+/// @param[in]  zero_points The zero point for each index of the axis
+/// @tparam     Qtype       The quantized type (int8_t or uint8_t)
+/// @tparam     E           The type of the expression
+/// @tparam     T           The traits of the expression
+/// @return     An expression with the quantized elements of x
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype, typename E, typename T>
+TensorQuantize<E, T, Qtype> quantize(const TensorExpression<E, T>& x, size_t axis, std::vector<float> scales,
+                                     std::vector<std::int32_t> zero_points)
+{
+    return TensorQuantize<E, T, Qtype>(x, detail::Quantization(x.dim_sizes(), axis, std::move(scales),
+                                                               std::move(zero_points),
+                                                               std::numeric_limits<Qtype>::min(),
+                                                               std::numeric_limits<Qtype>::max()));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the (float) values of a quantized tensor as an expression, which refers to the tensor
+/// @param[in]  x       The quantized tensor
+/// @tparam     Qtype   The quantized type
+/// @return     An expression with the values of x
+// ----------------------------------------------------------------------------------------------------------
+template <typename Qtype>
+TensorDequantize<Qtype> dequantize(const QuantizedTensorCpu<Qtype>& x)
+{
+    return TensorDequantize<Qtype>(x);
+}
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     QuantizedKernel
+/// @brief      Micro-kernel which computes an mr x nr tile of the 32 bit integer products of a panel of mr rows
+///             of the first operand and a panel of nr rows of the second. The panels are packed in groups of kr
+///             elements along the contracted dimension -- group g of row r of a panel is at (g * rows + r) * kr --
+///             so that the rows of the first panel fill the lanes of registers and each group of a row of the
+///             second panel is broadcast to all the lanes, and the tile is kept in registers for the whole
+///             depth. With VNNI each lane accumulates the products of 4 unsigned and 4 signed bytes, otherwise
+///             the elements are packed as 16 bit integers and each lane accumulates 2 products (pmaddwd).
+// ----------------------------------------------------------------------------------------------------------
+struct QuantizedKernel {
+#if defined(FTL_SIMD_AVX512_VNNI)
+    using a_type = std::uint8_t;
+    using b_type = std::int8_t;
+    static constexpr size_t mr = 32, nr = 8, kr = 4;
+
+    static inline void run(const a_type* a, const b_type* b, size_t groups, std::int32_t* c, size_t ldc)
+    {
+        __m512i acc[2][nr];
+        for (size_t j = 0; j < nr; ++j) acc[0][j] = acc[1][j] = _mm512_setzero_si512();
+
+        for (size_t g = 0; g < groups; ++g, a += mr * kr, b += nr * kr) {
+            const __m512i a0 = _mm512_loadu_si512(a), a1 = _mm512_loadu_si512(a + 64);
+            for (size_t j = 0; j < nr; ++j) {
+                const __m512i bj = _mm512_set1_epi32(load_group(b + j * kr));
+                acc[0][j] = _mm512_dpbusd_epi32(acc[0][j], a0, bj);
+                acc[1][j] = _mm512_dpbusd_epi32(acc[1][j], a1, bj);
+            }
+        }
+        for (size_t j = 0; j < nr; ++j) {
+            _mm512_storeu_si512(c + j * ldc, acc[0][j]);
+            _mm512_storeu_si512(c + j * ldc + 16, acc[1][j]);
+        }
+    }
+#elif defined(FTL_SIMD_AVX2)
+    #if defined(FTL_SIMD_AVX_VNNI)
+    using a_type = std::uint8_t;
+    using b_type = std::int8_t;
+    static constexpr size_t kr = 4;
+
+    static inline __m256i dot(const __m256i acc, const __m256i a, const __m256i b)
+    {
+        return _mm256_dpbusd_avx_epi32(acc, a, b);
+    }
+    #else
+    using a_type = std::int16_t;
+    using b_type = std::int16_t;
+    static constexpr size_t kr = 2;
+
+    static inline __m256i dot(const __m256i acc, const __m256i a, const __m256i b)
+    {
+        return _mm256_add_epi32(acc, _mm256_madd_epi16(a, b));
+    }
+    #endif
+    static constexpr size_t mr = 16, nr = 4;
+
+    static inline void run(const a_type* a, const b_type* b, size_t groups, std::int32_t* c, size_t ldc)
+    {
+        __m256i acc[2][nr];
+        for (size_t j = 0; j < nr; ++j) acc[0][j] = acc[1][j] = _mm256_setzero_si256();
+
+        for (size_t g = 0; g < groups; ++g, a += mr * kr, b += nr * kr) {
+            const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+            const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 8 * kr));
+            for (size_t j = 0; j < nr; ++j) {
+                const __m256i bj = _mm256_set1_epi32(load_group(b + j * kr));
+                acc[0][j] = dot(acc[0][j], a0, bj);
+                acc[1][j] = dot(acc[1][j], a1, bj);
+            }
+        }
+        for (size_t j = 0; j < nr; ++j) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + j * ldc    ), acc[0][j]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + j * ldc + 8), acc[1][j]);
+        }
+    }
+#else
+    using a_type = std::int16_t;
+    using b_type = std::int16_t;
+    static constexpr size_t mr = 4, nr = 4, kr = 1;
+
+    static inline void run(const a_type* a, const b_type* b, size_t groups, std::int32_t* c, size_t ldc)
+    {
+        std::int32_t acc[nr][mr] = {};
+        for (size_t g = 0; g < groups; ++g, a += mr, b += nr)
+            for (size_t j = 0; j < nr; ++j)
+                for (size_t i = 0; i < mr; ++i) acc[j][i] += static_cast<std::int32_t>(a[i]) * b[j];
+        for (size_t j = 0; j < nr; ++j)
+            for (size_t i = 0; i < mr; ++i) c[i + j * ldc] = acc[j][i];
+    }
+#endif
+
+    // Loads a group of elements of a row of the second panel, as a 32 bit integer to broadcast
+    template <typename Btype>
+    static inline std::int32_t load_group(const Btype* b)
+    {
+        std::int32_t group;
+        std::memcpy(&group, b, sizeof(group));
+        return group;
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      The number of bytes of panels of the first operand which are multiplied by each panel of the
+///             second operand before moving to the next block of panels, so that the block stays in cache
+// ----------------------------------------------------------------------------------------------------------
+static constexpr size_t quantized_block_bytes = 1 << 17;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Packs an operand of a quantized contraction into panels for the kernel, where row i of the
+///             operand holds the elements with indices outer[i] + inner[k], and the elements are shifted so
+///             that the packed type has the same values offset by a constant. Rows and groups past the end of
+///             the operand are zeros. Also computes the sum of the (shifted) elements of each row.
+/// @param[in]  data    A pointer to the quantized elements of the operand
+/// @param[in]  outer   The index offset of each row
+/// @param[in]  inner   The index offset of each element of a row
+/// @param[in]  groups  The number of groups of elements in each row of a panel
+/// @param[in]  shift   The shift of the elements
+/// @param[out] packed  The packed panels
+/// @param[out] sums    The sums of the rows
+/// @tparam     Rows    The number of rows in a panel
+/// @tparam     Group   The number of elements in a group
+/// @tparam     Qtype   The quantized type of the operand
+/// @tparam     Ptype   The packed type
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Rows, size_t Group, typename Qtype, typename Ptype>
+void pack_quantized(const Qtype* data, const std::vector<size_t>& outer, const std::vector<size_t>& inner,
+                    size_t groups, std::int32_t shift, std::vector<Ptype>& packed, std::vector<std::int64_t>& sums)
+{
+    const size_t panels = (outer.size() + Rows - 1) / Rows, panel_size = Rows * groups * Group;
+    packed.assign(panels * panel_size, Ptype(0));
+    sums.assign(panels * Rows, 0);
+    ThreadPool::instance().parallel_for(0, outer.size(), [&] (size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i) {
+            Ptype*       row = packed.data() + (i / Rows) * panel_size + (i % Rows) * Group;
+            std::int64_t sum = 0;
+            for (size_t k = 0; k < inner.size(); ++k) {
+                const std::int32_t value = static_cast<std::int32_t>(data[outer[i] + inner[k]]) + shift;
+                row[(k / Group) * Rows * Group + k % Group] = static_cast<Ptype>(value);
+                sum += value;
+            }
+            sums[i] = sum;
+        }
+    }, 1, std::max(size_t(1), ThreadPool::instance().grain_size() / std::max(size_t(1), inner.size())));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Multiplies the packed panels of two operands, giving the (column-major) matrix of the 32 bit
+///             integer dot products of each row of the first operand with each row of the second. The panels
+///             of the second operand are split between the threads of the pool.
+/// @param[in]  a       The packed panels of the first operand
+/// @param[in]  b       The packed panels of the second operand
+/// @param[in]  rows    The number of rows of the first operand (a multiple of mr)
+/// @param[in]  cols    The number of rows of the second operand (a multiple of nr)
+/// @param[in]  groups  The number of groups of elements in each row of a panel
+/// @param[out] c       The products, with rows * cols elements
+// ----------------------------------------------------------------------------------------------------------
+inline void quantized_gemm(const QuantizedKernel::a_type* a, const QuantizedKernel::b_type* b, size_t rows,
+                           size_t cols, size_t groups, std::int32_t* c)
+{
+    using kernel = QuantizedKernel;
+
+    const size_t a_panel = kernel::mr * groups * kernel::kr, b_panel = kernel::nr * groups * kernel::kr;
+    const size_t row_panels = rows / kernel::mr, col_panels = cols / kernel::nr;
+    const size_t block      = std::max(size_t(1), quantized_block_bytes / (a_panel * sizeof(kernel::a_type)));
+    const size_t work       = std::max(size_t(1), rows * groups * kernel::kr * kernel::nr);
+    ThreadPool::instance().parallel_for(0, col_panels, [=] (size_t begin, size_t end)
+    {
+        for (size_t first = 0; first < row_panels; first += block) {
+            const size_t last = std::min(row_panels, first + block);
+            for (size_t j = begin; j < end; ++j)
+                for (size_t i = first; i < last; ++i)
+                    kernel::run(a + i * a_panel, b + j * b_panel, groups, c + i * kernel::mr + j * kernel::nr * rows,
+                                rows);
+        }
+    }, 1, std::max(size_t(1), ThreadPool::instance().grain_size() / work));
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Contracts two quantized tensors over pairs of dimensions (see contract in
+///             tensor_contraction.hpp), multiplying the integers with 32 bit accumulation, and scaling the
+///             sums to give the (float) values of the result. A per-axis quantization can't be of a contracted
+///             dimension, since the scales of the products would then differ within each sum.
+/// @param[in]  x       The first quantized tensor
+/// @param[in]  y       The second quantized tensor
+/// @param[in]  pairs   The pairs of dimensions to contract, as (dimension of x, dimension of y)
+/// @return     A new (dynamic) tensor with the result of the contraction
+/// @tparam     QA      The quantized type of the first tensor
+/// @tparam     QB      The quantized type of the second tensor
+// ----------------------------------------------------------------------------------------------------------
+template <typename QA, typename QB>
+DynamicTensorCpu<float> contract(const QuantizedTensorCpu<QA>&                  x      ,
+                                 const QuantizedTensorCpu<QB>&                  y      ,
+                                 const std::vector<std::pair<size_t, size_t>>&  pairs  )
+{
+    using kernel = detail::QuantizedKernel;
+
+    const std::vector<size_t> dims_a(x.dim_sizes().begin(), x.dim_sizes().end());
+    const std::vector<size_t> dims_b(y.dim_sizes().begin(), y.dim_sizes().end());
+    detail::check_contraction(dims_a, dims_b, pairs);
+    for (const auto& pair : pairs) {
+        if (pair.first == x.axis() || pair.second == y.axis())
+            throw std::invalid_argument("ftl::contract : can't contract a dimension with a per-axis quantization");
+    }
+
+    std::vector<size_t> outer_a, inner_a, outer_b, inner_b;
+    detail::contraction_offsets(dims_a, pairs, true , outer_a, inner_a);
+    detail::contraction_offsets(dims_b, pairs, false, outer_b, inner_b);
+
+    // The first operand is packed as unsigned bytes and the second as signed bytes, and the zero points are
+    // shifted with them
+    const std::int32_t shift_a = std::is_signed<QA>::value ? 128 : 0, shift_b = std::is_signed<QB>::value ? 0 : -128;
+    const size_t rows   = (outer_a.size() + kernel::mr - 1) / kernel::mr * kernel::mr;
+    const size_t cols   = (outer_b.size() + kernel::nr - 1) / kernel::nr * kernel::nr;
+    const size_t groups = (inner_a.size() + kernel::kr - 1) / kernel::kr;
+
+    std::vector<kernel::a_type>          packed_a;
+    std::vector<kernel::b_type>          packed_b;
+    std::vector<std::int64_t>            sums_a, sums_b;
+    detail::pack_quantized<kernel::mr, kernel::kr>(x.values().data().data(), outer_a, inner_a, groups, shift_a,
+                                                   packed_a, sums_a);
+    detail::pack_quantized<kernel::nr, kernel::kr>(y.values().data().data(), outer_b, inner_b, groups, shift_b,
+                                                   packed_b, sums_b);
+
+    std::vector<std::int32_t> products(rows * cols);
+    detail::quantized_gemm(packed_a.data(), packed_b.data(), rows, cols, groups, products.data());
+
+    // sum (a - za)(b - zb) from the products and the sums of the rows, scaled by the scales of the row and column
+    DynamicLayout layout(detail::contraction_dims(dims_a, dims_b, pairs));
+    DynamicTensorCpu<float>::data_container data(layout.size());
+    const detail::Quantization& qa = x.quantization();
+    const detail::Quantization& qb = y.quantization();
+    const std::int64_t          n  = static_cast<std::int64_t>(inner_a.size());
+    const size_t                m  = outer_a.size();
+    float*                      out = data.data();
+    ThreadPool::instance().parallel_for(0, outer_b.size(), [&] (size_t begin, size_t end)
+    {
+        for (size_t j = begin; j < end; ++j) {
+            const size_t       cb = qb.channel(outer_b[j]);
+            const std::int64_t zb = qb.zero_points[cb] + shift_b;
+            for (size_t i = 0; i < m; ++i) {
+                const size_t       ca  = qa.channel(outer_a[i]);
+                const std::int64_t za  = qa.zero_points[ca] + shift_a;
+                const std::int64_t sum = products[i + j * rows] - zb * sums_a[i] - za * sums_b[j] + n * za * zb;
+                out[i + j * m] = qa.scales[ca] * qb.scales[cb] * static_cast<float>(sum);
+            }
+        }
+    }, 1, std::max(size_t(1), ThreadPool::instance().grain_size() / std::max(size_t(1), m)));
+    return DynamicTensorCpu<float>(layout, std::move(data));
+}
+
+}               // End namespace ftl
+#endif          // FTL_QUANTIZED_HPP
@@ -0,0 +1,304 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for the counter-based random number generation used to initialize tensors.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_RANDOM_HPP
+#define FTL_RANDOM_HPP
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+
+// NOTE : Random numbers are generated by a counter-based generator (Philox4x32-10), which maps a key (the
+//        seed) and a counter to 4 random 32 bit words with no state in between. The counter of the words for
+//        element i of a tensor is i / elements_per_block (and the stream), so each element only depends on
+//        the seed, the stream and its index, and tensors are filled in parallel (in any order) with the same
+//        result for any number of threads.
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     RandomDistribution
+/// @brief      Base class for random distributions, so that they can be detected
+// ----------------------------------------------------------------------------------------------------------
+struct RandomDistribution {};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IsDistribution
+/// @brief      Determines if a type is a random distribution
+/// @tparam     Type    The type to check
+// ----------------------------------------------------------------------------------------------------------
+template <typename Type>
+struct IsDistribution {
+    static constexpr bool value = std::is_base_of<RandomDistribution, Type>::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Philox
+/// @brief      The Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as
+///             1, 2, 3"), which generates a batch of blocks at a time so that the rounds are vectorized
+// ----------------------------------------------------------------------------------------------------------
+struct Philox {
+    static constexpr size_t         batch_size  = 16;               //!< Blocks generated at a time
+    static constexpr size_t         rounds      = 10;               //!< Rounds of the generator
+    static constexpr std::uint32_t  multiplier_0 = 0xD2511F53, multiplier_1 = 0xCD9E8D57;
+    static constexpr std::uint32_t  weyl_0       = 0x9E3779B9, weyl_1       = 0xBB67AE85;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Generates the words of consecutive blocks
+    /// @param[in]  first   The counter (the index) of the first block
+    /// @param[in]  blocks  The number of blocks, at most batch_size
+    /// @param[in]  stream  The stream, which is the high 64 bits of the counter
+    /// @param[in]  seed    The seed, which is the key
+    /// @param[out] words   The 4 words of each block, one block after the other
+    // ------------------------------------------------------------------------------------------------------
+    static void generate(std::uint64_t first, size_t blocks, std::uint64_t stream, std::uint64_t seed,
+                         std::uint32_t* words)
+    {
+        std::uint32_t c0[batch_size], c1[batch_size], c2[batch_size], c3[batch_size];
+        for (size_t b = 0; b < batch_size; ++b) {
+            const std::uint64_t counter = first + b;
+            c0[b] = static_cast<std::uint32_t>(counter);
+            c1[b] = static_cast<std::uint32_t>(counter >> 32);
+            c2[b] = static_cast<std::uint32_t>(stream);
+            c3[b] = static_cast<std::uint32_t>(stream >> 32);
+        }
+
+        std::uint32_t k0 = static_cast<std::uint32_t>(seed), k1 = static_cast<std::uint32_t>(seed >> 32);
+        for (size_t round = 0; round < rounds; ++round) {
+            for (size_t b = 0; b < batch_size; ++b) {
+                const std::uint64_t p0 = std::uint64_t(multiplier_0) * c0[b];
+                const std::uint64_t p1 = std::uint64_t(multiplier_1) * c2[b];
+                const std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1[b] ^ k0;
+                const std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3[b] ^ k1;
+                c1[b] = static_cast<std::uint32_t>(p1);
+                c3[b] = static_cast<std::uint32_t>(p0);
+                c0[b] = n0;
+                c2[b] = n2;
+            }
+            k0 += weyl_0; k1 += weyl_1;
+        }
+
+        for (size_t b = 0; b < blocks; ++b) {
+            words[4 * b]     = c0[b];
+            words[4 * b + 1] = c1[b];
+            words[4 * b + 2] = c2[b];
+            words[4 * b + 3] = c3[b];
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Converts random words to a uniform value in [0, 1) in the precision of the type
+/// @param[in]  words   The words -- 1 for float, 2 for double
+/// @tparam     Dtype   The floating point type
+/// @return     A uniform value in [0, 1)
+// ----------------------------------------------------------------------------------------------------------
+inline float unit_uniform(const std::uint32_t* words, float)
+{
+    return static_cast<float>(words[0] >> 8) * (1.f / 16777216.f);
+}
+
+inline double unit_uniform(const std::uint32_t* words, double)
+{
+    const std::uint64_t bits = (std::uint64_t(words[0]) << 21) ^ (words[1] >> 11);
+    return static_cast<double>(bits) * (1.0 / 9007199254740992.0);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets a seed from the random device, for initializations which don't need to be reproduced
+/// @return     A random 64 bit seed
+// ----------------------------------------------------------------------------------------------------------
+inline std::uint64_t random_seed()
+{
+    std::random_device rand_device;
+    return (std::uint64_t(rand_device()) << 32) ^ rand_device();
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      Uniform
+/// @brief      A uniform distribution in the data type of the tensor -- [min, max) for floating point types,
+///             and [min, max] for integer types
+/// @tparam     Dtype   The data type of the values
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+class Uniform : public RandomDistribution {
+public:
+    using data_type = Dtype;
+
+    static_assert(std::is_arithmetic<Dtype>::value, "Uniform distributions are for arithmetic types");
+    static constexpr size_t words_per_element = sizeof(Dtype) > 4 ? 2 : 1;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- sets the range of the distribution
+    /// @param[in]  min     The smallest value
+    /// @param[in]  max     The largest value (which is excluded for floating point types)
+    // ------------------------------------------------------------------------------------------------------
+    Uniform(Dtype min = Dtype(0), Dtype max = Dtype(1)) : _min(min), _max(max)
+    {
+        if (max < min) throw std::invalid_argument("ftl::Uniform : min must not be larger than max");
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Converts random words to values
+    /// @param[in]  words       The random words, words_per_element for each value
+    /// @param[in]  elements    The number of values
+    /// @param[out] out         The values
+    // ------------------------------------------------------------------------------------------------------
+    void generate(const std::uint32_t* words, size_t elements, Dtype* out) const
+    {
+        generate(words, elements, out, std::integral_constant<size_t,
+            std::is_floating_point<Dtype>::value ? 0 : words_per_element>());
+    }
+private:
+    Dtype _min;         //!< The smallest value
+    Dtype _max;         //!< The largest value
+
+    // Floating point values
+    void generate(const std::uint32_t* words, size_t elements, Dtype* out, std::integral_constant<size_t, 0>) const
+    {
+        const Dtype range = _max - _min;
+        for (size_t i = 0; i < elements; ++i)
+            out[i] = _min + range * detail::unit_uniform(words + i * words_per_element, Dtype());
+    }
+
+    // Integers with at most 32 bits -- the word is scaled to the range, rather than reduced modulo the range
+    void generate(const std::uint32_t* words, size_t elements, Dtype* out, std::integral_constant<size_t, 1>) const
+    {
+        const std::uint64_t range = std::uint64_t(std::int64_t(_max) - std::int64_t(_min)) + 1;
+        for (size_t i = 0; i < elements; ++i)
+            out[i] = static_cast<Dtype>(std::int64_t(_min) + std::int64_t((words[i] * range) >> 32));
+    }
+
+    // 64 bit integers -- a range of 0 is the full range of the type
+    void generate(const std::uint32_t* words, size_t elements, Dtype* out, std::integral_constant<size_t, 2>) const
+    {
+        const std::uint64_t range = std::uint64_t(_max) - std::uint64_t(_min) + 1;
+        for (size_t i = 0; i < elements; ++i) {
+            const std::uint64_t bits = (std::uint64_t(words[2 * i]) << 32) | words[2 * i + 1];
+            const std::uint64_t offset = range == 0
+                ? bits : static_cast<std::uint64_t>((static_cast<unsigned __int128>(bits) * range) >> 64);
+            out[i] = static_cast<Dtype>(std::uint64_t(_min) + offset);
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      Normal
+/// @brief      A normal distribution in the data type of the tensor (float or double), generated with the
+///             Box-Muller transform of pairs of uniform values
+/// @tparam     Dtype   The data type of the values
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+class Normal : public RandomDistribution {
+public:
+    using data_type = Dtype;
+
+    static_assert(std::is_floating_point<Dtype>::value, "Normal distributions are for floating point types");
+    static constexpr size_t words_per_element = sizeof(Dtype) > 4 ? 2 : 1;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- sets the mean and the standard deviation of the distribution
+    /// @param[in]  mean    The mean of the values
+    /// @param[in]  stddev  The standard deviation of the values
+    // ------------------------------------------------------------------------------------------------------
+    Normal(Dtype mean = Dtype(0), Dtype stddev = Dtype(1)) : _mean(mean), _stddev(stddev)
+    {
+        if (stddev < Dtype(0)) throw std::invalid_argument("ftl::Normal : stddev must not be negative");
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Converts random words to values -- the number of values is even, since each block of
+    ///             words gives a whole number of pairs
+    /// @param[in]  words       The random words, words_per_element for each value
+    /// @param[in]  elements    The number of values
+    /// @param[out] out         The values
+    // ------------------------------------------------------------------------------------------------------
+    void generate(const std::uint32_t* words, size_t elements, Dtype* out) const
+    {
+        const Dtype two_pi = Dtype(6.283185307179586476925286766559);
+        for (size_t i = 0; i + 1 < elements; i += 2) {
+            // 1 - u is in (0, 1], so the log is finite
+            const Dtype u1 = Dtype(1) - detail::unit_uniform(words + i * words_per_element, Dtype());
+            const Dtype u2 = detail::unit_uniform(words + (i + 1) * words_per_element, Dtype());
+            const Dtype r  = _stddev * std::sqrt(Dtype(-2) * std::log(u1));
+            out[i]     = _mean + r * std::cos(two_pi * u2);
+            out[i + 1] = _mean + r * std::sin(two_pi * u2);
+        }
+    }
+private:
+    Dtype _mean;        //!< The mean of the values
+    Dtype _stddev;      //!< The standard deviation of the values
+};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Fills contiguous memory with random values, in parallel. Value i only depends on the seed, the
+///             stream and i, so the result is the same for any number of threads.
+/// @param[out] out             The memory to fill
+/// @param[in]  size            The number of values
+/// @param[in]  distribution    The distribution of the values
+/// @param[in]  seed            The seed of the generator
+/// @param[in]  stream          The stream of the generator, for independent values with the same seed
+/// @tparam     Dtype           The type of the values
+/// @tparam     Distribution    The type of the distribution
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Distribution>
+void generate_random(Dtype* out, size_t size, const Distribution& distribution, std::uint64_t seed,
+                     std::uint64_t stream)
+{
+    constexpr size_t elements_per_block = 4 / Distribution::words_per_element;
+    constexpr size_t batch_blocks       = Philox::batch_size;
+    constexpr size_t batch_elements     = batch_blocks * elements_per_block;
+    const size_t     blocks             = (size + elements_per_block - 1) / elements_per_block;
+    const size_t     grain_size         = ThreadPool::instance().grain_size() / elements_per_block;
+
+    ThreadPool::instance().parallel_for(0, blocks, [&] (size_t begin, size_t end)
+    {
+        std::uint32_t   words[4 * Philox::batch_size];
+        Dtype           values[batch_elements];
+        for (size_t block = begin; block < end; block += batch_blocks) {
+            const size_t num_blocks = std::min(end - block, batch_blocks);
+            const size_t first      = block * elements_per_block;
+            const size_t elements   = std::min(num_blocks * elements_per_block, size - first);
+            Philox::generate(block, num_blocks, stream, seed, words);
+            if (elements == batch_elements) {
+                distribution.generate(words, elements, out + first);
+            } else {
+                distribution.generate(words, num_blocks * elements_per_block, values);
+                std::copy(values, values + elements, out + first);
+            }
+        }
+    }, batch_blocks, grain_size > 0 ? grain_size : 1);
+}
+
+}               // End namespace detail
+}               // End namespace ftl
+#endif          // FTL_RANDOM_HPP
@@ -0,0 +1,497 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for saving tensors to, and loading tensors from, files with chunks which are read and
+///         written in parallel.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_SERIALIZATION_HPP
+#define FTL_SERIALIZATION_HPP
+
+#include "aligned_allocator.hpp"
+#include "evaluator.hpp"
+#include "file.hpp"
+#include "tensor_dynamic_cpu.hpp"
+#include "tensor_static_cpu.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// NOTE : The format of a tensor file (all values are in the byte order of the machine which wrote the file,
+//        which is checked when the file is read):
+//
+//          - A FileHeader
+//          - The size of each dimension (rank x uint64)
+//          - A ChunkEntry for each chunk (the offset, the number of bytes and the checksum of the chunk)
+//          - The chunks, each of which starts at a multiple of the alignment in the header
+//
+//        The elements are stored in column-major order, and each chunk holds a number of whole slabs (all the
+//        elements with the same index in the last dimension), so a range of the last dimension can be read
+//        from the chunks which hold it only. Chunks are independent, so they are read, written and checked
+//        in parallel, and they are read straight into the memory of the tensor.
+namespace ftl {
+namespace detail {
+
+static constexpr char           file_magic[8]       = { 'F', 'T', 'L', 'T', 'N', 'S', 'R', '\0' };
+static constexpr std::uint32_t  file_version        = 1;
+static constexpr std::uint32_t  file_byte_order     = 0x01020304;       //!< Reads differently if swapped
+static constexpr std::uint32_t  file_column_major   = 0;                //!< The only layout of version 1
+static constexpr std::uint64_t  file_alignment      = 4096;             //!< Chunks start on page boundaries
+static constexpr size_t         default_chunk_bytes = size_t(1) << 22;  //!< 4 MiB chunks by default
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     FileHeader
+/// @brief      The header at the start of a tensor file
+// ----------------------------------------------------------------------------------------------------------
+struct FileHeader {
+    char            magic[8];       //!< Identifies the file as a tensor file
+    std::uint32_t   version;        //!< The version of the format
+    std::uint32_t   byte_order;     //!< file_byte_order, written in the byte order of the file
+    std::uint32_t   dtype_kind;     //!< The kind of the data type (see DtypeKind)
+    std::uint32_t   dtype_bytes;    //!< The number of bytes of an element
+    std::uint32_t   rank;           //!< The number of dimensions
+    std::uint32_t   layout;         //!< The order of the elements in the chunks
+    std::uint64_t   alignment;      //!< The alignment of the offsets of the chunks
+    std::uint64_t   chunk_slabs;    //!< The number of slabs in a chunk (the last chunk may have fewer)
+    std::uint64_t   num_chunks;     //!< The number of chunks
+};
+
+static_assert(sizeof(FileHeader) == 56, "The tensor file header must not be padded");
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ChunkEntry
+/// @brief      The position and the checksum of a chunk of a tensor file
+// ----------------------------------------------------------------------------------------------------------
+struct ChunkEntry {
+    std::uint64_t   offset;         //!< The offset of the chunk in the file
+    std::uint64_t   bytes;          //!< The number of bytes in the chunk
+    std::uint64_t   checksum;       //!< The checksum of the bytes of the chunk
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     DtypeKind
+/// @brief      The kind of a data type, which is stored with the number of bytes of the type -- 1 for floating
+///             point types, 2 for signed integers, 3 for unsigned integers and 0 for anything else
+/// @tparam     Dtype   The data type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct DtypeKind {
+    static constexpr std::uint32_t value = std::is_floating_point<Dtype>::value ? 1 :
+                                           std::is_integral<Dtype>::value       ?
+                                                (std::is_signed<Dtype>::value ? 2 : 3) : 0;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes a 64 bit checksum of bytes -- four independent multiply-rotate lanes over 8 byte
+///             words, so that the checksum runs at close to the speed of memory
+/// @param[in]  data    The bytes
+/// @param[in]  bytes   The number of bytes
+/// @return     The checksum of the bytes
+// ----------------------------------------------------------------------------------------------------------
+inline std::uint64_t checksum(const void* data, size_t bytes)
+{
+    constexpr std::uint64_t prime_1 = 0x9E3779B185EBCA87ULL, prime_2 = 0xC2B2AE3D27D4EB4FULL;
+    auto mix    = [] (std::uint64_t lane, std::uint64_t word)
+    {
+        lane ^= word * prime_2;
+        return ((lane << 31) | (lane >> 33)) * prime_1;
+    };
+    auto load   = [] (const char* position) { std::uint64_t word; std::memcpy(&word, position, 8); return word; };
+
+    const char*     position = static_cast<const char*>(data);
+    const char*     end      = position + bytes;
+    std::uint64_t   lanes[4] = { prime_1, prime_2, ~prime_1, ~prime_2 };
+    for (; end - position >= 32; position += 32) {
+        lanes[0] = mix(lanes[0], load(position));
+        lanes[1] = mix(lanes[1], load(position + 8));
+        lanes[2] = mix(lanes[2], load(position + 16));
+        lanes[3] = mix(lanes[3], load(position + 24));
+    }
+    std::uint64_t hash = static_cast<std::uint64_t>(bytes);
+    for (const std::uint64_t lane : lanes) hash = mix(hash, lane);
+    for (; end - position >= 8; position += 8) hash = mix(hash, load(position));
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, position, end - position);
+    hash = mix(hash, tail);
+    hash ^= hash >> 29; hash *= prime_1; hash ^= hash >> 32;
+    return hash;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Rounds a number of bytes up to a multiple of the alignment of the chunks
+/// @param[in]  bytes   The number of bytes
+/// @return     The smallest multiple of file_alignment which is not less than bytes
+// ----------------------------------------------------------------------------------------------------------
+inline std::uint64_t align_file_offset(std::uint64_t bytes)
+{
+    return (bytes + file_alignment - 1) / file_alignment * file_alignment;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     TensorFileInfo
+/// @brief      The header, the dimension sizes and the chunk table of a tensor file
+// ----------------------------------------------------------------------------------------------------------
+struct TensorFileInfo {
+    FileHeader                  header;         //!< The header of the file
+    std::vector<size_t>         dim_sizes;      //!< The sizes of the dimensions
+    std::vector<ChunkEntry>     chunks;         //!< The position and the checksum of each chunk
+    size_t                      slab_size;      //!< The number of elements in a slab
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of elements of the tensor in the file
+    /// @return     The number of elements
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t size() const { return dim_sizes.empty() ? 0 : slab_size * dim_sizes.back(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of elements in a full chunk
+    /// @return     The number of elements in all but (possibly) the last chunk
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t chunk_size() const { return slab_size * header.chunk_slabs; }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reads the header, the dimension sizes and the chunk table of a tensor file, and checks that
+///             the file is a tensor file which was written for the data type, and that the chunk table is
+///             consistent with the dimension sizes and the size of the file (a std::runtime_error is thrown
+///             if it isn't), so that the chunks can be read without any more checks
+/// @param[in]  file    The file to read
+/// @param[in]  path    The path of the file (for errors)
+/// @tparam     Dtype   The data type which the file must have
+/// @return     The information of the file
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+TensorFileInfo read_file_info(const File& file, const std::string& path)
+{
+    TensorFileInfo info;
+    if (file.bytes() < sizeof(FileHeader))
+        throw std::invalid_argument("ftl::load : " + path + " is not a tensor file");
+    file.read(&info.header, sizeof(FileHeader), 0);
+
+    const FileHeader& header = info.header;
+    if (std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0)
+        throw std::invalid_argument("ftl::load : " + path + " is not a tensor file");
+    if (header.version != file_version || header.layout != file_column_major)
+        throw std::invalid_argument("ftl::load : " + path + " has an unsupported version of the format");
+    if (header.byte_order != file_byte_order)
+        throw std::invalid_argument("ftl::load : " + path + " was written with a different byte order");
+    if (header.dtype_kind != DtypeKind<Dtype>::value || header.dtype_bytes != sizeof(Dtype))
+        throw std::invalid_argument("ftl::load : " + path + " has a different data type");
+
+    // Nothing in the rest of the header or the chunk table is trusted until it has been checked against the
+    // dimension sizes and the size of the file, since the chunks are read straight into memory
+    const std::uint64_t file_bytes = file.bytes();
+    const auto corrupt = [&path] (const std::string& what)
+    {
+        throw std::runtime_error("ftl::load : " + path + " is corrupt (" + what + ")");
+    };
+    if (header.rank == 0) corrupt("the tensor has no dimensions");
+    if (header.chunk_slabs == 0) corrupt("the chunks have no slabs");
+    if ((file_bytes - sizeof(FileHeader)) / sizeof(std::uint64_t) < header.rank)
+        corrupt("the file is too small for the dimension sizes");
+
+    std::vector<std::uint64_t> dim_sizes(header.rank);
+    file.read(dim_sizes.data(), header.rank * sizeof(std::uint64_t), sizeof(FileHeader));
+
+    const std::uint64_t table_offset = sizeof(FileHeader) + header.rank * sizeof(std::uint64_t);
+    const std::uint64_t slabs        = dim_sizes.back();
+    if (header.num_chunks != slabs / header.chunk_slabs + (slabs % header.chunk_slabs != 0))
+        corrupt("the number of chunks doesn't match the dimension sizes");
+    if ((file_bytes - table_offset) / sizeof(ChunkEntry) < header.num_chunks)
+        corrupt("the file is too small for the chunk table");
+
+    std::uint64_t slab_bytes = sizeof(Dtype);
+    for (size_t dim = 0; dim + 1 < dim_sizes.size(); ++dim) {
+        if (dim_sizes[dim] != 0 && slab_bytes > file_bytes / dim_sizes[dim])
+            corrupt("the dimension sizes are larger than the file");
+        slab_bytes *= dim_sizes[dim];
+    }
+
+    info.chunks.resize(header.num_chunks);
+    file.read(info.chunks.data(), header.num_chunks * sizeof(ChunkEntry), table_offset);
+    for (size_t chunk = 0; chunk < info.chunks.size(); ++chunk) {
+        const ChunkEntry&   entry       = info.chunks[chunk];
+        const std::uint64_t chunk_slabs = std::min(header.chunk_slabs, slabs - chunk * header.chunk_slabs);
+        if (slab_bytes != 0 && chunk_slabs > file_bytes / slab_bytes)
+            corrupt("chunk " + std::to_string(chunk) + " is larger than the file");
+        if (entry.bytes != chunk_slabs * slab_bytes)
+            corrupt("chunk " + std::to_string(chunk) + " has the wrong number of bytes");
+        if (entry.offset > file_bytes || entry.bytes > file_bytes - entry.offset)
+            corrupt("chunk " + std::to_string(chunk) + " is past the end of the file");
+    }
+
+    info.dim_sizes.assign(dim_sizes.begin(), dim_sizes.end());
+    info.slab_size = 1;
+    for (size_t dim = 0; dim + 1 < info.dim_sizes.size(); ++dim) info.slab_size *= info.dim_sizes[dim];
+    return info;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reads a chunk of a tensor file and checks its checksum
+/// @param[in]  file    The file to read
+/// @param[in]  info    The information of the file
+/// @param[in]  chunk   The index of the chunk
+/// @param[out] data    Where to put the bytes of the chunk
+// ----------------------------------------------------------------------------------------------------------
+inline void read_chunk(const File& file, const TensorFileInfo& info, size_t chunk, void* data)
+{
+    const ChunkEntry& entry = info.chunks[chunk];
+    file.read(data, entry.bytes, entry.offset);
+    if (checksum(data, entry.bytes) != entry.checksum)
+        throw std::runtime_error("ftl::load : chunk " + std::to_string(chunk) + " has the wrong checksum");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reads all the chunks of a tensor file into contiguous memory, in parallel
+/// @param[in]  file    The file to read
+/// @param[in]  info    The information of the file
+/// @param[out] data    The memory for all the elements of the tensor
+/// @tparam     Dtype   The type of the data
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+void read_chunks(const File& file, const TensorFileInfo& info, Dtype* data)
+{
+    ThreadPool::instance().parallel_for(0, info.chunks.size(), [&] (size_t begin, size_t end)
+    {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+            read_chunk(file, info, chunk, data + chunk * info.chunk_size());
+    }, 1, 1);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the memory of an expression, if it is a tensor whose elements are contiguous in
+///             column-major order, so that chunks can be written from it without being evaluated
+/// @return     A pointer to the elements of the tensor, or a null pointer
+// ----------------------------------------------------------------------------------------------------------
+template <typename Expression>
+const typename Expression::traits::data_type* contiguous_data(const Expression&) { return nullptr; }
+
+template <typename DT>
+const typename TensorTraits<DT, CPU>::data_type* contiguous_data(const TensorInterface<TensorTraits<DT, CPU>>& x)
+{
+    return x.contiguous() ? x.data().data() : nullptr;
+}
+
+template <typename DT, size_t SF, size_t... SR>
+const typename TensorTraits<DT, CPU, SF, SR...>::data_type*
+contiguous_data(const TensorInterface<TensorTraits<DT, CPU, SF, SR...>>& x)
+{
+    return x.contiguous() ? x.data().data() : nullptr;
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Saves a tensor (or any expression, which is evaluated a chunk at a time) to a file. The chunks
+///             are evaluated (if necessary), checksummed and written in parallel, and the chunks of a
+///             contiguous tensor are written straight from its memory.
+/// @param[in]  path        The path of the file, which is replaced if it exists
+/// @param[in]  expression  The tensor or expression to save
+/// @param[in]  chunk_bytes The largest number of bytes of a chunk -- a chunk always has at least one slab
+/// @tparam     E           The type of the expression
+/// @tparam     T           The tensor traits of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+void save(const std::string&                path                                        ,
+          const TensorExpression<E, T>&     expression                                  ,
+          size_t                            chunk_bytes = detail::default_chunk_bytes   )
+{
+    using data_type = typename T::data_type;
+    const E& x = static_cast<const E&>(expression);
+    if (x.rank() == 0) throw std::invalid_argument("ftl::save : can't save a tensor with no dimensions");
+
+    detail::FileHeader header;
+    std::memcpy(header.magic, detail::file_magic, sizeof(header.magic));
+    header.version      = detail::file_version;
+    header.byte_order   = detail::file_byte_order;
+    header.dtype_kind   = detail::DtypeKind<data_type>::value;
+    header.dtype_bytes  = sizeof(data_type);
+    header.rank         = static_cast<std::uint32_t>(x.rank());
+    header.layout       = detail::file_column_major;
+    header.alignment    = detail::file_alignment;
+
+    std::vector<std::uint64_t> dim_sizes(x.dim_sizes().begin(), x.dim_sizes().end());
+    const size_t slab_size  = x.size() / std::max(dim_sizes.back(), std::uint64_t(1));
+    const size_t slab_bytes = std::max(slab_size * sizeof(data_type), size_t(1));
+    header.chunk_slabs  = std::max(std::min<std::uint64_t>(chunk_bytes / slab_bytes, dim_sizes.back()),
+                                   std::uint64_t(1));
+    header.num_chunks   = (dim_sizes.back() + header.chunk_slabs - 1) / header.chunk_slabs;
+
+    const size_t chunk_size   = slab_size * header.chunk_slabs;
+    const size_t table_bytes  = sizeof(detail::FileHeader) + dim_sizes.size() * sizeof(std::uint64_t)
+                              + header.num_chunks * sizeof(detail::ChunkEntry);
+    const size_t first_offset = detail::align_file_offset(table_bytes);
+    const size_t chunk_stride = detail::align_file_offset(chunk_size * sizeof(data_type));
+
+    detail::File                    file(path, FileMode::create);
+    std::vector<detail::ChunkEntry> chunks(header.num_chunks);
+    file.resize(first_offset + header.num_chunks * chunk_stride);
+
+    const data_type* data = detail::contiguous_data(x);
+    ThreadPool::instance().parallel_for(0, chunks.size(), [&] (size_t begin, size_t end)
+    {
+        std::vector<data_type, AlignedAllocator<data_type>> buffer(data == nullptr ? chunk_size : 0);
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            const size_t first = chunk * chunk_size, last = std::min(first + chunk_size, x.size());
+            const data_type* elements = data + first;
+            if (data == nullptr) {
+                detail::evaluate_range(buffer.data(), x, first, last);
+                elements = buffer.data();
+            }
+            detail::ChunkEntry& entry = chunks[chunk];
+            entry.offset    = first_offset + chunk * chunk_stride;
+            entry.bytes     = (last - first) * sizeof(data_type);
+            entry.checksum  = detail::checksum(elements, entry.bytes);
+            file.write(elements, entry.bytes, entry.offset);
+        }
+    }, 1, 1);
+
+    file.write(&header, sizeof(header), 0);
+    file.write(dim_sizes.data(), dim_sizes.size() * sizeof(std::uint64_t), sizeof(header));
+    file.write(chunks.data(), chunks.size() * sizeof(detail::ChunkEntry),
+               sizeof(header) + dim_sizes.size() * sizeof(std::uint64_t));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Loads a file into a dynamic tensor, which takes the dimension sizes of the file. The chunks are
+///             read (and checked) in parallel, straight into the memory of the tensor.
+/// @param[in]  path    The path of the file
+/// @param[out] tensor  The tensor to load the file into
+/// @tparam     DT      The data type of the tensor
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT>
+void load(const std::string& path, TensorInterface<TensorTraits<DT, CPU>>& tensor)
+{
+    using tensor_type   = TensorInterface<TensorTraits<DT, CPU>>;
+    using data_type     = typename tensor_type::data_type;
+
+    const detail::File      file(path, FileMode::read);
+    const detail::TensorFileInfo info = detail::read_file_info<data_type>(file, path);
+
+    typename tensor_type::data_container data(tensor.release());
+    data.resize(info.size());
+    detail::read_chunks(file, info, data.data());
+    tensor.adopt(typename tensor_type::dim_container(info.dim_sizes.begin(), info.dim_sizes.end()),
+                 std::move(data));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Loads a file into a static tensor, which must have the dimension sizes of the file. If the
+///             tensor is contiguous the chunks are read straight into its memory.
+/// @param[in]  path    The path of the file
+/// @param[out] tensor  The tensor to load the file into
+/// @tparam     DT      The data type of the tensor
+/// @tparam     SF      The size of the first dimension of the tensor
+/// @tparam     SR      The sizes of the other dimensions of the tensor
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT, size_t SF, size_t... SR>
+void load(const std::string& path, TensorInterface<TensorTraits<DT, CPU, SF, SR...>>& tensor)
+{
+    using data_type = typename TensorTraits<DT, CPU, SF, SR...>::data_type;
+
+    const detail::File      file(path, FileMode::read);
+    const detail::TensorFileInfo info = detail::read_file_info<data_type>(file, path);
+    if (!std::equal(info.dim_sizes.begin(), info.dim_sizes.end(), tensor.dim_sizes().begin()) ||
+        info.dim_sizes.size() != tensor.rank())
+        throw std::invalid_argument("ftl::load : " + path + " has different dimension sizes to the tensor");
+
+    if (tensor.contiguous()) {
+        detail::read_chunks(file, info, tensor.data().data());
+    } else {
+        DynamicTensorCpu<data_type> loaded(info.dim_sizes.size());
+        load(path, loaded);
+        tensor = loaded;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Loads a file into a new dynamic tensor
+/// @param[in]  path    The path of the file
+/// @tparam     DT      The data type of the tensor
+/// @return     A tensor with the dimension sizes and the elements of the file
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT>
+DynamicTensorCpu<DT> load(const std::string& path)
+{
+    DynamicTensorCpu<DT> tensor(1);
+    load(path, tensor);
+    return tensor;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Loads a range of the last dimension of a file (the elements with indices [first, first + slabs)
+///             in the last dimension), reading only the chunks which hold the range. Chunks which are inside
+///             the range are read straight into the memory of the tensor.
+/// @param[in]  path    The path of the file
+/// @param[in]  first   The first index of the last dimension to load
+/// @param[in]  slabs   The number of indices of the last dimension to load
+/// @tparam     DT      The data type of the tensor
+/// @return     A tensor with the dimension sizes of the file, except that the last dimension has a size of
+///             slabs, holding the range of the file
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT>
+DynamicTensorCpu<DT> load_slabs(const std::string& path, size_t first, size_t slabs)
+{
+    using tensor_type   = DynamicTensorCpu<DT>;
+    using data_type     = typename tensor_type::data_type;
+
+    const detail::File      file(path, FileMode::read);
+    const detail::TensorFileInfo info = detail::read_file_info<data_type>(file, path);
+    if (first + slabs > info.dim_sizes.back())
+        throw std::out_of_range("ftl::load_slabs : range is outside the last dimension of " + path);
+
+    const size_t begin = first * info.slab_size, end = (first + slabs) * info.slab_size;
+    const size_t chunk_size = info.chunk_size();
+    typename tensor_type::data_container data(end - begin);
+
+    const size_t first_chunk = first / info.header.chunk_slabs;
+    const size_t last_chunk  = slabs == 0 ? first_chunk
+                             : (first + slabs + info.header.chunk_slabs - 1) / info.header.chunk_slabs;
+    ThreadPool::instance().parallel_for(first_chunk, last_chunk, [&] (size_t chunk_begin, size_t chunk_end)
+    {
+        std::vector<data_type, AlignedAllocator<data_type>> buffer;
+        for (size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+            const size_t chunk_first = chunk * chunk_size;
+            const size_t chunk_last  = chunk_first + info.chunks[chunk].bytes / sizeof(data_type);
+            if (chunk_first >= begin && chunk_last <= end) {
+                detail::read_chunk(file, info, chunk, data.data() + (chunk_first - begin));
+            } else {
+                // The checksum is of the whole chunk, so the chunk is read and only the range is kept
+                buffer.resize(chunk_last - chunk_first);
+                detail::read_chunk(file, info, chunk, buffer.data());
+                const size_t keep_first = std::max(chunk_first, begin), keep_last = std::min(chunk_last, end);
+                std::copy(buffer.data() + (keep_first - chunk_first), buffer.data() + (keep_last - chunk_first),
+                          data.data() + (keep_first - begin));
+            }
+        }
+    }, 1, 1);
+
+    typename tensor_type::dim_container dim_sizes(info.dim_sizes.begin(), info.dim_sizes.end());
+    dim_sizes.back() = slabs;
+    return tensor_type(std::move(dim_sizes), std::move(data));
+}
+
+}               // End namespace ftl
+#endif          // FTL_SERIALIZATION_HPP
@@ -0,0 +1,738 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for simd packet types which allow tensor expressions to be evaluated one vector
+///         register at a time rather than one element at a time. The instruction set is chosen at compile
+///         time from the target architecture (AVX-512, AVX/AVX2, SSE2, or scalar if none are available).
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_SIMD_HPP
+#define FTL_SIMD_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// NOTE : The instruction set is selected using the compiler's target macros, so compiling with -march=native
+//        (or -mavx2, -mavx512f etc...) selects the widest registers available. Defining FTL_NO_SIMD forces
+//        the scalar implementation, which is useful for testing and debugging.
+#if !defined(FTL_NO_SIMD)
+    #if defined(__AVX512F__)
+        #define FTL_SIMD_AVX512
+    #endif
+    #if defined(__AVX__)
+        #define FTL_SIMD_AVX
+    #endif
+    #if defined(__AVX2__)
+        #define FTL_SIMD_AVX2
+    #endif
+    #if defined(__SSE2__) || defined(_M_X64)
+        #define FTL_SIMD_SSE2
+    #endif
+    #if defined(__F16C__)
+        #define FTL_SIMD_F16C
+    #endif
+    #if defined(__AVX512VNNI__)
+        #define FTL_SIMD_AVX512_VNNI
+    #endif
+    #if defined(__AVXVNNI__)
+        #define FTL_SIMD_AVX_VNNI
+    #endif
+#endif
+
+#if defined(FTL_SIMD_AVX512) || defined(FTL_SIMD_AVX) || defined(FTL_SIMD_SSE2)
+    #include <immintrin.h>
+#endif
+
+namespace ftl {
+namespace simd {
+
+namespace detail {
+
+// Fused multiply-add of scalars, which is only fused (like the packet version) when the target supports FMA,
+// so that the scalar and packet versions of a computation round in the same places
+template <typename Dtype>
+inline Dtype fmadd(const Dtype x, const Dtype y, const Dtype z) { return x * y + z; }
+
+#if defined(__FMA__) || defined(FTL_SIMD_AVX512)
+inline float  fmadd(const float x , const float y , const float z ) { return std::fma(x, y, z); }
+inline double fmadd(const double x, const double y, const double z) { return std::fma(x, y, z); }
+#endif
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ScalarPacket
+/// @brief      Defines the packet operations for a packet of a single element, which is the general case of a
+///             Packet, and which the scalar versions of vectorized computations use so that they compute the
+///             same approximations as the packet versions.
+///
+///             fmadd(x, y, z) computes x * y + z, fused into a single instruction when the target supports
+///             FMA. min and max are the elementwise minimum and maximum, which return the second argument if
+///             either argument is NaN (as the SSE/AVX instructions do). The comparisons (less, equal) return
+///             masks which select(mask, x, y) uses to choose elements from x (where the mask is set) or y.
+///             pow2i(n) is 2^n for integer valued n in the range of normal exponents, and frexp(x, e) returns
+///             the mantissa of x in [0.5, 1) and sets e to its exponent (for positive, normal x).
+/// @tparam     Dtype   The type of data in the packet
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct ScalarPacket {
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using data_type = Dtype;
+    using type      = Dtype;
+    using mask_type = bool;
+    // ------------------------------------------------------------------------------------------------------
+
+    static constexpr size_t size = 1;                           //!< Number of elements in the packet
+
+    static inline type load(const data_type* data)              { return *data;     }
+    static inline type loadu(const data_type* data)             { return *data;     }
+    static inline type set1(const data_type value)              { return value;     }
+    static inline void store(data_type* data, const type x)     { *data = x;        }
+    static inline void storeu(data_type* data, const type x)    { *data = x;        }
+    static inline type add(const type x, const type y)          { return x + y;     }
+    static inline type sub(const type x, const type y)          { return x - y;     }
+    static inline type mul(const type x, const type y)          { return x * y;     }
+    static inline type div(const type x, const type y)          { return x / y;     }
+    static inline type min(const type x, const type y)          { return x < y ? x : y; }
+    static inline type max(const type x, const type y)          { return y < x ? x : y; }
+    static inline type abs(const type x)                        { return x < type(0) ? -x : x; }
+    static inline type neg(const type x)                        { return -x;        }
+    static inline type sqrt(const type x)                       { return std::sqrt(x); }
+    static inline type fmadd(const type x, const type y, const type z)  { return detail::fmadd(x, y, z); }
+
+    static inline mask_type less(const type x, const type y)    { return x < y;     }
+    static inline mask_type equal(const type x, const type y)   { return x == y;    }
+    static inline type select(const mask_type m, const type x, const type y) { return m ? x : y; }
+
+    static inline type pow2i(const type n) { return std::ldexp(type(1), static_cast<int>(n)); }
+
+    static inline type frexp(const type x, type& exponent)
+    {
+        int e = 0;
+        const type mantissa = std::frexp(x, &e);
+        exponent = static_cast<type>(e);
+        return mantissa;
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Packet
+/// @brief      Defines the register type and the operations on the register for a data type (see
+///             ScalarPacket for the operations). The general case is a packet of a single element, so that any
+///             data type can use the packet interface and the vectorized evaluation simply degenerates to the
+///             scalar case. Division, square roots, comparisons, pow2i and frexp are only vectorized for
+///             floating point types.
+/// @tparam     Dtype   The type of data in the packet
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct Packet : ScalarPacket<Dtype> {};
+
+#if defined(FTL_SIMD_AVX512)
+
+// Specialization for floats with AVX-512 -- 16 elements per packet
+template <>
+struct Packet<float> {
+    using data_type = float;
+    using type      = __m512;
+
+    static constexpr size_t size = 16;
+
+    static inline type load(const data_type* data)              { return _mm512_load_ps(data);      }
+    static inline type loadu(const data_type* data)             { return _mm512_loadu_ps(data);     }
+    static inline type set1(const data_type value)              { return _mm512_set1_ps(value);     }
+    static inline void store(data_type* data, const type x)     { _mm512_store_ps(data, x);         }
+    static inline void storeu(data_type* data, const type x)    { _mm512_storeu_ps(data, x);        }
+    static inline type add(const type x, const type y)          { return _mm512_add_ps(x, y);       }
+    static inline type sub(const type x, const type y)          { return _mm512_sub_ps(x, y);       }
+    static inline type mul(const type x, const type y)          { return _mm512_mul_ps(x, y);       }
+    static inline type min(const type x, const type y)          { return _mm512_min_ps(x, y);       }
+    static inline type max(const type x, const type y)          { return _mm512_max_ps(x, y);       }
+    static inline type fmadd(const type x, const type y, const type z)  { return _mm512_fmadd_ps(x, y, z); }
+
+    using mask_type = __mmask16;
+
+    static inline type div(const type x, const type y)          { return _mm512_div_ps(x, y);       }
+    static inline type abs(const type x)                        { return _mm512_abs_ps(x);          }
+    static inline type sqrt(const type x)                       { return _mm512_sqrt_ps(x);         }
+
+    static inline type neg(const type x)
+    {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), _mm512_set1_epi32(INT32_MIN)));
+    }
+
+    static inline mask_type less(const type x, const type y)    { return _mm512_cmp_ps_mask(x, y, _CMP_LT_OQ); }
+    static inline mask_type equal(const type x, const type y)   { return _mm512_cmp_ps_mask(x, y, _CMP_EQ_OQ); }
+    static inline type select(const mask_type m, const type x, const type y) { return _mm512_mask_blend_ps(m, y, x); }
+
+    // The biased exponent shifted into place is an integer which a float represents exactly
+    static inline type pow2i(const type n)
+    {
+        return _mm512_castsi512_ps(_mm512_cvtps_epi32(mul(add(n, set1(127.f)), set1(8388608.f))));
+    }
+
+    static inline type frexp(const type x, type& exponent)
+    {
+        exponent = add(_mm512_getexp_ps(x), set1(1.f));
+        return _mm512_getmant_ps(x, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_src);
+    }
+};
+
+// Specialization for doubles with AVX-512 -- 8 elements per packet
+template <>
+struct Packet<double> {
+    using data_type = double;
+    using type      = __m512d;
+
+    static constexpr size_t size = 8;
+
+    static inline type load(const data_type* data)              { return _mm512_load_pd(data);      }
+    static inline type loadu(const data_type* data)             { return _mm512_loadu_pd(data);     }
+    static inline type set1(const data_type value)              { return _mm512_set1_pd(value);     }
+    static inline void store(data_type* data, const type x)     { _mm512_store_pd(data, x);         }
+    static inline void storeu(data_type* data, const type x)    { _mm512_storeu_pd(data, x);        }
+    static inline type add(const type x, const type y)          { return _mm512_add_pd(x, y);       }
+    static inline type sub(const type x, const type y)          { return _mm512_sub_pd(x, y);       }
+    static inline type mul(const type x, const type y)          { return _mm512_mul_pd(x, y);       }
+    static inline type min(const type x, const type y)          { return _mm512_min_pd(x, y);       }
+    static inline type max(const type x, const type y)          { return _mm512_max_pd(x, y);       }
+    static inline type fmadd(const type x, const type y, const type z)  { return _mm512_fmadd_pd(x, y, z); }
+
+    using mask_type = __mmask8;
+
+    static inline type div(const type x, const type y)          { return _mm512_div_pd(x, y);       }
+    static inline type abs(const type x)                        { return _mm512_abs_pd(x);          }
+    static inline type sqrt(const type x)                       { return _mm512_sqrt_pd(x);         }
+
+    static inline type neg(const type x)
+    {
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(x), _mm512_set1_epi64(INT64_MIN)));
+    }
+
+    static inline mask_type less(const type x, const type y)    { return _mm512_cmp_pd_mask(x, y, _CMP_LT_OQ); }
+    static inline mask_type equal(const type x, const type y)   { return _mm512_cmp_pd_mask(x, y, _CMP_EQ_OQ); }
+    static inline type select(const mask_type m, const type x, const type y) { return _mm512_mask_blend_pd(m, y, x); }
+
+    // The high words of the results are the biased exponents shifted into place, the low words are zero
+    static inline type pow2i(const type n)
+    {
+        const __m256i high = _mm512_cvtpd_epi32(mul(add(n, set1(1023.0)), set1(1048576.0)));
+        return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_cvtepu32_epi64(high), 32));
+    }
+
+    static inline type frexp(const type x, type& exponent)
+    {
+        exponent = add(_mm512_getexp_pd(x), set1(1.0));
+        return _mm512_getmant_pd(x, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_src);
+    }
+};
+
+// Specialization for ints with AVX-512 -- 16 elements per packet
+template <>
+struct Packet<int> {
+    using data_type = int;
+    using type      = __m512i;
+
+    static constexpr size_t size = 16;
+
+    static inline type load(const data_type* data)              { return _mm512_load_si512(data);   }
+    static inline type loadu(const data_type* data)             { return _mm512_loadu_si512(data);  }
+    static inline type set1(const data_type value)              { return _mm512_set1_epi32(value);  }
+    static inline void store(data_type* data, const type x)     { _mm512_store_si512(data, x);      }
+    static inline void storeu(data_type* data, const type x)    { _mm512_storeu_si512(data, x);     }
+    static inline type add(const type x, const type y)          { return _mm512_add_epi32(x, y);    }
+    static inline type sub(const type x, const type y)          { return _mm512_sub_epi32(x, y);    }
+    static inline type mul(const type x, const type y)          { return _mm512_mullo_epi32(x, y);  }
+    static inline type min(const type x, const type y)          { return _mm512_min_epi32(x, y);    }
+    static inline type max(const type x, const type y)          { return _mm512_max_epi32(x, y);    }
+    static inline type fmadd(const type x, const type y, const type z)  { return add(mul(x, y), z); }
+    static inline type abs(const type x)                        { return _mm512_abs_epi32(x);       }
+    static inline type neg(const type x)                        { return sub(_mm512_setzero_si512(), x); }
+};
+
+#elif defined(FTL_SIMD_AVX)
+
+// Specialization for floats with AVX -- 8 elements per packet
+template <>
+struct Packet<float> {
+    using data_type = float;
+    using type      = __m256;
+
+    static constexpr size_t size = 8;
+
+    static inline type load(const data_type* data)              { return _mm256_load_ps(data);      }
+    static inline type loadu(const data_type* data)             { return _mm256_loadu_ps(data);     }
+    static inline type set1(const data_type value)              { return _mm256_set1_ps(value);     }
+    static inline void store(data_type* data, const type x)     { _mm256_store_ps(data, x);         }
+    static inline void storeu(data_type* data, const type x)    { _mm256_storeu_ps(data, x);        }
+    static inline type add(const type x, const type y)          { return _mm256_add_ps(x, y);       }
+    static inline type sub(const type x, const type y)          { return _mm256_sub_ps(x, y);       }
+    static inline type mul(const type x, const type y)          { return _mm256_mul_ps(x, y);       }
+    static inline type min(const type x, const type y)          { return _mm256_min_ps(x, y);       }
+    static inline type max(const type x, const type y)          { return _mm256_max_ps(x, y);       }
+#if defined(__FMA__)
+    static inline type fmadd(const type x, const type y, const type z)  { return _mm256_fmadd_ps(x, y, z); }
+#else
+    static inline type fmadd(const type x, const type y, const type z)  { return add(mul(x, y), z); }
+#endif
+
+    using mask_type = __m256;
+
+    static inline type div(const type x, const type y)          { return _mm256_div_ps(x, y);       }
+    static inline type abs(const type x)                        { return _mm256_andnot_ps(set1(-0.f), x); }
+    static inline type neg(const type x)                        { return _mm256_xor_ps(x, set1(-0.f)); }
+    static inline type sqrt(const type x)                       { return _mm256_sqrt_ps(x);         }
+
+    static inline mask_type less(const type x, const type y)    { return _mm256_cmp_ps(x, y, _CMP_LT_OQ); }
+    static inline mask_type equal(const type x, const type y)   { return _mm256_cmp_ps(x, y, _CMP_EQ_OQ); }
+    static inline type select(const mask_type m, const type x, const type y) { return _mm256_blendv_ps(y, x, m); }
+
+    // The biased exponent shifted into place is an integer which a float represents exactly
+    static inline type pow2i(const type n)
+    {
+        return _mm256_castsi256_ps(_mm256_cvtps_epi32(mul(add(n, set1(127.f)), set1(8388608.f))));
+    }
+
+    // The exponent bits are converted as an integer, so that no 256 bit integer arithmetic is needed
+    static inline type frexp(const type x, type& exponent)
+    {
+        const type bits = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7F800000)));
+        exponent = sub(mul(_mm256_cvtepi32_ps(_mm256_castps_si256(bits)), set1(1.f / 8388608.f)), set1(126.f));
+        return _mm256_or_ps(_mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x807FFFFF))), set1(0.5f));
+    }
+};
+
+// Specialization for doubles with AVX -- 4 elements per packet
+template <>
+struct Packet<double> {
+    using data_type = double;
+    using type      = __m256d;
+
+    static constexpr size_t size = 4;
+
+    static inline type load(const data_type* data)              { return _mm256_load_pd(data);      }
+    static inline type loadu(const data_type* data)             { return _mm256_loadu_pd(data);     }
+    static inline type set1(const data_type value)              { return _mm256_set1_pd(value);     }
+    static inline void store(data_type* data, const type x)     { _mm256_store_pd(data, x);         }
+    static inline void storeu(data_type* data, const type x)    { _mm256_storeu_pd(data, x);        }
+    static inline type add(const type x, const type y)          { return _mm256_add_pd(x, y);       }
+    static inline type sub(const type x, const type y)          { return _mm256_sub_pd(x, y);       }
+    static inline type mul(const type x, const type y)          { return _mm256_mul_pd(x, y);       }
+    static inline type min(const type x, const type y)          { return _mm256_min_pd(x, y);       }
+    static inline type max(const type x, const type y)          { return _mm256_max_pd(x, y);       }
+#if defined(__FMA__)
+    static inline type fmadd(const type x, const type y, const type z)  { return _mm256_fmadd_pd(x, y, z); }
+#else
+    static inline type fmadd(const type x, const type y, const type z)  { return add(mul(x, y), z); }
+#endif
+
+    using mask_type = __m256d;
+
+    static inline type div(const type x, const type y)          { return _mm256_div_pd(x, y);       }
+    static inline type abs(const type x)                        { return _mm256_andnot_pd(set1(-0.0), x); }
+    static inline type neg(const type x)                        { return _mm256_xor_pd(x, set1(-0.0)); }
+    static inline type sqrt(const type x)                       { return _mm256_sqrt_pd(x);         }
+
+    static inline mask_type less(const type x, const type y)    { return _mm256_cmp_pd(x, y, _CMP_LT_OQ); }
+    static inline mask_type equal(const type x, const type y)   { return _mm256_cmp_pd(x, y, _CMP_EQ_OQ); }
+    static inline type select(const mask_type m, const type x, const type y) { return _mm256_blendv_pd(y, x, m); }
+
+    // The high words of the results are the biased exponents shifted into place, the low words are zero
+    static inline type pow2i(const type n)
+    {
+        const __m128i high = _mm256_cvtpd_epi32(mul(add(n, set1(1023.0)), set1(1048576.0)));
+        const __m128i lo   = _mm_unpacklo_epi32(_mm_setzero_si128(), high);
+        const __m128i hi   = _mm_unpackhi_epi32(_mm_setzero_si128(), high);
+        return _mm256_castsi256_pd(_mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+    }
+
+    // The high words (with the exponent bits) of the elements are gathered and converted as integers
+    static inline type frexp(const type x, type& exponent)
+    {
+        const __m256 bits = _mm256_castpd_ps(_mm256_and_pd(x, _mm256_castsi256_pd(
+                                                _mm256_set1_epi64x(0x7FF0000000000000LL))));
+        const __m128 high = _mm_shuffle_ps(_mm256_castps256_ps128(bits), _mm256_extractf128_ps(bits, 1),
+                                           _MM_SHUFFLE(3, 1, 3, 1));
+        exponent = sub(mul(_mm256_cvtepi32_pd(_mm_castps_si128(high)), set1(1.0 / 1048576.0)), set1(1022.0));
+        return _mm256_or_pd(_mm256_and_pd(x, _mm256_castsi256_pd(_mm256_set1_epi64x(0x800FFFFFFFFFFFFFLL))),
+                            set1(0.5));
+    }
+};
+
+#if defined(FTL_SIMD_AVX2)
+
+// Specialization for ints with AVX2 -- 8 elements per packet (AVX has no 256 bit integer arithmetic)
+template <>
+struct Packet<int> {
+    using data_type = int;
+    using type      = __m256i;
+
+    static constexpr size_t size = 8;
+
+    static inline type load(const data_type* data)
+    {
+        return _mm256_load_si256(reinterpret_cast<const type*>(data));
+    }
+
+    static inline type loadu(const data_type* data)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const type*>(data));
+    }
+
+    static inline void store(data_type* data, const type x)
+    {
+        _mm256_store_si256(reinterpret_cast<type*>(data), x);
+    }
+
+    static inline void storeu(data_type* data, const type x)
+    {
+        _mm256_storeu_si256(reinterpret_cast<type*>(data), x);
+    }
+
+    static inline type set1(const data_type value)              { return _mm256_set1_epi32(value);  }
+    static inline type add(const type x, const type y)          { return _mm256_add_epi32(x, y);    }
+    static inline type sub(const type x, const type y)          { return _mm256_sub_epi32(x, y);    }
+    static inline type mul(const type x, const type y)          { return _mm256_mullo_epi32(x, y);  }
+    static inline type min(const type x, const type y)          { return _mm256_min_epi32(x, y);    }
+    static inline type max(const type x, const type y)          { return _mm256_max_epi32(x, y);    }
+    static inline type fmadd(const type x, const type y, const type z)  { return add(mul(x, y), z); }
+    static inline type abs(const type x)                        { return _mm256_abs_epi32(x);       }
+    static inline type neg(const type x)                        { return sub(_mm256_setzero_si256(), x); }
+};
+
+#endif      // FTL_SIMD_AVX2
+#elif defined(FTL_SIMD_SSE2)
+
+// Specialization for floats with SSE -- 4 elements per packet
+template <>
+struct Packet<float> {
+    using data_type = float;
+    using type      = __m128;
+
+    static constexpr size_t size = 4;
+
+    static inline type load(const data_type* data)              { return _mm_load_ps(data);         }
+    static inline type loadu(const data_type* data)             { return _mm_loadu_ps(data);        }
+    static inline type set1(const data_type value)              { return _mm_set1_ps(value);        }
+    static inline void store(data_type* data, const type x)     { _mm_store_ps(data, x);            }
+    static inline void storeu(data_type* data, const type x)    { _mm_storeu_ps(data, x);           }
+    static inline type add(const type x, const type y)          { return _mm_add_ps(x, y);          }
+    static inline type sub(const type x, const type y)          { return _mm_sub_ps(x, y);          }
+    static inline type mul(const type x, const type y)          { return _mm_mul_ps(x, y);          }
+    static inline type min(const type x, const type y)          { return _mm_min_ps(x, y);          }
+    static inline type max(const type x, const type y)          { return _mm_max_ps(x, y);          }
+#if defined(__FMA__)
+    static inline type fmadd(const type x, const type y, const type z)  { return _mm_fmadd_ps(x, y, z); }
+#else
+    static inline type fmadd(const type x, const type y, const type z)  { return add(mul(x, y), z); }
+#endif
+
+    using mask_type = __m128;
+
+    static inline type div(const type x, const type y)          { return _mm_div_ps(x, y);          }
+    static inline type abs(const type x)                        { return _mm_andnot_ps(set1(-0.f), x); }
+    static inline type neg(const type x)                        { return _mm_xor_ps(x, set1(-0.f)); }
+    static inline type sqrt(const type x)                       { return _mm_sqrt_ps(x);            }
+
+    static inline mask_type less(const type x, const type y)    { return _mm_cmplt_ps(x, y);        }
+    static inline mask_type equal(const type x, const type y)   { return _mm_cmpeq_ps(x, y);        }
+
+    static inline type select(const mask_type m, const type x, const type y)
+    {
+#if defined(__SSE4_1__)
+        return _mm_blendv_ps(y, x, m);
+#else
+        return _mm_or_ps(_mm_and_ps(m, x), _mm_andnot_ps(m, y));
+#endif
+    }
+
+    // The biased exponent shifted into place is an integer which a float represents exactly
+    static inline type pow2i(const type n)
+    {
+        return _mm_castsi128_ps(_mm_cvtps_epi32(mul(add(n, set1(127.f)), set1(8388608.f))));
+    }
+
+    static inline type frexp(const type x, type& exponent)
+    {
+        const type bits = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7F800000)));
+        exponent = sub(mul(_mm_cvtepi32_ps(_mm_castps_si128(bits)), set1(1.f / 8388608.f)), set1(126.f));
+        return _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x807FFFFF))), set1(0.5f));
+    }
+};
+
+// Specialization for doubles with SSE2 -- 2 elements per packet
+template <>
+struct Packet<double> {
+    using data_type = double;
+    using type      = __m128d;
+
+    static constexpr size_t size = 2;
+
+    static inline type load(const data_type* data)              { return _mm_load_pd(data);         }
+    static inline type loadu(const data_type* data)             { return _mm_loadu_pd(data);        }
+    static inline type set1(const data_type value)              { return _mm_set1_pd(value);        }
+    static inline void store(data_type* data, const type x)     { _mm_store_pd(data, x);            }
+    static inline void storeu(data_type* data, const type x)    { _mm_storeu_pd(data, x);           }
+    static inline type add(const type x, const type y)          { return _mm_add_pd(x, y);          }
+    static inline type sub(const type x, const type y)          { return _mm_sub_pd(x, y);          }
+    static inline type mul(const type x, const type y)          { return _mm_mul_pd(x, y);          }
+    static inline type min(const type x, const type y)          { return _mm_min_pd(x, y);          }
+    static inline type max(const type x, const type y)          { return _mm_max_pd(x, y);          }
+#if defined(__FMA__)
+    static inline type fmadd(const type x, const type y, const type z)  { return _mm_fmadd_pd(x, y, z); }
+#else
+    static inline type fmadd(const type x, const type y, const type z)  { return add(mul(x, y), z); }
+#endif
+
+    using mask_type = __m128d;
+
+    static inline type div(const type x, const type y)          { return _mm_div_pd(x, y);          }
+    static inline type abs(const type x)                        { return _mm_andnot_pd(set1(-0.0), x); }
+    static inline type neg(const type x)                        { return _mm_xor_pd(x, set1(-0.0)); }
+    static inline type sqrt(const type x)                       { return _mm_sqrt_pd(x);            }
+
+    static inline mask_type less(const type x, const type y)    { return _mm_cmplt_pd(x, y);        }
+    static inline mask_type equal(const type x, const type y)   { return _mm_cmpeq_pd(x, y);        }
+
+    static inline type select(const mask_type m, const type x, const type y)
+    {
+#if defined(__SSE4_1__)
+        return _mm_blendv_pd(y, x, m);
+#else
+        return _mm_or_pd(_mm_and_pd(m, x), _mm_andnot_pd(m, y));
+#endif
+    }
+
+    // The high words of the results are the biased exponents shifted into place, the low words are zero
+    static inline type pow2i(const type n)
+    {
+        const __m128i high = _mm_cvtpd_epi32(mul(add(n, set1(1023.0)), set1(1048576.0)));
+        return _mm_castsi128_pd(_mm_unpacklo_epi32(_mm_setzero_si128(), high));
+    }
+
+    static inline type frexp(const type x, type& exponent)
+    {
+        const __m128i bits = _mm_castpd_si128(_mm_and_pd(x, _mm_castsi128_pd(
+                                                _mm_set1_epi64x(0x7FF0000000000000LL))));
+        const __m128i high = _mm_shuffle_epi32(bits, _MM_SHUFFLE(3, 1, 3, 1));
+        exponent = sub(mul(_mm_cvtepi32_pd(high), set1(1.0 / 1048576.0)), set1(1022.0));
+        return _mm_or_pd(_mm_and_pd(x, _mm_castsi128_pd(_mm_set1_epi64x(0x800FFFFFFFFFFFFFLL))), set1(0.5));
+    }
+};
+
+#endif      // FTL_SIMD_AVX512 | FTL_SIMD_AVX | FTL_SIMD_SSE2
+
+#if defined(FTL_SIMD_SSE2) && !defined(FTL_SIMD_AVX2) && !defined(FTL_SIMD_AVX512)
+
+// Specialization for ints with SSE2 -- 4 elements per packet (also used with AVX1 which has no 256 bit
+// integer arithmetic)
+template <>
+struct Packet<int> {
+    using data_type = int;
+    using type      = __m128i;
+
+    static constexpr size_t size = 4;
+
+    static inline type load(const data_type* data)
+    {
+        return _mm_load_si128(reinterpret_cast<const type*>(data));
+    }
+
+    static inline type loadu(const data_type* data)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const type*>(data));
+    }
+
+    static inline void store(data_type* data, const type x)
+    {
+        _mm_store_si128(reinterpret_cast<type*>(data), x);
+    }
+
+    static inline void storeu(data_type* data, const type x)
+    {
+        _mm_storeu_si128(reinterpret_cast<type*>(data), x);
+    }
+
+    static inline type set1(const data_type value)              { return _mm_set1_epi32(value);     }
+    static inline type add(const type x, const type y)          { return _mm_add_epi32(x, y);       }
+    static inline type sub(const type x, const type y)          { return _mm_sub_epi32(x, y);       }
+
+    static inline type mul(const type x, const type y)
+    {
+#if defined(__SSE4_1__)
+        return _mm_mullo_epi32(x, y);
+#else
+        // SSE2 only multiplies the even lanes, so multiply the even and odd lanes separately and interleave
+        const type even = _mm_mul_epu32(x, y);
+        const type odd  = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd , _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+
+    static inline type fmadd(const type x, const type y, const type z)  { return add(mul(x, y), z); }
+
+    static inline type min(const type x, const type y)
+    {
+#if defined(__SSE4_1__)
+        return _mm_min_epi32(x, y);
+#else
+        const type x_greater = _mm_cmpgt_epi32(x, y);
+        return _mm_or_si128(_mm_and_si128(x_greater, y), _mm_andnot_si128(x_greater, x));
+#endif
+    }
+
+    static inline type max(const type x, const type y)
+    {
+#if defined(__SSE4_1__)
+        return _mm_max_epi32(x, y);
+#else
+        const type x_greater = _mm_cmpgt_epi32(x, y);
+        return _mm_or_si128(_mm_and_si128(x_greater, x), _mm_andnot_si128(x_greater, y));
+#endif
+    }
+
+    static inline type neg(const type x)                        { return sub(_mm_setzero_si128(), x); }
+
+    static inline type abs(const type x)
+    {
+#if defined(__SSSE3__)
+        return _mm_abs_epi32(x);
+#else
+        const type sign = _mm_srai_epi32(x, 31);
+        return _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+#endif
+    }
+};
+
+#endif      // FTL_SIMD_SSE2 only
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Transpose
+/// @brief      Transposes a square block of size x size elements in registers, so that element c of row r of
+///             the input is element r of row c of the output. The general case is a block of one element.
+/// @tparam     Dtype   The type of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct Transpose {
+    static constexpr size_t size = 1;                           //!< Number of rows and columns of the block
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Transposes a block
+    /// @param[in]  in          The first row of the input block
+    /// @param[in]  in_stride   The stride between the rows of the input block
+    /// @param[out] out         The first row of the output block
+    /// @param[in]  out_stride  The stride between the rows of the output block
+    // ------------------------------------------------------------------------------------------------------
+    static inline void apply(const Dtype* in, size_t, Dtype* out, size_t) { *out = *in; }
+};
+
+#if defined(FTL_SIMD_AVX)
+
+// Specialization for floats with AVX -- 8 x 8 blocks, with pairs of rows interleaved, then quadruples, then
+// the 128 bit lanes swapped
+template <>
+struct Transpose<float> {
+    static constexpr size_t size = 8;
+
+    static inline void apply(const float* in, size_t in_stride, float* out, size_t out_stride)
+    {
+        __m256 r[8], t[8];
+        for (size_t i = 0; i < 8; ++i) r[i] = _mm256_loadu_ps(in + i * in_stride);
+        for (size_t i = 0; i < 8; i += 2) {
+            t[i]     = _mm256_unpacklo_ps(r[i], r[i + 1]);
+            t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+        }
+        for (size_t i = 0; i < 8; i += 4) {
+            r[i]     = _mm256_shuffle_ps(t[i]    , t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+            r[i + 1] = _mm256_shuffle_ps(t[i]    , t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+            r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+            r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            _mm256_storeu_ps(out + i * out_stride      , _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+            _mm256_storeu_ps(out + (i + 4) * out_stride, _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+        }
+    }
+};
+
+// Specialization for doubles with AVX -- 4 x 4 blocks
+template <>
+struct Transpose<double> {
+    static constexpr size_t size = 4;
+
+    static inline void apply(const double* in, size_t in_stride, double* out, size_t out_stride)
+    {
+        const __m256d r0 = _mm256_loadu_pd(in)                , r1 = _mm256_loadu_pd(in + in_stride);
+        const __m256d r2 = _mm256_loadu_pd(in + 2 * in_stride), r3 = _mm256_loadu_pd(in + 3 * in_stride);
+        const __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+        const __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+        _mm256_storeu_pd(out                 , _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(out + out_stride    , _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(out + 2 * out_stride, _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(out + 3 * out_stride, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+};
+
+#elif defined(FTL_SIMD_SSE2)
+
+// Specialization for floats with SSE -- 4 x 4 blocks
+template <>
+struct Transpose<float> {
+    static constexpr size_t size = 4;
+
+    static inline void apply(const float* in, size_t in_stride, float* out, size_t out_stride)
+    {
+        __m128 r0 = _mm_loadu_ps(in)                , r1 = _mm_loadu_ps(in + in_stride);
+        __m128 r2 = _mm_loadu_ps(in + 2 * in_stride), r3 = _mm_loadu_ps(in + 3 * in_stride);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(out, r0);
+        _mm_storeu_ps(out + out_stride, r1);
+        _mm_storeu_ps(out + 2 * out_stride, r2);
+        _mm_storeu_ps(out + 3 * out_stride, r3);
+    }
+};
+
+// Specialization for doubles with SSE -- 2 x 2 blocks
+template <>
+struct Transpose<double> {
+    static constexpr size_t size = 2;
+
+    static inline void apply(const double* in, size_t in_stride, double* out, size_t out_stride)
+    {
+        const __m128d r0 = _mm_loadu_pd(in), r1 = _mm_loadu_pd(in + in_stride);
+        _mm_storeu_pd(out             , _mm_unpacklo_pd(r0, r1));
+        _mm_storeu_pd(out + out_stride, _mm_unpackhi_pd(r0, r1));
+    }
+};
+
+#endif      // FTL_SIMD_AVX | FTL_SIMD_SSE2
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      The alignment (in bytes) required for aligned loads and stores of packets of a data type
+/// @tparam     Dtype   The type of data in the packet
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct PacketAlignment {
+    static constexpr size_t value = sizeof(typename Packet<Dtype>::type);
+};
+
+}               // End namespace simd
+}               // End namespace ftl
+#endif          // FTL_SIMD_HPP
@@ -0,0 +1,388 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for the specification of slices of tensors -- a slice is given by one specifier for
+///         each dimension of the tensor, which can be all of the dimension, a fixed index (which removes the
+///         dimension from the view), or a range of the dimension with an optional step. The shapes of views
+///         of static tensors are computed at compile time when all the ranges are known at compile time.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_SLICE_HPP
+#define FTL_SLICE_HPP
+
+#include "layout.hpp"
+#include "tensor_traits.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace ftl {
+
+// Forward declaration of TensorView so that the types of slices can be determined -- the Strides are a
+// detail::SizeList for views with a static shape, and void for views with a dynamic shape
+template <typename Traits, typename Element, typename Strides = void>
+class TensorView;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     All
+/// @brief      Slice specifier which keeps all the elements of a dimension
+// ----------------------------------------------------------------------------------------------------------
+struct All {
+    constexpr size_t start() const { return 0; }
+};
+
+static constexpr All all = All();
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Index
+/// @brief      Slice specifier which fixes the index of a dimension, removing the dimension from the view --
+///             integers given as slice specifiers are converted to an Index
+// ----------------------------------------------------------------------------------------------------------
+struct Index {
+    constexpr Index(size_t index) : value(index) {}
+
+    constexpr size_t start() const { return value; }
+
+    size_t value;       //!< The index in the dimension
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Range
+/// @brief      Slice specifier which keeps the elements [start, end) of a dimension, with a step between
+///             elements (a strided slice when step > 1). The ends of ranges past the end of the dimension are
+///             clamped to the size of the dimension.
+// ----------------------------------------------------------------------------------------------------------
+struct Range {
+    constexpr Range(size_t start, size_t end, size_t step_size = 1)
+    : start_index(start), end_index(end), step(step_size) {}
+
+    constexpr size_t start() const { return start_index; }
+
+    size_t start_index;     //!< The index of the first element in the range
+    size_t end_index;       //!< The index after the last element in the range
+    size_t step;            //!< The step between the elements in the range
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticRange
+/// @brief      Slice specifier which keeps the elements [Start, End) of a dimension, with a step between the
+///             elements, where the range is known at compile time so views of static tensors have a static
+///             shape.
+/// @tparam     Start   The index of the first element in the range
+/// @tparam     End     The index after the last element in the range
+/// @tparam     Step    The step between elements in the range
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Start, size_t End, size_t Step = 1>
+struct StaticRange {
+    static_assert(Start < End && Step > 0, "Invalid static range for slice");
+
+    constexpr size_t start() const { return Start; }
+};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     SliceSpec
+/// @brief      Gets the type of a slice specifier, converting integral indices to Index
+/// @tparam     Spec    The type of the slice specifier
+// ----------------------------------------------------------------------------------------------------------
+template <typename Spec>
+struct SliceSpec {
+    using type = typename std::conditional<std::is_integral<Spec>::value, Index, Spec>::type;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticSlice
+/// @brief      Computes the sizes and the strides of the view given by a list of slice specifiers at compile
+///             time -- if any of the specifiers is only known at runtime then the view can't be static
+/// @tparam     Sizes           The sizes of the dimensions which still need to be sliced
+/// @tparam     Strides         The strides of the dimensions which still need to be sliced
+/// @tparam     ViewSizes       The sizes of the dimensions of the view
+/// @tparam     ViewStrides     The strides of the dimensions of the view
+/// @tparam     Specs           The slice specifiers for the dimensions which still need to be sliced
+// ----------------------------------------------------------------------------------------------------------
+template <typename Sizes, typename Strides, typename ViewSizes, typename ViewStrides, typename... Specs>
+struct StaticSlice {
+    static constexpr bool is_static = ViewSizes::size > 0;
+    using sizes                     = ViewSizes;
+    using strides                   = ViewStrides;
+};
+
+template <size_t DF, size_t... DR, size_t SF, size_t... SR, size_t... VD, size_t... VS, typename... Specs>
+struct StaticSlice<SizeList<DF, DR...>, SizeList<SF, SR...>, SizeList<VD...>, SizeList<VS...>, All, Specs...>
+: StaticSlice<SizeList<DR...>, SizeList<SR...>, SizeList<VD..., DF>, SizeList<VS..., SF>, Specs...> {};
+
+template <size_t DF, size_t... DR, size_t SF, size_t... SR, size_t... VD, size_t... VS, typename... Specs>
+struct StaticSlice<SizeList<DF, DR...>, SizeList<SF, SR...>, SizeList<VD...>, SizeList<VS...>, Index, Specs...>
+: StaticSlice<SizeList<DR...>, SizeList<SR...>, SizeList<VD...>, SizeList<VS...>, Specs...> {};
+
+template <size_t DF, size_t... DR, size_t SF, size_t... SR, size_t... VD, size_t... VS, typename... Specs>
+struct StaticSlice<SizeList<DF, DR...>, SizeList<SF, SR...>, SizeList<VD...>, SizeList<VS...>, Range, Specs...> {
+    static constexpr bool is_static = false;
+};
+
+template <size_t DF, size_t... DR, size_t SF, size_t... SR, size_t... VD, size_t... VS,
+          size_t Start, size_t End, size_t Step, typename... Specs>
+struct StaticSlice<SizeList<DF, DR...>, SizeList<SF, SR...>, SizeList<VD...>, SizeList<VS...>,
+                   StaticRange<Start, End, Step>, Specs...>
+: StaticSlice<SizeList<DR...>, SizeList<SR...>, SizeList<VD..., (End - Start + Step - 1) / Step>,
+              SizeList<VS..., SF * Step>, Specs...>
+{
+    static_assert(End <= DF, "Static range is out of the bounds of the dimension");
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     SliceOffset
+/// @brief      Computes the memory offset of the first element of a slice, using strides which are known at
+///             compile time
+/// @tparam     Strides     The strides of the dimensions (a SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Strides>
+struct SliceOffset {
+    static constexpr size_t offset() { return 0; }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     SliceBounds
+/// @brief      Checks that the indices given at runtime for a slice of a static tensor are in range -- the
+///             other specifiers of static slices are checked at compile time
+/// @tparam     Sizes   The sizes of the dimensions (a SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Sizes>
+struct SliceBounds {
+    static void check() {}
+};
+
+template <size_t DF, size_t... DR>
+struct SliceBounds<SizeList<DF, DR...>> {
+    template <typename Spec, typename... Specs>
+    static void check(const Spec&, const Specs&... specs) { SliceBounds<SizeList<DR...>>::check(specs...); }
+
+    template <typename... Specs>
+    static void check(const Index& index, const Specs&... specs)
+    {
+        if (index.value >= DF) throw std::out_of_range("ftl::TensorView : slice index is out of range");
+        SliceBounds<SizeList<DR...>>::check(specs...);
+    }
+};
+
+template <size_t SF, size_t... SR>
+struct SliceOffset<SizeList<SF, SR...>> {
+    template <typename Spec, typename... Specs>
+    static constexpr size_t offset(const Spec& spec, const Specs&... specs)
+    {
+        return SF * spec.start() + SliceOffset<SizeList<SR...>>::offset(specs...);
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ToArray
+/// @brief      Converts a compile time list of sizes to an array
+/// @tparam     Sizes   The list of sizes (a SizeList)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Sizes>
+struct ToArray;
+
+template <size_t... Sizes>
+struct ToArray<SizeList<Sizes...>> {
+    static std::array<size_t, sizeof...(Sizes)> array() { return {{ Sizes... }}; }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      SliceBuilder
+/// @brief      Builds the layout of a view (and the offset of its first element) at runtime from the sizes and
+///             the strides of the dimensions of a tensor and a slice specifier for each dimension
+// ----------------------------------------------------------------------------------------------------------
+class SliceBuilder {
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Slices each of the dimensions with its specifier
+    /// @param[in]  sizes       The sizes of the dimensions of the tensor
+    /// @param[in]  strides     The strides of the dimensions of the tensor
+    /// @param[in]  specs       The slice specifiers for each of the dimensions
+    /// @tparam     Sizes       The type of the container of sizes
+    /// @tparam     Strides     The type of the container of strides
+    /// @tparam     Specs       The types of the slice specifiers
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Sizes, typename Strides, typename... Specs>
+    SliceBuilder(const Sizes& sizes, const Strides& strides, const Specs&... specs)
+    : _offset(0)
+    {
+        if (sizeof...(Specs) != sizes.size())
+            throw std::invalid_argument("ftl::TensorView : slices need a specifier for each dimension");
+        _sizes.reserve(sizeof...(Specs)); _strides.reserve(sizeof...(Specs));
+        slice(sizes, strides, 0, specs...);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the layout of the view
+    /// @return     The layout of the view
+    // ------------------------------------------------------------------------------------------------------
+    DynamicLayout layout() const { return DynamicLayout(_sizes, _strides); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the memory offset of the first element of the view
+    /// @return     The memory offset of the first element of the view
+    // ------------------------------------------------------------------------------------------------------
+    size_t offset() const { return _offset; }
+private:
+    std::vector<size_t>     _sizes;         //!< The sizes of the dimensions of the view
+    std::vector<size_t>     _strides;       //!< The strides of the dimensions of the view
+    size_t                  _offset;        //!< The memory offset of the first element of the view
+
+    template <typename Sizes, typename Strides>
+    void slice(const Sizes&, const Strides&, size_t) {}
+
+    template <typename Sizes, typename Strides, typename Spec, typename... Specs>
+    void slice(const Sizes& sizes, const Strides& strides, size_t dim, const Spec& spec, const Specs&... specs)
+    {
+        add(sizes[dim], strides[dim], spec);
+        slice(sizes, strides, dim + 1, specs...);
+    }
+
+    void add(size_t size, size_t stride, All)
+    {
+        _sizes.push_back(size); _strides.push_back(stride);
+    }
+
+    void add(size_t size, size_t stride, Index index)
+    {
+        if (index.value >= size) throw std::out_of_range("ftl::TensorView : slice index is out of range");
+        _offset += index.value * stride;
+    }
+
+    void add(size_t size, size_t stride, const Range& range)
+    {
+        if (range.step == 0) throw std::invalid_argument("ftl::TensorView : slice range has a step of 0");
+        const size_t end = range.end_index < size ? range.end_index : size;
+        _sizes.push_back(end > range.start_index ? (end - range.start_index + range.step - 1) / range.step : 0);
+        _strides.push_back(stride * range.step);
+        _offset += range.start_index * stride;
+    }
+
+    template <size_t Start, size_t End, size_t Step>
+    void add(size_t size, size_t stride, StaticRange<Start, End, Step>)
+    {
+        add(size, stride, Range(Start, End, Step));
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates a view with a dynamic shape from the sizes and the strides of a tensor
+/// @param[in]  data        A pointer to the first element of the tensor
+/// @param[in]  sizes       The sizes of the dimensions of the tensor
+/// @param[in]  strides     The strides of the dimensions of the tensor
+/// @param[in]  specs       The slice specifier for each of the dimensions
+/// @tparam     View        The type of the view
+/// @tparam     Element     The type of the elements of the view (const for views of constant data)
+/// @tparam     Sizes       The type of the container of sizes
+/// @tparam     Strides     The type of the container of strides
+/// @tparam     Specs       The types of the slice specifiers
+/// @return     The view of the tensor
+// ----------------------------------------------------------------------------------------------------------
+template <typename View, typename Element, typename Sizes, typename Strides, typename... Specs>
+View make_dynamic_view(Element* data, const Sizes& sizes, const Strides& strides, const Specs&... specs)
+{
+    static_assert(sizeof...(Specs) > 0, "Slices need a specifier for each dimension");
+    SliceBuilder builder(sizes, strides, typename SliceSpec<Specs>::type(specs)...);
+    return View(data + builder.offset(), builder.layout());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     SliceView
+/// @brief      Gets the type of the view of a tensor with a static layout, and creates it -- the view has a
+///             static shape if all the specifiers are known at compile time, otherwise the shape is dynamic
+/// @tparam     DT          The type of the data of the tensor
+/// @tparam     Element     The type of the elements of the view (const for views of constant data)
+/// @tparam     Layout      The static layout of the tensor
+/// @tparam     Specs       The (normalized) slice specifier for each dimension
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT, typename Element, typename Layout, typename... Specs>
+struct SliceView {
+private:
+    static_assert(sizeof...(Specs) == Layout::sizes::size, "Slices need a specifier for each dimension");
+    static_assert(!Layout::tiled, "Tiled tensors can't be sliced, since the elements of a view must be strided");
+
+    using slice = StaticSlice<typename Layout::sizes, typename Layout::strides, SizeList<>, SizeList<>, Specs...>;
+
+    template <typename Sizes, typename Strides> struct StaticView;
+    template <size_t... Sizes, typename Strides>
+    struct StaticView<SizeList<Sizes...>, Strides> {
+        using type = TensorView<TensorTraits<DT, CPU, Sizes...>, Element, Strides>;
+    };
+
+    template <bool IsStatic, typename Dummy = void>
+    struct Maker {
+        using type = typename StaticView<typename slice::sizes, typename slice::strides>::type;
+
+        static type make(Element* data, const Specs&... specs)
+        {
+            SliceBounds<typename Layout::sizes>::check(specs...);
+            return type(data + SliceOffset<typename Layout::strides>::offset(specs...));
+        }
+    };
+
+    template <typename Dummy>
+    struct Maker<false, Dummy> {
+        using type = TensorView<TensorTraits<DT, CPU>, Element>;
+
+        static type make(Element* data, const Specs&... specs)
+        {
+            return make_dynamic_view<type>(data, ToArray<typename Layout::sizes>::array()     ,
+                                                 ToArray<typename Layout::strides>::array()   , specs...);
+        }
+    };
+public:
+    using type = typename Maker<slice::is_static>::type;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates the view
+    /// @param[in]  data    A pointer to the first element of the tensor
+    /// @param[in]  specs   The slice specifiers for each of the dimensions
+    /// @return     The view of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    static type make(Element* data, const Specs&... specs) { return Maker<slice::is_static>::make(data, specs...); }
+};
+
+// Type of the view of a static tensor, with integral specifiers converted to Index
+template <typename DT, typename Element, typename Layout, typename... Specs>
+using StaticSliceType = typename SliceView<DT, Element, Layout, typename SliceSpec<Specs>::type...>::type;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Creates a view of a tensor with a static layout
+/// @param[in]  data        A pointer to the first element of the tensor
+/// @param[in]  specs       The slice specifier for each of the dimensions
+/// @tparam     DT          The type of the data of the tensor
+/// @tparam     Element     The type of the elements of the view (const for views of constant data)
+/// @tparam     Layout      The static layout of the tensor
+/// @tparam     Specs       The types of the slice specifiers
+/// @return     The view of the tensor
+// ----------------------------------------------------------------------------------------------------------
+template <typename DT, typename Layout, typename Element, typename... Specs>
+StaticSliceType<DT, Element, Layout, Specs...> make_static_view(Element* data, const Specs&... specs)
+{
+    return SliceView<DT, Element, Layout, typename SliceSpec<Specs>::type...>::make(
+                data, typename SliceSpec<Specs>::type(specs)...);
+}
+
+}               // End namespace detail
+}               // End namespace ftl
+#endif          // FTL_SLICE_HPP
@@ -0,0 +1,749 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for sparse tensors, which store the nonzero elements only, in coordinate (COO) format
+///         for construction and compressed sparse fiber (CSF) format for computation.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_SPARSE_HPP
+#define FTL_SPARSE_HPP
+
+#include "permute.hpp"
+#include "simd.hpp"
+#include "tensor_contraction.hpp"
+#include "tensor_dynamic_cpu.hpp"
+#include "tensor_elementwise.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// NOTE : A CSF tensor is a tree with a level for each dimension, in the order of its modes. Each node holds
+//        the index of a dimension, the children of a node share the indices of all of its ancestors, and the
+//        leaves hold the nonzero values. With the order of the modes chosen so that the leaves are the
+//        contracted dimension, each fiber (the leaves of a parent) gives a different element of the free
+//        dimensions, so the fibers are contracted in parallel without synchronization.
+//
+//        Operations with dense tensors are not lazy: sparse + dense is dense, and is evaluated into a new
+//        tensor, while sparse * dense has the nonzeros of the sparse tensor, so it is a new CSF tensor. The
+//        dense operands can be any expression, which is evaluated (or accessed) through TensorExpression.
+namespace ftl {
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the strides of the column-major linear index of a tensor with given dimension sizes
+/// @param[in]  dim_sizes   The sizes of the dimensions
+/// @return     The stride of each dimension
+// ----------------------------------------------------------------------------------------------------------
+inline std::vector<size_t> linear_strides(const std::vector<size_t>& dim_sizes)
+{
+    std::vector<size_t> strides(dim_sizes.size(), 1);
+    for (size_t d = 1; d < dim_sizes.size(); ++d) strides[d] = strides[d - 1] * dim_sizes[d - 1];
+    return strides;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Checks that a dense expression has the same dimension sizes as a sparse tensor
+/// @param[in]  sparse  The dimension sizes of the sparse tensor
+/// @param[in]  dense   The dimension sizes of the dense expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename Container>
+void check_sparse_sizes(const std::vector<size_t>& sparse, const Container& dense)
+{
+    if (sparse.size() != dense.size() || !std::equal(sparse.begin(), sparse.end(), dense.begin()))
+        throw std::invalid_argument("ftl::sparse : the sparse and dense tensors have different sizes");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Adds a multiple of a row to another row, a packet at a time
+/// @param[in]  value   The multiplier of the row which is added
+/// @param[in]  x       The row which is added
+/// @param[out] y       The row which is added to
+/// @param[in]  size    The number of elements in the rows
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+void axpy(const Dtype value, const Dtype* x, Dtype* y, size_t size)
+{
+    using packet = simd::Packet<Dtype>;
+    const auto multiplier = packet::set1(value);
+    size_t i = 0;
+    for (; i + packet::size <= size; i += packet::size)
+        packet::storeu(y + i, packet::fmadd(multiplier, packet::loadu(x + i), packet::loadu(y + i)));
+    for (; i < size; ++i) y[i] = simd::ScalarPacket<Dtype>::fmadd(value, x[i], y[i]);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Permutes the dimensions of a dense tensor into a new tensor (see permute.hpp), for the dense
+///             operand of a sparse contraction. Tiled tensors are evaluated into a strided tensor first.
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+DynamicTensorCpu<typename T::data_type> permute_operand(const TensorExpression<E, T>& x,
+                                                        const std::vector<size_t>& order)
+{
+    return permute(DynamicTensorCpu<typename T::data_type>(x), order);
+}
+
+template <typename DT>
+DynamicTensorCpu<typename TensorInterface<TensorTraits<DT, CPU>>::data_type>
+permute_operand(const TensorInterface<TensorTraits<DT, CPU>>& x, const std::vector<size_t>& order)
+{
+    using expression_type = TensorExpression<TensorInterface<TensorTraits<DT, CPU>>, TensorTraits<DT, CPU>>;
+    return x.layout().tiled() ? permute_operand(static_cast<const expression_type&>(x), order)
+                              : permute(x, order);
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      CooTensorCpu
+/// @brief      Sparse tensor in coordinate format, which holds the indices and the value of each nonzero in the
+///             order in which they were inserted. Nonzeros can be inserted more than once, in which case their
+///             values are added when the tensor is converted.
+/// @tparam     Dtype   The type of the data
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+class CooTensorCpu {
+public:
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using data_type         = Dtype;
+    using size_type         = size_t;
+    using dim_container     = std::vector<size_type>;
+    // ------------------------------------------------------------------------------------------------------
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- creates an empty tensor (with no nonzeros)
+    /// @param[in]  dim_sizes   The size of each dimension of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    explicit CooTensorCpu(dim_container dim_sizes);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- creates a tensor from the nonzeros of a dense expression, which are found in
+    ///             parallel (in blocks of the column-major index)
+    /// @param[in]  expression  The expression to take the nonzeros of, which must have at least one dimension
+    /// @tparam     E           The type of the expression
+    /// @tparam     T           The traits of the expression
+    // ------------------------------------------------------------------------------------------------------
+    template <typename E, typename T>
+    explicit CooTensorCpu(const TensorExpression<E, T>& expression);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Inserts a nonzero, for example A.insert({i, j, k}, value)
+    /// @param[in]  index   The index of the nonzero in each dimension
+    /// @param[in]  value   The value of the nonzero
+    // ------------------------------------------------------------------------------------------------------
+    void insert(const std::vector<size_type>& index, const data_type value);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Reserves memory for a number of nonzeros
+    /// @param[in]  nnz     The number of nonzeros to reserve memory for
+    // ------------------------------------------------------------------------------------------------------
+    void reserve(size_type nnz) { _indices.reserve(nnz * rank()); _values.reserve(nnz); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of nonzeros which have been inserted (including repeated nonzeros)
+    /// @return     The number of nonzeros
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type nnz() const { return _values.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the rank (number of dimensions) of the tensor
+    /// @return     The rank of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type rank() const { return _dim_sizes.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of elements of the tensor (including the zeros)
+    /// @return     The number of elements of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type size() const
+    {
+        return std::accumulate(_dim_sizes.begin(), _dim_sizes.end(), size_type(1), std::multiplies<size_type>());
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the size of each dimension of the tensor
+    /// @return     The size of each dimension
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _dim_sizes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the index of a nonzero in a dimension
+    /// @param[in]  n       The nonzero
+    /// @param[in]  dim     The dimension
+    /// @return     The index of the nonzero in the dimension
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type index(size_type n, size_type dim) const { return _indices[n * rank() + dim]; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the values of the nonzeros, in the order in which they were inserted
+    /// @return     The values of the nonzeros
+    // ------------------------------------------------------------------------------------------------------
+    inline const std::vector<data_type>& values() const { return _values; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a dense (column-major) tensor with the elements of the tensor
+    /// @return     A new dense tensor
+    // ------------------------------------------------------------------------------------------------------
+    DynamicTensorCpu<data_type> dense() const;
+private:
+    dim_container           _dim_sizes;     //!< The size of each dimension
+    std::vector<size_type>  _indices;       //!< The indices of the nonzeros (rank for each nonzero)
+    std::vector<data_type>  _values;        //!< The values of the nonzeros
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      CsfTensorCpu
+/// @brief      Sparse tensor in compressed sparse fiber format (see the note at the top of the file), in which
+///             each nonzero is stored once, with its value and its index in the last mode, and the indices of
+///             the other modes are shared by all the nonzeros of a subtree.
+/// @tparam     Dtype   The type of the data
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+class CsfTensorCpu {
+public:
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using data_type         = Dtype;
+    using size_type         = size_t;
+    using dim_container     = std::vector<size_type>;
+    // ------------------------------------------------------------------------------------------------------
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- creates a tensor from the nonzeros of a COO tensor, adding the values of
+    ///             nonzeros which were inserted more than once
+    /// @param[in]  coo     The COO tensor
+    /// @param[in]  modes   The dimensions of the levels of the tree, from the root to the leaves -- by
+    ///                     default the last dimension is the root and the first dimension is the leaves
+    // ------------------------------------------------------------------------------------------------------
+    explicit CsfTensorCpu(const CooTensorCpu<data_type>& coo, std::vector<size_type> modes = {});
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- creates a tensor from the nonzeros of a dense expression
+    /// @param[in]  expression  The expression to take the nonzeros of
+    /// @tparam     E           The type of the expression
+    /// @tparam     T           The traits of the expression
+    // ------------------------------------------------------------------------------------------------------
+    template <typename E, typename T>
+    explicit CsfTensorCpu(const TensorExpression<E, T>& expression)
+    : CsfTensorCpu(CooTensorCpu<data_type>(expression)) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of nonzeros
+    /// @return     The number of nonzeros
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type nnz() const { return _values.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the rank (number of dimensions) of the tensor
+    /// @return     The rank of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type rank() const { return _dim_sizes.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of elements of the tensor (including the zeros)
+    /// @return     The number of elements of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type size() const
+    {
+        return std::accumulate(_dim_sizes.begin(), _dim_sizes.end(), size_type(1), std::multiplies<size_type>());
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the size of each dimension of the tensor
+    /// @return     The size of each dimension
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _dim_sizes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the dimensions of the levels of the tree, from the root to the leaves
+    /// @return     The dimension of each level
+    // ------------------------------------------------------------------------------------------------------
+    inline const std::vector<size_type>& modes() const { return _modes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of nodes in a level of the tree (the number of nonzeros for the leaves)
+    /// @param[in]  level   The level of the tree
+    /// @return     The number of nodes in the level
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type num_nodes(size_type level) const { return _ids[level].size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the values of the nonzeros, in the order of the leaves
+    /// @return     The values of the nonzeros
+    // ------------------------------------------------------------------------------------------------------
+    inline const std::vector<data_type>& values() const { return _values; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Calls a function for each nonzero with the column-major index of the nonzero in the dense
+    ///             tensor and the position of its value. The subtrees of the root are shared between the
+    ///             threads of the pool, so the function is called in parallel, for different nonzeros.
+    /// @param[in]  function    The function to call, as function(dense_index, value_index)
+    /// @tparam     Function    The type of the function
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Function>
+    void for_each(Function&& function) const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a tensor with the same nonzeros (indices) as this tensor, and other values
+    /// @param[in]  values  The value of each nonzero, in the order of the leaves
+    /// @return     A new tensor with the values
+    // ------------------------------------------------------------------------------------------------------
+    CsfTensorCpu with_values(std::vector<data_type>&& values) const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a COO tensor with the nonzeros of the tensor
+    /// @return     A new COO tensor
+    // ------------------------------------------------------------------------------------------------------
+    CooTensorCpu<data_type> coo() const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a dense (column-major) tensor with the elements of the tensor
+    /// @return     A new dense tensor
+    // ------------------------------------------------------------------------------------------------------
+    DynamicTensorCpu<data_type> dense() const;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Contracts a dimension of the tensor with a dimension of a dense expression, which is a
+    ///             dense tensor with the free dimensions of the dense expression followed by those of this
+    ///             tensor. The leaves of the tree must be the contracted dimension.
+    /// @param[in]  dim         The dimension of this tensor to contract
+    /// @param[in]  expression  The dense expression
+    /// @param[in]  other_dim   The dimension of the dense expression to contract
+    /// @return     A new dense tensor with the result of the contraction
+    // ------------------------------------------------------------------------------------------------------
+    template <typename E, typename T>
+    DynamicTensorCpu<data_type> contract_leaves(size_type dim, const TensorExpression<E, T>& expression,
+                                                size_type other_dim) const;
+private:
+    dim_container                           _dim_sizes;     //!< The size of each dimension
+    std::vector<size_type>                  _modes;         //!< The dimension of each level of the tree
+    std::vector<std::vector<size_type>>     _ids;           //!< The index of each node of each level
+    std::vector<std::vector<size_type>>     _pointers;      //!< The first child of each node (and one past
+                                                            //!< the last child of the last node)
+    std::vector<data_type>                  _values;        //!< The value of each leaf
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Calls a function for each nonzero in the subtree of a node
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Function>
+    void visit(size_type level, size_type node, size_type offset, const std::vector<size_type>& strides,
+               Function& function) const;
+};
+
+// ---------------------------------------------- COO IMPLEMENTATIONS ---------------------------------------
+
+template <typename Dtype>
+CooTensorCpu<Dtype>::CooTensorCpu(dim_container dim_sizes)
+: _dim_sizes(std::move(dim_sizes))
+{
+    if (_dim_sizes.empty())
+        throw std::invalid_argument("ftl::CooTensorCpu : sparse tensors must have at least one dimension");
+}
+
+template <typename Dtype> template <typename E, typename T>
+CooTensorCpu<Dtype>::CooTensorCpu(const TensorExpression<E, T>& expression)
+: _dim_sizes(static_cast<const E&>(expression).dim_sizes().begin(),
+             static_cast<const E&>(expression).dim_sizes().end())
+{
+    static_assert(std::is_same<typename T::data_type, Dtype>::value,
+                  "ftl::CooTensorCpu : the expression has a different data type");
+    if (_dim_sizes.empty())
+        throw std::invalid_argument("ftl::CooTensorCpu : sparse tensors must have at least one dimension");
+    const E& x = static_cast<const E&>(expression);
+
+    // The nonzeros of each block are counted, and then written from the sum of the counts of the blocks before
+    const size_type total = x.size(), block = ThreadPool::instance().grain_size();
+    const size_type blocks = (total + block - 1) / block;
+    std::vector<size_type> counts(blocks + 1, 0);
+    ThreadPool::instance().parallel_for(0, blocks, [&] (size_type begin, size_type end)
+    {
+        for (size_type b = begin; b < end; ++b)
+            for (size_type i = b * block; i < std::min(total, (b + 1) * block); ++i)
+                counts[b + 1] += x[i] != Dtype(0);
+    }, 1, 1);
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+    _indices.resize(counts.back() * rank());
+    _values.resize(counts.back());
+    ThreadPool::instance().parallel_for(0, blocks, [&] (size_type begin, size_type end)
+    {
+        for (size_type b = begin; b < end; ++b) {
+            size_type n = counts[b];
+            for (size_type i = b * block; i < std::min(total, (b + 1) * block); ++i) {
+                const Dtype value = x[i];
+                if (value == Dtype(0)) continue;
+                for (size_type d = 0, index = i; d < rank(); index /= _dim_sizes[d++])
+                    _indices[n * rank() + d] = index % _dim_sizes[d];
+                _values[n++] = value;
+            }
+        }
+    }, 1, 1);
+}
+
+template <typename Dtype>
+void CooTensorCpu<Dtype>::insert(const std::vector<size_type>& index, const data_type value)
+{
+    if (index.size() != rank())
+        throw std::invalid_argument("ftl::CooTensorCpu : the index must have an element for each dimension");
+    for (size_type d = 0; d < rank(); ++d)
+        if (index[d] >= _dim_sizes[d]) throw std::out_of_range("ftl::CooTensorCpu : index out of range");
+
+    _indices.insert(_indices.end(), index.begin(), index.end());
+    _values.push_back(value);
+}
+
+template <typename Dtype>
+DynamicTensorCpu<Dtype> CooTensorCpu<Dtype>::dense() const
+{
+    typename DynamicTensorCpu<Dtype>::data_container data(size(), Dtype(0));
+    const std::vector<size_type> strides = detail::linear_strides(_dim_sizes);
+    for (size_type n = 0; n < nnz(); ++n) {
+        size_type offset = 0;
+        for (size_type d = 0; d < rank(); ++d) offset += index(n, d) * strides[d];
+        data[offset] += _values[n];
+    }
+    return DynamicTensorCpu<Dtype>(_dim_sizes, std::move(data));
+}
+
+// ---------------------------------------------- CSF IMPLEMENTATIONS ---------------------------------------
+
+template <typename Dtype>
+CsfTensorCpu<Dtype>::CsfTensorCpu(const CooTensorCpu<data_type>& coo, std::vector<size_type> modes)
+: _dim_sizes(coo.dim_sizes()), _modes(std::move(modes)), _ids(coo.rank()), _pointers(coo.rank() - 1)
+{
+    if (_modes.empty()) {
+        for (size_type d = rank(); d > 0; --d) _modes.push_back(d - 1);
+    }
+    detail::check_permutation(_modes, rank());
+
+    // The nonzeros are sorted by their indices in the order of the modes, so that each subtree is a range
+    const size_type levels = rank();
+    std::vector<size_type> order(coo.nnz());
+    std::iota(order.begin(), order.end(), size_type(0));
+    std::sort(order.begin(), order.end(), [&] (size_type a, size_type b)
+    {
+        for (const size_type mode : _modes)
+            if (coo.index(a, mode) != coo.index(b, mode)) return coo.index(a, mode) < coo.index(b, mode);
+        return a < b;
+    });
+
+    // A nonzero starts a node in each level from the first in which its index differs from the previous
+    // nonzero, and is added to the previous nonzero if none differ
+    for (size_type n = 0; n < order.size(); ++n) {
+        size_type level = 0;
+        if (n > 0) {
+            while (level < levels && coo.index(order[n], _modes[level]) == coo.index(order[n - 1], _modes[level]))
+                ++level;
+            if (level == levels) { _values.back() += coo.values()[order[n]]; continue; }
+        }
+        for (; level < levels; ++level) {
+            if (level + 1 < levels) _pointers[level].push_back(_ids[level + 1].size());
+            _ids[level].push_back(coo.index(order[n], _modes[level]));
+        }
+        _values.push_back(coo.values()[order[n]]);
+    }
+    for (size_type level = 0; level + 1 < levels; ++level) _pointers[level].push_back(_ids[level + 1].size());
+}
+
+template <typename Dtype> template <typename Function>
+void CsfTensorCpu<Dtype>::visit(size_type level, size_type node, size_type offset,
+                                const std::vector<size_type>& strides, Function& function) const
+{
+    offset += _ids[level][node] * strides[_modes[level]];
+    if (level + 1 == rank()) {
+        function(offset, node);
+        return;
+    }
+    for (size_type child = _pointers[level][node]; child < _pointers[level][node + 1]; ++child)
+        visit(level + 1, child, offset, strides, function);
+}
+
+template <typename Dtype> template <typename Function>
+void CsfTensorCpu<Dtype>::for_each(Function&& function) const
+{
+    const std::vector<size_type> strides = detail::linear_strides(_dim_sizes);
+    const size_type roots = _ids[0].size();
+    const size_type grain = std::max<size_type>(ThreadPool::instance().grain_size() * roots / std::max<size_type>(nnz(), 1), 1);
+    ThreadPool::instance().parallel_for(0, roots, [&] (size_type begin, size_type end)
+    {
+        for (size_type root = begin; root < end; ++root) visit(0, root, 0, strides, function);
+    }, 1, grain);
+}
+
+template <typename Dtype>
+CsfTensorCpu<Dtype> CsfTensorCpu<Dtype>::with_values(std::vector<data_type>&& values) const
+{
+    if (values.size() != nnz())
+        throw std::invalid_argument("ftl::CsfTensorCpu : there must be a value for each nonzero");
+    CsfTensorCpu result(*this);
+    result._values = std::move(values);
+    return result;
+}
+
+template <typename Dtype>
+CooTensorCpu<Dtype> CsfTensorCpu<Dtype>::coo() const
+{
+    CooTensorCpu<data_type> result(_dim_sizes);
+    result.reserve(nnz());
+
+    // The index of each nonzero is the index of each of its ancestors, which are found going down the tree
+    std::vector<size_type> index(rank()), node(rank(), 0);
+    for (size_type leaf = 0; leaf < nnz(); ++leaf) {
+        node[rank() - 1] = leaf;
+        for (size_type level = rank() - 1; level > 0; --level) {
+            while (_pointers[level - 1][node[level - 1] + 1] <= node[level]) ++node[level - 1];
+        }
+        for (size_type level = 0; level < rank(); ++level) index[_modes[level]] = _ids[level][node[level]];
+        result.insert(index, _values[leaf]);
+    }
+    return result;
+}
+
+template <typename Dtype>
+DynamicTensorCpu<Dtype> CsfTensorCpu<Dtype>::dense() const
+{
+    typename DynamicTensorCpu<Dtype>::data_container data(size(), Dtype(0));
+    for_each([&] (size_type offset, size_type n) { data[offset] = _values[n]; });
+    return DynamicTensorCpu<Dtype>(_dim_sizes, std::move(data));
+}
+
+template <typename Dtype> template <typename E, typename T>
+DynamicTensorCpu<Dtype> CsfTensorCpu<Dtype>::contract_leaves(size_type dim, const TensorExpression<E, T>& expression,
+                                                             size_type other_dim) const
+{
+    const E& y = static_cast<const E&>(expression);
+    const std::vector<size_type> dims_y(y.dim_sizes().begin(), y.dim_sizes().end());
+    detail::check_contraction(_dim_sizes, dims_y, {{ dim, other_dim }});
+    if (_modes.back() != dim)
+        throw std::invalid_argument("ftl::CsfTensorCpu : the leaves must be the contracted dimension");
+
+    // The dense operand is permuted so that the contracted dimension is the last, and each of its slices is
+    // a contiguous row of the free elements
+    std::vector<size_type> order, dims;
+    for (size_type d = 0; d < dims_y.size(); ++d)
+        if (d != other_dim) { order.push_back(d); dims.push_back(dims_y[d]); }
+    const size_type free_y = std::accumulate(dims.begin(), dims.end(), size_type(1), std::multiplies<size_type>());
+    order.push_back(other_dim);
+    const DynamicTensorCpu<Dtype> rows = detail::permute_operand(y, order);
+    const Dtype* row = rows.data().data();
+
+    // The offset of each fiber in the result, from the indices of its ancestors in the free dimensions
+    std::vector<size_type> free_strides(rank(), 0);
+    for (size_type d = 0, stride = free_y; d < rank(); ++d) {
+        if (d == dim) continue;
+        free_strides[d] = stride;
+        stride *= _dim_sizes[d];
+        dims.push_back(_dim_sizes[d]);
+    }
+    if (dims.empty()) dims.push_back(1);
+
+    const size_type fiber_level = rank() >= 2 ? rank() - 2 : 0;
+    std::vector<size_type> offsets(rank() >= 2 ? _ids[fiber_level].size() : 1, 0);
+    if (rank() >= 2) {
+        std::vector<size_type> parents(1, 0), children;
+        for (size_type level = 0; level <= fiber_level; ++level) {
+            children.assign(_ids[level].size(), 0);
+            for (size_type node = 0; node < _ids[level].size(); ++node)
+                children[node] = _ids[level][node] * free_strides[_modes[level]];
+            if (level > 0) {
+                for (size_type parent = 0; parent + 1 < _pointers[level - 1].size(); ++parent)
+                    for (size_type node = _pointers[level - 1][parent]; node < _pointers[level - 1][parent + 1]; ++node)
+                        children[node] += parents[parent];
+            }
+            parents.swap(children);
+        }
+        offsets.swap(parents);
+    }
+
+    using data_container = typename DynamicTensorCpu<Dtype>::data_container;
+    const size_type total = std::accumulate(dims.begin(), dims.end(), size_type(1), std::multiplies<size_type>());
+    data_container data(total);
+    auto& pool = ThreadPool::instance();
+    pool.parallel_for(0, total, [&] (size_type begin, size_type end)
+    {
+        std::fill(data.data() + begin, data.data() + end, Dtype(0));
+    });
+
+    // Each fiber adds a multiple of a row of the dense operand for each of its leaves to a different row
+    const size_type fibers = offsets.size();
+    const size_type grain = std::max<size_type>(pool.grain_size() * fibers / std::max<size_type>(nnz() * free_y, 1), 1);
+    pool.parallel_for(0, fibers, [&] (size_type begin, size_type end)
+    {
+        for (size_type fiber = begin; fiber < end; ++fiber) {
+            const size_type first = rank() >= 2 ? _pointers[fiber_level][fiber]     : 0;
+            const size_type last  = rank() >= 2 ? _pointers[fiber_level][fiber + 1] : nnz();
+            for (size_type leaf = first; leaf < last; ++leaf)
+                detail::axpy(_values[leaf], row + _ids[rank() - 1][leaf] * free_y, data.data() + offsets[fiber], free_y);
+        }
+    }, 1, grain);
+
+    return DynamicTensorCpu<Dtype>(dims, std::move(data));
+}
+
+// ----------------------------------------------- SPARSE FUNCTIONS -----------------------------------------
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Contracts a dimension of a sparse tensor with a dimension of a dense expression, for example
+///             contract(S, M, {{1, 0}}) for the product of a sparse matrix and a dense matrix. The dimensions
+///             of the result are the free dimensions of the sparse tensor followed by the free dimensions of
+///             the dense expression, as for dense contractions. If the leaves of the tree aren't the
+///             contracted dimension, the tensor is reordered first, which is best done once by the caller.
+/// @param[in]  x       The sparse tensor
+/// @param[in]  y       The dense expression
+/// @param[in]  pairs   The pair of dimensions to contract, as (dimension of x, dimension of y)
+/// @return     A new (dense) tensor with the result of the contraction
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename E, typename T>
+DynamicTensorCpu<Dtype> contract(const CsfTensorCpu<Dtype>& x, const TensorExpression<E, T>& y,
+                                 const std::vector<std::pair<size_t, size_t>>& pairs)
+{
+    static_assert(std::is_same<typename T::data_type, Dtype>::value,
+                  "Can't contract tensors with different data types");
+    if (pairs.size() != 1)
+        throw std::invalid_argument("ftl::contract : sparse tensors are contracted along one dimension");
+
+    const size_t dim = pairs[0].first;
+    if (dim < x.rank() && x.modes().back() != dim) {
+        std::vector<size_t> modes;
+        for (const size_t mode : x.modes()) if (mode != dim) modes.push_back(mode);
+        modes.push_back(dim);
+        return contract(CsfTensorCpu<Dtype>(x.coo(), modes), y, pairs);
+    }
+
+    // The result has the free dimensions of y first, so they are swapped unless either side has none
+    DynamicTensorCpu<Dtype> result = x.contract_leaves(dim, y, pairs[0].second);
+    const size_t free_y = static_cast<const E&>(y).rank() - 1, free_x = x.rank() - 1;
+    if (free_x == 0 || free_y == 0) return result;
+
+    std::vector<size_t> order;
+    for (size_t d = 0; d < free_x; ++d) order.push_back(free_y + d);
+    for (size_t d = 0; d < free_y; ++d) order.push_back(d);
+    return permute(result, order);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Contracts a dimension of a dense expression with a dimension of a sparse tensor, where the
+///             result has the free dimensions of the dense expression followed by those of the sparse tensor
+/// @param[in]  x       The dense expression
+/// @param[in]  y       The sparse tensor
+/// @param[in]  pairs   The pair of dimensions to contract, as (dimension of x, dimension of y)
+/// @return     A new (dense) tensor with the result of the contraction
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename E, typename T>
+DynamicTensorCpu<Dtype> contract(const TensorExpression<E, T>& x, const CsfTensorCpu<Dtype>& y,
+                                 const std::vector<std::pair<size_t, size_t>>& pairs)
+{
+    static_assert(std::is_same<typename T::data_type, Dtype>::value,
+                  "Can't contract tensors with different data types");
+    if (pairs.size() != 1)
+        throw std::invalid_argument("ftl::contract : sparse tensors are contracted along one dimension");
+
+    const size_t dim = pairs[0].second;
+    if (dim < y.rank() && y.modes().back() != dim) {
+        std::vector<size_t> modes;
+        for (const size_t mode : y.modes()) if (mode != dim) modes.push_back(mode);
+        modes.push_back(dim);
+        return contract(x, CsfTensorCpu<Dtype>(y.coo(), modes), pairs);
+    }
+    return y.contract_leaves(dim, x, pairs[0].first);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Adds a sparse tensor and a dense expression with the same dimension sizes
+/// @param[in]  x   The sparse tensor
+/// @param[in]  y   The dense expression
+/// @return     A new dense tensor with the sum
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename E, typename T>
+DynamicTensorCpu<Dtype> operator+(const CsfTensorCpu<Dtype>& x, const TensorExpression<E, T>& y)
+{
+    detail::check_sparse_sizes(x.dim_sizes(), static_cast<const E&>(y).dim_sizes());
+    DynamicTensorCpu<Dtype> result(y);
+    auto data = result.release();
+    x.for_each([&] (size_t offset, size_t n) { data[offset] += x.values()[n]; });
+    result.adopt(x.dim_sizes(), std::move(data));
+    return result;
+}
+
+template <typename Dtype, typename E, typename T>
+DynamicTensorCpu<Dtype> operator+(const TensorExpression<E, T>& x, const CsfTensorCpu<Dtype>& y)
+{
+    return y + x;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Subtracts a dense expression from a sparse tensor with the same dimension sizes
+/// @param[in]  x   The sparse tensor
+/// @param[in]  y   The dense expression
+/// @return     A new dense tensor with the difference
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename E, typename T>
+DynamicTensorCpu<Dtype> operator-(const CsfTensorCpu<Dtype>& x, const TensorExpression<E, T>& y)
+{
+    return x + TensorUnaryOperation<E, T, detail::NegateOp>(y);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Subtracts a sparse tensor from a dense expression with the same dimension sizes
+/// @param[in]  x   The dense expression
+/// @param[in]  y   The sparse tensor
+/// @return     A new dense tensor with the difference
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename E, typename T>
+DynamicTensorCpu<Dtype> operator-(const TensorExpression<E, T>& x, const CsfTensorCpu<Dtype>& y)
+{
+    detail::check_sparse_sizes(y.dim_sizes(), static_cast<const E&>(x).dim_sizes());
+    DynamicTensorCpu<Dtype> result(x);
+    auto data = result.release();
+    y.for_each([&] (size_t offset, size_t n) { data[offset] -= y.values()[n]; });
+    result.adopt(y.dim_sizes(), std::move(data));
+    return result;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Multiplies the elements of a sparse tensor and a dense expression with the same dimension
+///             sizes, where only the elements of the expression at the nonzeros of the sparse tensor are read
+/// @param[in]  x   The sparse tensor
+/// @param[in]  y   The dense expression
+/// @return     A new sparse tensor with the products, with the same nonzeros as x
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename E, typename T>
+CsfTensorCpu<Dtype> operator*(const CsfTensorCpu<Dtype>& x, const TensorExpression<E, T>& y)
+{
+    static_assert(std::is_same<typename T::data_type, Dtype>::value,
+                  "Can't multiply tensors with different data types");
+    const E& dense = static_cast<const E&>(y);
+    detail::check_sparse_sizes(x.dim_sizes(), dense.dim_sizes());
+    std::vector<Dtype> values(x.nnz());
+    x.for_each([&] (size_t offset, size_t n) { values[n] = x.values()[n] * dense[offset]; });
+    return x.with_values(std::move(values));
+}
+
+template <typename Dtype, typename E, typename T>
+CsfTensorCpu<Dtype> operator*(const TensorExpression<E, T>& x, const CsfTensorCpu<Dtype>& y)
+{
+    return y * x;
+}
+
+}               // End namespace ftl
+
+#endif          // FTL_SPARSE_HPP
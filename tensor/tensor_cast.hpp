@@ -0,0 +1,261 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for lazy casts of tensor expressions to another data type, for example
+///         ftl::cast<ftl::half>(A) to store the elements of A in half precision, or ftl::cast<float>(H) to
+///         compute with the elements of a half precision tensor in single precision. Casts between floats and
+///         the 16 bit floating point types (half.hpp) convert whole packets or blocks of elements at a time.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_TENSOR_CAST_HPP
+#define FTL_TENSOR_CAST_HPP
+
+#include "alias.hpp"
+#include "evaluator.hpp"
+#include "half.hpp"
+#include "policies.hpp"
+#include "tensor_expressions.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace ftl {
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      The number of elements of the source of a cast which are evaluated into a buffer and then
+///             converted at a time, when a cast is evaluated into contiguous memory
+// ----------------------------------------------------------------------------------------------------------
+static constexpr size_t cast_block = 256;
+
+// Replaces the data type of a (possibly policy wrapped) data type, keeping the policies
+template <typename Dtype, typename To>
+struct RebindDtype {
+    using type = To;
+};
+
+template <typename Dtype, typename... PolicyList, typename To>
+struct RebindDtype<Policies<Dtype, PolicyList...>, To> {
+    using type = Policies<To, PolicyList...>;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     CastTraits
+/// @brief      Gets the traits of an expression with a different data type, but the same policies, device and
+///             (static or dynamic) dimension sizes as other traits
+/// @tparam     Traits  The traits of the expression which is cast
+/// @tparam     To      The data type to cast to
+// ----------------------------------------------------------------------------------------------------------
+template <typename Traits, typename To>
+struct CastTraits;
+
+template <typename Dtype, device DeviceType, size_t... Sizes, typename To>
+struct CastTraits<TensorTraits<Dtype, DeviceType, Sizes...>, To> {
+    using type = TensorTraits<typename RebindDtype<Dtype, To>::type, DeviceType, Sizes...>;
+};
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      TensorCast
+/// @brief      Expression class for converting the elements of an expression to another data type, element
+///             by element. The elements of casts between types which have different packet sizes can only
+///             be computed a packet at a time if the source has packets of single elements (as the 16 bit
+///             floating point types do), in which case a packet of the source elements is gathered and then
+///             converted. Evaluating a cast into contiguous memory converts blocks of the source instead.
+/// @tparam     E       The expression to cast
+/// @tparam     T       The traits of the expression
+/// @tparam     To      The data type to cast to
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename To>
+class TensorCast : public TensorExpression<TensorCast<E, T, To>, typename detail::CastTraits<T, To>::type> {
+public:
+    using traits            = typename detail::CastTraits<T, To>::type;
+    using dim_container     = typename traits::dim_container;
+    using size_type         = typename traits::size_type;
+    using data_type         = typename traits::data_type;
+    using source_type       = typename E::data_type;
+    using packet_type       = typename simd::Packet<data_type>::type;
+
+    // Packets can be used if the source can use them, and has the same type or packets of single elements
+    static constexpr bool vectorizable = E::vectorizable &&
+                                         (std::is_same<data_type, source_type>::value ||
+                                          simd::Packet<source_type>::size == 1);
+private:
+    typename detail::ExpressionStorage<E>::type _x;     //!< Expression to cast
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Sets the expression to cast
+    /// @param[in] x       The expression to cast
+    // ------------------------------------------------------------------------------------------------------
+    TensorCast(const TensorExpression<E, T>& x) : _x(static_cast<const E&>(x)) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the expression which is cast
+    /// @return    A constant reference to the expression which is cast
+    // ------------------------------------------------------------------------------------------------------
+    inline const E& source() const { return _x; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the sizes of the all the dimensions of the expression
+    /// @return    A constant reference to the dimension sizes of the expression
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _x.dim_sizes(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the size of the expression
+    /// @return    The size of the expression
+    // ------------------------------------------------------------------------------------------------------
+    inline const size_type size() const { return _x.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the rank of the expression
+    /// @return    The rank of the expression
+    // ------------------------------------------------------------------------------------------------------
+    inline const size_type rank() const { return _x.rank(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets if the expression is stored contiguously, so that packets can be used
+    /// @return    If the expression is contiguous
+    // ------------------------------------------------------------------------------------------------------
+    inline bool contiguous() const { return _x.contiguous(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Checks if the expression can't be read while memory with a footprint is written
+    /// @param[in] target  The footprint of the memory which is written
+    /// @return    True if evaluating into the target requires a temporary buffer
+    // ------------------------------------------------------------------------------------------------------
+    inline bool aliases(const detail::MemoryFootprint& target) const { return _x.aliases(target); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Converts an element of the expression
+    /// @param[in] i   The index of the element
+    /// @return    The converted element
+    // ------------------------------------------------------------------------------------------------------
+    inline data_type operator[](size_type i) const { return static_cast<data_type>(_x[i]); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Converts a packet of elements of the expression
+    /// @param[in] i   The index of the first element in the packet
+    /// @return    The packet of converted elements
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const
+    {
+        return packet(i, std::is_same<data_type, source_type>());
+    }
+private:
+    inline packet_type packet(size_type i, std::true_type) const { return _x.packet(i); }
+
+    inline packet_type packet(size_type i, std::false_type) const
+    {
+        using packet = simd::Packet<data_type>;
+
+        source_type source[packet::size];
+        data_type   result[packet::size];
+        for (size_t k = 0; k < packet::size; ++k) source[k] = _x.packet(i + k);
+        simd::convert(source, result, packet::size);
+        return packet::loadu(result);
+    }
+};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates a range of a cast into contiguous memory one block at a time -- the source is
+///             evaluated into a buffer (with packets, if it can use them), which is then converted
+/// @param[in]  out         A pointer to the destination of the element begin
+/// @param[in]  expression  The cast to evaluate
+/// @param[in]  begin       The index of the first element to evaluate
+/// @param[in]  end         The index of the element after the last element to evaluate
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename To>
+void evaluate_cast(To* out, const TensorCast<E, T, To>& expression, size_t begin, size_t end, std::true_type)
+{
+    typename E::data_type buffer[cast_block];
+    for (size_t i = begin; i < end; i += cast_block) {
+        const size_t count = std::min(cast_block, end - i);
+        evaluate_range(buffer, expression.source(), i, i + count);
+        simd::convert(buffer, out + (i - begin), count);
+    }
+}
+
+// Other destinations (with a different type than the result of the cast) are evaluated element by element
+template <typename Dtype, typename E, typename T, typename To>
+void evaluate_cast(Dtype* out, const TensorCast<E, T, To>& expression, size_t begin, size_t end, std::false_type)
+{
+    evaluate_range(out, expression, begin, end);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Accumulating
+/// @brief      Gets the expression which reductions of an expression accumulate -- the expression itself, or
+///             a cast to the accumulator type for data types which are accumulated in a wider type
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T,
+          bool Widen = !std::is_same<typename T::data_type, typename Accumulator<typename T::data_type>::type>::value>
+struct Accumulating {
+    using type = E;
+    static inline const E& apply(const TensorExpression<E, T>& x) { return static_cast<const E&>(x); }
+};
+
+template <typename E, typename T>
+struct Accumulating<E, T, true> {
+    using type = TensorCast<E, T, typename Accumulator<typename T::data_type>::type>;
+    static inline type apply(const TensorExpression<E, T>& x) { return type(x); }
+};
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates the elements [begin, end) of a cast into contiguous memory, converting blocks of
+///             elements at a time (see evaluate in evaluator.hpp)
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The cast to evaluate
+/// @param[in]  begin       The index of the first element to evaluate
+/// @param[in]  end         The index of the element after the last element to evaluate
+/// @tparam     Dtype       The type of data in the output
+/// @tparam     E           The type of the expression which is cast
+/// @tparam     T           The traits of the expression which is cast
+/// @tparam     To          The type to cast to
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename E, typename T, typename To>
+inline void evaluate(Dtype* out, const TensorCast<E, T, To>& expression, size_t begin, size_t end)
+{
+    detail::evaluate_cast(out + begin, expression, begin, end, std::is_same<Dtype, To>());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Casts the elements of an expression to another type, lazily -- for example
+///             DynamicTensorCpu<ftl::half> H = ftl::cast<ftl::half>(A)
+/// @param[in]  x   The expression to cast
+/// @tparam     To  The type to cast to
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     An expression with the elements of x converted to To
+// ----------------------------------------------------------------------------------------------------------
+template <typename To, typename E, typename T>
+TensorCast<E, T, To> cast(const TensorExpression<E, T>& x)
+{
+    return TensorCast<E, T, To>(x);
+}
+
+}               // End namespace ftl
+#endif          // FTL_TENSOR_CAST_HPP
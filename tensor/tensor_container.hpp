@@ -23,19 +23,146 @@
 #ifndef FTL_TENSOR_CONTAINER_HPP
 #define FTL_TENSOR_CONTAINER_HPP
 
+#include "policies.hpp"
+
 #include <nano/nano.hpp>
 
+#include <algorithm>
 #include <array>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+// The largest amount of data (in bytes) which static tensors with ftl::AutomaticStorage store in the tensor,
+// the data of larger static tensors is stored on the heap
+#ifndef FTL_MAX_INLINE_BYTES
+    #define FTL_MAX_INLINE_BYTES 65536
+#endif
+
 namespace ftl {
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      HeapArray
+/// @brief      Array with a size which is known at compile time (like std::array), which stores its elements
+///             in a heap buffer from an allocator. Copies copy the elements and moves move the buffer. The
+///             elements are value initialized (zero for arithmetic types).
+/// @tparam     Dtype       The type of the elements
+/// @tparam     Size        The number of elements
+/// @tparam     Allocator   The (default constructible) allocator for the buffer
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, size_t Size, typename Allocator>
+class HeapArray {
+public:
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using value_type        = Dtype;
+    using size_type         = size_t;
+    using reference         = Dtype&;
+    using const_reference   = const Dtype&;
+    using iterator          = Dtype*;
+    using const_iterator    = const Dtype*;
+    // ------------------------------------------------------------------------------------------------------
+
+    HeapArray() : _data(allocate()) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor which sets the first elements to a list of values (the others are value 
+    ///             initialized)
+    /// @param[in]  values  The values of the first elements
+    // ------------------------------------------------------------------------------------------------------
+    HeapArray(std::initializer_list<Dtype> values) : _data(allocate()) 
+    { 
+        std::copy(values.begin(), values.begin() + std::min(values.size(), Size), _data); 
+    }
+
+    HeapArray(const HeapArray& other) : _data(allocate()) { std::copy(other.begin(), other.end(), _data); }
+
+    HeapArray(HeapArray&& other) noexcept : _data(other._data) { other._data = nullptr; }
+
+    ~HeapArray() { release(); }
+
+    HeapArray& operator=(const HeapArray& other) 
+    {
+        if (this == &other) return *this;
+        if (_data == nullptr) _data = allocate();
+        std::copy(other.begin(), other.end(), _data);
+        return *this;
+    }
+
+    HeapArray& operator=(HeapArray&& other) noexcept
+    {
+        std::swap(_data, other._data);
+        return *this;
+    }
+
+    constexpr size_type size() const { return Size; }
+
+    inline Dtype* data() { return _data; }
+    inline const Dtype* data() const { return _data; }
+
+    inline reference operator[](size_type i) { return _data[i]; }
+    inline const_reference operator[](size_type i) const { return _data[i]; }
+
+    iterator begin() { return _data; }
+    iterator end() { return _data + Size; }
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + Size; }
+private:
+    Dtype*  _data;                      //!< The buffer with the elements
+
+    static Dtype* allocate()
+    {
+        Allocator allocator;
+        Dtype* data = allocator.allocate(Size);
+        std::uninitialized_fill_n(data, Size, Dtype());
+        return data;
+    }
+
+    void release()
+    {
+        if (_data == nullptr) return;
+        if (!std::is_trivially_destructible<Dtype>::value) {
+            for (size_t i = 0; i < Size; ++i) _data[i].~Dtype();
+        }
+        Allocator().deallocate(_data, Size);
+        _data = nullptr;
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticStorage
+/// @brief      Gets the container for the data of a static tensor from its storage policy
+/// @tparam     Dtype       The type of the data
+/// @tparam     Size        The number of elements
+/// @tparam     Allocator   The allocator for heap storage
+/// @tparam     Storage     The storage policy
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, size_t Size, typename Allocator, typename Storage>
+struct StaticStorage;
+
+template <typename Dtype, size_t Size, typename Allocator>
+struct StaticStorage<Dtype, Size, Allocator, InlineStorage> { using type = std::array<Dtype, Size>; };
+
+template <typename Dtype, size_t Size, typename Allocator>
+struct StaticStorage<Dtype, Size, Allocator, HeapStorage> { using type = HeapArray<Dtype, Size, Allocator>; };
+
+template <typename Dtype, size_t Size, typename Allocator>
+struct StaticStorage<Dtype, Size, Allocator, AutomaticStorage> 
+: StaticStorage<Dtype, Size, Allocator, typename std::conditional<Size * sizeof(Dtype) <= FTL_MAX_INLINE_BYTES,
+                                                                  InlineStorage, HeapStorage>::type> {};
+
+}               // End namespace detail
    
 // ----------------------------------------------------------------------------------------------------------
 /// @struct     TensorContainer
 /// @brief      Container for tensor data depending on if the tensor is static (dimension sizes, and hence the
-///             total number of elements, are known at compile time -- uses std::array) or dynamic (dimension 
-///             sizes are not known at compile time -- uses std::vector).
-/// @tparam     Dtype   The type of data used by the tensor
+///             total number of elements, are known at compile time -- uses std::array, or a heap buffer as 
+///             chosen by the storage policy) or dynamic (dimension 
+///             sizes are not known at compile time -- uses std::vector with the allocator given by the 
+///             policies, which is an ftl::AlignedAllocator by default).
+/// @tparam     Dtype   The type of data used by the tensor, optionally wrapped with ftl::Policies
 /// @tparam     Sizes   The sizes of the dimensions (optional)
 // ----------------------------------------------------------------------------------------------------------
 template <typename Dtype, size_t... Sizes>
@@ -46,10 +173,16 @@ template <typename Dtype, size_t SizeFirst, size_t... SizeRest>
 class TensorContainer<Dtype, SizeFirst, SizeRest...> {
 public:
     // ---------------------------------------- ALIAS'S -----------------------------------------------------
-    using data_type         = Dtype;
+    using data_type         = typename detail::PolicyTraits<Dtype>::data_type;
+    using layout_type       = StaticLayout<typename detail::PolicyTraits<Dtype>::layout_policy, 
+                                           SizeFirst, SizeRest...                               >;
     using dimension_sizes   = nano::list<nano::size_t<SizeFirst>, nano::size_t<SizeRest>...>;
     using dimension_product = nano::multiplies<dimension_sizes>;
-    using data_container    = std::array<data_type, dimension_product::result>; 
+    using data_container    = typename detail::StaticStorage<
+                                    data_type                                                   , 
+                                    layout_type::storage_size                                   ,
+                                    typename detail::PolicyTraits<Dtype>::allocator_type        ,
+                                    typename detail::PolicyTraits<Dtype>::storage_policy        >::type;
     using dim_container     = typename nano::runtime_converter<dimension_sizes>::array_type;
     using size_type         = typename data_container::size_type;
     using iterator          = typename data_container::iterator;
@@ -117,8 +250,9 @@ template <typename Dtype>
 class TensorContainer<Dtype> {
 public:
     // ----------------------------------------- ALIAS'S ----------------------------------------------------
-    using data_type         = Dtype;
-    using data_container    = std::vector<data_type>;
+    using data_type         = typename detail::PolicyTraits<Dtype>::data_type;
+    using allocator_type    = typename detail::PolicyTraits<Dtype>::allocator_type;
+    using data_container    = std::vector<data_type, allocator_type>;
     using size_type         = typename data_container::size_type;
     using dim_container     = std::vector<size_type>;
     using iterator          = typename data_container::iterator;
@@ -128,6 +262,12 @@ public:
     /// @brief      Default constructor 
     // ------------------------------------------------------------------------------------------------------
     TensorContainer() : _size(0), _data(0) {}
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor which uses an allocator instance for the data (for allocators with state)
+    /// @param[in]  allocator   The allocator to use for the data
+    // ------------------------------------------------------------------------------------------------------
+    explicit TensorContainer(const allocator_type& allocator) : _size(0), _data(allocator) {}
 
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Contructor when given an array with the data for the container
@@ -135,6 +275,13 @@ public:
     // ------------------------------------------------------------------------------------------------------
     TensorContainer(data_container& data)
     : _size(data.size()), _data(data){}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Contructor which takes the data of the container, without copying it
+    /// @param[in]  data    The data for the container, which is moved into the container
+    // ------------------------------------------------------------------------------------------------------
+    TensorContainer(data_container&& data)
+    : _data(std::move(data)), _size(_data.size()) {}
    
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets the size (total number of elements) in the container
@@ -0,0 +1,454 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for tensor contractions. A contraction sums the products of the elements of two
+///         tensors over pairs of dimensions (one from each tensor) with the same size -- for example, the
+///         contraction of two matrices over the columns of the first and the rows of the second is matrix
+///         multiplication. The free (not contracted) dimensions of the first tensor followed by the free
+///         dimensions of the second tensor are the dimensions of the result, and the contraction is mapped
+///         to a single cache-blocked matrix multiplication (see gemm.hpp). Contractions of the 16 bit floating
+///         point types (half.hpp) accumulate in floats.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_TENSOR_CONTRACTION_HPP
+#define FTL_TENSOR_CONTRACTION_HPP
+
+#include "gemm.hpp"
+#include "half.hpp"
+#include "tensor.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     IndexPair
+/// @brief      A pair of dimensions to contract over, for contractions where the pairs are known at compile
+///             time, for example ftl::contract<ftl::IndexPair<1, 0>>(A, B) for a matrix multiplication
+/// @tparam     First   The dimension of the first tensor
+/// @tparam     Second  The dimension of the second tensor
+// ----------------------------------------------------------------------------------------------------------
+template <size_t First, size_t Second>
+struct IndexPair {
+    static constexpr size_t first  = First;
+    static constexpr size_t second = Second;
+};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     GetSize
+/// @brief      Gets the value at a position in a list of sizes (0 if the position is past the end)
+/// @tparam     Index   The position of the value in the list
+/// @tparam     List    The list of sizes
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Index, typename List>
+struct GetSize { static constexpr size_t value = 0; };
+
+template <size_t SF, size_t... SR>
+struct GetSize<0, SizeList<SF, SR...>> { static constexpr size_t value = SF; };
+
+template <size_t Index, size_t SF, size_t... SR>
+struct GetSize<Index, SizeList<SF, SR...>> : GetSize<Index - 1, SizeList<SR...>> {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ContainsSize
+/// @brief      Checks if a list of sizes contains a value
+/// @tparam     Value   The value to look for
+/// @tparam     List    The list of sizes
+// ----------------------------------------------------------------------------------------------------------
+template <size_t Value, typename List>
+struct ContainsSize { static constexpr bool value = false; };
+
+template <size_t Value, size_t SF, size_t... SR>
+struct ContainsSize<Value, SizeList<SF, SR...>> {
+    static constexpr bool value = Value == SF || ContainsSize<Value, SizeList<SR...>>::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     UniqueSizes
+/// @brief      Checks that all the values in a list of sizes are different
+/// @tparam     List    The list of sizes
+// ----------------------------------------------------------------------------------------------------------
+template <typename List>
+struct UniqueSizes { static constexpr bool value = true; };
+
+template <size_t SF, size_t... SR>
+struct UniqueSizes<SizeList<SF, SR...>> {
+    static constexpr bool value = !ContainsSize<SF, SizeList<SR...>>::value && UniqueSizes<SizeList<SR...>>::value;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ConcatSizes
+/// @brief      Joins two lists of sizes
+/// @tparam     First   The first list
+/// @tparam     Second  The second list
+// ----------------------------------------------------------------------------------------------------------
+template <typename First, typename Second>
+struct ConcatSizes;
+
+template <size_t... First, size_t... Second>
+struct ConcatSizes<SizeList<First...>, SizeList<Second...>> { using type = SizeList<First..., Second...>; };
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     FreeSizes
+/// @brief      Gets the sizes of the dimensions of a tensor which are not contracted
+/// @tparam     Contracted  The list of the contracted dimensions
+/// @tparam     Sizes       The list of the sizes of the dimensions of the tensor
+/// @tparam     Index       The dimension of the first size in the list of sizes
+// ----------------------------------------------------------------------------------------------------------
+template <typename Contracted, typename Sizes, size_t Index = 0>
+struct FreeSizes { using type = SizeList<>; };
+
+template <typename Contracted, size_t SF, size_t... SR, size_t Index>
+struct FreeSizes<Contracted, SizeList<SF, SR...>, Index> {
+    using rest = typename FreeSizes<Contracted, SizeList<SR...>, Index + 1>::type;
+    using type = typename std::conditional<ContainsSize<Index, Contracted>::value          ,
+                                           rest                                            ,
+                                           typename ConcatSizes<SizeList<SF>, rest>::type  >::type;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticTensorFromSizes
+/// @brief      Gets the type of a static tensor from a list of sizes, where an empty list (the result of a
+///             contraction over all the dimensions) gives a tensor with a single element
+/// @tparam     Dtype   The type of the data
+/// @tparam     Sizes   The list of the sizes of the dimensions
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename Sizes>
+struct StaticTensorFromSizes { using type = StaticTensorCpu<Dtype, 1>; };
+
+template <typename Dtype, size_t SF, size_t... SR>
+struct StaticTensorFromSizes<Dtype, SizeList<SF, SR...>> { using type = StaticTensorCpu<Dtype, SF, SR...>; };
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticPairsValid
+/// @brief      Checks that the pairs of a contraction are in range and contract dimensions of equal size
+/// @tparam     SizesA  The list of the sizes of the dimensions of the first tensor
+/// @tparam     SizesB  The list of the sizes of the dimensions of the second tensor
+/// @tparam     Pairs   The pairs of dimensions to contract (ftl::IndexPair)
+// ----------------------------------------------------------------------------------------------------------
+template <typename SizesA, typename SizesB, typename... Pairs>
+struct StaticPairsValid {
+    static constexpr bool in_range   = true;
+    static constexpr bool same_sizes = true;
+};
+
+template <typename SizesA, typename SizesB, typename PF, typename... PR>
+struct StaticPairsValid<SizesA, SizesB, PF, PR...> {
+    using rest = StaticPairsValid<SizesA, SizesB, PR...>;
+
+    static constexpr bool in_range   = PF::first < SizesA::size && PF::second < SizesB::size && rest::in_range;
+    static constexpr bool same_sizes = GetSize<PF::first, SizesA>::value == GetSize<PF::second, SizesB>::value
+                                    && rest::same_sizes;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ContractionResult
+/// @brief      Gets the type of the result of a contraction -- a static tensor if both tensors have static
+///             shapes, otherwise a dynamic tensor
+/// @tparam     Dtype   The type of the data
+/// @tparam     TA      The traits of the first tensor
+/// @tparam     TB      The traits of the second tensor
+/// @tparam     Pairs   The pairs of dimensions to contract (ftl::IndexPair)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename TA, typename TB, typename... Pairs>
+struct ContractionResult {
+    using sizes_a = typename StaticSizes<TA>::type;
+    using sizes_b = typename StaticSizes<TB>::type;
+    using free_a  = typename FreeSizes<SizeList<Pairs::first...>, sizes_a>::type;
+    using free_b  = typename FreeSizes<SizeList<Pairs::second...>, sizes_b>::type;
+
+    static constexpr bool is_static = StaticSizes<TA>::is_static && StaticSizes<TB>::is_static;
+
+    using type = typename std::conditional<
+                    is_static                                                                       ,
+                    typename StaticTensorFromSizes<Dtype, typename ConcatSizes<free_a, free_b>::type>::type,
+                    DynamicTensorCpu<Dtype>                                                         >::type;
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the (column-major) index offset of each element of a block of dimensions, where the first
+///             dimension of the block changes fastest
+/// @param[in]  sizes       The sizes of the dimensions of the block
+/// @param[in]  strides     The (column-major) index stride of each dimension of the block
+/// @return     The index offsets of the elements of the block
+// ----------------------------------------------------------------------------------------------------------
+inline std::vector<size_t> block_offsets(const std::vector<size_t>& sizes, const std::vector<size_t>& strides)
+{
+    size_t total = 1;
+    for (auto size : sizes) total *= size;
+
+    std::vector<size_t> offsets(total), index(sizes.size(), 0);
+    size_t offset = 0;
+    for (size_t i = 0; i < total; ++i) {
+        offsets[i] = offset;
+        // Odometer increment, resetting the dimensions which wrap around
+        for (size_t d = 0; d < sizes.size(); ++d) {
+            offset += strides[d];
+            if (++index[d] < sizes[d]) break;
+            offset -= strides[d] * sizes[d];
+            index[d] = 0;
+        }
+    }
+    return offsets;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Checks the pairs of dimensions for a contraction of tensors with given dimension sizes, and
+///             throws std::invalid_argument if a dimension is out of range, if a dimension is contracted more
+///             than once, or if the dimensions of a pair have different sizes
+/// @param[in]  dims_a  The sizes of the dimensions of the first tensor
+/// @param[in]  dims_b  The sizes of the dimensions of the second tensor
+/// @param[in]  pairs   The pairs of dimensions to contract
+// ----------------------------------------------------------------------------------------------------------
+inline void check_contraction(const std::vector<size_t>&                     dims_a   ,
+                              const std::vector<size_t>&                     dims_b   ,
+                              const std::vector<std::pair<size_t, size_t>>&  pairs    )
+{
+    std::vector<bool> used_a(dims_a.size(), false), used_b(dims_b.size(), false);
+    for (const auto& pair : pairs) {
+        if (pair.first >= dims_a.size() || pair.second >= dims_b.size())
+            throw std::invalid_argument("ftl::contract : dimension of index pair out of range");
+        if (used_a[pair.first] || used_b[pair.second])
+            throw std::invalid_argument("ftl::contract : dimension contracted more than once");
+        if (dims_a[pair.first] != dims_b[pair.second])
+            throw std::invalid_argument("ftl::contract : contracted dimensions have different sizes ("
+                                        + std::to_string(dims_a[pair.first]) + " and "
+                                        + std::to_string(dims_b[pair.second]) + ")");
+        used_a[pair.first] = used_b[pair.second] = true;
+    }
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Splits the dimensions of an operand of a contraction into the free (outer) and contracted
+///             (inner) dimensions, and gets the (logical column-major) index offsets of the elements of each,
+///             so that element (i, k) of the operand as a matrix has index outer[i] + inner[k]
+/// @param[in]  dims    The sizes of the dimensions of the operand
+/// @param[in]  pairs   The pairs of dimensions to contract
+/// @param[in]  first   If the operand is the first operand (which has the first dimension of each pair)
+/// @param[out] outer   The index offsets of the elements of the free dimensions
+/// @param[out] inner   The index offsets of the elements of the contracted dimensions
+// ----------------------------------------------------------------------------------------------------------
+inline void contraction_offsets(const std::vector<size_t>& dims, const std::vector<std::pair<size_t, size_t>>& pairs,
+                                bool first, std::vector<size_t>& outer, std::vector<size_t>& inner)
+{
+    std::vector<size_t> strides(dims.size()), outer_sizes, outer_strides, inner_sizes, inner_strides;
+    std::vector<bool>   contracted(dims.size(), false);
+    for (size_t d = 0, stride = 1; d < dims.size(); stride *= dims[d++]) strides[d] = stride;
+    for (const auto& pair : pairs) {
+        const size_t d = first ? pair.first : pair.second;
+        contracted[d] = true;
+        inner_sizes.push_back(dims[d]); inner_strides.push_back(strides[d]);
+    }
+    for (size_t d = 0; d < dims.size(); ++d) {
+        if (contracted[d]) continue;
+        outer_sizes.push_back(dims[d]); outer_strides.push_back(strides[d]);
+    }
+    outer = block_offsets(outer_sizes, outer_strides);
+    inner = block_offsets(inner_sizes, inner_strides);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the dimension sizes of the result of a contraction -- the free dimensions of the first
+///             operand followed by the free dimensions of the second (or a single dimension of size 1)
+/// @param[in]  dims_a  The sizes of the dimensions of the first operand
+/// @param[in]  dims_b  The sizes of the dimensions of the second operand
+/// @param[in]  pairs   The pairs of dimensions to contract
+/// @return     The sizes of the dimensions of the result
+// ----------------------------------------------------------------------------------------------------------
+inline std::vector<size_t> contraction_dims(const std::vector<size_t>& dims_a, const std::vector<size_t>& dims_b,
+                                            const std::vector<std::pair<size_t, size_t>>& pairs)
+{
+    std::vector<size_t> dims;
+    for (size_t i = 0; i < 2; ++i) {
+        const std::vector<size_t>& operand_dims = i == 0 ? dims_a : dims_b;
+        for (size_t d = 0; d < operand_dims.size(); ++d) {
+            bool contracted = false;
+            for (const auto& pair : pairs) contracted = contracted || (i == 0 ? pair.first : pair.second) == d;
+            if (!contracted) dims.push_back(operand_dims[d]);
+        }
+    }
+    if (dims.empty()) dims.push_back(1);
+    return dims;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Multiplies the matrices of two operands into the memory of a result, either directly, or (for
+///             the types which are accumulated in a wider type) into a buffer of the accumulator type which is
+///             then converted, so the operands are converted when they are packed and the sums are only rounded
+///             to the data type at the end
+/// @param[out] out     A pointer to the first element of the result
+/// @param[in]  a       The first operand
+/// @param[in]  b       The second operand
+/// @tparam     Dtype   The type of the data
+/// @tparam     EA      The type of the expression of the first operand
+/// @tparam     EB      The type of the expression of the second operand
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename EA, typename EB>
+inline void gemm_into(Dtype* out, const GemmOperand<EA>& a, const GemmOperand<EB>& b, std::true_type)
+{
+    gemm(out, a, b);
+}
+
+template <typename Dtype, typename EA, typename EB>
+void gemm_into(Dtype* out, const GemmOperand<EA>& a, const GemmOperand<EB>& b, std::false_type)
+{
+    std::vector<typename Accumulator<Dtype>::type> result(a.outer_size() * b.outer_size());
+    gemm(result.data(), a, b);
+    simd::convert(result.data(), out, result.size());
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Contracts two expressions into the (column-major, contiguous) memory of a result, where the
+///             pairs have already been checked
+/// @param[out] out     A pointer to the first element of the result
+/// @param[in]  a       The first expression
+/// @param[in]  b       The second expression
+/// @param[in]  dims_a  The sizes of the dimensions of the first expression
+/// @param[in]  dims_b  The sizes of the dimensions of the second expression
+/// @param[in]  pairs   The pairs of dimensions to contract
+/// @tparam     Dtype   The type of the data
+/// @tparam     EA      The type of the first expression
+/// @tparam     EB      The type of the second expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype, typename EA, typename EB>
+void contract_into(Dtype* out, const EA& a, const EB& b, const std::vector<size_t>& dims_a,
+                   const std::vector<size_t>& dims_b, const std::vector<std::pair<size_t, size_t>>& pairs)
+{
+    std::vector<size_t> outer_a, inner_a, outer_b, inner_b;
+    contraction_offsets(dims_a, pairs, true , outer_a, inner_a);
+    contraction_offsets(dims_b, pairs, false, outer_b, inner_b);
+
+    using accumulate_type = typename Accumulator<Dtype>::type;
+    gemm_into(out, GemmOperand<EA>(a, std::move(outer_a), std::move(inner_a)),
+                   GemmOperand<EB>(b, std::move(outer_b), std::move(inner_b)),
+              std::is_same<Dtype, accumulate_type>());
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Contracts two tensor expressions over pairs of dimensions which are given at runtime, for
+///             example contract(A, B, {{1, 0}}) for the product of matrices A and B. The dimensions of the
+///             result are the free dimensions of A followed by the free dimensions of B (or a single dimension
+///             of size 1 if all the dimensions are contracted).
+/// @param[in]  x       The first expression
+/// @param[in]  y       The second expression
+/// @param[in]  pairs   The pairs of dimensions to contract, as (dimension of x, dimension of y)
+/// @return     A new (dynamic) tensor with the result of the contraction
+/// @tparam     EA      The type of the first expression
+/// @tparam     TA      The traits of the first expression
+/// @tparam     EB      The type of the second expression
+/// @tparam     TB      The traits of the second expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename EA, typename TA, typename EB, typename TB>
+DynamicTensorCpu<typename TA::data_type> contract(const TensorExpression<EA, TA>&                x      ,
+                                                  const TensorExpression<EB, TB>&                y      ,
+                                                  const std::vector<std::pair<size_t, size_t>>&  pairs  )
+{
+    static_assert(std::is_same<typename TA::data_type, typename TB::data_type>::value,
+                  "Can't contract tensors with different data types");
+
+    using data_type     = typename TA::data_type;
+    using result_type   = DynamicTensorCpu<data_type>;
+
+    const EA& a = static_cast<const EA&>(x);
+    const EB& b = static_cast<const EB&>(y);
+
+    const std::vector<size_t> dims_a(a.dim_sizes().begin(), a.dim_sizes().end());
+    const std::vector<size_t> dims_b(b.dim_sizes().begin(), b.dim_sizes().end());
+    detail::check_contraction(dims_a, dims_b, pairs);
+
+    // The data is not initialized, since the contraction writes every element
+    DynamicLayout layout(detail::contraction_dims(dims_a, dims_b, pairs));
+    typename result_type::data_container data(layout.size());
+    if (!data.empty()) detail::contract_into(data.data(), a, b, dims_a, dims_b, pairs);
+    return result_type(layout, std::move(data));
+}
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Contracts two expressions with static shapes into a static tensor
+// ----------------------------------------------------------------------------------------------------------
+template <typename Result, typename EA, typename EB>
+Result contract_static(const EA& a, const EB& b, const std::vector<std::pair<size_t, size_t>>& pairs,
+                       std::true_type)
+{
+    Result result;
+    if (result.size() == 0) return result;
+    contract_into(result.data().data(), a, b, std::vector<size_t>(a.dim_sizes().begin(), a.dim_sizes().end()),
+                  std::vector<size_t>(b.dim_sizes().begin(), b.dim_sizes().end()), pairs);
+    return result;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Contracts two expressions, where at least one does not have a static shape, into a dynamic
+///             tensor
+// ----------------------------------------------------------------------------------------------------------
+template <typename Result, typename EA, typename EB>
+Result contract_static(const EA& a, const EB& b, const std::vector<std::pair<size_t, size_t>>& pairs,
+                       std::false_type)
+{
+    return ftl::contract(a, b, pairs);
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Contracts two tensor expressions over pairs of dimensions which are given at compile time, for
+///             example contract<IndexPair<1, 0>>(A, B) for the product of matrices A and B. When both
+///             expressions have static shapes the pairs are checked at compile time and the result is a static
+///             tensor, otherwise the result is a dynamic tensor (see the runtime contract).
+/// @param[in]  x       The first expression
+/// @param[in]  y       The second expression
+/// @return     A new tensor with the result of the contraction
+/// @tparam     Pairs   The pairs of dimensions to contract (ftl::IndexPair)
+/// @tparam     EA      The type of the first expression
+/// @tparam     TA      The traits of the first expression
+/// @tparam     EB      The type of the second expression
+/// @tparam     TB      The traits of the second expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename... Pairs, typename EA, typename TA, typename EB, typename TB>
+typename detail::ContractionResult<typename TA::data_type, TA, TB, Pairs...>::type
+contract(const TensorExpression<EA, TA>& x, const TensorExpression<EB, TB>& y)
+{
+    using result = detail::ContractionResult<typename TA::data_type, TA, TB, Pairs...>;
+    using checks = detail::StaticPairsValid<typename result::sizes_a, typename result::sizes_b, Pairs...>;
+
+    static_assert(std::is_same<typename TA::data_type, typename TB::data_type>::value,
+                  "Can't contract tensors with different data types");
+    static_assert(detail::UniqueSizes<detail::SizeList<Pairs::first...>>::value &&
+                  detail::UniqueSizes<detail::SizeList<Pairs::second...>>::value,
+                  "Can't contract a dimension more than once");
+    static_assert(!result::is_static || checks::in_range, "Dimension of index pair out of range");
+    static_assert(!result::is_static || checks::same_sizes, "Contracted dimensions have different sizes");
+
+    const std::vector<std::pair<size_t, size_t>> pairs = { std::make_pair(Pairs::first, Pairs::second)... };
+    return detail::contract_static<typename result::type>(static_cast<const EA&>(x), static_cast<const EB&>(y),
+                                                          pairs, std::integral_constant<bool, result::is_static>());
+}
+
+}               // End namespace ftl
+#endif          // FTL_TENSOR_CONTRACTION_HPP
@@ -23,13 +23,25 @@
 #ifndef FTL_TENSOR_DYNAMIC_CPU_HPP
 #define FTL_TENSOR_DYNAMIC_CPU_HPP
 
+#include "alias.hpp"
+#include "evaluator.hpp"
 #include "mapper.hpp"
+#include "random.hpp"
+#include "tensor_addition.hpp"
+#include "tensor_subtraction.hpp"
+#include "tensor_view_dynamic_cpu.hpp"
 #include "tensor_expression_dynamic_cpu.hpp"        // NOTE: Only including expression specialization for 
                                                     //       dynamic cpu implementation -- all specializations
                                                     //       are provided by tensor_expressions.hpp 
 
+#include <algorithm>
+#include <cstdint>
 #include <initializer_list>
 #include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 // NOTE : Using long template names results in extremely bulky code, so the following abbreviations are
 //        used to reduve the bulk for template parameters:
@@ -43,28 +55,41 @@ namespace ftl {
 template <typename Traits>
 class TensorInterface;
 
-// Type alias for dynamic cpu tensor to make the code more readable
-template <typename DT>
-using DynamicTensorCpu = TensorInterface<TensorTraits<DT, CPU>>;
+// Type alias for dynamic cpu tensor to make the code more readable -- the allocator is optional, and the
+// default (64 byte aligned) allocator gives the same type as a tensor declared without an allocator
+template <typename DT, typename Allocator = AlignedAllocator<DT>>
+using DynamicTensorCpu = TensorInterface<TensorTraits<typename detail::WithAllocator<DT, Allocator>::type, CPU>>;
 
-// Specialization for a tensor using a dynamic container and CPU devices
+// Specialization for a tensor using a dynamic container and CPU devices -- DT may be wrapped with 
+// ftl::Policies to specify the allocator. The layout of the data (column-major by default, row-major or any 
+// strides) is set at runtime.
 template <typename DT>
-class TensorInterface<TensorTraits<DT, CPU>> : public TensorExpression<DynamicTensorCpu<DT> , 
-                                                                       TensorTraits<DT, CPU>> {   
+class TensorInterface<TensorTraits<DT, CPU>> : public TensorExpression<TensorInterface<TensorTraits<DT, CPU>>, 
+                                                                       TensorTraits<DT, CPU>                 > {   
 public:
     // ---------------------------------------- ALIAS'S ----------------------------------------------------- 
     using traits            = TensorTraits<DT, CPU>;
     using container_type    = typename traits::container_type;
+    using allocator_type    = typename traits::allocator_type;
     using data_container    = typename traits::data_container;
     using dim_container     = typename traits::dim_container;
     using data_type         = typename traits::data_type;
     using size_type         = typename traits::size_type;
+    using layout_type       = typename traits::layout_type;
+    using view_type         = TensorView<TensorTraits<data_type, CPU>, data_type>;
+    using const_view_type   = TensorView<TensorTraits<data_type, CPU>, const data_type>;
+    using packet_type       = typename simd::Packet<data_type>::type;
     // ------------------------------------------------------------------------------------------------------
     
+    static constexpr bool vectorizable = true;      //!< Tensors can always be accessed a packet at a time
+    
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Default constructor - sets the data to have no elements, the rank to the specified rank
+    /// @param[in]  rank        The rank of the tensor
+    /// @param[in]  allocator   The allocator to use for the data of the tensor
     // ------------------------------------------------------------------------------------------------------
-    explicit TensorInterface(size_type rank) : _data(0), _rank(rank), _dim_sizes(rank) {}
+    explicit TensorInterface(size_type rank, const allocator_type& allocator = allocator_type()) 
+    : _data(allocator), _layout(rank), _rank(rank) {}
 
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Constructor using vectors to set the dimension sizes and the data of the tensor. Moves the 
@@ -75,12 +100,59 @@ public:
     TensorInterface(dim_container& dim_sizes, data_container& data);
    
     // ------------------------------------------------------------------------------------------------------
-    /// @brief      Constructor using vectors to set the dimension sizes and the data of the tensor. Moves the 
-    ///             data if the data are passed as rvalue references.
+    /// @brief      Constructor which adopts the data for the tensor -- the data is moved into the tensor, so no
+    ///             memory is allocated for the data.
     /// @param      dim_sizes    The sizes of each of the dimensions for the tensor.
-    /// @param      data         The data for the tensor.
+    /// @param      data         The data for the tensor, which must have at least as many elements as the
+    ///             product of the dimension sizes.
+    // ------------------------------------------------------------------------------------------------------
+    TensorInterface(dim_container dim_sizes, data_container&& data);
+
+    TensorInterface(const TensorInterface& other)            = default;
+    TensorInterface& operator=(const TensorInterface& other) = default;
+
     // ------------------------------------------------------------------------------------------------------
-    TensorInterface(dim_container&& dim_sizes, data_container&& data);
+    /// @brief      Move constructor -- takes the data of the other tensor (no memory is allocated), which is 
+    ///             left with rank 0 and no elements.
+    /// @param[in]  other   The tensor to move.
+    // ------------------------------------------------------------------------------------------------------
+    TensorInterface(TensorInterface&& other) noexcept
+    : _data(std::move(other._data)), _layout(std::move(other._layout)), _rank(other._rank) 
+    {
+        other._rank = 0;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Move assignment -- takes the data of the other tensor (no memory is allocated), which is 
+    ///             left with rank 0 and no elements.
+    /// @param[in]  other   The tensor to move.
+    /// @return     A reference to the tensor.
+    // ------------------------------------------------------------------------------------------------------
+    TensorInterface& operator=(TensorInterface&& other) noexcept
+    {
+        if (this != &other) {
+            _data       = std::move(other._data);
+            _layout     = std::move(other._layout);
+            _rank       = other._rank;
+            other._data.clear();
+            other._rank = 0;
+        }
+        return *this;
+    }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor using a container of dimension sizes and any other container (for example a 
+    ///             std::vector with a different allocator) for the data of the tensor. The data is copied.
+    /// @param      dim_sizes    The sizes of each of the dimensions for the tensor.
+    /// @param      data         The data for the tensor, which must have at least as many elements as the
+    ///                          dimension sizes require (otherwise std::invalid_argument is thrown).
+    /// @param      allocator    The allocator to use for the data of the tensor
+    /// @tparam     Container    The type of the container of the data
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Container>
+    TensorInterface(const dim_container&    dim_sizes                       , 
+                    const Container&        data                            , 
+                    const allocator_type&   allocator = allocator_type()    );
     
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Constructor using an initializer list - sets the size of each of the dimensions to the 
@@ -88,8 +160,33 @@ public:
     ///             the dimension sizes. 
     /// @param[in]  dim_sizes    The list of dimension sizes where the nth element in the list sets the size 
     ///             of the nth dimension of the tensor.
+    /// @param[in]  allocator    The allocator to use for the data of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    TensorInterface(std::initializer_list<size_type> dim_sizes, const allocator_type& allocator = allocator_type()); 
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor using an initializer list of dimension sizes and the order (ftl::ColumnMajor,
+    ///             ftl::RowMajor, ftl::Tiled<...> or ftl::MortonTiled<...>) in which the elements are stored in 
+    ///             memory.
+    /// @param[in]  dim_sizes    The list of dimension sizes where the nth element in the list sets the size 
+    ///             of the nth dimension of the tensor.
+    /// @param[in]  order        The order of the elements in memory
+    /// @param[in]  allocator    The allocator to use for the data of the tensor
+    /// @tparam     Order        The type of the order of the elements
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Order, typename = typename std::enable_if<detail::IsLayout<Order>::value>::type>
+    TensorInterface(std::initializer_list<size_type>    dim_sizes                       , 
+                    Order                               order                           , 
+                    const allocator_type&               allocator = allocator_type()    );
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor using a layout (which can have any strides, for example to pad the data) and
+    ///             the data for the tensor, which is moved into the tensor. 
+    /// @param[in]  layout      The layout of the tensor data
+    /// @param[in]  data        The data for the tensor, which must have at least layout.storage_size() 
+    ///             elements
     // ------------------------------------------------------------------------------------------------------
-    TensorInterface(std::initializer_list<size_type> dim_sizes); 
+    TensorInterface(const layout_type& layout, data_container&& data);
    
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Constructor for creation from a tensor expression -- this is only used for simple 
@@ -97,11 +194,49 @@ public:
     ///             and subtraction. Rank modifying expressions-- such as multiplication and slicing -- have 
     ///             specialized constructors (to be implemented).
     /// @param[in]  expression      The expression instance to create the static tensor from
+    /// @param[in]  allocator       The allocator to use for the data of the tensor
     /// @tparam     Expression      The type of the expressionA
     /// @tparam     Traits          The tensor traits of the expression
     // ------------------------------------------------------------------------------------------------------
     template <typename Expression, typename Traits>
-    TensorInterface(const TensorExpression<Expression, Traits>& expression);
+    TensorInterface(const TensorExpression<Expression, Traits>& expression                    , 
+                    const allocator_type&                       allocator = allocator_type()  );
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression into the tensor. If the expression has the same dimension sizes as
+    ///             the tensor then it is evaluated directly into the existing data, unless it reads the data of
+    ///             the tensor at different indices to those which are written (for example a reversed view of
+    ///             the tensor), in which case it is evaluated into a temporary first. Otherwise the tensor takes
+    ///             the dimension sizes of the expression, with new (column-major) data.
+    /// @param[in]  expression      The expression to evaluate
+    /// @tparam     Expression      The type of the expression
+    /// @tparam     Traits          The tensor traits of the expression
+    /// @return     A reference to the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression, typename Traits>
+    TensorInterface& operator=(const TensorExpression<Expression, Traits>& expression);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Adds an expression to the tensor, in place (see operator=)
+    /// @param[in]  expression      The expression to add, which must have the same dimension sizes, or be
+    ///                             able to be broadcast to them
+    /// @tparam     Expression      The type of the expression
+    /// @tparam     Traits          The tensor traits of the expression
+    /// @return     A reference to the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression, typename Traits>
+    TensorInterface& operator+=(const TensorExpression<Expression, Traits>& expression);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Subtracts an expression from the tensor, in place (see operator=)
+    /// @param[in]  expression      The expression to subtract, which must have the same dimension sizes, or
+    ///                             be able to be broadcast to them
+    /// @tparam     Expression      The type of the expression
+    /// @tparam     Traits          The tensor traits of the expression
+    /// @return     A reference to the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression, typename Traits>
+    TensorInterface& operator-=(const TensorExpression<Expression, Traits>& expression);
     
     // ------------------------------------------------------------------------------------------------------
     /// @brief     Gets the rank (number of dimensions) of the tensor.
@@ -113,7 +248,7 @@ public:
     /// @brief     Gets the size (total number of elements) of the tensor
     /// @return    The total number of elements in the tensor.
     // ------------------------------------------------------------------------------------------------------
-    inline size_type size() const { return _data.size(); }
+    inline size_type size() const { return _layout.size(); }
    
     // NOTE: need to add out of range exception here too 
     // ------------------------------------------------------------------------------------------------------
@@ -123,40 +258,114 @@ public:
     /// @return    The number of elements in the requested dimension, if the dimension is a valid dimension
     ///            for the tensor, otherwise 0 is returned.
     // ------------------------------------------------------------------------------------------------------
-    inline size_t size(const int dim) const { return dim < _rank ? _dim_sizes[dim] : 0; }
+    inline size_t size(const int dim) const { return dim < _rank ? _layout.dim_sizes()[dim] : 0; }
     
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets a vector holding the size of each dimension of the tensor.
     /// @return     A vector holding the size of each dimension of the tensor.
     // ------------------------------------------------------------------------------------------------------
-    const dim_container& dim_sizes() const { return _dim_sizes; }
+    const dim_container& dim_sizes() const { return _layout.dim_sizes(); }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the layout (dimension sizes and strides) of the tensor data.
+    /// @return     The layout of the tensor data.
+    // ------------------------------------------------------------------------------------------------------
+    const layout_type& layout() const { return _layout; }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets if the elements of the tensor are stored contiguously in column-major order, in which
+    ///             case the tensor can be accessed a packet at a time.
+    /// @return     If the elements of the tensor are stored contiguously in column-major order.
+    // ------------------------------------------------------------------------------------------------------
+    inline bool contiguous() const { return _layout.contiguous(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the footprint (memory and index mapping) of the tensor data, for alias analysis.
+    /// @return     The footprint of the tensor data.
+    // ------------------------------------------------------------------------------------------------------
+    inline detail::MemoryFootprint footprint() const { return detail::make_footprint(_data.data(), _layout); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the tensor can't be read while memory with a footprint is written.
+    /// @param[in]  target  The footprint of the memory which is written.
+    /// @return     True if evaluating into the target requires a temporary buffer.
+    // ------------------------------------------------------------------------------------------------------
+    inline bool aliases(const detail::MemoryFootprint& target) const { return target.conflicts(footprint()); }
      
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets the tensor data.
     /// @return     The data for the tensor.
     // ------------------------------------------------------------------------------------------------------
     const data_container& data() const { return _data; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Releases the data of the tensor to the caller (without copying it), leaving the tensor 
+    ///             with rank 0 and no elements. The data is in the order of the layout of the tensor.
+    /// @return     The data of the tensor.
+    // ------------------------------------------------------------------------------------------------------
+    data_container release();
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Adopts data for the tensor (without copying it), replacing the dimension sizes and the data
+    ///             of the tensor. The layout of the tensor becomes column-major.
+    /// @param[in]  dim_sizes   The new sizes of the dimensions of the tensor.
+    /// @param[in]  data        The data for the tensor, which must have at least as many elements as the 
+    ///             product of the dimension sizes.
+    // ------------------------------------------------------------------------------------------------------
+    void adopt(dim_container dim_sizes, data_container&& data);
     
     // ------------------------------------------------------------------------------------------------------
-    /// @brief      Initializes each element of the tensor between a range using a uniform ditribution
+    /// @brief      Gets the allocator used for the tensor data.
+    /// @return     A copy of the allocator used for the tensor data.
+    // ------------------------------------------------------------------------------------------------------
+    allocator_type get_allocator() const { return _data.get_allocator(); }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Initializes each element of the tensor between a range using a uniform ditribution, with a
+    ///             seed from std::random_device (see the overload with a distribution to reproduce the values)
     /// @param[in]  min     The minimum value of an element after the initialization
-    /// @param[in]  max     The max value of an element after the initialization
+    /// @param[in]  max     The max value of an element after the initialization (which is included for
+    ///                     integer types)
     // ------------------------------------------------------------------------------------------------------
-    void initialize(const data_type min, const data_type max);
+    void initialize(const data_type min, const data_type max)
+    {
+        initialize(Uniform<data_type>(min, max), detail::random_seed());
+    }
 
     // ------------------------------------------------------------------------------------------------------
-    /// @brief      Gets the element at position i in the tensor's data vector, by refernce
+    /// @brief      Initializes the elements of the tensor with values from a distribution (for example 
+    ///             ftl::Uniform<float>(-1.f, 1.f) or ftl::Normal<float>(0.f, 1.f)), in parallel. The value of 
+    ///             each element only depends on the seed, the stream and its (column-major) index, so the
+    ///             values are the same for any number of threads and any layout.
+    /// @param[in]  distribution    The distribution of the values, in the data type of the tensor
+    /// @param[in]  seed            The seed of the generator
+    /// @param[in]  stream          The stream of the generator, for independent values with the same seed
+    /// @tparam     Distribution    The type of the distribution
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Distribution, typename = typename std::enable_if<detail::IsDistribution<Distribution>::value>::type>
+    void initialize(const Distribution& distribution, std::uint64_t seed, std::uint64_t stream = 0);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the element at (column-major) position i in the tensor, by refernce
     /// @param[in]  i   The index of the element to access.
-    /// @return     The element at position i in the tensor's data vecor.
+    /// @return     The element at position i in the tensor.
     // ------------------------------------------------------------------------------------------------------
-    inline data_type& operator[](size_type i) { return _data[i]; }
+    inline data_type& operator[](size_type i) { return _data[_layout.offset(i)]; }
 
     // ------------------------------------------------------------------------------------------------------
-    /// @brief      Gets the element at position i in the tensor's data vector, by value.
+    /// @brief      Gets the element at (column-major) position i in the tensor, by value.
     /// @param[in]  i   The index of the element to access.
-    /// @return     The element at position i in the tensor's data vector.
+    /// @return     The element at position i in the tensor.
+    // ------------------------------------------------------------------------------------------------------
+    inline const data_type& operator[](size_type i) const { return _data[_layout.offset(i)]; }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets a packet of elements starting at position i in the tensor's data -- only valid when
+    ///             the tensor is contiguous.
+    /// @param[in]  i   The index of the first element in the packet.
+    /// @return     The packet of elements starting at position i in the tensor's data.
     // ------------------------------------------------------------------------------------------------------
-    inline const data_type& operator[](size_type i) const { return _data[i]; }
+    inline packet_type packet(size_type i) const { return simd::Packet<data_type>::loadu(_data.data() + i); }
 
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets the element at a given index for each dimension of a tensor -- there is no bound
@@ -168,7 +377,7 @@ public:
     /// @return     A reference to the element at the position given by the indices
     // ------------------------------------------------------------------------------------------------------
     template <typename IF, typename... IR>
-    DT& operator()(IF index_dim_one, IR... index_dim_other);
+    data_type& operator()(IF index_dim_one, IR... index_dim_other);
    
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets the element at a given index for each dimension of a tensor -- there is no bound
@@ -180,11 +389,87 @@ public:
     /// @return     The value of the element at the position given by the indices
     // ------------------------------------------------------------------------------------------------------
     template <typename IF, typename... IR>
-    DT operator()(IF index_dim_one, IR... index_dim_other) const; 
+    data_type operator()(IF index_dim_one, IR... index_dim_other) const; 
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a view of a slice of the tensor, which refers to the data of the tensor (no data is
+    ///             copied). The view can be used in expressions and assigned to, for example:
+    ///             
+    ///             A.slice(ftl::all, c, ftl::Range(0, 8, 2)) = B.slice(ftl::all, c, ftl::Range(0, 4));
+    ///             
+    ///             The view is only valid while the tensor is alive and is not resized. Tiled tensors
+    ///             can't be sliced, since the elements of a view must be strided.
+    /// @param[in]  specs   The slice specifier for each dimension of the tensor, which is one of:
+    ///                     - ftl::all                      : All of the elements of the dimension
+    ///                     - An index                      : The element at the index (the dimension is removed)
+    ///                     - ftl::Range(start, end, step)  : The elements [start, end) with a step (default 1)
+    ///                     - ftl::StaticRange<S, E, Step>  : A range which is known at compile time
+    /// @tparam     Specs   The types of the slice specifiers
+    /// @return     A view of the slice of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename... Specs>
+    view_type slice(const Specs&... specs)
+    {
+        if (_layout.tiled()) throw std::invalid_argument("ftl::Tensor::slice : tiled tensors can't be sliced");
+        return detail::make_dynamic_view<view_type>(_data.data(), dim_sizes(), _layout.strides(), specs...);
+    }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a view of a slice of a constant tensor, which can't be assigned to.
+    /// @param[in]  specs   The slice specifier for each dimension of the tensor
+    /// @tparam     Specs   The types of the slice specifiers
+    /// @return     A constant view of the slice of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename... Specs>
+    const_view_type slice(const Specs&... specs) const
+    {
+        if (_layout.tiled()) throw std::invalid_argument("ftl::Tensor::slice : tiled tensors can't be sliced");
+        return detail::make_dynamic_view<const_view_type>(_data.data(), dim_sizes(), _layout.strides(), specs...);
+    }
 private:
     data_container      _data;              //!< Data for the tensor
-    dim_container       _dim_sizes;         //!< Sizes of the dimensions for the tensor
+    layout_type         _layout;            //!< Sizes and strides of the dimensions for the tensor
     size_type           _rank;              //!< The rank (number of dimensions) in the tensor
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the tensor has given dimension sizes
+    /// @param[in]  dim_sizes   The dimension sizes to compare with
+    /// @tparam     Container   The type of the container of the dimension sizes
+    /// @return     True if the tensor has the dimension sizes
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Container>
+    bool has_dim_sizes(const Container& dim_sizes) const
+    {
+        return dim_sizes.size() == _rank && std::equal(dim_sizes.begin(), dim_sizes.end(), 
+                                                        _layout.dim_sizes().begin()        );
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression (with the same dimension sizes) into the data of the tensor
+    /// @param[in]  expression      The expression to evaluate
+    /// @tparam     Expression      The type of the expression
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression>
+    void evaluate_from(const Expression& expression)
+    {
+        if (_layout.contiguous())
+            evaluate(_data.data(), expression, size());
+        else if (_layout.tiled())
+            detail::evaluate_into_tiles(_data.data(), expression, _rank, _layout.dim_sizes().data(),
+                                        _layout.tiles().data(), _layout.morton());
+        else
+            evaluate(_data.data(), _layout, expression, size(), _layout.dim_sizes()[0], _layout.strides()[0]);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression (with the same dimension sizes) into the tensor, using a temporary
+    ///             if the expression aliases the tensor data
+    /// @param[in]  expression      The expression to evaluate
+    /// @tparam     Expression      The type of the expression
+    /// @return     A reference to the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression>
+    TensorInterface& assign(const Expression& expression);
 };
 
 // ------------------------------------------- IMPLEMENTATIONS ----------------------------------------------
@@ -192,16 +477,32 @@ private:
 // ----------------------------------------------- PUBLIC ---------------------------------------------------
 
 template <typename DT>
-TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(std::initializer_list<size_type> dim_sizes)
-: _data(std::accumulate(dim_sizes.begin(), dim_sizes.end(), 1, std::multiplies<size_type>())), 
-  _rank(dim_sizes.size())
-{   
-    for (auto& element : dim_sizes) _dim_sizes.push_back(element);
+TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(std::initializer_list<size_type> dim_sizes,
+                                                        const allocator_type&            allocator)
+: _data(std::accumulate(dim_sizes.begin(), dim_sizes.end(), 1, std::multiplies<size_type>()),
+        data_type(), allocator), 
+  _layout(dim_sizes), _rank(dim_sizes.size())
+{}
+
+template <typename DT> template <typename Order, typename>
+TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(std::initializer_list<size_type> dim_sizes,
+                                                        Order                            order    ,
+                                                        const allocator_type&            allocator)
+: _data(layout_type(dim_sizes, order).storage_size(), data_type(), allocator), 
+  _layout(dim_sizes, order), _rank(dim_sizes.size())
+{}
+
+template <typename DT>
+TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(const layout_type& layout, data_container&& data)
+: _data(std::move(data)), _layout(layout), _rank(layout.dim_sizes().size())
+{
+    if (_data.size() < _layout.storage_size())
+        throw std::invalid_argument("ftl::Tensor : data has fewer elements than the layout requires");
 }
 
 template <typename DT>
 TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(dim_container& dim_sizes, data_container& data)
-: _data(data), _rank(dim_sizes.size()), _dim_sizes(dim_sizes)
+: _data(data), _layout(dim_sizes), _rank(dim_sizes.size())
 {
     // TODO: Add exception checking that the number of elements in the data container is the same as the
     //       product of the sizes of the dimensions that were given
@@ -209,40 +510,143 @@ TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(dim_container& dim_sizes
 }
 
 template <typename DT>
-TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(dim_container&& dim_sizes, data_container&& data)
-: _data(data), _rank(dim_sizes.size()), _dim_sizes(dim_sizes)
+TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(dim_container dim_sizes, data_container&& data)
+: _data(std::move(data)), _layout(std::move(dim_sizes)), _rank(_layout.dim_sizes().size())
 {
-    // TODO: Add exception checking that the number of elements in the data container is the same as the
-    //       product of the sizes of the dimensions that were given
-    
+    if (_data.size() < _layout.size())
+        throw std::invalid_argument("ftl::Tensor : data has fewer elements than the dimension sizes require");
+}
+  
+template <typename DT> template <typename Container>
+TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(const dim_container&    dim_sizes   , 
+                                                        const Container&        data        ,
+                                                        const allocator_type&   allocator   )
+: _data(data.begin(), data.end(), allocator), _layout(dim_sizes), _rank(dim_sizes.size())
+{
+    if (_data.size() < _layout.size())
+        throw std::invalid_argument("ftl::Tensor : data has fewer elements than the dimension sizes require");
 }
   
 template <typename DT> template <typename E, typename T> 
-TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(const TensorExpression<E, T>& expression)
-: _data(expression.size()), _dim_sizes(expression.dim_sizes()), _rank(expression.rank())
+TensorInterface<TensorTraits<DT, CPU>>::TensorInterface(const TensorExpression<E, T>& expression,
+                                                        const allocator_type&         allocator )
+: _data(expression.size(), allocator), _layout(expression.dim_sizes()), _rank(expression.rank())
+{
+    // The data is default-initialized (see AlignedAllocator::construct), so the parallel evaluation is the
+    // first to touch it
+    evaluate(_data.data(), static_cast<const E&>(expression), size());
+}
+
+template <typename DT> template <typename E, typename T>
+TensorInterface<TensorTraits<DT, CPU>>& 
+TensorInterface<TensorTraits<DT, CPU>>::operator=(const TensorExpression<E, T>& expression)
+{
+    const E& expr = static_cast<const E&>(expression);
+    if (has_dim_sizes(expr.dim_sizes())) return assign(expr);
+
+    // Different shape -- the data is reused (if it has space for the elements) unless the expression reads
+    // it, in which case the data is only replaced after the evaluation
+    if (!expr.aliases(footprint())) {
+        _layout = layout_type(expr.dim_sizes());
+        _rank   = _layout.dim_sizes().size();
+        _data.resize(_layout.size());
+        evaluate_from(expr);
+        return *this;
+    }
+    return *this = TensorInterface(expression, get_allocator());
+}
+
+template <typename DT> template <typename E, typename T>
+TensorInterface<TensorTraits<DT, CPU>>& 
+TensorInterface<TensorTraits<DT, CPU>>::operator+=(const TensorExpression<E, T>& expression)
+{
+    // The expression can be broadcast to the tensor, but the tensor can't be broadcast to the expression
+    const TensorAddition<TensorInterface, E, traits, T> result(*this, expression);
+    if (!has_dim_sizes(result.dim_sizes())) 
+        throw std::invalid_argument("ftl::Tensor::operator+= : expression has different dimension sizes");
+    return assign(result);
+}
+
+template <typename DT> template <typename E, typename T>
+TensorInterface<TensorTraits<DT, CPU>>& 
+TensorInterface<TensorTraits<DT, CPU>>::operator-=(const TensorExpression<E, T>& expression)
 {
-    for (size_type i = 0; i != size(); ++i) _data[i] = expression[i];
+    // The expression can be broadcast to the tensor, but the tensor can't be broadcast to the expression
+    const TensorSubtraction<TensorInterface, E, traits, T> result(*this, expression);
+    if (!has_dim_sizes(result.dim_sizes())) 
+        throw std::invalid_argument("ftl::Tensor::operator-= : expression has different dimension sizes");
+    return assign(result);
 }
 
 template <typename DT>
-void TensorInterface<TensorTraits<DT, CPU>>::initialize(const data_type min, const data_type max)
+typename TensorInterface<TensorTraits<DT, CPU>>::data_container TensorInterface<TensorTraits<DT, CPU>>::release()
+{
+    data_container data(std::move(_data));
+    _data.clear();
+    _layout = layout_type();
+    _rank   = 0;
+    return data;
+}
+
+template <typename DT>
+void TensorInterface<TensorTraits<DT, CPU>>::adopt(dim_container dim_sizes, data_container&& data)
+{
+    layout_type layout(std::move(dim_sizes));
+    if (data.size() < layout.size())
+        throw std::invalid_argument("ftl::Tensor::adopt : data has fewer elements than the dimension sizes require");
+    _data   = std::move(data);
+    _layout = std::move(layout);
+    _rank   = _layout.dim_sizes().size();
+}
+
+template <typename DT> template <typename Distribution, typename>
+void TensorInterface<TensorTraits<DT, CPU>>::initialize(const Distribution& distribution,
+                                                        std::uint64_t seed, std::uint64_t stream)
 {
-    std::random_device                  rand_device;
-    std::mt19937                        gen(rand_device());
-    std::uniform_real_distribution<>    dist(min, max);
-    for (auto& element : _data) element = static_cast<data_type>(dist(gen));     
+    static_assert(std::is_same<typename Distribution::data_type, data_type>::value,
+                  "The distribution must have the data type of the tensor");
+    if (_layout.contiguous()) {
+        detail::generate_random(_data.data(), size(), distribution, seed, stream);
+    } else {
+        // The values are generated in column-major order, so they don't depend on the layout
+        std::vector<data_type> values(size());
+        detail::generate_random(values.data(), values.size(), distribution, seed, stream);
+        for (size_type i = 0; i < values.size(); ++i) (*this)[i] = values[i];
+    }
 }
 
 template <typename DT> template <typename IF, typename... IR>
-DT& TensorInterface<TensorTraits<DT, CPU>>::operator()(IF dim_one_index, IR... other_dim_indices) 
+typename TensorInterface<TensorTraits<DT, CPU>>::data_type& 
+TensorInterface<TensorTraits<DT, CPU>>::operator()(IF dim_one_index, IR... other_dim_indices) 
 {
-    return _data[DynamicMapper::indices_to_index(_dim_sizes, dim_one_index, other_dim_indices...)];
+    return _data[DynamicMapper::indices_to_index(_layout, dim_one_index, other_dim_indices...)];
 }
 
 template <typename DT> template <typename IF, typename... IR>
-DT TensorInterface<TensorTraits<DT, CPU>>::operator()(IF dim_one_index, IR... other_dim_indices) const
+typename TensorInterface<TensorTraits<DT, CPU>>::data_type 
+TensorInterface<TensorTraits<DT, CPU>>::operator()(IF dim_one_index, IR... other_dim_indices) const
 {
-    return _data[DynamicMapper::indices_to_index(_dim_sizes, dim_one_index, other_dim_indices...)];
+    return _data[DynamicMapper::indices_to_index(_layout, dim_one_index, other_dim_indices...)];
+}
+
+// ----------------------------------------------- PRIVATE --------------------------------------------------
+
+template <typename DT> template <typename E>
+TensorInterface<TensorTraits<DT, CPU>>& TensorInterface<TensorTraits<DT, CPU>>::assign(const E& expression)
+{
+    if (!expression.aliases(footprint())) {
+        evaluate_from(expression);
+        return *this;
+    }
+
+    // The expression reads the data at other indices than those written, so evaluate into a temporary, which
+    // replaces the data if the layout is dense (and is otherwise copied into the data)
+    TensorInterface result(expression, get_allocator());
+    if (_layout.contiguous())
+        _data.swap(result._data);
+    else
+        evaluate_from(result);
+    return *this;
 }
 
 }               // End namespace ftl
@@ -0,0 +1,631 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for elementwise operations (arithmetic, minimum and maximum, and elementary functions)
+///         on tensor expressions for tensor library.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_TENSOR_ELEMENTWISE_HPP
+#define FTL_TENSOR_ELEMENTWISE_HPP
+
+#include "alias.hpp"
+#include "broadcast.hpp"
+#include "tensor_expressions.hpp"
+#include "vector_math.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Tag to select the fast (lower precision) approximations of the elementary functions, for
+///             example ftl::exp(A, ftl::fast_math) -- see vector_math.hpp for the error bounds
+// ----------------------------------------------------------------------------------------------------------
+static constexpr simd::Fast fast_math = simd::Fast();
+
+namespace detail {
+
+// NOTE : Each operation defines apply for a packet type P, which is either a simd::Packet (for the packet
+//        interface of an expression) or a simd::ScalarPacket (for a single element), so that the elements
+//        which are computed one at a time use the same approximations as those computed a packet at a time.
+//        vectorizable<Dtype>() is if the operation can use the packet interface for the data type.
+
+// ------------------------------------------- BINARY OPERATIONS --------------------------------------------
+
+// Multiplies elements
+struct MultiplyOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x, const typename P::type y)
+    {
+        return P::mul(x, y);
+    }
+};
+
+// Divides elements -- the packets only have division for floating point types
+struct DivideOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return std::is_floating_point<Dtype>::value; }
+    template <typename P> static inline typename P::type apply(const typename P::type x, const typename P::type y)
+    {
+        return P::div(x, y);
+    }
+};
+
+// Adds elements
+struct AddOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x, const typename P::type y)
+    {
+        return P::add(x, y);
+    }
+};
+
+// Subtracts elements
+struct SubtractOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x, const typename P::type y)
+    {
+        return P::sub(x, y);
+    }
+};
+
+// Takes the minimum of elements -- the second element if either is NaN
+struct MinimumOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x, const typename P::type y)
+    {
+        return P::min(x, y);
+    }
+};
+
+// Takes the maximum of elements -- the second element if either is NaN
+struct MaximumOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x, const typename P::type y)
+    {
+        return P::max(x, y);
+    }
+};
+
+// Raises elements to the power of other elements
+template <typename Precision>
+struct PowOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x, const typename P::type y)
+    {
+        return simd::pow<P>(x, y, Precision());
+    }
+};
+
+// ------------------------------------------- UNARY OPERATIONS ---------------------------------------------
+
+// Negates elements
+struct NegateOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x) { return P::neg(x); }
+};
+
+// Takes the absolute value of elements
+struct AbsOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x) { return P::abs(x); }
+};
+
+// Takes the square root of elements -- the packets only have square roots for floating point types
+struct SqrtOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return std::is_floating_point<Dtype>::value; }
+    template <typename P> static inline typename P::type apply(const typename P::type x) { return P::sqrt(x); }
+};
+
+// Takes the exponential of elements
+template <typename Precision>
+struct ExpOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x)
+    {
+        return simd::exp<P>(x, Precision());
+    }
+};
+
+// Takes the natural logarithm of elements
+template <typename Precision>
+struct LogOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x)
+    {
+        return simd::log<P>(x, Precision());
+    }
+};
+
+// Takes the hyperbolic tangent of elements
+template <typename Precision>
+struct TanhOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x)
+    {
+        return simd::tanh<P>(x, Precision());
+    }
+};
+
+// Takes the logistic sigmoid of elements
+template <typename Precision>
+struct SigmoidOp {
+    template <typename Dtype> static constexpr bool vectorizable() { return true; }
+    template <typename P> static inline typename P::type apply(const typename P::type x)
+    {
+        return simd::sigmoid<P>(x, Precision());
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     BindRight
+/// @brief      Makes a unary operation from a binary operation by using a scalar as the second operand of
+///             each application, for example A * 2.
+/// @tparam     Op      The binary operation
+/// @tparam     Dtype   The type of the scalar
+// ----------------------------------------------------------------------------------------------------------
+template <typename Op, typename Dtype>
+struct BindRight {
+    Dtype scalar;                                           //!< The second operand of the operation
+
+    template <typename T> static constexpr bool vectorizable() { return Op::template vectorizable<T>(); }
+    template <typename P> inline typename P::type apply(const typename P::type x) const
+    {
+        return Op::template apply<P>(x, P::set1(scalar));
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     BindLeft
+/// @brief      Makes a unary operation from a binary operation by using a scalar as the first operand of
+///             each application, for example 2 / A.
+/// @tparam     Op      The binary operation
+/// @tparam     Dtype   The type of the scalar
+// ----------------------------------------------------------------------------------------------------------
+template <typename Op, typename Dtype>
+struct BindLeft {
+    Dtype scalar;                                           //!< The first operand of the operation
+
+    template <typename T> static constexpr bool vectorizable() { return Op::template vectorizable<T>(); }
+    template <typename P> inline typename P::type apply(const typename P::type x) const
+    {
+        return Op::template apply<P>(P::set1(scalar), x);
+    }
+};
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      TensorUnaryOperation
+/// @brief      Expression class for applying an operation to each element of an expression.
+/// @tparam     E       The expression to apply the operation to
+/// @tparam     T       The traits of the expression
+/// @tparam     Op      The operation to apply to each element
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Op>
+class TensorUnaryOperation : public TensorExpression<TensorUnaryOperation<E, T, Op>, T> {
+public:
+    using traits            = T;
+    using dim_container     = typename traits::dim_container;
+    using size_type         = typename traits::size_type;
+    using data_type         = typename traits::data_type;
+    using packet_type       = typename simd::Packet<data_type>::type;
+
+    // Packets can be used if the expression and the operation can use them, and are of the same type
+    static constexpr bool vectorizable = E::vectorizable && Op::template vectorizable<data_type>() &&
+                                         std::is_same<data_type, typename E::data_type>::value;
+private:
+    typename detail::ExpressionStorage<E>::type _x;     //!< Expression to apply the operation to
+    Op                                          _op;    //!< Operation to apply to each element
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Sets the expression and the operation to apply to it.
+    /// @param[in] x       The expression to apply the operation to.
+    /// @param[in] op      The operation to apply to each element.
+    // ------------------------------------------------------------------------------------------------------
+    TensorUnaryOperation(TensorExpression<E, T> const& x, const Op& op = Op())
+    : _x(static_cast<const E&>(x)), _op(op) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the sizes of the all the dimensions of the expression.
+    /// @return    A constant reference to the dimension size vector of the expression
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _x.dim_sizes(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the size of the expression.
+    /// @return    The size of the expression.
+    // ------------------------------------------------------------------------------------------------------
+    inline const size_type size() const { return _x.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the rank of the expression.
+    /// @return    The rank of the expression.
+    // ------------------------------------------------------------------------------------------------------
+    inline const size_type rank() const { return _x.rank(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets if the expression is stored contiguously, so that packets can be used.
+    /// @return    If the expression is contiguous.
+    // ------------------------------------------------------------------------------------------------------
+    inline bool contiguous() const { return _x.contiguous(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Checks if the expression can't be read while memory with a footprint is written.
+    /// @param[in] target  The footprint of the memory which is written.
+    /// @return    True if evaluating into the target requires a temporary buffer.
+    // ------------------------------------------------------------------------------------------------------
+    inline bool aliases(const detail::MemoryFootprint& target) const { return _x.aliases(target); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Applies the operation to an element of the expression.
+    /// @param[in] i   The element in the expression which must be fetched.
+    /// @return    The result of the operation on the element.
+    // ------------------------------------------------------------------------------------------------------
+    inline data_type operator[](size_type i) const
+    {
+        return _op.template apply<simd::ScalarPacket<data_type>>(_x[i]);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Applies the operation to a packet of the expression.
+    /// @param[in] i   The index of the first element in the packet.
+    /// @return    The result of the operation on the packet.
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const
+    {
+        return _op.template apply<simd::Packet<data_type>>(_x.packet(i));
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      TensorBinaryOperation
+/// @brief      Expression class for applying an operation to the elements of two expressions, element by
+///             element. The expressions are broadcast together (see broadcast.hpp), so the result has the
+///             broadcast shape of the expressions, which is static if both of their shapes are static.
+/// @tparam     E1      The first expression for the operation
+/// @tparam     E2      The second expression for the operation
+/// @tparam     T1      The traits of the first expression
+/// @tparam     T2      The traits if the second expression
+/// @tparam     Op      The operation to apply to each pair of elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E1, typename E2, typename T1, typename T2, typename Op>
+class TensorBinaryOperation : public TensorExpression<TensorBinaryOperation<E1, E2, T1, T2, Op>,
+                                                      typename detail::BroadcastTraits<T1, T2>::type> {
+public:
+    using traits            = typename detail::BroadcastTraits<T1, T2>::type;
+    using dim_container     = typename traits::dim_container;
+    using size_type         = typename traits::size_type;
+    using data_type         = typename traits::data_type;
+    using packet_type       = typename simd::Packet<data_type>::type;
+
+    // Packets can be used if both expressions and the operation can use them, and are of the same type
+    static constexpr bool vectorizable = E1::vectorizable && E2::vectorizable                          &&
+                                         Op::template vectorizable<data_type>()                         &&
+                                         std::is_same<data_type, typename E1::data_type>::value         &&
+                                         std::is_same<data_type, typename E2::data_type>::value;
+private:
+    using x_map             = typename detail::OperandMap<T1, traits>::type;
+    using y_map             = typename detail::OperandMap<T2, traits>::type;
+
+    typename detail::ExpressionStorage<E1>::type _x;    //!< First expression for the operation
+    typename detail::ExpressionStorage<E2>::type _y;    //!< Second expression for the operation
+    detail::BroadcastShape<traits>               _shape;    //!< Shape of the result
+    x_map                                        _x_map;    //!< Map of the result indices to those of x
+    y_map                                        _y_map;    //!< Map of the result indices to those of y
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Sets the expressions for the operation and checks that they can be broadcast together
+    /// @param[in] x       The first expression for the operation.
+    /// @param[in] y       The second expression for the operation.
+    // ------------------------------------------------------------------------------------------------------
+    TensorBinaryOperation(TensorExpression<E1, T1> const& x, TensorExpression<E2, T2> const& y);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the sizes of the all the dimensions of the expression.
+    /// @return    A constant reference to the dimension size vector of the expression
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _shape.dim_sizes(_x.dim_sizes()); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the size of the expression.
+    /// @return    The size of the expression.
+    // ------------------------------------------------------------------------------------------------------
+    inline const size_type size() const { return _shape.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the rank of the expression.
+    /// @return    The rank of the expression.
+    // ------------------------------------------------------------------------------------------------------
+    inline const size_type rank() const { return _shape.rank(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets if both expressions are stored contiguously, so that packets can be used.
+    /// @return    If both expressions are contiguous.
+    // ------------------------------------------------------------------------------------------------------
+    inline bool contiguous() const { return _x.contiguous() && _y.contiguous(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Checks if either expression can't be read while memory with a footprint is written. A
+    ///            broadcast operand reads its elements more than once, so it conflicts with any overlap.
+    /// @param[in] target  The footprint of the memory which is written.
+    /// @return    True if evaluating into the target requires a temporary buffer.
+    // ------------------------------------------------------------------------------------------------------
+    inline bool aliases(const detail::MemoryFootprint& target) const
+    {
+        return _x.aliases(_x_map.identity() ? target : target.unordered()) ||
+               _y.aliases(_y_map.identity() ? target : target.unordered());
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Applies the operation to two elements (one from each expression).
+    /// @param[in] i   The element in the expressions which must be fetched.
+    /// @return    The result of the operation on the elements.
+    // ------------------------------------------------------------------------------------------------------
+    inline data_type operator[](size_type i) const
+    {
+        return Op::template apply<simd::ScalarPacket<data_type>>(_x[_x_map(i)], _y[_y_map(i)]);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Applies the operation to two packets (one from each expression).
+    /// @param[in] i   The index of the first element in the packets.
+    /// @return    The result of the operation on the packets.
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const
+    {
+        using packet = simd::Packet<data_type>;
+        return Op::template apply<packet>(_x_map.template packet<packet>(_x, i),
+                                          _y_map.template packet<packet>(_y, i));
+    }
+};
+
+// ------------------------------------- BINARY OPERATION IMPLEMENTATIONS -----------------------------------
+
+template <typename E1, typename E2, typename T1, typename T2, typename Op>
+TensorBinaryOperation<E1, E2, T1, T2, Op>::TensorBinaryOperation(const TensorExpression<E1, T1>& x,
+                                                                 const TensorExpression<E2, T2>& y)
+: _x(static_cast<const E1&>(x)), _y(static_cast<const E2&>(y)), _shape(_x, _y),
+  _x_map(_x, *this), _y_map(_y, *this)
+{}
+
+// ------------------------------------------- ELEMENTWISE FUNCTIONS ----------------------------------------
+
+// NOTE : The elementary functions are only defined for float and double, and use the accurate approximations
+//        unless ftl::fast_math is given. The minimum and maximum are named so that they don't hide the
+//        reductions ftl::min and ftl::max.
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the exponential of each element of an expression
+/// @param[in]  x           The expression
+/// @param[in]  precision   The precision of the approximation (ftl::fast_math for the fast approximation)
+/// @tparam     E           The type of the expression
+/// @tparam     T           The traits of the expression
+/// @tparam     Precision   The type of the precision tag
+/// @return     An expression for the exponentials of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Precision = simd::Accurate>
+TensorUnaryOperation<E, T, detail::ExpOp<Precision>> exp(const TensorExpression<E, T>& x,
+                                                         Precision = Precision())
+{
+    static_assert(std::is_same<typename T::data_type, float>::value ||
+                  std::is_same<typename T::data_type, double>::value,
+                  "ftl::exp : the exponential is only defined for float and double");
+    return TensorUnaryOperation<E, T, detail::ExpOp<Precision>>(x);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the natural logarithm of each element of an expression
+/// @param[in]  x           The expression
+/// @param[in]  precision   The precision of the approximation (ftl::fast_math for the fast approximation)
+/// @tparam     E           The type of the expression
+/// @tparam     T           The traits of the expression
+/// @tparam     Precision   The type of the precision tag
+/// @return     An expression for the logarithms of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Precision = simd::Accurate>
+TensorUnaryOperation<E, T, detail::LogOp<Precision>> log(const TensorExpression<E, T>& x,
+                                                         Precision = Precision())
+{
+    static_assert(std::is_same<typename T::data_type, float>::value ||
+                  std::is_same<typename T::data_type, double>::value,
+                  "ftl::log : the logarithm is only defined for float and double");
+    return TensorUnaryOperation<E, T, detail::LogOp<Precision>>(x);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the hyperbolic tangent of each element of an expression
+/// @param[in]  x           The expression
+/// @param[in]  precision   The precision of the approximation (ftl::fast_math for the fast approximation)
+/// @tparam     E           The type of the expression
+/// @tparam     T           The traits of the expression
+/// @tparam     Precision   The type of the precision tag
+/// @return     An expression for the hyperbolic tangents of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Precision = simd::Accurate>
+TensorUnaryOperation<E, T, detail::TanhOp<Precision>> tanh(const TensorExpression<E, T>& x,
+                                                           Precision = Precision())
+{
+    static_assert(std::is_same<typename T::data_type, float>::value ||
+                  std::is_same<typename T::data_type, double>::value,
+                  "ftl::tanh : the hyperbolic tangent is only defined for float and double");
+    return TensorUnaryOperation<E, T, detail::TanhOp<Precision>>(x);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the logistic sigmoid, 1 / (1 + exp(-x)), of each element of an expression
+/// @param[in]  x           The expression
+/// @param[in]  precision   The precision of the approximation (ftl::fast_math for the fast approximation)
+/// @tparam     E           The type of the expression
+/// @tparam     T           The traits of the expression
+/// @tparam     Precision   The type of the precision tag
+/// @return     An expression for the sigmoids of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Precision = simd::Accurate>
+TensorUnaryOperation<E, T, detail::SigmoidOp<Precision>> sigmoid(const TensorExpression<E, T>& x,
+                                                                 Precision = Precision())
+{
+    static_assert(std::is_same<typename T::data_type, float>::value ||
+                  std::is_same<typename T::data_type, double>::value,
+                  "ftl::sigmoid : the sigmoid is only defined for float and double");
+    return TensorUnaryOperation<E, T, detail::SigmoidOp<Precision>>(x);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the absolute value of each element of an expression
+/// @param[in]  x   The expression
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     An expression for the absolute values of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorUnaryOperation<E, T, detail::AbsOp> abs(const TensorExpression<E, T>& x)
+{
+    return TensorUnaryOperation<E, T, detail::AbsOp>(x);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the square root of each element of an expression (correctly rounded)
+/// @param[in]  x   The expression
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     An expression for the square roots of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorUnaryOperation<E, T, detail::SqrtOp> sqrt(const TensorExpression<E, T>& x)
+{
+    return TensorUnaryOperation<E, T, detail::SqrtOp>(x);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Raises each element of an expression to the power of the element of another expression
+/// @param[in]  x   The expression of the bases
+/// @param[in]  y           The expression of the exponents
+/// @param[in]  precision   The precision of the approximation (ftl::fast_math for the fast approximation)
+/// @tparam     E1          The type of the expression of the bases
+/// @tparam     E2          The type of the expression of the exponents
+/// @tparam     T1          The traits of the expression of the bases (the traits of the result)
+/// @tparam     T2          The traits of the expression of the exponents
+/// @tparam     Precision   The type of the precision tag
+/// @return     An expression for the powers of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E1, typename E2, typename T1, typename T2, typename Precision = simd::Accurate>
+TensorBinaryOperation<E1, E2, T1, T2, detail::PowOp<Precision>> pow(const TensorExpression<E1, T1>& x,
+                                                                     const TensorExpression<E2, T2>& y,
+                                                                     Precision = Precision())
+{
+    static_assert(std::is_same<typename T1::data_type, float>::value ||
+                  std::is_same<typename T1::data_type, double>::value,
+                  "ftl::pow : the power is only defined for float and double");
+    return TensorBinaryOperation<E1, E2, T1, T2, detail::PowOp<Precision>>(x, y);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Raises each element of an expression to a power
+/// @param[in]  x           The expression of the bases
+/// @param[in]  y           The exponent
+/// @param[in]  precision   The precision of the approximation (ftl::fast_math for the fast approximation)
+/// @tparam     E           The type of the expression
+/// @tparam     T           The traits of the expression
+/// @tparam     Precision   The type of the precision tag
+/// @return     An expression for the powers of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Precision = simd::Accurate>
+TensorUnaryOperation<E, T, detail::BindRight<detail::PowOp<Precision>, typename T::data_type>>
+pow(const TensorExpression<E, T>& x, const typename T::data_type y, Precision = Precision())
+{
+    static_assert(std::is_same<typename T::data_type, float>::value ||
+                  std::is_same<typename T::data_type, double>::value,
+                  "ftl::pow : the power is only defined for float and double");
+    using op_type = detail::BindRight<detail::PowOp<Precision>, typename T::data_type>;
+    return TensorUnaryOperation<E, T, op_type>(x, op_type{y});
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Takes the minimum of the elements of two expressions, element by element (the element of the
+///             second expression if either is NaN)
+/// @param[in]  x   The first expression
+/// @param[in]  y   The second expression
+/// @tparam     E1  The type of the first expression
+/// @tparam     E2  The type of the second expression
+/// @tparam     T1  The traits of the first expression (the traits of the result)
+/// @tparam     T2  The traits of the second expression
+/// @return     An expression for the minimums of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E1, typename E2, typename T1, typename T2>
+TensorBinaryOperation<E1, E2, T1, T2, detail::MinimumOp> minimum(const TensorExpression<E1, T1>& x,
+                                                                 const TensorExpression<E2, T2>& y)
+{
+    return TensorBinaryOperation<E1, E2, T1, T2, detail::MinimumOp>(x, y);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Takes the minimum of each element of an expression and a scalar (the scalar if the element is
+///             NaN), for example ftl::minimum(A, 6.f) to clip A
+/// @param[in]  x   The expression
+/// @param[in]  y   The scalar
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     An expression for the minimums
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorUnaryOperation<E, T, detail::BindRight<detail::MinimumOp, typename T::data_type>>
+minimum(const TensorExpression<E, T>& x, const typename T::data_type y)
+{
+    using op_type = detail::BindRight<detail::MinimumOp, typename T::data_type>;
+    return TensorUnaryOperation<E, T, op_type>(x, op_type{y});
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Takes the maximum of the elements of two expressions, element by element (the element of the
+///             second expression if either is NaN)
+/// @param[in]  x   The first expression
+/// @param[in]  y   The second expression
+/// @tparam     E1  The type of the first expression
+/// @tparam     E2  The type of the second expression
+/// @tparam     T1  The traits of the first expression (the traits of the result)
+/// @tparam     T2  The traits of the second expression
+/// @return     An expression for the maximums of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E1, typename E2, typename T1, typename T2>
+TensorBinaryOperation<E1, E2, T1, T2, detail::MaximumOp> maximum(const TensorExpression<E1, T1>& x,
+                                                                 const TensorExpression<E2, T2>& y)
+{
+    return TensorBinaryOperation<E1, E2, T1, T2, detail::MaximumOp>(x, y);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Takes the maximum of each element of an expression and a scalar (the scalar if the element is
+///             NaN), for example ftl::maximum(A, 0.f) for a rectified linear unit
+/// @param[in]  x   The expression
+/// @param[in]  y   The scalar
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     An expression for the maximums
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorUnaryOperation<E, T, detail::BindRight<detail::MaximumOp, typename T::data_type>>
+maximum(const TensorExpression<E, T>& x, const typename T::data_type y)
+{
+    using op_type = detail::BindRight<detail::MaximumOp, typename T::data_type>;
+    return TensorUnaryOperation<E, T, op_type>(x, op_type{y});
+}
+
+}           // End namespace ftl
+#endif      // FTL_TENSOR_ELEMENTWISE_HPP
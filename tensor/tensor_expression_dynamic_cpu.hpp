@@ -23,6 +23,7 @@
 #ifndef FTL_TENSOR_EXPRESSIONS_DYNAMIC_CPU_HPP
 #define FTL_TENSOR_EXPRESSIONS_DYNAMIC_CPU_HPP
 
+#include "simd.hpp"
 #include "tensor_expression_interface.hpp"
 
 namespace ftl {
@@ -38,6 +39,7 @@ public:
     using container_type    = typename traits::container_type;
     using data_container    = typename traits::data_container;
     using dim_container     = typename traits::dim_container;
+    using packet_type       = typename simd::Packet<data_type>::type;
     // ------------------------------------------------------------------------------------------------------
 
     // ------------------------------------------------------------------------------------------------------
@@ -82,6 +84,13 @@ public:
     // ------------------------------------------------------------------------------------------------------
     const dim_container& dim_sizes() const { return expression()->dim_sizes(); }
 
+    // ------------------------------------------------------------------------------------------------------
+    //! @brief     Gets if all the tensors in the expression are stored contiguously in column-major order,
+    //!            so that the expression can be accessed a packet at a time.
+    //! @return    If all the tensors in the expression are contiguous.
+    // ------------------------------------------------------------------------------------------------------
+    inline bool contiguous() const { return expression()->contiguous(); }
+    
     // ------------------------------------------------------------------------------------------------------
     //! @brief     Gets and element from the Tensor expression data.
     //! @param[in] i   The element in the expression which must be fetched.
@@ -94,7 +103,14 @@ public:
     //! @param[in] i   The element in the expression which must be fetched.
     //! @return    The value of the element at position i of the expression data.
     // ------------------------------------------------------------------------------------------------------
-    inline const data_type& operator[](size_type i) const { return expression()->operator[](i); }
+    inline data_type operator[](size_type i) const { return expression()->operator[](i); }
+
+    // ------------------------------------------------------------------------------------------------------
+    //! @brief     Gets a packet of elements from the Tensor expression data.
+    //! @param[in] i   The index of the first element in the packet which must be fetched.
+    //! @return    The packet of elements starting at position i of the expression data.
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const { return expression()->packet(i); }
 };
             
 }               // End namespace ftl
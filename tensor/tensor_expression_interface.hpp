@@ -48,5 +48,27 @@ namespace ftl {
 template <typename Expression, typename Traits>
 class TensorExpression;
 
+// Forward declaration of the tensor class (specializations are in tensor_<container_type>_<device_type>.hpp)
+template <typename Traits>
+class TensorInterface;
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ExpressionStorage
+/// @brief      Gets the type used by an expression node to hold one of its operands. Tensors own their data
+///             and outlive the expressions which use them, so they are held by reference, while all other
+///             expressions (operation nodes and views) are cheap to copy and are usually temporaries, so they
+///             are held by value -- this allows expressions to be stored (with auto) and evaluated later.
+/// @tparam     Expression  The type of the operand
+// ----------------------------------------------------------------------------------------------------------
+template <typename Expression>
+struct ExpressionStorage { using type = const Expression; };
+
+template <typename Traits>
+struct ExpressionStorage<TensorInterface<Traits>> { using type = const TensorInterface<Traits>&; };
+
+}               // End namespace detail
+
 }           // End namespace ftl       
 #endif      // FTL_TENSOR_EXPRESSION_INTERFACE_HPP
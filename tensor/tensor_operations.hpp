@@ -24,6 +24,9 @@
 #define FTL_TENSOR_OPERATIONS_HPP
 
 #include "tensor_addition.hpp"
+#include "tensor_contraction.hpp"
+#include "tensor_elementwise.hpp"
+#include "tensor_reduction.hpp"
 #include "tensor_subtraction.hpp"
 
 // Unnamed namespace so that operations are available everywhere
@@ -65,5 +68,149 @@ const ftl::TensorSubtraction<E1, E2, T1, T2> operator-(ftl::TensorExpression<E1,
     return ftl::TensorSubtraction<E1, E2, T1, T2>(x, y);
 }
 
+// ----------------------------------------------------------------------------------------------------------    
+/// @brief      Multiplies two tensor expressions element by element
+/// @param[in]  x   The first expression to multiply
+/// @param[in]  y   The second expression to multiply
+/// @return     The result of the elementwise multiplication of the two tensor_expressions.
+/// @tparam     E1  The type of the first expression for the multiplication
+/// @tparam     E2  The type of the second expression for the multiplication
+/// @tparam     T1  The traits of the first expression -- the traits of the returned expression
+/// @tparam     T2  The traits of the second expression
+// ----------------------------------------------------------------------------------------------------------    
+template <typename E1, typename E2, typename T1, typename T2>
+const ftl::TensorBinaryOperation<E1, E2, T1, T2, ftl::detail::MultiplyOp> 
+operator*(ftl::TensorExpression<E1, T1> const& x, ftl::TensorExpression<E2, T2> const& y)    
+{
+    return ftl::TensorBinaryOperation<E1, E2, T1, T2, ftl::detail::MultiplyOp>(x, y);
+}
+
+// ----------------------------------------------------------------------------------------------------------    
+/// @brief      Divides two tensor expressions element by element
+/// @param[in]  x   The expression to divide
+/// @param[in]  y   The expression to divide by
+/// @return     The result of the elementwise division of the two tensor_expressions.
+/// @tparam     E1  The type of the first expression for the division
+/// @tparam     E2  The type of the second expression for the division
+/// @tparam     T1  The traits of the first expression -- the traits of the returned expression
+/// @tparam     T2  The traits of the second expression
+// ----------------------------------------------------------------------------------------------------------    
+template <typename E1, typename E2, typename T1, typename T2>
+const ftl::TensorBinaryOperation<E1, E2, T1, T2, ftl::detail::DivideOp> 
+operator/(ftl::TensorExpression<E1, T1> const& x, ftl::TensorExpression<E2, T2> const& y)    
+{
+    return ftl::TensorBinaryOperation<E1, E2, T1, T2, ftl::detail::DivideOp>(x, y);
+}
+
+// ----------------------------------------------------------------------------------------------------------    
+/// @brief      Negates a tensor expression
+/// @param[in]  x   The expression to negate
+/// @return     The negation of the tensor_expression.
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+// ----------------------------------------------------------------------------------------------------------    
+template <typename E, typename T>
+const ftl::TensorUnaryOperation<E, T, ftl::detail::NegateOp> operator-(ftl::TensorExpression<E, T> const& x)
+{
+    return ftl::TensorUnaryOperation<E, T, ftl::detail::NegateOp>(x);
+}
+
+// NOTE : The operations with a scalar convert the scalar to the data type of the expression, so A * 2 
+//        and 0.5 * A are both valid for a tensor of floats.
+
+// ----------------------------------------------------------------------------------------------------------    
+/// @brief      Applies a binary operation to each element of an expression and a scalar 
+/// @param[in]  x   The expression (the first operand of the operation)
+/// @param[in]  y   The scalar (the second operand of the operation)
+/// @return     The expression for the operation on each element
+/// @tparam     Op  The binary operation
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+// ----------------------------------------------------------------------------------------------------------    
+template <typename Op, typename E, typename T>
+const ftl::TensorUnaryOperation<E, T, ftl::detail::BindRight<Op, typename T::data_type>> 
+scalar_right(ftl::TensorExpression<E, T> const& x, const typename T::data_type y)
+{
+    using op_type = ftl::detail::BindRight<Op, typename T::data_type>;
+    return ftl::TensorUnaryOperation<E, T, op_type>(x, op_type{y});
+}
+
+// ----------------------------------------------------------------------------------------------------------    
+/// @brief      Applies a binary operation to a scalar and each element of an expression
+/// @param[in]  x   The scalar (the first operand of the operation)
+/// @param[in]  y   The expression (the second operand of the operation)
+/// @return     The expression for the operation on each element
+/// @tparam     Op  The binary operation
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+// ----------------------------------------------------------------------------------------------------------    
+template <typename Op, typename E, typename T>
+const ftl::TensorUnaryOperation<E, T, ftl::detail::BindLeft<Op, typename T::data_type>> 
+scalar_left(const typename T::data_type x, ftl::TensorExpression<E, T> const& y)
+{
+    using op_type = ftl::detail::BindLeft<Op, typename T::data_type>;
+    return ftl::TensorUnaryOperation<E, T, op_type>(y, op_type{x});
+}
+
+// Adds an expression and a scalar
+template <typename E, typename T>
+auto operator+(ftl::TensorExpression<E, T> const& x, const typename T::data_type y)
+-> decltype(scalar_right<ftl::detail::AddOp>(x, y))
+{
+    return scalar_right<ftl::detail::AddOp>(x, y);
+}
+
+template <typename E, typename T>
+auto operator+(const typename T::data_type x, ftl::TensorExpression<E, T> const& y)
+-> decltype(scalar_left<ftl::detail::AddOp>(x, y))
+{
+    return scalar_left<ftl::detail::AddOp>(x, y);
+}
+
+// Subtracts a scalar from an expression, or an expression from a scalar
+template <typename E, typename T>
+auto operator-(ftl::TensorExpression<E, T> const& x, const typename T::data_type y)
+-> decltype(scalar_right<ftl::detail::SubtractOp>(x, y))
+{
+    return scalar_right<ftl::detail::SubtractOp>(x, y);
+}
+
+template <typename E, typename T>
+auto operator-(const typename T::data_type x, ftl::TensorExpression<E, T> const& y)
+-> decltype(scalar_left<ftl::detail::SubtractOp>(x, y))
+{
+    return scalar_left<ftl::detail::SubtractOp>(x, y);
+}
+
+// Multiplies an expression by a scalar
+template <typename E, typename T>
+auto operator*(ftl::TensorExpression<E, T> const& x, const typename T::data_type y)
+-> decltype(scalar_right<ftl::detail::MultiplyOp>(x, y))
+{
+    return scalar_right<ftl::detail::MultiplyOp>(x, y);
+}
+
+template <typename E, typename T>
+auto operator*(const typename T::data_type x, ftl::TensorExpression<E, T> const& y)
+-> decltype(scalar_left<ftl::detail::MultiplyOp>(x, y))
+{
+    return scalar_left<ftl::detail::MultiplyOp>(x, y);
+}
+
+// Divides an expression by a scalar, or a scalar by an expression
+template <typename E, typename T>
+auto operator/(ftl::TensorExpression<E, T> const& x, const typename T::data_type y)
+-> decltype(scalar_right<ftl::detail::DivideOp>(x, y))
+{
+    return scalar_right<ftl::detail::DivideOp>(x, y);
+}
+
+template <typename E, typename T>
+auto operator/(const typename T::data_type x, ftl::TensorExpression<E, T> const& y)
+-> decltype(scalar_left<ftl::detail::DivideOp>(x, y))
+{
+    return scalar_left<ftl::detail::DivideOp>(x, y);
+}
+
 }           // End unnamed namespace    
 #endif      // FTL_TENSOR_OPERATIONS_HPP
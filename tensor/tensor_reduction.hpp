@@ -0,0 +1,1150 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for reductions of tensor expressions -- sum, product, minimum, maximum, the indices of
+///         the minimum and maximum, mean, and the L1, L2 and infinity norms -- either over all the elements
+///         of an expression, which gives a single value, or along one dimension, which gives a (lazy)
+///         expression with the dimension removed.
+///
+///         Contiguous elements are reduced with several packet accumulators, and blocks of elements are
+///         combined pairwise so that the rounding error of floating point sums grows with the logarithm of
+///         the number of elements rather than linearly. Reductions along a dimension other than the first
+///         accumulate whole runs of the first dimensions at a time, so that memory is read in the order that
+///         it is stored, and large reductions are split between the threads of the pool. The 16 bit floating
+///         point types (half.hpp) are accumulated in floats, and only the results are rounded.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_TENSOR_REDUCTION_HPP
+#define FTL_TENSOR_REDUCTION_HPP
+
+#include "alias.hpp"
+#include "evaluator.hpp"
+#include "tensor_cast.hpp"
+#include "tensor_expressions.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ftl {
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reductions of contiguous elements reduce blocks of this many packets with independent
+///             accumulators, and then combine the blocks pairwise
+// ----------------------------------------------------------------------------------------------------------
+static constexpr size_t reduction_block_packets = 64;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reductions along a dimension accumulate this many runs of the first dimensions sequentially,
+///             and then combine the partial results pairwise
+// ----------------------------------------------------------------------------------------------------------
+static constexpr size_t reduction_leaf_rows = 16;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      The maximum number of elements of the first dimensions which are accumulated together when
+///             reducing along a dimension other than the first (the width of a tile)
+// ----------------------------------------------------------------------------------------------------------
+static constexpr size_t reduction_tile = 4096;
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      The maximum depth of the pairwise combination of the rows of a reduction along a dimension,
+///             which is enough for any number of rows which can be indexed
+// ----------------------------------------------------------------------------------------------------------
+static constexpr size_t max_reduction_depth = 64;
+
+// ------------------------------------------- COMBINATIONS -------------------------------------------------
+
+// Combines elements by addition
+struct Add {
+    template <typename T> static inline T identity() { return T(0); }
+    template <typename T> static inline T apply(const T x, const T y) { return x + y; }
+    template <typename P> static inline typename P::type packet(const typename P::type x, const typename P::type y)
+    {
+        return P::add(x, y);
+    }
+};
+
+// Combines elements by multiplication
+struct Multiply {
+    template <typename T> static inline T identity() { return T(1); }
+    template <typename T> static inline T apply(const T x, const T y) { return x * y; }
+    template <typename P> static inline typename P::type packet(const typename P::type x, const typename P::type y)
+    {
+        return P::mul(x, y);
+    }
+};
+
+// Combines elements by taking the minimum
+struct Minimum {
+    template <typename T> static inline T identity()
+    {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::max();
+    }
+    template <typename T> static inline T apply(const T x, const T y) { return y < x ? y : x; }
+    template <typename P> static inline typename P::type packet(const typename P::type x, const typename P::type y)
+    {
+        return P::min(x, y);
+    }
+};
+
+// Combines elements by taking the maximum
+struct Maximum {
+    template <typename T> static inline T identity()
+    {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::lowest();
+    }
+    template <typename T> static inline T apply(const T x, const T y) { return x < y ? y : x; }
+    template <typename P> static inline typename P::type packet(const typename P::type x, const typename P::type y)
+    {
+        return P::max(x, y);
+    }
+};
+
+// -------------------------------------------- TRANSFORMS --------------------------------------------------
+
+// Uses the elements as they are
+struct Copy {
+    template <typename T> static inline T apply(const T x) { return x; }
+    template <typename P> static inline typename P::type packet(const typename P::type x) { return x; }
+};
+
+// Uses the absolute values of the elements
+struct Absolute {
+    template <typename T> static inline T apply(const T x) { return x < T(0) ? -x : x; }
+    template <typename P> static inline typename P::type packet(const typename P::type x)
+    {
+        return P::max(x, P::sub(P::set1(typename P::data_type(0)), x));
+    }
+};
+
+// Uses the squares of the elements
+struct Square {
+    template <typename T> static inline T apply(const T x) { return x * x; }
+    template <typename P> static inline typename P::type packet(const typename P::type x) { return P::mul(x, x); }
+};
+
+// -------------------------------------------- FINALIZERS --------------------------------------------------
+
+// Uses the combined result as it is
+struct Keep {
+    template <typename T> static inline T apply(const T x, size_t) { return x; }
+};
+
+// Divides the combined result by the number of elements
+struct Average {
+    template <typename T> static inline T apply(const T x, size_t n) { return n > 0 ? x / static_cast<T>(n) : x; }
+};
+
+// Takes the square root of the combined result
+struct Root {
+    template <typename T> static inline T apply(const T x, size_t) { return static_cast<T>(std::sqrt(x)); }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Reducer
+/// @brief      Defines a reduction as a transform which is applied to each element, an (associative)
+///             combination of the transformed elements, and a finalizer which is applied to the combined
+///             result with the number of elements which were reduced
+/// @tparam     Combine     The combination of the elements (Add, Multiply, Minimum or Maximum)
+/// @tparam     Transform   The transform of each element (Copy, Absolute or Square)
+/// @tparam     Finalize    The finalizer of the result (Keep, Average or Root)
+// ----------------------------------------------------------------------------------------------------------
+template <typename Combine, typename Transform = Copy, typename Finalize = Keep>
+struct Reducer {
+    using combine   = Combine;
+    using transform = Transform;
+    using finalize  = Finalize;
+};
+
+using SumReducer        = Reducer<Add>;
+using ProductReducer    = Reducer<Multiply>;
+using MinReducer        = Reducer<Minimum>;
+using MaxReducer        = Reducer<Maximum>;
+using MeanReducer       = Reducer<Add, Copy, Average>;
+using Norm1Reducer      = Reducer<Add, Absolute>;
+using Norm2Reducer      = Reducer<Add, Square, Root>;
+using NormInfReducer    = Reducer<Maximum, Absolute>;
+
+// Comparisons for the indices of the minimum and maximum -- only strictly better elements replace the best
+// element, so the index of the first of equal elements is found. NaN is better than any number (and no
+// element is better than NaN), so the index of the first NaN is found if there is one.
+struct Less {
+    template <typename T> static inline bool better(const T x, const T y) { return y == y && (x < y || x != x); }
+};
+struct Greater {
+    template <typename T> static inline bool better(const T x, const T y) { return y == y && (y < x || x != x); }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reduces a block of contiguous elements of an expression with four packet accumulators
+/// @param[in]  x           The expression to reduce
+/// @param[in]  begin       The index of the first element in the block
+/// @param[in]  end         The index after the last element in the block
+/// @tparam     R           The reducer
+/// @tparam     Expression  The type of the expression
+/// @return     The combination of the transformed elements (not finalized)
+// ----------------------------------------------------------------------------------------------------------
+template <typename R, typename Expression>
+typename Expression::data_type reduce_block(const Expression& x, size_t begin, size_t end, std::true_type)
+{
+    using data_type = typename Expression::data_type;
+    using packet    = simd::Packet<data_type>;
+    using C         = typename R::combine;
+    using T         = typename R::transform;
+
+    const typename packet::type identity = packet::set1(C::template identity<data_type>());
+    typename packet::type a0 = identity, a1 = identity, a2 = identity, a3 = identity;
+
+    size_t i = begin;
+    for (; i + 4 * packet::size <= end; i += 4 * packet::size) {
+        a0 = C::template packet<packet>(a0, T::template packet<packet>(x.packet(i                   )));
+        a1 = C::template packet<packet>(a1, T::template packet<packet>(x.packet(i +     packet::size)));
+        a2 = C::template packet<packet>(a2, T::template packet<packet>(x.packet(i + 2 * packet::size)));
+        a3 = C::template packet<packet>(a3, T::template packet<packet>(x.packet(i + 3 * packet::size)));
+    }
+    for (; i + packet::size <= end; i += packet::size)
+        a0 = C::template packet<packet>(a0, T::template packet<packet>(x.packet(i)));
+    a0 = C::template packet<packet>(C::template packet<packet>(a0, a1), C::template packet<packet>(a2, a3));
+
+    data_type lanes[packet::size];
+    packet::storeu(lanes, a0);
+    data_type result = lanes[0];
+    for (size_t lane = 1; lane < packet::size; ++lane) result = C::apply(result, lanes[lane]);
+    for (; i < end; ++i) result = C::apply(result, T::apply(static_cast<data_type>(x[i])));
+    return result;
+}
+
+// Scalar case -- for expressions which are not contiguous or can't use packets
+template <typename R, typename Expression>
+typename Expression::data_type reduce_block(const Expression& x, size_t begin, size_t end, std::false_type)
+{
+    using data_type = typename Expression::data_type;
+    using C         = typename R::combine;
+    using T         = typename R::transform;
+
+    data_type a0 = C::template identity<data_type>(), a1 = a0, a2 = a0, a3 = a0;
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        a0 = C::apply(a0, T::apply(static_cast<data_type>(x[i    ])));
+        a1 = C::apply(a1, T::apply(static_cast<data_type>(x[i + 1])));
+        a2 = C::apply(a2, T::apply(static_cast<data_type>(x[i + 2])));
+        a3 = C::apply(a3, T::apply(static_cast<data_type>(x[i + 3])));
+    }
+    for (; i < end; ++i) a0 = C::apply(a0, T::apply(static_cast<data_type>(x[i])));
+    return C::apply(C::apply(a0, a1), C::apply(a2, a3));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reduces contiguous elements of an expression, splitting the range in half (on block boundaries)
+///             until it is a single block, and combining the halves pairwise
+/// @param[in]  x           The expression to reduce
+/// @param[in]  begin       The index of the first element to reduce
+/// @param[in]  end         The index after the last element to reduce
+/// @tparam     R           The reducer
+/// @tparam     Vectorize   If packets are used (std::true_type or std::false_type)
+/// @tparam     Expression  The type of the expression
+/// @return     The combination of the transformed elements (not finalized)
+// ----------------------------------------------------------------------------------------------------------
+template <typename R, typename Vectorize, typename Expression>
+typename Expression::data_type reduce_pairwise(const Expression& x, size_t begin, size_t end)
+{
+    constexpr size_t block = reduction_block_packets * simd::Packet<typename Expression::data_type>::size;
+
+    if (end - begin <= block) return reduce_block<R>(x, begin, end, Vectorize());
+
+    const size_t half = ((end - begin) / 2 + block - 1) / block * block;
+    return R::combine::apply(reduce_pairwise<R, Vectorize>(x, begin, begin + half),
+                             reduce_pairwise<R, Vectorize>(x, begin + half, end  ));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reduces contiguous elements of an expression, using packets if the expression can use them
+/// @param[in]  x           The expression to reduce
+/// @param[in]  begin       The index of the first element to reduce
+/// @param[in]  end         The index after the last element to reduce
+/// @tparam     R           The reducer
+/// @tparam     Expression  The type of the expression
+/// @return     The combination of the transformed elements (not finalized)
+// ----------------------------------------------------------------------------------------------------------
+template <typename R, typename Expression>
+inline typename Expression::data_type reduce_range(const Expression& x, size_t begin, size_t end)
+{
+    using vectorize = std::integral_constant<bool, Expression::vectorizable>;
+    return x.contiguous() ? reduce_pairwise<R, vectorize      >(x, begin, end)
+                          : reduce_pairwise<R, std::false_type>(x, begin, end);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Accumulates a run of contiguous elements of an expression into accumulators
+/// @param[in]  x           The expression to reduce
+/// @param[in]  begin       The index of the first element of the run
+/// @param[in]  width       The number of elements in the run (and accumulators)
+/// @param[in]  acc         The accumulators
+/// @tparam     R           The reducer
+/// @tparam     Expression  The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename R, typename Expression>
+void accumulate_run(const Expression& x, size_t begin, size_t width, typename Expression::data_type* acc,
+                    std::true_type)
+{
+    using packet = simd::Packet<typename Expression::data_type>;
+    using C      = typename R::combine;
+    using T      = typename R::transform;
+
+    size_t k = 0;
+    for (; k + packet::size <= width; k += packet::size) {
+        packet::storeu(acc + k, C::template packet<packet>(packet::loadu(acc + k),
+                                                           T::template packet<packet>(x.packet(begin + k))));
+    }
+    for (; k < width; ++k) acc[k] = C::apply(acc[k], T::apply(x[begin + k]));
+}
+
+// Scalar case -- for expressions which are not contiguous or can't use packets
+template <typename R, typename Expression>
+void accumulate_run(const Expression& x, size_t begin, size_t width, typename Expression::data_type* acc,
+                    std::false_type)
+{
+    using data_type = typename Expression::data_type;
+    for (size_t k = 0; k < width; ++k)
+        acc[k] = R::combine::apply(acc[k], R::transform::apply(static_cast<data_type>(x[begin + k])));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reduces the rows [row_begin, row_end) of a tile into accumulators, where row j of the tile is
+///             the run of width elements starting at index base + j * stride. Runs of reduction_leaf_rows rows
+///             are accumulated in order, and halves are combined pairwise, so the memory of the tile is read in
+///             the order that it is stored. The combination of each element does not depend on the width, so
+///             a tile gives the same results as reducing its elements one at a time.
+/// @param[in]  x           The expression to reduce
+/// @param[in]  base        The index of the first element of the tile
+/// @param[in]  stride      The distance between the first elements of the rows
+/// @param[in]  width       The number of elements in each row
+/// @param[in]  row_begin   The first row to reduce
+/// @param[in]  row_end     The row after the last row to reduce
+/// @param[out] acc         The accumulators (width elements) for the result
+/// @param[in]  scratch     Memory for the partial results, of width * reduction_depth(row_end - row_begin)
+/// @tparam     R           The reducer
+/// @tparam     Vectorize   If packets are used (std::true_type or std::false_type)
+/// @tparam     Expression  The type of the expression
+// ----------------------------------------------------------------------------------------------------------
+template <typename R, typename Vectorize, typename Expression>
+void reduce_rows(const Expression& x, size_t base, size_t stride, size_t width, size_t row_begin, size_t row_end,
+                 typename Expression::data_type* acc, typename Expression::data_type* scratch)
+{
+    using data_type = typename Expression::data_type;
+
+    if (row_end - row_begin <= reduction_leaf_rows) {
+        for (size_t k = 0; k < width; ++k) acc[k] = R::combine::template identity<data_type>();
+        for (size_t j = row_begin; j < row_end; ++j)
+            accumulate_run<R>(x, base + j * stride, width, acc, Vectorize());
+        return;
+    }
+
+    const size_t middle = row_begin + (row_end - row_begin) / 2;
+    reduce_rows<R, Vectorize>(x, base, stride, width, row_begin, middle , acc    , scratch + width);
+    reduce_rows<R, Vectorize>(x, base, stride, width, middle   , row_end, scratch, scratch + width);
+    for (size_t k = 0; k < width; ++k) acc[k] = R::combine::apply(acc[k], scratch[k]);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Gets the depth of the pairwise combination of the rows in reduce_rows
+/// @param[in]  rows    The number of rows
+/// @return     The number of rows of scratch memory required by reduce_rows
+// ----------------------------------------------------------------------------------------------------------
+inline size_t reduction_depth(size_t rows)
+{
+    size_t depth = 1;
+    while (rows > reduction_leaf_rows) { rows = rows - rows / 2; ++depth; }
+    return depth;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Splits a range of work items between the threads of the pool
+/// @param[in]  items       The number of work items
+/// @param[in]  item_size   The (approximate) number of elements read by each work item
+/// @param[in]  function    The function to execute for each chunk of items, as function(begin, end)
+/// @tparam     Function    The type of the function
+// ----------------------------------------------------------------------------------------------------------
+template <typename Function>
+inline void parallel_items(size_t items, size_t item_size, Function&& function)
+{
+    const size_t grain_size = ThreadPool::instance().grain_size() / (item_size > 0 ? item_size : 1);
+    ThreadPool::instance().parallel_for(0, items, function, 1, grain_size > 0 ? grain_size : 1);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reduces all the elements of an expression. Large expressions are split into one contiguous chunk
+///             per thread, and the results of the chunks are combined in order, so the result only depends on
+///             the number of threads.
+/// @param[in]  x           The expression to reduce
+/// @tparam     R           The reducer
+/// @tparam     Expression  The type of the expression
+/// @return     The (finalized) result of the reduction
+// ----------------------------------------------------------------------------------------------------------
+template <typename R, typename Expression>
+typename Expression::data_type reduce_all(const Expression& x)
+{
+    using data_type = typename Expression::data_type;
+
+    const size_t size       = x.size();
+    const size_t alignment  = reduction_block_packets * simd::Packet<data_type>::size;
+    const size_t threads    = ThreadPool::instance().num_threads();
+    const size_t chunks     = std::max(size_t(1), std::min(threads, size / ThreadPool::instance().grain_size()));
+    const size_t chunk_size = ((size + chunks - 1) / chunks + alignment - 1) / alignment * alignment;
+
+    std::vector<data_type> partials(chunks, R::combine::template identity<data_type>());
+    ThreadPool::instance().parallel_for(0, chunks, [&x, &partials, size, chunk_size] (size_t begin, size_t end)
+    {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            const size_t first = std::min(size, chunk * chunk_size);
+            partials[chunk]    = reduce_range<R>(x, first, std::min(size, first + chunk_size));
+        }
+    }, 1, 1);
+
+    data_type result = partials[0];
+    for (size_t chunk = 1; chunk < chunks; ++chunk) result = R::combine::apply(result, partials[chunk]);
+    return R::finalize::apply(result, size);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Finds the (linear) index of the first element of an expression which is better than all
+///             others, in a single pass. Large expressions are split into one contiguous chunk per thread, and
+///             the (value, index) pairs of the chunks are combined in order, so the first best element is found.
+/// @param[in]  x           The expression to search
+/// @param[in]  function    The name of the reduction, for the error message
+/// @tparam     Compare     The comparison which determines the best element (Less or Greater)
+/// @tparam     Expression  The type of the expression
+/// @return     The index of the best element
+// ----------------------------------------------------------------------------------------------------------
+template <typename Compare, typename Expression>
+size_t index_of_best(const Expression& x, const char* function)
+{
+    using data_type = typename Expression::data_type;
+    using candidate = std::pair<data_type, size_t>;
+
+    const size_t size = x.size();
+    if (size == 0)
+        throw std::invalid_argument(std::string("ftl::") + function + " : expression has no elements");
+
+    const size_t threads    = ThreadPool::instance().num_threads();
+    const size_t chunks     = std::max(size_t(1), std::min(threads, size / ThreadPool::instance().grain_size()));
+    const size_t chunk_size = (size + chunks - 1) / chunks;
+
+    // Chunks past the end of the expression keep an index of size, and are not combined
+    std::vector<candidate> partials(chunks, candidate(x[0], size));
+    ThreadPool::instance().parallel_for(0, chunks, [&x, &partials, size, chunk_size] (size_t begin, size_t end)
+    {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            const size_t first = std::min(size, chunk * chunk_size);
+            const size_t last  = std::min(size, first + chunk_size);
+            if (first == last) continue;
+
+            candidate best(x[first], first);
+            for (size_t i = first + 1; i < last && best.first == best.first; ++i) {
+                const data_type value = x[i];
+                if (Compare::better(value, best.first)) best = candidate(value, i);
+            }
+            partials[chunk] = best;
+        }
+    }, 1, 1);
+
+    candidate best = partials[0];
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        if (partials[chunk].second < size && Compare::better(partials[chunk].first, best.first))
+            best = partials[chunk];
+    }
+    return best.second;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     ReductionShape
+/// @brief      The shape of a reduction along a dimension -- the elements of the expression are viewed as
+///             (inner, axis, outer) where inner is the product of the sizes of the dimensions before the
+///             reduced dimension and outer is the product of the sizes after it, and the result has the
+///             dimensions of the expression without the reduced dimension (or a single dimension of size one
+///             if the expression has only one dimension)
+// ----------------------------------------------------------------------------------------------------------
+struct ReductionShape {
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- computes the shape and checks that the dimension exists
+    /// @param[in]  sizes       The sizes of the dimensions of the expression
+    /// @param[in]  rank        The rank of the expression
+    /// @param[in]  axis        The dimension to reduce
+    /// @param[in]  function    The name of the reduction, for the error message
+    /// @tparam     Sizes       The type of the container of sizes
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Sizes>
+    ReductionShape(const Sizes& sizes, size_t rank, size_t axis, const char* function)
+    : inner(1), axis_size(1), outer(1)
+    {
+        if (axis >= rank)
+            throw std::invalid_argument(std::string("ftl::") + function + " : dimension to reduce is out of range");
+        for (size_t i = 0; i < rank; ++i) {
+            if      (i < axis) inner *= sizes[i];
+            else if (i > axis) outer *= sizes[i];
+            if (i != axis) dim_sizes.push_back(sizes[i]);
+        }
+        axis_size = sizes[axis];
+        if (dim_sizes.empty()) dim_sizes.push_back(1);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the index of the element of the expression in the first reduced row of an element of
+    ///             the result
+    /// @param[in]  i   The index of the element of the result
+    /// @return     The index of the first element which is reduced into element i of the result
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t base(size_t i) const { return (i / inner) * inner * axis_size + i % inner; }
+
+    std::vector<size_t>     dim_sizes;      //!< The sizes of the dimensions of the result
+    size_t                  inner;          //!< The number of elements before the reduced dimension
+    size_t                  axis_size;      //!< The size of the reduced dimension
+    size_t                  outer;          //!< The number of elements after the reduced dimension
+};
+
+// Gets the accumulators for a tile of a reduction -- the results themselves, unless the results are
+// accumulated in a different type, in which case a buffer is used
+template <typename Dtype>
+inline Dtype* accumulators(Dtype* results, Dtype*) { return results; }
+
+template <typename Dtype, typename Atype>
+inline Atype* accumulators(Dtype*, Atype* buffer) { return buffer; }
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      TensorReduction
+/// @brief      Expression class for the reduction of an expression along one of its dimensions. Elements (or
+///             packets) of the reduction can be computed one at a time, like any other expression, but when
+///             the reduction is evaluated into contiguous memory the whole result is accumulated one tile at a
+///             time, so the memory of the expression is read in order.
+/// @tparam     E       The expression to reduce
+/// @tparam     T       The traits of the expression
+/// @tparam     R       The reducer (detail::Reducer)
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename R>
+class TensorReduction : public TensorExpression<TensorReduction<E, T, R>,
+                                                TensorTraits<typename T::data_type, CPU>> {
+public:
+    using traits            = TensorTraits<typename T::data_type, CPU>;
+    using dim_container     = typename traits::dim_container;
+    using size_type         = typename traits::size_type;
+    using data_type         = typename traits::data_type;
+    using packet_type       = typename simd::Packet<data_type>::type;
+private:
+    using accumulated       = typename detail::Accumulating<E, T>::type;
+    using accumulate_type   = typename accumulated::data_type;
+public:
+    // Packets can be used if the reduced expression can use them, and is accumulated in the result type
+    static constexpr bool vectorizable = accumulated::vectorizable &&
+                                         std::is_same<data_type, accumulate_type>::value;
+private:
+    using vectorize = std::integral_constant<bool, vectorizable>;
+
+    typename detail::ExpressionStorage<accumulated>::type _x;   //!< The (accumulated) expression to reduce
+    detail::ReductionShape                      _shape;     //!< The shape of the reduction
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Sets the expression to reduce and the dimension to reduce along
+    /// @param[in] x           The expression to reduce
+    /// @param[in] axis        The dimension to reduce
+    /// @param[in] function    The name of the reduction, for error messages
+    // ------------------------------------------------------------------------------------------------------
+    TensorReduction(const TensorExpression<E, T>& x, size_t axis, const char* function)
+    : _x(detail::Accumulating<E, T>::apply(x)), _shape(x.dim_sizes(), x.rank(), axis, function) {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the sizes of the all the dimensions of the result
+    /// @return    A constant reference to the dimension sizes of the result
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _shape.dim_sizes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the number of elements in the result
+    /// @return    The number of elements in the result
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type size() const { return _shape.inner * _shape.outer; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the rank of the result
+    /// @return    The rank of the result
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type rank() const { return _shape.dim_sizes.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets if the reduced expression is contiguous, so that packets can be used
+    /// @return    If the reduced expression is contiguous
+    // ------------------------------------------------------------------------------------------------------
+    inline bool contiguous() const { return _x.contiguous(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Checks if the reduced expression reads any of the memory with a footprint, since each
+    ///            element of the result depends on many elements of the expression
+    /// @param[in] target  The footprint of the memory which is written
+    /// @return    True if evaluating into the target requires a temporary buffer
+    // ------------------------------------------------------------------------------------------------------
+    inline bool aliases(const detail::MemoryFootprint& target) const { return _x.aliases(target.unordered()); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Computes an element of the result
+    /// @param[in] i   The index of the element of the result
+    /// @return    The reduction of the elements of the expression which give element i of the result
+    // ------------------------------------------------------------------------------------------------------
+    inline data_type operator[](size_type i) const
+    {
+        if (_shape.inner == 1) {
+            const size_t begin = i * _shape.axis_size;
+            return R::finalize::apply(detail::reduce_range<R>(_x, begin, begin + _shape.axis_size),
+                                      _shape.axis_size);
+        }
+        accumulate_type result, scratch[detail::max_reduction_depth];
+        detail::reduce_rows<R, std::false_type>(_x, _shape.base(i), _shape.inner, 1, 0, _shape.axis_size,
+                                                &result, scratch);
+        return R::finalize::apply(result, _shape.axis_size);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Computes a packet of elements of the result -- when the elements are in the same run of the
+    ///            dimensions before the reduced dimension, the packet is accumulated from packets of the
+    ///            expression
+    /// @param[in] i   The index of the first element in the packet
+    /// @return    The packet of results
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const
+    {
+        using packet = simd::Packet<data_type>;
+
+        data_type result[packet::size];
+        if (_shape.inner > 1 && i % _shape.inner + packet::size <= _shape.inner) {
+            data_type scratch[packet::size * detail::max_reduction_depth];
+            detail::reduce_rows<R, vectorize>(_x, _shape.base(i), _shape.inner, packet::size, 0, _shape.axis_size,
+                                              result, scratch);
+            for (size_t k = 0; k < packet::size; ++k) result[k] = R::finalize::apply(result[k], _shape.axis_size);
+        } else {
+            for (size_t k = 0; k < packet::size; ++k) result[k] = (*this)[i + k];
+        }
+        return packet::loadu(result);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Evaluates the whole result into contiguous memory. Reductions along the first dimension
+    ///            reduce each contiguous run in parallel, and other reductions accumulate tiles of the runs of
+    ///            the dimensions before the reduced dimension, one row after the other, in parallel.
+    /// @param[in] out     A pointer to the memory for the result
+    // ------------------------------------------------------------------------------------------------------
+    void evaluate_into(data_type* out) const
+    {
+        const detail::ReductionShape& shape = _shape;
+        const auto& x = _x;
+
+        if (shape.inner == 1) {
+            detail::parallel_items(shape.outer, shape.axis_size, [out, &x, &shape] (size_t begin, size_t end)
+            {
+                for (size_t o = begin; o < end; ++o) {
+                    const size_t first = o * shape.axis_size;
+                    out[o] = R::finalize::apply(detail::reduce_range<R>(x, first, first + shape.axis_size),
+                                                shape.axis_size);
+                }
+            });
+            return;
+        }
+
+        const size_t tile  = std::min(shape.inner, detail::reduction_tile);
+        const size_t tiles = (shape.inner + tile - 1) / tile;
+        const bool   vector = x.contiguous();
+
+        detail::parallel_items(shape.outer * tiles, tile * shape.axis_size,
+            [out, &x, &shape, tile, tiles, vector] (size_t begin, size_t end)
+            {
+                std::vector<accumulate_type> scratch(tile * detail::reduction_depth(shape.axis_size));
+                std::vector<accumulate_type> buffer(std::is_same<data_type, accumulate_type>::value ? 0 : tile);
+                for (size_t item = begin; item < end; ++item) {
+                    const size_t o      = item / tiles;
+                    const size_t first  = (item % tiles) * tile;
+                    const size_t width  = std::min(tile, shape.inner - first);
+                    const size_t base   = o * shape.inner * shape.axis_size + first;
+                    data_type*   result = out + o * shape.inner + first;
+                    auto*        acc    = detail::accumulators(result, buffer.data());
+
+                    if (vector)
+                        detail::reduce_rows<R, vectorize>(x, base, shape.inner, width, 0, shape.axis_size,
+                                                          acc, scratch.data());
+                    else
+                        detail::reduce_rows<R, std::false_type>(x, base, shape.inner, width, 0, shape.axis_size,
+                                                                acc, scratch.data());
+                    for (size_t k = 0; k < width; ++k) result[k] = R::finalize::apply(acc[k], shape.axis_size);
+                }
+            });
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      TensorIndexReduction
+/// @brief      Expression class for the indices of the minimum or maximum elements along one dimension of an
+///             expression -- each element of the result is the index (in the reduced dimension) of the first
+///             best element. As for TensorReduction, evaluating the whole result reads the memory in order.
+/// @tparam     E       The expression to reduce
+/// @tparam     T       The traits of the expression
+/// @tparam     Compare The comparison which determines the best element (detail::Less or detail::Greater)
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Compare>
+class TensorIndexReduction : public TensorExpression<TensorIndexReduction<E, T, Compare>,
+                                                     TensorTraits<size_t, CPU>> {
+public:
+    using traits            = TensorTraits<size_t, CPU>;
+    using dim_container     = typename traits::dim_container;
+    using size_type         = typename traits::size_type;
+    using data_type         = typename traits::data_type;
+    using value_type        = typename T::data_type;
+    using packet_type       = typename simd::Packet<data_type>::type;
+
+    static constexpr bool vectorizable = false;             //!< Indices are computed an element at a time
+private:
+    typename detail::ExpressionStorage<E>::type _x;         //!< The expression to reduce
+    detail::ReductionShape                      _shape;     //!< The shape of the reduction
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Sets the expression to reduce and the dimension to reduce along
+    /// @param[in] x           The expression to reduce
+    /// @param[in] axis        The dimension to reduce
+    /// @param[in] function    The name of the reduction, for error messages
+    // ------------------------------------------------------------------------------------------------------
+    TensorIndexReduction(const TensorExpression<E, T>& x, size_t axis, const char* function)
+    : _x(static_cast<const E&>(x)), _shape(x.dim_sizes(), x.rank(), axis, function)
+    {
+        if (_shape.axis_size == 0)
+            throw std::invalid_argument(std::string("ftl::") + function + " : dimension to reduce is empty");
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets the sizes of the all the dimensions of the result
+    /// @return    A constant reference to the dimension sizes of the result
+    // ------------------------------------------------------------------------------------------------------
+    inline const dim_container& dim_sizes() const { return _shape.dim_sizes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the number of elements in the result
+    /// @return    The number of elements in the result
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type size() const { return _shape.inner * _shape.outer; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Returns the rank of the result
+    /// @return    The rank of the result
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type rank() const { return _shape.dim_sizes.size(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Gets if the reduced expression is contiguous
+    /// @return    If the reduced expression is contiguous
+    // ------------------------------------------------------------------------------------------------------
+    inline bool contiguous() const { return _x.contiguous(); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Checks if the reduced expression reads any of the memory with a footprint
+    /// @param[in] target  The footprint of the memory which is written
+    /// @return    True if evaluating into the target requires a temporary buffer
+    // ------------------------------------------------------------------------------------------------------
+    inline bool aliases(const detail::MemoryFootprint& target) const { return _x.aliases(target.unordered()); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Computes an element of the result
+    /// @param[in] i   The index of the element of the result
+    /// @return    The index of the first best element which gives element i of the result
+    // ------------------------------------------------------------------------------------------------------
+    inline data_type operator[](size_type i) const
+    {
+        const size_t base = _shape.base(i);
+        value_type   best = _x[base];
+        size_t       index = 0;
+        for (size_t j = 1; j < _shape.axis_size; ++j) {
+            const value_type value = _x[base + j * _shape.inner];
+            if (Compare::better(value, best)) { best = value; index = j; }
+        }
+        return index;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Computes a packet of elements of the result (a single element)
+    /// @param[in] i   The index of the element
+    /// @return    The packet with the element
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const { return (*this)[i]; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief     Evaluates the whole result into contiguous memory, a tile of the runs of the dimensions
+    ///            before the reduced dimension at a time, in parallel
+    /// @param[in] out     A pointer to the memory for the result
+    // ------------------------------------------------------------------------------------------------------
+    void evaluate_into(data_type* out) const
+    {
+        const detail::ReductionShape& shape = _shape;
+        const auto& x = _x;
+
+        const size_t tile  = std::min(shape.inner, detail::reduction_tile);
+        const size_t tiles = (shape.inner + tile - 1) / tile;
+
+        detail::parallel_items(shape.outer * tiles, tile * shape.axis_size,
+            [this, out, &x, &shape, tile, tiles] (size_t begin, size_t end)
+            {
+                std::vector<value_type> best(tile);
+                for (size_t item = begin; item < end; ++item) {
+                    const size_t o     = item / tiles;
+                    const size_t first = (item % tiles) * tile;
+                    const size_t width = std::min(tile, shape.inner - first);
+                    const size_t base  = o * shape.inner * shape.axis_size + first;
+                    data_type*   index = out + o * shape.inner + first;
+
+                    if (shape.inner == 1) { *index = (*this)[o]; continue; }
+
+                    for (size_t k = 0; k < width; ++k) { best[k] = x[base + k]; index[k] = 0; }
+                    for (size_t j = 1; j < shape.axis_size; ++j) {
+                        const size_t row = base + j * shape.inner;
+                        for (size_t k = 0; k < width; ++k) {
+                            const value_type value = x[row + k];
+                            if (Compare::better(value, best[k])) { best[k] = value; index[k] = j; }
+                        }
+                    }
+                }
+            });
+    }
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates a reduction along a dimension into contiguous memory, reading the reduced expression
+///             in the order it is stored (rather than one element of the result at a time)
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The reduction to evaluate
+/// @param[in]  size        The number of elements to evaluate (unused -- the reduction knows its size)
+/// @tparam     E           The type of the reduced expression
+/// @tparam     T           The traits of the reduced expression
+/// @tparam     R           The reducer
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename R>
+inline void evaluate(typename TensorReduction<E, T, R>::data_type* out, const TensorReduction<E, T, R>& expression,
+                     size_t)
+{
+    expression.evaluate_into(out);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates the indices of the best elements along a dimension into contiguous memory, reading
+///             the reduced expression in the order it is stored
+/// @param[in]  out         A pointer to the memory to write the results to
+/// @param[in]  expression  The reduction to evaluate
+/// @param[in]  size        The number of elements to evaluate (unused -- the reduction knows its size)
+/// @tparam     E           The type of the reduced expression
+/// @tparam     T           The traits of the reduced expression
+/// @tparam     Compare     The comparison for the best element
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T, typename Compare>
+inline void evaluate(size_t* out, const TensorIndexReduction<E, T, Compare>& expression, size_t)
+{
+    expression.evaluate_into(out);
+}
+
+// ------------------------------------------ FULL REDUCTIONS -----------------------------------------------
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the sum of all the elements of an expression
+/// @param[in]  x   The expression to reduce
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The sum of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+typename T::data_type sum(const TensorExpression<E, T>& x)
+{
+    return detail::reduce_all<detail::SumReducer>(detail::Accumulating<E, T>::apply(x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the product of all the elements of an expression
+/// @param[in]  x   The expression to reduce
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The product of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+typename T::data_type prod(const TensorExpression<E, T>& x)
+{
+    return detail::reduce_all<detail::ProductReducer>(detail::Accumulating<E, T>::apply(x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the minimum of all the elements of an expression
+/// @param[in]  x   The expression to reduce
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The minimum element
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+typename T::data_type min(const TensorExpression<E, T>& x)
+{
+    return detail::reduce_all<detail::MinReducer>(detail::Accumulating<E, T>::apply(x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the maximum of all the elements of an expression
+/// @param[in]  x   The expression to reduce
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The maximum element
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+typename T::data_type max(const TensorExpression<E, T>& x)
+{
+    return detail::reduce_all<detail::MaxReducer>(detail::Accumulating<E, T>::apply(x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the mean of all the elements of an expression
+/// @param[in]  x   The expression to reduce
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The mean of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+typename T::data_type mean(const TensorExpression<E, T>& x)
+{
+    return detail::reduce_all<detail::MeanReducer>(detail::Accumulating<E, T>::apply(x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the L1 norm (the sum of the absolute values) of all the elements of an expression
+/// @param[in]  x   The expression to reduce
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The L1 norm of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+typename T::data_type norm1(const TensorExpression<E, T>& x)
+{
+    return detail::reduce_all<detail::Norm1Reducer>(detail::Accumulating<E, T>::apply(x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the L2 (Euclidean) norm of all the elements of an expression
+/// @param[in]  x   The expression to reduce
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The L2 norm of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+typename T::data_type norm2(const TensorExpression<E, T>& x)
+{
+    return detail::reduce_all<detail::Norm2Reducer>(detail::Accumulating<E, T>::apply(x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the infinity norm (the maximum absolute value) of all the elements of an expression
+/// @param[in]  x   The expression to reduce
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The infinity norm of the elements
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+typename T::data_type norm_inf(const TensorExpression<E, T>& x)
+{
+    return detail::reduce_all<detail::NormInfReducer>(detail::Accumulating<E, T>::apply(x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Finds the (linear, column-major) index of the first minimum element of an expression, or of the
+///             first NaN if there is one
+/// @param[in]  x   The expression to search
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The index of the minimum element
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+size_t argmin(const TensorExpression<E, T>& x)
+{
+    return detail::index_of_best<detail::Less>(static_cast<const E&>(x), "argmin");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Finds the (linear, column-major) index of the first maximum element of an expression, or of the
+///             first NaN if there is one
+/// @param[in]  x   The expression to search
+/// @tparam     E   The type of the expression
+/// @tparam     T   The traits of the expression
+/// @return     The index of the maximum element
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+size_t argmax(const TensorExpression<E, T>& x)
+{
+    return detail::index_of_best<detail::Greater>(static_cast<const E&>(x), "argmax");
+}
+
+// ------------------------------------------ AXIS REDUCTIONS -----------------------------------------------
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Sums the elements of an expression along a dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the sums, with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorReduction<E, T, detail::SumReducer> sum(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorReduction<E, T, detail::SumReducer>(x, axis, "sum");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Multiplies the elements of an expression along a dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the products, with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorReduction<E, T, detail::ProductReducer> prod(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorReduction<E, T, detail::ProductReducer>(x, axis, "prod");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Finds the minimum elements of an expression along a dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the minimums, with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorReduction<E, T, detail::MinReducer> min(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorReduction<E, T, detail::MinReducer>(x, axis, "min");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Finds the maximum elements of an expression along a dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the maximums, with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorReduction<E, T, detail::MaxReducer> max(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorReduction<E, T, detail::MaxReducer>(x, axis, "max");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the means of the elements of an expression along a dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the means, with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorReduction<E, T, detail::MeanReducer> mean(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorReduction<E, T, detail::MeanReducer>(x, axis, "mean");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the L1 norms of an expression along a dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the norms, with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorReduction<E, T, detail::Norm1Reducer> norm1(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorReduction<E, T, detail::Norm1Reducer>(x, axis, "norm1");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the L2 norms of an expression along a dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the norms, with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorReduction<E, T, detail::Norm2Reducer> norm2(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorReduction<E, T, detail::Norm2Reducer>(x, axis, "norm2");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the infinity norms of an expression along a dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the norms, with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorReduction<E, T, detail::NormInfReducer> norm_inf(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorReduction<E, T, detail::NormInfReducer>(x, axis, "norm_inf");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Finds the indices of the first minimum elements (or the first NaNs) of an expression along a
+///             dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the indices (in the reduced dimension), with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorIndexReduction<E, T, detail::Less> argmin(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorIndexReduction<E, T, detail::Less>(x, axis, "argmin");
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Finds the indices of the first maximum elements (or the first NaNs) of an expression along a
+///             dimension
+/// @param[in]  x       The expression to reduce
+/// @param[in]  axis    The dimension to reduce
+/// @tparam     E       The type of the expression
+/// @tparam     T       The traits of the expression
+/// @return     An expression for the indices (in the reduced dimension), with the dimension removed
+// ----------------------------------------------------------------------------------------------------------
+template <typename E, typename T>
+TensorIndexReduction<E, T, detail::Greater> argmax(const TensorExpression<E, T>& x, size_t axis)
+{
+    return TensorIndexReduction<E, T, detail::Greater>(x, axis, "argmax");
+}
+
+}               // End namespace ftl
+#endif          // FTL_TENSOR_REDUCTION_HPP
@@ -24,12 +24,23 @@
 #define FTL_TENSOR_STATIC_CPU_HPP
 
 #include <iostream>
+#include "alias.hpp"
+#include "evaluator.hpp"
 #include "mapper.hpp"
+#include "random.hpp"
+#include "tensor_addition.hpp"
+#include "tensor_subtraction.hpp"
+#include "tensor_view_static_cpu.hpp"
 #include "tensor_expression_static_cpu.hpp"         // NOTE: Only including expression specialization for 
                                                     //       static cpu implementation -- all specializations
                                                     //       are provided by tensor_expressions.hpp 
                                                 
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 // NOTE : Using long template names results in extremely bulky code, so the following abbreviations are
 //        used to reduve the bulk for template parameters:
@@ -46,7 +57,8 @@ class TensorInterface;
 template <typename DT, size_t SF, size_t... SR>
 using StaticTensorCpu = TensorInterface<TensorTraits<DT, CPU, SF, SR...>>;
 
-// Specialization for a tensor using a static container and a CPU device
+// Specialization for a tensor using a static container and a CPU device -- DT may be wrapped with 
+// ftl::Policies to specify the layout (ftl::ColumnMajor or ftl::RowMajor) of the data
 template <typename DT, size_t SF, size_t... SR>
 class TensorInterface<TensorTraits<DT, CPU, SF, SR...>> : public TensorExpression<
                                                                     StaticTensorCpu<DT, SF, SR...>  , 
@@ -59,27 +71,33 @@ public:
     using container_type    = typename traits::container_type;
     using data_container    = typename container_type::data_container;    
     using dim_container     = typename container_type::dim_container;    
+    using layout_type       = typename traits::layout_type;
+    using packet_type       = typename simd::Packet<data_type>::type;
     // ------------------------------------------------------------------------------------------------------
     
+    static constexpr bool vectorizable = true;      //!< Tensors can always be accessed a packet at a time
+    
     // ------------------------------------------------------------------------------------------------------
-    /// @brief      Default constructor, converts the compile time list of dimension sizes to an array
+    /// @brief      Default constructor -- the elements of tensors with inline storage are not initialized (use
+    ///             T{} for zeros), while the elements of tensors with heap storage are zero
     // ------------------------------------------------------------------------------------------------------
-    TensorInterface();
+    TensorInterface() = default;
     
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Constructor for when the data is given as an lvalue 
     /// @param[in]  data    The data to use for the tensor
     // ------------------------------------------------------------------------------------------------------
-    TensorInterface(data_container& data);
+    constexpr TensorInterface(data_container& data);
    
     // ------------------------------------------------------------------------------------------------------
-    /// @brief      Constructor for when the data is specified as a literal list
+    /// @brief      Constructor for when the data is specified as a literal list, in the order of the layout,
+    ///             which can be used in constant expressions
     /// @param[in]  first_value     The first value in the literal list -- must be data_type
     /// @param[in]  other_values    The other values which make up the data
     /// @tparam     TR              The type of the rest of the values
     // ------------------------------------------------------------------------------------------------------
     template <typename... TR>
-    TensorInterface(DT&& first_value, TR&&... other_values);
+    constexpr TensorInterface(data_type&& first_value, TR&&... other_values);
 
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Constructor for creation from a tensor expression -- this is only used for simple 
@@ -91,6 +109,56 @@ public:
     // ------------------------------------------------------------------------------------------------------
     template <typename Expression, typename Traits>
     TensorInterface(const TensorExpression<Expression, Traits>& expression);
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression directly into the data of the tensor, unless the expression reads
+    ///             the data of the tensor at different indices to those which are written (for example a
+    ///             reversed view of the tensor), in which case it is evaluated into a temporary first.
+    /// @param[in]  expression      The expression to evaluate, which must have the same size as the tensor
+    /// @tparam     Expression      The type of the expression
+    /// @tparam     Traits          The tensor traits of the expression
+    /// @return     A reference to the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression, typename Traits>
+    TensorInterface& operator=(const TensorExpression<Expression, Traits>& expression)
+    {
+        check_dim_sizes<Traits>(expression);
+        return assign(static_cast<const Expression&>(expression));
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Adds an expression to the tensor, in place (see operator=)
+    /// @param[in]  expression      The expression to add, which must have the same size as the tensor, or
+    ///                             be able to be broadcast to it
+    /// @tparam     Expression      The type of the expression
+    /// @tparam     Traits          The tensor traits of the expression
+    /// @return     A reference to the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression, typename Traits>
+    TensorInterface& operator+=(const TensorExpression<Expression, Traits>& expression)
+    {
+        using result_type = TensorAddition<TensorInterface, Expression, traits, Traits>;
+        const result_type result(*this, expression);
+        check_dim_sizes<typename result_type::traits>(result);
+        return assign(result);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Subtracts an expression from the tensor, in place (see operator=)
+    /// @param[in]  expression      The expression to subtract, which must have the same size as the tensor,
+    ///                             or be able to be broadcast to it
+    /// @tparam     Expression      The type of the expression
+    /// @tparam     Traits          The tensor traits of the expression
+    /// @return     A reference to the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression, typename Traits>
+    TensorInterface& operator-=(const TensorExpression<Expression, Traits>& expression)
+    {
+        using result_type = TensorSubtraction<TensorInterface, Expression, traits, Traits>;
+        const result_type result(*this, expression);
+        check_dim_sizes<typename result_type::traits>(result);
+        return assign(result);
+    }
     
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets the rank (number of dimensions) of the tensor
@@ -102,7 +170,7 @@ public:
     /// @brief      Gets the size (total number of elements) in the tensor
     /// @return     The size of the tensor
     // ------------------------------------------------------------------------------------------------------
-    constexpr size_type size() const { return _data.size(); }
+    constexpr size_type size() const { return layout_type::num_elements; }
  
     // TODO: Add out of range exception
     // ------------------------------------------------------------------------------------------------------
@@ -111,34 +179,89 @@ public:
     /// @param[in]  dim     The dimension to get the size of
     /// @return     The size of the requested dimension of the tensor if valid, otherwise 0
     // ------------------------------------------------------------------------------------------------------
-    inline size_type size(const size_type dim) const { return dim < rank() ? _dim_sizes[dim] : 0; }  
+    constexpr size_type size(const size_type dim) const 
+    { 
+        return dim < rank() ? static_dim_sizes()[dim] : 0; 
+    }
     
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets a reference to the container holding the sizes of the dimensions for the tensor
     /// @return     A constant reference to the dimension sizes of the tensor
     // ------------------------------------------------------------------------------------------------------
-    constexpr const dim_container& dim_sizes() const { return _dim_sizes; }
+    constexpr const dim_container& dim_sizes() const { return static_dim_sizes(); }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets if the elements of the tensor are stored contiguously in column-major order, in which
+    ///             case the tensor can be accessed a packet at a time.
+    /// @return     If the elements of the tensor are stored contiguously in column-major order.
+    // ------------------------------------------------------------------------------------------------------
+    constexpr bool contiguous() const { return layout_type::contiguous; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the footprint (memory and index mapping) of the tensor data, for alias analysis
+    /// @return     The footprint of the tensor data
+    // ------------------------------------------------------------------------------------------------------
+    inline detail::MemoryFootprint footprint() const { return detail::make_footprint<layout_type>(_data.data()); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the tensor can't be read while memory with a footprint is written
+    /// @param[in]  target  The footprint of the memory which is written
+    /// @return     True if evaluating into the target requires a temporary buffer
+    // ------------------------------------------------------------------------------------------------------
+    inline bool aliases(const detail::MemoryFootprint& target) const { return target.conflicts(footprint()); }
     
     // ------------------------------------------------------------------------------------------------------
-    /// @brief      Initializes each element of the tensor between a range using a uniform ditribution
+    /// @brief      Gets the tensor data.
+    /// @return     The data for the tensor, in the order of the layout.
+    // ------------------------------------------------------------------------------------------------------
+    data_container& data() { return _data; }
+    const data_container& data() const { return _data; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Initializes each element of the tensor between a range using a uniform ditribution, with a
+    ///             seed from std::random_device (see the overload with a distribution to reproduce the values)
     /// @param[in]  min     The minimum value of an element after the initialization
-    /// @param[in]  max     The max value of an element after the initialization
+    /// @param[in]  max     The max value of an element after the initialization (which is included for
+    ///                     integer types)
+    // ------------------------------------------------------------------------------------------------------
+    void initialize(const data_type min, const data_type max)
+    {
+        initialize(Uniform<data_type>(min, max), detail::random_seed());
+    }
+
     // ------------------------------------------------------------------------------------------------------
-    void initialize(const data_type min, const data_type max);
+    /// @brief      Initializes the elements of the tensor with values from a distribution (for example 
+    ///             ftl::Uniform<float>(-1.f, 1.f) or ftl::Normal<float>(0.f, 1.f)), in parallel. The value of 
+    ///             each element only depends on the seed, the stream and its (column-major) index, so the
+    ///             values are the same for any number of threads and any layout.
+    /// @param[in]  distribution    The distribution of the values, in the data type of the tensor
+    /// @param[in]  seed            The seed of the generator
+    /// @param[in]  stream          The stream of the generator, for independent values with the same seed
+    /// @tparam     Distribution    The type of the distribution
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Distribution, typename = typename std::enable_if<detail::IsDistribution<Distribution>::value>::type>
+    void initialize(const Distribution& distribution, std::uint64_t seed, std::uint64_t stream = 0);
     
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets an element from the tensor
-    /// @param[in]  i   The index of the element in the tensor
+    /// @param[in]  i   The (column-major) index of the element in the tensor
     /// @return     A reference to the element at the index i in the tensor
     // ------------------------------------------------------------------------------------------------------
-    inline data_type& operator[](size_type i) { return _data[i]; }
+    inline data_type& operator[](size_type i) { return _data[layout_type::offset(i)]; }
    
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets an element from the tensor
-    /// @param[in]  i   The index of the element in the tensor
+    /// @param[in]  i   The (column-major) index of the element in the tensor
     /// @return     The value of the element at the index i in the tensor
     // ------------------------------------------------------------------------------------------------------
-    inline const data_type& operator[](size_type i) const { return _data[i]; }
+    constexpr const data_type& operator[](size_type i) const { return _data[layout_type::offset(i)]; }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets a packet of elements from the tensor -- only valid when the tensor is contiguous
+    /// @param[in]  i   The index of the first element in the packet
+    /// @return     The packet of elements starting at the index i in the tensor
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const { return simd::Packet<data_type>::loadu(_data.data() + i); }
    
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets the element at a given index for each dimension of a tensor -- there is no bound
@@ -150,7 +273,7 @@ public:
     /// @return     A reference to the element at the position given by the indices
     // ------------------------------------------------------------------------------------------------------
     template <typename IF, typename... IR>
-    DT& operator()(IF index_dim_one, IR... index_dim_other);
+    data_type& operator()(IF index_dim_one, IR... index_dim_other);
    
     // ------------------------------------------------------------------------------------------------------
     /// @brief      Gets the element at a given index for each dimension of a tensor -- there is no bound
@@ -162,10 +285,147 @@ public:
     /// @return     The value of the element at the position given by the indices
     // ------------------------------------------------------------------------------------------------------
     template <typename IF, typename... IR>
-    DT operator()(IF index_dim_one, IR... index_dim_other) const;
+    constexpr data_type operator()(IF index_dim_one, IR... index_dim_other) const;
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a view of a slice of the tensor, which refers to the data of the tensor (no data is
+    ///             copied). The view can be used in expressions and assigned to, for example:
+    ///             
+    ///             A.slice(ftl::all, c, ftl::Range(0, 8, 2)) = B.slice(ftl::all, c, ftl::Range(0, 4));
+    ///             
+    ///             The view has a static shape (computed at compile time) unless a runtime ftl::Range is used, 
+    ///             and is only valid while the tensor is alive.
+    /// @param[in]  specs   The slice specifier for each dimension of the tensor, which is one of:
+    ///                     - ftl::all                      : All of the elements of the dimension
+    ///                     - An index                      : The element at the index (the dimension is removed)
+    ///                     - ftl::Range(start, end, step)  : The elements [start, end) with a step (default 1)
+    ///                     - ftl::StaticRange<S, E, Step>  : A range which is known at compile time
+    /// @tparam     Specs   The types of the slice specifiers
+    /// @return     A view of the slice of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename... Specs>
+    detail::StaticSliceType<data_type, data_type, layout_type, Specs...> slice(const Specs&... specs)
+    {
+        return detail::make_static_view<data_type, layout_type>(_data.data(), specs...);
+    }
+    
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a view of a slice of a constant tensor, which can't be assigned to.
+    /// @param[in]  specs   The slice specifier for each dimension of the tensor
+    /// @tparam     Specs   The types of the slice specifiers
+    /// @return     A constant view of the slice of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename... Specs>
+    detail::StaticSliceType<data_type, const data_type, layout_type, Specs...> slice(const Specs&... specs) const
+    {
+        return detail::make_static_view<data_type, layout_type>(_data.data(), specs...);
+    }
 private:
     data_container      _data;                  //!< The data container which holds all the data
-    dim_container       _dim_sizes;             //!< The sizes of the dimensions for the tensor
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the sizes of the dimensions, which are built at compile time rather than stored
+    /// @return     A constant reference to the dimension sizes of the tensor
+    // ------------------------------------------------------------------------------------------------------
+    static constexpr const dim_container& static_dim_sizes() 
+    { 
+        return detail::StaticDimSizes<dim_container, detail::SizeList<SF, SR...>>::values; 
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression (with the same size) into the data of the tensor
+    /// @param[in]  expression      The expression to evaluate
+    /// @tparam     Expression      The type of the expression
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression>
+    void evaluate_from(const Expression& expression)
+    {
+        evaluate_from(expression, std::integral_constant<bool, layout_type::contiguous && 
+                                                               layout_type::num_elements <= detail::max_unrolled_size>());
+    }
+
+    // Small contiguous tensors -- the loops are unrolled at compile time
+    template <typename Expression>
+    void evaluate_from(const Expression& expression, std::true_type)
+    {
+        evaluate_unrolled<layout_type::num_elements>(_data.data(), expression);
+    }
+
+    template <typename Expression>
+    void evaluate_from(const Expression& expression, std::false_type)
+    {
+        evaluate_layout(expression, std::integral_constant<bool, layout_type::tiled>());
+    }
+
+    // Strided layouts
+    template <typename Expression>
+    void evaluate_layout(const Expression& expression, std::false_type /* tiled */)
+    {
+        if (layout_type::contiguous) 
+            evaluate(_data.data(), expression, size());
+        else 
+            evaluate(_data.data(), layout_type(), expression, size(), SF,
+                     detail::SizeArray<typename layout_type::strides>::values[0]);
+    }
+
+    // Tiled layouts -- the elements are evaluated a tile at a time
+    template <typename Expression>
+    void evaluate_layout(const Expression& expression, std::true_type /* tiled */)
+    {
+        detail::evaluate_into_tiles(_data.data(), expression, 1 + sizeof...(SR),
+                                    detail::SizeArray<typename layout_type::sizes>::values, layout_type::tiles,
+                                    layout_type::morton);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks that an expression has the same rank and dimension sizes as the tensor -- at compile
+    ///             time if the shape of the expression is static, otherwise at runtime
+    /// @param[in]  expression      The expression to check
+    /// @tparam     Traits          The tensor traits of the expression
+    /// @tparam     Expression      The type of the expression
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Traits, typename Expression>
+    void check_dim_sizes(const Expression& expression) const
+    {
+        check_dim_sizes(expression, std::integral_constant<bool, detail::StaticSizes<Traits>::is_static>());
+    }
+
+    // The shape of the expression is known at compile time
+    template <typename E, typename T>
+    void check_dim_sizes(const TensorExpression<E, T>&, std::true_type) const
+    {
+        static_assert(std::is_same<typename detail::StaticSizes<T>::type, detail::SizeList<SF, SR...>>::value,
+                      "Can't assign an expression with different dimension sizes to a static tensor");
+    }
+
+    // The shape of the expression is only known at runtime
+    template <typename E, typename T>
+    void check_dim_sizes(const TensorExpression<E, T>& expression, std::false_type) const
+    {
+        const dim_container& dim_sizes = static_dim_sizes();
+        if (expression.rank() != rank() ||
+            !std::equal(dim_sizes.begin(), dim_sizes.end(), expression.dim_sizes().begin()))
+            throw std::invalid_argument("ftl::Tensor : can't assign an expression with different dimension sizes");
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression (with the same dimension sizes) into the tensor, using a temporary
+    ///             if the expression aliases the tensor data
+    /// @param[in]  expression      The expression to evaluate
+    /// @tparam     Expression      The type of the expression
+    /// @return     A reference to the tensor
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression>
+    TensorInterface& assign(const Expression& expression)
+    {
+        if (expression.aliases(footprint())) {
+            TensorInterface result(expression);
+            _data = std::move(result._data);
+        } else {
+            evaluate_from(expression);
+        }
+        return *this;
+    }
 };
 
 // ----------------------------------------------- IMPLEMENTATIONS ------------------------------------------
@@ -173,57 +433,50 @@ private:
 // ------------------------------------------------- PUBLIC -------------------------------------------------
 
 template <typename DT, size_t SF, size_t...SR> 
-TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::TensorInterface() 
-{
-    // Convert the nano::list of dimension sizes to a constant array
-     _dim_sizes = nano::runtime_converter<typename container_type::dimension_sizes>::to_array(); 
-};
-
-template <typename DT, size_t SF, size_t...SR> 
-TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::TensorInterface(data_container& data)
-: _data(data) 
-{
-    // Convert the nano::list of dimension sizes to a constant array
-    _dim_sizes = nano::runtime_converter<typename container_type::dimension_sizes>::to_array();
-}
+constexpr TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::TensorInterface(data_container& data)
+: _data(data) {}
 
+// The values are cast rather than forwarded since std::forward can't be used in constant expressions in C++11
 template <typename DT, size_t SF, size_t...SR> template <typename... TR> 
-TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::TensorInterface(DT&& first_value, TR&&... other_values) 
-: _data{{std::forward<DT>(first_value), std::forward<TR>(other_values)...}}
-{
-    // Convert the nano::list of dimension sizes to a constant array
-    _dim_sizes = nano::runtime_converter<typename container_type::dimension_sizes>::to_array(); 
-}
+constexpr TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::TensorInterface(data_type&&  first_value  , 
+                                                                             TR&&...      other_values ) 
+: _data{{static_cast<data_type>(first_value), static_cast<data_type>(other_values)...}} {}
 
 template <typename DT, size_t SF, size_t...SR> template <typename E, typename T> 
 TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::TensorInterface(const TensorExpression<E, T>& expression) 
 {
-    // Convert the nano::list of dimension sizes to a constant array
-    _dim_sizes = nano::runtime_converter<typename container_type::dimension_sizes>::to_array();  
-    for (size_type i = 0; i != size(); ++i) _data[i] = expression[i];
+    check_dim_sizes<T>(expression);
+    evaluate_from(static_cast<const E&>(expression));
 }
 
-template <typename DT, size_t SF, size_t... SR>
-void TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::initialize(const data_type min, const data_type max)
+template <typename DT, size_t SF, size_t... SR> template <typename Distribution, typename>
+void TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::initialize(const Distribution& distribution,
+                                                                   std::uint64_t seed, std::uint64_t stream)
 {
-    std::random_device                  rand_device;
-    std::mt19937                        gen(rand_device());
-    std::uniform_real_distribution<>    dist(min, max);
-    for (auto& element : _data) element = static_cast<data_type>(dist(gen));     
+    static_assert(std::is_same<typename Distribution::data_type, data_type>::value,
+                  "The distribution must have the data type of the tensor");
+    if (layout_type::contiguous) {
+        detail::generate_random(_data.data(), size(), distribution, seed, stream);
+    } else {
+        // The values are generated in column-major order, so they don't depend on the layout
+        std::vector<data_type> values(size());
+        detail::generate_random(values.data(), values.size(), distribution, seed, stream);
+        for (size_type i = 0; i < values.size(); ++i) (*this)[i] = values[i];
+    }
 }
 
 template <typename DT, size_t SF, size_t...SR> template <typename IF, typename... IR>
-DT& TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::operator()(IF dim_one_index, IR... other_dim_indices) 
+typename TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::data_type& 
+TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::operator()(IF dim_one_index, IR... other_dim_indices) 
 {
-    using dimension_sizes = typename container_type::dimension_sizes;
-    return _data[StaticMapper::indices_to_index<dimension_sizes>(dim_one_index, other_dim_indices...)];
+    return _data[StaticMapper::indices_to_index<layout_type>(dim_one_index, other_dim_indices...)];
 }
 
 template <typename DT, size_t SF, size_t...SR> template <typename IF, typename... IR>
-DT TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::operator()(IF dim_one_index, IR... other_dim_indices) const
+constexpr typename TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::data_type 
+TensorInterface<TensorTraits<DT, CPU, SF, SR...>>::operator()(IF dim_one_index, IR... other_dim_indices) const
 {
-    using dimension_sizes = typename container_type::dimension_sizes;
-    return _data[StaticMapper::indices_to_index<dimension_sizes>(dim_one_index, other_dim_indices...)];
+    return _data[StaticMapper::indices_to_index<layout_type>(dim_one_index, other_dim_indices...)];
 }
 
 }               // End namespace ftl
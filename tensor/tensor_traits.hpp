@@ -38,7 +38,8 @@ static constexpr device GPU = 1;
 /// @struct     TensorTraits
 /// @brief      Traits class which specifies parameters for a tensor, such as what type of container it uses
 ///             and what type of device the computations should be performed on
-/// @tparam     Dtype           The type of data used by the container
+/// @tparam     Dtype           The type of data used by the container, which can be wrapped with ftl::Policies
+///             to specify the policies of the container (for example the allocator of a dynamic container)
 /// @tparam     DeviceType      The type of device used for computation -- CPU or GPU
 /// @tparam     DimSizes        The sizes of each of the dimensions of the tensor -- an optional parameters.
 ///             This parameter is used to determine the container type -- static if the dimension sizes are 
@@ -47,12 +48,13 @@ static constexpr device GPU = 1;
 template <typename Dtype, device DeviceType, size_t... DimSizes>
 struct TensorTraits;
 
-// Specialize for static container
+// Specialize for static container -- Dtype can be wrapped with ftl::Policies to set the layout
 template <typename Dtype, device DeviceType, size_t SizeFirst, size_t... SizeRest>
 struct TensorTraits<Dtype, DeviceType, SizeFirst, SizeRest...> {
     // ---------------------------------------- ALIAS'S -----------------------------------------------------
-    using data_type         = Dtype;
     using container_type    = TensorContainer<Dtype, SizeFirst, SizeRest...>;
+    using data_type         = typename container_type::data_type;
+    using layout_type       = typename container_type::layout_type;
     using data_container    = typename container_type::data_container;
     using dim_container     = typename container_type::dim_container;
     using size_type         = typename container_type::size_type;
@@ -60,12 +62,14 @@ struct TensorTraits<Dtype, DeviceType, SizeFirst, SizeRest...> {
     static constexpr device device_type     = DeviceType;
 };
 
-// Specialize for dynamic container
+// Specialize for dynamic container -- Dtype can be wrapped with ftl::Policies to set the allocator
 template <typename Dtype, device DeviceType>
 struct TensorTraits<Dtype, DeviceType> {
     // ---------------------------------------- ALIAS'S -----------------------------------------------------
-    using data_type         = Dtype;
     using container_type    = TensorContainer<Dtype>;
+    using data_type         = typename container_type::data_type;
+    using allocator_type    = typename container_type::allocator_type;
+    using layout_type       = DynamicLayout;
     using data_container    = typename container_type::data_container;
     using dim_container     = typename container_type::dim_container;
     using size_type         = typename container_type::size_type;
@@ -73,5 +77,25 @@ struct TensorTraits<Dtype, DeviceType> {
     static constexpr device device_type     = DeviceType;
 };
 
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     StaticSizes
+/// @brief      Gets the dimension sizes of tensor traits as a compile time list, if the traits are static
+/// @tparam     Traits  The tensor traits
+// ----------------------------------------------------------------------------------------------------------
+template <typename Traits>
+struct StaticSizes {
+    static constexpr bool is_static = false;
+    using type                      = SizeList<>;
+};
+
+template <typename Dtype, device DeviceType, size_t SizeFirst, size_t... SizeRest>
+struct StaticSizes<TensorTraits<Dtype, DeviceType, SizeFirst, SizeRest...>> {
+    static constexpr bool is_static = true;
+    using type                      = SizeList<SizeFirst, SizeRest...>;
+};
+
+}               // End namespace detail
 }               // End namespace ftl
 #endif          // FTL_TENSOR_TRAITS_HPP
@@ -0,0 +1,239 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for view specialization with a static shape using the cpu. A view refers to (does not
+///         own) a strided sub-block of the data of a tensor, where the sizes and the strides of the view are
+///         known at compile time.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_TENSOR_VIEW_STATIC_CPU_HPP
+#define FTL_TENSOR_VIEW_STATIC_CPU_HPP
+
+#include "alias.hpp"
+#include "evaluator.hpp"
+#include "mapper.hpp"
+#include "slice.hpp"
+#include "tensor_expression_static_cpu.hpp"
+#include "tensor_view_dynamic_cpu.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+// NOTE : Using long template names results in extremely bulky code, so the following abbreviations are
+//        used to reduve the bulk for template parameters:
+//          - DT = Dtype        = data type
+//          - SF = SizeFirst    = size of first dimension
+//          - SR = SizeRest     = size of other dimensions
+namespace ftl {
+
+// Specialization for a view with a static shape and a CPU device. Copying a view copies the reference to
+// the data, while assigning to a view assigns to the elements which it refers to.
+template <typename DT, typename Element, size_t... Strides, size_t SF, size_t... SR>
+class TensorView<TensorTraits<DT, CPU, SF, SR...>, Element, detail::SizeList<Strides...>>
+: public TensorExpression<TensorView<TensorTraits<DT, CPU, SF, SR...>, Element, detail::SizeList<Strides...>>,
+                          TensorTraits<DT, CPU, SF, SR...>                                                    > {
+public:
+    // ---------------------------------------- ALIAS'S -----------------------------------------------------
+    using traits            = TensorTraits<DT, CPU, SF, SR...>;
+    using size_type         = typename traits::size_type;
+    using data_type         = typename traits::data_type;
+    using dim_container     = typename traits::dim_container;
+    using layout_type       = StridedLayout<detail::SizeList<SF, SR...>, detail::SizeList<Strides...>>;
+    using packet_type       = typename simd::Packet<data_type>::type;
+    // ------------------------------------------------------------------------------------------------------
+
+    static constexpr bool vectorizable = true;      //!< Views can be accessed a packet at a time if contiguous
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- creates a view of the data
+    /// @param[in]  data    A pointer to the first element of the view
+    // ------------------------------------------------------------------------------------------------------
+    explicit TensorView(Element* data) : _data(data), _dim_sizes{{SF, SR...}} {}
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Copy constructor -- the new view refers to the same data as the other view
+    /// @param[in]  other   The view to copy
+    // ------------------------------------------------------------------------------------------------------
+    TensorView(const TensorView& other) = default;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Assigns the elements of another view to the elements of this view
+    /// @param[in]  other   The view to assign the elements from
+    /// @return     A reference to this view
+    // ------------------------------------------------------------------------------------------------------
+    TensorView& operator=(const TensorView& other) { return assign(other); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression into the elements of the view
+    /// @param[in]  expression  The expression to evaluate, which must have the same size as the view
+    /// @tparam     Expression  The type of the expression
+    /// @tparam     Traits      The traits of the expression
+    /// @return     A reference to this view
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression, typename Traits>
+    TensorView& operator=(const TensorExpression<Expression, Traits>& expression)
+    {
+        return assign(static_cast<const Expression&>(expression));
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the rank (number of dimensions) of the view
+    /// @return     The rank (number of dimensions) of the view
+    // ------------------------------------------------------------------------------------------------------
+    constexpr size_type rank() const { return sizeof...(SR) + 1; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the size (total number of elements) of the view
+    /// @return     The size of the view
+    // ------------------------------------------------------------------------------------------------------
+    constexpr size_type size() const { return layout_type::num_elements; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the size of a specific dimension of the view, if the dimension is valid
+    /// @param[in]  dim     The dimension to get the size of
+    /// @return     The size of the requested dimension of the view if valid, otherwise 0
+    // ------------------------------------------------------------------------------------------------------
+    inline size_type size(const size_type dim) const { return dim < rank() ? _dim_sizes[dim] : 0; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets a reference to the container holding the sizes of the dimensions for the view
+    /// @return     A constant reference to the dimension sizes of the view
+    // ------------------------------------------------------------------------------------------------------
+    constexpr const dim_container& dim_sizes() const { return _dim_sizes; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets if the elements of the view are contiguous in column-major order.
+    /// @return     If the elements of the view are contiguous.
+    // ------------------------------------------------------------------------------------------------------
+    constexpr bool contiguous() const { return layout_type::contiguous; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the footprint (memory and index mapping) of the view, for alias analysis.
+    /// @return     The footprint of the view.
+    // ------------------------------------------------------------------------------------------------------
+    inline detail::MemoryFootprint footprint() const { return detail::make_footprint<layout_type>(_data); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the view can't be read while memory with a footprint is written.
+    /// @param[in]  target  The footprint of the memory which is written.
+    /// @return     True if evaluating into the target requires a temporary buffer.
+    // ------------------------------------------------------------------------------------------------------
+    inline bool aliases(const detail::MemoryFootprint& target) const { return target.conflicts(footprint()); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets a pointer to the first element of the view.
+    /// @return     A pointer to the first element of the view.
+    // ------------------------------------------------------------------------------------------------------
+    inline Element* data() const { return _data; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets an element from the view
+    /// @param[in]  i   The (column-major) index of the element in the view
+    /// @return     A reference to the element at the index i in the view
+    // ------------------------------------------------------------------------------------------------------
+    inline Element& operator[](size_type i) { return _data[layout_type::offset(i)]; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets an element from the view
+    /// @param[in]  i   The (column-major) index of the element in the view
+    /// @return     The value of the element at the index i in the view
+    // ------------------------------------------------------------------------------------------------------
+    inline const data_type& operator[](size_type i) const { return _data[layout_type::offset(i)]; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets a packet of elements from the view -- only valid when the view is contiguous
+    /// @param[in]  i   The index of the first element in the packet
+    /// @return     The packet of elements starting at the index i in the view
+    // ------------------------------------------------------------------------------------------------------
+    inline packet_type packet(size_type i) const { return simd::Packet<data_type>::loadu(_data + i); }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the element at a given index for each dimension of the view
+    /// @param[in]  index_dim_one   The index of the element in dimension 1
+    /// @param[in]  index_dim_other The index of the element in the other dimensions
+    /// @tparam     IF              The type of the first index parameter
+    /// @tparam     IR              The types of the rest of the index parameters
+    /// @return     A reference to the element at the position given by the indices
+    // ------------------------------------------------------------------------------------------------------
+    template <typename IF, typename... IR>
+    Element& operator()(IF index_dim_one, IR... index_dim_other)
+    {
+        return _data[StaticMapper::indices_to_index<layout_type>(index_dim_one, index_dim_other...)];
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the element at a given index for each dimension of the view
+    /// @param[in]  index_dim_one   The index of the element in dimension 1
+    /// @param[in]  index_dim_other The index of the element in the other dimensions
+    /// @tparam     IF              The type of the first index parameter
+    /// @tparam     IR              The types of the rest of the index parameters
+    /// @return     The value of the element at the position given by the indices
+    // ------------------------------------------------------------------------------------------------------
+    template <typename IF, typename... IR>
+    data_type operator()(IF index_dim_one, IR... index_dim_other) const
+    {
+        return _data[StaticMapper::indices_to_index<layout_type>(index_dim_one, index_dim_other...)];
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Creates a view of a slice of the view -- see Tensor::slice.
+    /// @param[in]  specs   The slice specifier (ftl::all, an index, an ftl::Range or an ftl::StaticRange) for
+    ///             each dimension of the view
+    /// @tparam     Specs   The types of the slice specifiers
+    /// @return     A view of the slice, which refers to the same data as this view
+    // ------------------------------------------------------------------------------------------------------
+    template <typename... Specs>
+    detail::StaticSliceType<data_type, Element, layout_type, Specs...> slice(const Specs&... specs) const
+    {
+        return detail::make_static_view<data_type, layout_type>(_data, specs...);
+    }
+private:
+    Element*        _data;              //!< A pointer to the first element of the view
+    dim_container   _dim_sizes;         //!< The sizes of the dimensions of the view
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Evaluates an expression into the elements of the view
+    /// @param[in]  expression  The expression to evaluate
+    /// @tparam     Expression  The type of the expression
+    /// @return     A reference to this view
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Expression>
+    TensorView& assign(const Expression& expression)
+    {
+        static_assert(!std::is_const<Element>::value, "Can't assign to a view of constant data");
+        constexpr size_t strides[] = { Strides... };
+
+        if (expression.rank() != rank() ||
+            !std::equal(_dim_sizes.begin(), _dim_sizes.end(), expression.dim_sizes().begin()))
+            throw std::invalid_argument("ftl::TensorView::assign : expression has different dimension sizes");
+
+        // The expression reads the viewed data at other indices than those written, so evaluate it first
+        if (expression.aliases(footprint())) return assign(TensorInterface<traits>(expression));
+
+        if (layout_type::contiguous)
+            evaluate(_data, expression, size());
+        else
+            evaluate(_data, layout_type(), expression, size(), SF, strides[0]);
+        return *this;
+    }
+};
+
+}               // End namespace ftl
+#endif          // FTL_TENSOR_VIEW_STATIC_CPU_HPP
@@ -0,0 +1,318 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for the thread pool which is used to split work (such as the evaluation of an
+///         expression) across multiple cores. The pool is persistent so that the threads are only created
+///         once, and work is split into contiguous chunks so that each thread streams through its own part
+///         of memory.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_THREAD_POOL_HPP
+#define FTL_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace ftl {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @class      ThreadPool
+/// @brief      A persistent pool of worker threads which execute a range of work split into contiguous
+///             chunks. The thread which submits the work also executes chunks, so a pool with n threads has
+///             n - 1 workers. Ranges which are smaller than twice the grain size are executed serially by
+///             the calling thread, as are ranges submitted from inside a worker.
+// ----------------------------------------------------------------------------------------------------------
+class ThreadPool {
+public:
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the pool owned by the library, which is used for the evaluation of expressions. The
+    ///             number of threads defaults to the value of the FTL_NUM_THREADS environment variable, or to
+    ///             the number of hardware threads if it is not set.
+    /// @return     A reference to the library's thread pool
+    // ------------------------------------------------------------------------------------------------------
+    static ThreadPool& instance()
+    {
+        static ThreadPool pool(default_num_threads());
+        return pool;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Constructor -- creates the worker threads
+    /// @param[in]  num_threads     The number of threads (including the calling thread) to use
+    /// @param[in]  grain_size      The minimum number of elements which are given to a thread
+    /// @param[in]  pin_threads     If each worker thread should be pinned to a cpu
+    // ------------------------------------------------------------------------------------------------------
+    explicit ThreadPool(size_t num_threads, size_t grain_size = default_grain_size, bool pin_threads = false)
+    : _grain_size(grain_size > 0 ? grain_size : 1), _pin_threads(pin_threads), _stop(false), _generation(0),
+      _num_chunks(0), _next_chunk(0), _active(0)
+    {
+        start(num_threads);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Destructor -- joins all the worker threads
+    // ------------------------------------------------------------------------------------------------------
+    ~ThreadPool() { stop(); }
+
+    ThreadPool(const ThreadPool&)               = delete;
+    ThreadPool& operator=(const ThreadPool&)    = delete;
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the number of threads which execute work, including the calling thread
+    /// @return     The number of threads which are used by the pool
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t num_threads() const { return _workers.size() + 1; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the grain size -- the minimum number of elements given to a single thread
+    /// @return     The grain size of the pool
+    // ------------------------------------------------------------------------------------------------------
+    inline size_t grain_size() const { return _grain_size; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Sets the grain size -- the minimum number of elements given to a single thread
+    /// @param[in]  grain_size  The new grain size, values of 0 are treated as 1
+    // ------------------------------------------------------------------------------------------------------
+    inline void set_grain_size(size_t grain_size) { _grain_size = grain_size > 0 ? grain_size : 1; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Checks if the worker threads are pinned to cpus
+    /// @return     True if the worker threads are pinned, otherwise false
+    // ------------------------------------------------------------------------------------------------------
+    inline bool pinned() const { return _pin_threads; }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Changes the number of threads in the pool -- this must not be called while work is being
+    ///             executed by the pool
+    /// @param[in]  num_threads     The new number of threads (including the calling thread)
+    // ------------------------------------------------------------------------------------------------------
+    void resize(size_t num_threads)
+    {
+        std::lock_guard<std::mutex> submit_lock(_submit_mutex);
+        stop();
+        start(num_threads);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Enables or disables the pinning of worker thread i to cpu i + 1 (modulo the number of
+    ///             cpus), so that a worker always streams through memory from the same core. Pinning is only
+    ///             supported on linux, it is ignored on other platforms.
+    /// @param[in]  pin_threads     If the worker threads should be pinned
+    // ------------------------------------------------------------------------------------------------------
+    void pin_threads(bool pin_threads)
+    {
+        std::lock_guard<std::mutex> submit_lock(_submit_mutex);
+        const size_t threads = num_threads();
+        stop();
+        _pin_threads = pin_threads;
+        start(threads);
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Executes a function over the range [begin, end), split into at most num_threads()
+    ///             contiguous chunks each with at least grain_size() elements (or the given grain size, for
+    ///             ranges where each element is a lot more work than a single operation). The function is 
+    ///             called as function(chunk_begin, chunk_end). Returns once all chunks have been executed, 
+    ///             and rethrows the first exception thrown by the function, if there was one.
+    /// @param[in]  begin       The start of the range
+    /// @param[in]  end         The end of the range
+    /// @param[in]  function    The function to execute on each chunk
+    /// @param[in]  alignment   The chunk boundaries are made multiples of the alignment (relative to begin),
+    ///                         so that chunks don't share packets or cache lines
+    /// @param[in]  grain_size  The minimum number of elements per chunk for this range, 0 uses grain_size()
+    /// @tparam     Function    The type of the function
+    // ------------------------------------------------------------------------------------------------------
+    template <typename Function>
+    void parallel_for(size_t begin, size_t end, Function&& function, size_t alignment = 1, size_t grain_size = 0);
+
+private:
+    static constexpr size_t default_grain_size = 1 << 15;   //!< Default minimum elements per thread
+
+    std::vector<std::thread>                _workers;       //!< The worker threads
+    std::mutex                              _mutex;         //!< Mutex for the job state
+    std::mutex                              _submit_mutex;  //!< Serializes submissions from multiple threads
+    std::condition_variable                 _wake;          //!< Signals the workers that there is work
+    std::condition_variable                 _done;          //!< Signals the submitter that work is done
+    std::function<void(size_t)>             _job;           //!< The job, which executes a chunk
+    std::exception_ptr                      _exception;     //!< The first exception thrown by a chunk
+    size_t                                  _grain_size;    //!< Minimum number of elements per chunk
+    bool                                    _pin_threads;   //!< If the workers are pinned to cpus
+    bool                                    _stop;          //!< If the workers must exit
+    size_t                                  _generation;    //!< Incremented for each new job
+    size_t                                  _num_chunks;    //!< Number of chunks in the current job
+    std::atomic<size_t>                     _next_chunk;    //!< The next chunk to be executed
+    size_t                                  _active;        //!< Workers still working on the current job
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Gets the default number of threads for the library's pool
+    /// @return     The value of FTL_NUM_THREADS if set, otherwise the number of hardware threads
+    // ------------------------------------------------------------------------------------------------------
+    static size_t default_num_threads()
+    {
+        const char* env = std::getenv("FTL_NUM_THREADS");
+        if (env != nullptr && std::atoi(env) > 0) return static_cast<size_t>(std::atoi(env));
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        return hardware_threads > 0 ? hardware_threads : 1;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Flag which is set for the threads of a pool so that nested work is executed serially
+    /// @return     A reference to the flag for the calling thread
+    // ------------------------------------------------------------------------------------------------------
+    static bool& inside_worker()
+    {
+        static thread_local bool inside = false;
+        return inside;
+    }
+
+    // ------------------------------------------------------------------------------------------------------
+    /// @brief      Executes chunks of the current job until there are none left
+    // ------------------------------------------------------------------------------------------------------
+    void execute_chunks()
+    {
+        size_t chunk;
+        while ((chunk = _next_chunk.fetch_add(1)) < _num_chunks) {
+            try {
+                _job(chunk);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_exception) _exception = std::current_exception();
+            }
+        }
+    }
+
+    void start(size_t num_threads);
+    void stop();
+    void worker_loop(size_t generation);
+};
+
+// ---------------------------------------------- IMPLEMENTATIONS -------------------------------------------
+
+template <typename Function>
+void ThreadPool::parallel_for(size_t begin, size_t end, Function&& function, size_t alignment, size_t grain_size)
+{
+    if (end <= begin) return;
+
+    const size_t elements   = end - begin;
+    size_t       num_chunks = elements / (grain_size > 0 ? grain_size : _grain_size);
+    if (num_chunks > num_threads()) num_chunks = num_threads();
+
+    // Small ranges, or work submitted from inside a worker, are done serially
+    if (num_chunks <= 1 || inside_worker()) {
+        function(begin, end);
+        return;
+    }
+
+    // Make the chunks as equal as possible, with the boundaries on multiples of the alignment
+    if (alignment == 0) alignment = 1;
+    size_t chunk_size = (elements + num_chunks - 1) / num_chunks;
+    chunk_size        = (chunk_size + alignment - 1) / alignment * alignment;
+    num_chunks        = (elements + chunk_size - 1) / chunk_size;
+
+    std::lock_guard<std::mutex> submit_lock(_submit_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = [&function, begin, end, chunk_size] (size_t chunk)
+        {
+            const size_t chunk_begin = begin + chunk * chunk_size;
+            const size_t chunk_end   = chunk_begin + chunk_size < end ? chunk_begin + chunk_size : end;
+            function(chunk_begin, chunk_end);
+        };
+        _exception  = nullptr;
+        _num_chunks = num_chunks;
+        _next_chunk = 0;
+        _active     = _workers.size();
+        ++_generation;
+    }
+    _wake.notify_all();
+
+    // The calling thread works too, and any work it submits is serial
+    inside_worker() = true;
+    execute_chunks();
+    inside_worker() = false;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this] { return _active == 0; });
+    _job = nullptr;
+    if (_exception) {
+        std::exception_ptr exception = _exception;
+        _exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+inline void ThreadPool::start(size_t num_threads)
+{
+    _stop = false;
+    for (size_t i = 1; i < num_threads; ++i) {
+        _workers.emplace_back(&ThreadPool::worker_loop, this, _generation);
+#if defined(__linux__)
+        if (_pin_threads) {
+            const size_t cpus = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(i % cpus, &cpu_set);
+            pthread_setaffinity_np(_workers.back().native_handle(), sizeof(cpu_set_t), &cpu_set);
+        }
+#endif
+    }
+}
+
+inline void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers) worker.join();
+    _workers.clear();
+}
+
+inline void ThreadPool::worker_loop(size_t generation)
+{
+    inside_worker() = true;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [this, generation] { return _stop || _generation != generation; });
+            if (_stop) return;
+            generation = _generation;
+        }
+        execute_chunks();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_active == 0) _done.notify_one();
+        }
+    }
+}
+
+}               // End namespace ftl
+#endif          // FTL_THREAD_POOL_HPP
@@ -0,0 +1,396 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   Header file for vectorized approximations of elementary functions (exp, log, tanh, sigmoid and
+///         pow) for tensor library. Each function is written once in terms of the operations of a packet, so
+///         the same code computes a single element (with a ScalarPacket) or a whole register (with a Packet),
+///         and the scalar head and tail of an evaluation use the same approximations as the packet body.
+// ----------------------------------------------------------------------------------------------------------
+
+/*
+ * ----------------------------------------------------------------------------------------------------------
+ *  Tensor is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published
+ *  by the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Tensor is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with tensor; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ----------------------------------------------------------------------------------------------------------
+ */
+
+#ifndef FTL_VECTOR_MATH_HPP
+#define FTL_VECTOR_MATH_HPP
+
+#include "simd.hpp"
+
+#include <limits>
+
+// NOTE : The error bounds (measured over the whole range of each function against long double results, see
+//        tests/elementwise_tests.cpp) are the same for float and double with the accurate approximations :
+//
+//          - exp <= 2 ulp, log <= 1 ulp, tanh <= 4 ulp and sigmoid <= 3 ulp
+//
+//        and for the fast approximations, which are about 1e-5 (float) and 1e-10 (double) relative :
+//
+//          - float     : exp, log and sigmoid <= 64 ulp, tanh <= 128 ulp
+//          - double    : exp and sigmoid <= 2^16 ulp, tanh <= 2^18 ulp, log <= 2^19 ulp
+//
+//        pow(x, y) is computed as exp(y * log(|x|)), so the error of the log is scaled by |y * log(x)|, and
+//        the error of pow is bounded by about (2 + |y * log(x)|) ulp (the same as the accurate bounds when
+//        |y * log(x)| is small, and much larger for results near the limits of the range of the type).
+
+namespace ftl {
+namespace simd {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Accurate
+/// @brief      Precision tag for the accurate approximations -- errors of a few ulp (see above)
+// ----------------------------------------------------------------------------------------------------------
+struct Accurate {};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     Fast
+/// @brief      Precision tag for the fast approximations, which use shorter polynomials and have larger
+///             errors (see above). The special values (infinities, zeros and NaN) are handled as for Accurate.
+// ----------------------------------------------------------------------------------------------------------
+struct Fast {};
+
+namespace detail {
+
+// ----------------------------------------------------------------------------------------------------------
+/// @struct     MathConstants
+/// @brief      Constants for the approximations of a floating point type
+/// @tparam     Dtype   The floating point type
+// ----------------------------------------------------------------------------------------------------------
+template <typename Dtype>
+struct MathConstants;
+
+template <>
+struct MathConstants<float> {
+    static constexpr float log2e()      { return 1.44269504088896341f;  }
+    static constexpr float ln2_hi()     { return 0.693359375f;          }   //!< Exact multiples for exp
+    static constexpr float ln2_lo()     { return -2.12194440e-4f;       }
+    static constexpr float log_hi()     { return 6.9313812256e-01f;     }   //!< Exact multiples for log
+    static constexpr float log_lo()     { return 9.0580006145e-06f;     }
+    static constexpr float exp_min()    { return -104.f;                }   //!< exp underflows to 0 below
+    static constexpr float exp_max()    { return 89.f;                  }   //!< exp overflows to inf above
+    static constexpr float tanh_max()   { return 10.f;                  }   //!< tanh rounds to 1 above
+    static constexpr float min_normal() { return 1.17549435e-38f;       }
+    static constexpr float denormal()   { return 16777216.f;            }   //!< Scale for denormal logs
+    static constexpr float denormal_e() { return 24.f;                  }
+    static constexpr float integral()   { return 8388608.f;             }   //!< All larger values are integers
+};
+
+template <>
+struct MathConstants<double> {
+    static constexpr double log2e()      { return 1.44269504088896340736;   }
+    static constexpr double ln2_hi()     { return 6.93145751953125E-1;      }   //!< Exact multiples for exp
+    static constexpr double ln2_lo()     { return 1.42860682030941723212E-6;}
+    static constexpr double log_hi()     { return 6.93147180369123816490e-01; } //!< Exact multiples for log
+    static constexpr double log_lo()     { return 1.90821492927058770002e-10; }
+    static constexpr double exp_min()    { return -746.0;                   }   //!< exp underflows to 0 below
+    static constexpr double exp_max()    { return 710.0;                    }   //!< exp overflows to inf above
+    static constexpr double tanh_max()   { return 20.0;                     }   //!< tanh rounds to 1 above
+    static constexpr double min_normal() { return 2.2250738585072014e-308;  }
+    static constexpr double denormal()   { return 18014398509481984.0;      }   //!< Scale for denormal logs
+    static constexpr double denormal_e() { return 54.0;                     }
+    static constexpr double integral()   { return 4503599627370496.0;       }   //!< All larger values are integers
+};
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Evaluates the polynomial c0 + c1 * x + c2 * x^2 + ... with Horner's scheme
+/// @param[in]  x       The value at which to evaluate the polynomial
+/// @param[in]  c       The coefficient of the highest power
+/// @tparam     P       The packet to evaluate the polynomial with
+// ----------------------------------------------------------------------------------------------------------
+template <typename P>
+inline typename P::type horner(const typename P::type, const typename P::data_type c)
+{
+    return P::set1(c);
+}
+
+template <typename P, typename... Coefficients>
+inline typename P::type horner(const typename P::type x, const typename P::data_type c0,
+                               Coefficients... cs)
+{
+    return P::fmadd(horner<P>(x, cs...), x, P::set1(c0));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Rounds values to the nearest integer (ties to even) in the current rounding mode, by adding
+///             and subtracting a constant which leaves no fraction bits, which is valid for |x| < 2^22 (float)
+///             or |x| < 2^51 (double)
+/// @param[in]  x       The values to round
+/// @tparam     P       The packet of the values
+// ----------------------------------------------------------------------------------------------------------
+template <typename P>
+inline typename P::type round_nearest(const typename P::type x)
+{
+    using constants = MathConstants<typename P::data_type>;
+    const typename P::type shift = P::set1(constants::integral() * typename P::data_type(1.5));
+    return P::sub(P::add(x, shift), shift);
+}
+
+// Rounds non-negative values to the nearest integer, which is valid for x < 2^23 (float) or x < 2^52 (double)
+template <typename P>
+inline typename P::type round_positive(const typename P::type x)
+{
+    const typename P::type shift = P::set1(MathConstants<typename P::data_type>::integral());
+    return P::sub(P::add(x, shift), shift);
+}
+
+// ------------------------------------------------ EXP -----------------------------------------------------
+
+// The Taylor series of (exp(r) - 1) / r, for |r| <= ln(2) / 2
+template <typename P>
+inline typename P::type exp_series(const typename P::type r, float*, Accurate)
+{
+    return horner<P>(r, 1.f, 1.f / 2, 1.f / 6, 1.f / 24, 1.f / 120, 1.f / 720, 1.f / 5040);
+}
+
+template <typename P>
+inline typename P::type exp_series(const typename P::type r, float*, Fast)
+{
+    return horner<P>(r, 1.f, 1.f / 2, 1.f / 6, 1.f / 24, 1.f / 120);
+}
+
+template <typename P>
+inline typename P::type exp_series(const typename P::type r, double*, Accurate)
+{
+    return horner<P>(r, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+                     1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800);
+}
+
+template <typename P>
+inline typename P::type exp_series(const typename P::type r, double*, Fast)
+{
+    return horner<P>(r, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+                     1.0 / 362880);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Reduces x to x = n * ln(2) + r, with |r| <= ln(2) / 2, so that exp(x) = 2^n * exp(r), and the
+///             two multiplications of ln(2) are exact (Cody and Waite)
+/// @param[in]  x       The values to reduce
+/// @param[out] n       The integer (valued) multiples of ln(2)
+/// @return     The reduced values r
+// ----------------------------------------------------------------------------------------------------------
+template <typename P>
+inline typename P::type reduce_ln2(const typename P::type x, typename P::type& n)
+{
+    using constants = MathConstants<typename P::data_type>;
+    n = round_nearest<P>(P::mul(x, P::set1(constants::log2e())));
+    const typename P::type r = P::fmadd(n, P::set1(-constants::ln2_hi()), x);
+    return P::fmadd(n, P::set1(-constants::ln2_lo()), r);
+}
+
+// Multiplies by 2^n in two steps, so that n can be outside the range of normal exponents
+template <typename P>
+inline typename P::type scale(const typename P::type x, const typename P::type n)
+{
+    const typename P::type half = round_nearest<P>(P::mul(n, P::set1(typename P::data_type(0.5))));
+    return P::mul(P::mul(x, P::pow2i(half)), P::pow2i(P::sub(n, half)));
+}
+
+// Computes exp(x) - 1, for x within the limits of exp, accurately for small x
+template <typename P, typename Precision>
+inline typename P::type expm1(const typename P::type x, Precision precision)
+{
+    using dtype = typename P::data_type;
+    typename P::type n;
+    const typename P::type r = reduce_ln2<P>(x, n);
+    const typename P::type q = P::mul(r, exp_series<P>(r, static_cast<dtype*>(nullptr), precision));
+    const typename P::type t = P::pow2i(n);
+    return P::fmadd(t, q, P::sub(t, P::set1(dtype(1))));
+}
+
+// ------------------------------------------------ LOG -----------------------------------------------------
+
+// The polynomial R(z) / z of fdlibm, where log(1 + f) = f - f^2 / 2 + s * (f^2 / 2 + R(z)), s = f / (2 + f)
+// and z = s^2, for sqrt(2) / 2 <= 1 + f < sqrt(2)
+template <typename P>
+inline typename P::type log_series(const typename P::type z, float*, Accurate)
+{
+    return horner<P>(z, 0.66666662693f, 0.40000972152f, 0.28498786688f, 0.24279078841f);
+}
+
+template <typename P>
+inline typename P::type log_series(const typename P::type z, float*, Fast)
+{
+    return horner<P>(z, 0.6666666666666735130f, 0.3999999999940941908f);
+}
+
+template <typename P>
+inline typename P::type log_series(const typename P::type z, double*, Accurate)
+{
+    return horner<P>(z, 6.666666666666735130e-01, 3.999999999940941908e-01, 2.857142874366239149e-01,
+                     2.222219843214978396e-01, 1.818357216161805012e-01, 1.531383769920937332e-01,
+                     1.479819860511658591e-01);
+}
+
+template <typename P>
+inline typename P::type log_series(const typename P::type z, double*, Fast)
+{
+    return horner<P>(z, 6.666666666666735130e-01, 3.999999999940941908e-01, 2.857142874366239149e-01,
+                     2.222219843214978396e-01, 1.818357216161805012e-01);
+}
+
+}               // End namespace detail
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes e^x. The argument is reduced to x = n * ln(2) + r, exp(r) is approximated by a
+///             polynomial, and the result is scaled by 2^n.
+/// @param[in]  x           The values to compute the exponential of
+/// @param[in]  precision   The precision of the approximation (Accurate or Fast)
+/// @tparam     P           The packet of the values (a Packet or ScalarPacket of float or double)
+/// @tparam     Precision   The type of the precision tag
+// ----------------------------------------------------------------------------------------------------------
+template <typename P, typename Precision>
+inline typename P::type exp(const typename P::type x, Precision precision)
+{
+    using dtype     = typename P::data_type;
+    using constants = detail::MathConstants<dtype>;
+
+    const typename P::type clamped = P::min(P::max(x, P::set1(constants::exp_min())),
+                                            P::set1(constants::exp_max()));
+    typename P::type n;
+    const typename P::type r = detail::reduce_ln2<P>(clamped, n);
+    const typename P::type p = P::fmadd(r, detail::exp_series<P>(r, static_cast<dtype*>(nullptr), precision),
+                                        P::set1(dtype(1)));
+
+    // The clamp replaces NaN, so it's restored
+    return P::select(P::equal(x, x), detail::scale<P>(p, n), x);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the natural logarithm of x. x is split into a mantissa m in [sqrt(2) / 2, sqrt(2))
+///             and an exponent e, and log(x) = e * ln(2) + log(m), with log(m) approximated as in fdlibm.
+/// @param[in]  x           The values to compute the logarithm of
+/// @param[in]  precision   The precision of the approximation (Accurate or Fast)
+/// @tparam     P           The packet of the values (a Packet or ScalarPacket of float or double)
+/// @tparam     Precision   The type of the precision tag
+// ----------------------------------------------------------------------------------------------------------
+template <typename P, typename Precision>
+inline typename P::type log(const typename P::type x, Precision precision)
+{
+    using dtype     = typename P::data_type;
+    using constants = detail::MathConstants<dtype>;
+    using limits    = std::numeric_limits<dtype>;
+
+    const typename P::type one  = P::set1(dtype(1));
+    const typename P::type zero = P::set1(dtype(0));
+
+    // Denormals are scaled to be normal
+    const typename P::mask_type tiny = P::less(x, P::set1(constants::min_normal()));
+    const typename P::type      y    = P::select(tiny, P::mul(x, P::set1(constants::denormal())), x);
+
+    typename P::type e;
+    typename P::type m = P::frexp(y, e);
+    e = P::select(tiny, P::sub(e, P::set1(constants::denormal_e())), e);
+
+    const typename P::mask_type small = P::less(m, P::set1(dtype(0.70710678118654752440)));
+    m = P::select(small, P::add(m, m), m);
+    e = P::select(small, P::sub(e, one), e);
+
+    const typename P::type f    = P::sub(m, one);
+    const typename P::type s    = P::div(f, P::add(f, P::set1(dtype(2))));
+    const typename P::type z    = P::mul(s, s);
+    const typename P::type r    = P::mul(z, detail::log_series<P>(z, static_cast<dtype*>(nullptr), precision));
+    const typename P::type hfsq = P::mul(P::set1(dtype(0.5)), P::mul(f, f));
+
+    const typename P::type t = P::fmadd(e, P::set1(constants::log_lo()), P::mul(s, P::add(hfsq, r)));
+    typename P::type result  = P::fmadd(e, P::set1(constants::log_hi()), P::sub(f, P::sub(hfsq, t)));
+
+    const typename P::type inf = P::set1(limits::infinity());
+    result = P::select(P::less(x, zero), P::set1(limits::quiet_NaN()), result);
+    result = P::select(P::equal(x, zero), P::neg(inf), result);
+    result = P::select(P::equal(x, inf), inf, result);
+    return P::select(P::equal(x, x), result, x);
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the hyperbolic tangent of x, as (e^2x - 1) / (e^2x + 1), with e^2x - 1 computed
+///             accurately for small x
+/// @param[in]  x           The values to compute the hyperbolic tangent of
+/// @param[in]  precision   The precision of the approximation (Accurate or Fast)
+/// @tparam     P           The packet of the values (a Packet or ScalarPacket of float or double)
+/// @tparam     Precision   The type of the precision tag
+// ----------------------------------------------------------------------------------------------------------
+template <typename P, typename Precision>
+inline typename P::type tanh(const typename P::type x, Precision precision)
+{
+    using dtype     = typename P::data_type;
+    using constants = detail::MathConstants<dtype>;
+
+    const typename P::type limit   = P::set1(constants::tanh_max());
+    const typename P::type clamped = P::min(P::max(x, P::neg(limit)), limit);
+    const typename P::type u       = detail::expm1<P>(P::add(clamped, clamped), precision);
+    const typename P::type result  = P::div(u, P::add(u, P::set1(dtype(2))));
+
+    // Zeros keep their sign, and the clamp replaces NaN, so it's restored
+    return P::select(P::equal(x, P::set1(dtype(0))), x, P::select(P::equal(x, x), result, x));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes the logistic sigmoid of x, 1 / (1 + e^-x), using e^-|x| so that the result is
+///             accurate (and doesn't overflow) for large negative x
+/// @param[in]  x           The values to compute the sigmoid of
+/// @param[in]  precision   The precision of the approximation (Accurate or Fast)
+/// @tparam     P           The packet of the values (a Packet or ScalarPacket of float or double)
+/// @tparam     Precision   The type of the precision tag
+// ----------------------------------------------------------------------------------------------------------
+template <typename P, typename Precision>
+inline typename P::type sigmoid(const typename P::type x, Precision precision)
+{
+    using dtype = typename P::data_type;
+
+    const typename P::type one = P::set1(dtype(1));
+    const typename P::type e   = exp<P>(P::neg(P::abs(x)), precision);
+    const typename P::type d   = P::add(one, e);
+    return P::select(P::less(x, P::set1(dtype(0))), P::div(e, d), P::div(one, d));
+}
+
+// ----------------------------------------------------------------------------------------------------------
+/// @brief      Computes x raised to the power y, as exp(y * log(|x|)), with the sign of the result for
+///             negative x given by y (if it's an integer), and NaN if y is not an integer. pow(x, 0) and
+///             pow(1, y) are 1 for any x and y (including NaN).
+/// @param[in]  x           The bases
+/// @param[in]  y           The exponents
+/// @param[in]  precision   The precision of the approximation (Accurate or Fast)
+/// @tparam     P           The packet of the values (a Packet or ScalarPacket of float or double)
+/// @tparam     Precision   The type of the precision tag
+// ----------------------------------------------------------------------------------------------------------
+template <typename P, typename Precision>
+inline typename P::type pow(const typename P::type x, const typename P::type y, Precision precision)
+{
+    using dtype     = typename P::data_type;
+    using constants = detail::MathConstants<dtype>;
+
+    const typename P::type one      = P::set1(dtype(1));
+    const typename P::type integral = P::set1(constants::integral());
+
+    typename P::type result = exp<P>(P::mul(y, log<P>(P::abs(x), precision)), precision);
+
+    // Values of at least 2^23 (float) or 2^52 (double) are integers, and values of at least twice that are even
+    const typename P::type ay   = P::abs(y);
+    const typename P::type half = P::mul(ay, P::set1(dtype(0.5)));
+    const typename P::type iy   = P::select(P::less(ay, integral), detail::round_positive<P>(ay), ay);
+    const typename P::type ih   = P::select(P::less(half, integral), detail::round_positive<P>(half), half);
+    const typename P::type odd  = P::sub(ay, P::add(ih, ih));                   // 0 or +-1 for integers
+
+    const typename P::type signed_result = P::select(P::equal(P::abs(odd), one), P::neg(result), result);
+    const typename P::type negative      = P::select(P::equal(iy, ay), signed_result,
+                                                     P::set1(std::numeric_limits<dtype>::quiet_NaN()));
+    result = P::select(P::less(x, P::set1(dtype(0))), negative, result);
+    result = P::select(P::equal(x, one), one, result);
+    return P::select(P::equal(y, P::set1(dtype(0))), one, result);
+}
+
+}               // End namespace simd
+}               // End namespace ftl
+#endif          // FTL_VECTOR_MATH_HPP
@@ -0,0 +1,143 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   allocation_tests.cpp
+/// @brief  Test suite which counts the allocations of tensor data, to check that moving, returning and
+///         assigning tensors does not allocate
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE AllocationTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <utility>
+
+namespace {
+
+// Aligned allocator which counts the number of allocations of tensor data
+template <typename T>
+struct AllocationCounter : ftl::AlignedAllocator<T> {
+    using value_type = T;
+
+    template <typename U> struct rebind { using other = AllocationCounter<U>; };
+
+    static size_t& allocations() { static size_t count = 0; return count; }
+
+    AllocationCounter() noexcept {}
+    template <typename U> AllocationCounter(const AllocationCounter<U>&) noexcept {}
+
+    T* allocate(size_t n) { ++allocations(); return ftl::AlignedAllocator<T>::allocate(n); }
+};
+
+using tensor_type = ftl::DynamicTensorCpu<float, AllocationCounter<float>>;
+
+// Counts the allocations of tensor data from construction to destruction
+struct AllocationScope {
+    AllocationScope() : start(AllocationCounter<float>::allocations()) {}
+    size_t count() const { return AllocationCounter<float>::allocations() - start; }
+    size_t start;
+};
+
+tensor_type make_tensor(size_t rows, size_t cols, float value)
+{
+    tensor_type result({rows, cols});
+    for (size_t i = 0; i < result.size(); ++i) result[i] = value;
+    return result;
+}
+
+}               // End unnamed namespace
+
+BOOST_AUTO_TEST_SUITE( AllocationSuite )
+
+BOOST_AUTO_TEST_CASE( returningATensorAllocatesOnce )
+{
+    AllocationScope scope;
+    tensor_type A = make_tensor(30, 20, 1.f);
+
+    BOOST_CHECK( scope.count() == 1 );
+    BOOST_CHECK( A.size() == 600 );
+}
+
+BOOST_AUTO_TEST_CASE( movingATensorDoesNotAllocate )
+{
+    tensor_type A = make_tensor(8, 8, 2.f);
+    const float* data = A.data().data();
+
+    AllocationScope scope;
+    tensor_type B(std::move(A));
+    tensor_type C({1});
+    C = std::move(B);
+
+    BOOST_CHECK( scope.count() == 1 );          // Only the data of C before the move
+    BOOST_CHECK( C.data().data() == data );
+    BOOST_CHECK( C.size() == 64 );
+    BOOST_CHECK( C(7, 7) == 2.f );
+
+    // Moved-from tensors are empty
+    BOOST_CHECK( A.size() == 0 );
+    BOOST_CHECK( A.rank() == 0 );
+    BOOST_CHECK( B.size() == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( canReleaseAndAdoptDataWithoutAllocating )
+{
+    tensor_type A = make_tensor(4, 5, 3.f);
+    const float* data = A.data().data();
+
+    AllocationScope scope;
+    tensor_type::data_container buffer = A.release();
+    BOOST_CHECK( A.size() == 0 );
+    BOOST_CHECK( buffer.data() == data );
+    BOOST_CHECK( buffer.size() == 20 );
+
+    // Adopt the buffer with a different shape, then hand it to a new tensor
+    A.adopt({10, 2}, std::move(buffer));
+    BOOST_CHECK( A.size(0) == 10 );
+    BOOST_CHECK( A(9, 1) == 3.f );
+
+    tensor_type B({2, 10}, A.release());
+    BOOST_CHECK( B.data().data() == data );
+    BOOST_CHECK( B(1, 9) == 3.f );
+    BOOST_CHECK( scope.count() == 0 );
+
+    BOOST_CHECK_THROW( A.adopt({4, 4}, tensor_type::data_container(15)), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( evaluatingExpressionsAllocatesOnlyTheResult )
+{
+    tensor_type A = make_tensor(16, 16, 1.f);
+    tensor_type B = make_tensor(16, 16, 2.f);
+
+    // Building a tensor from an expression allocates only the result
+    {
+        AllocationScope scope;
+        tensor_type C = A + B - A;
+        BOOST_CHECK( scope.count() == 1 );
+        BOOST_CHECK( C[100] == 2.f );
+    }
+
+    // Assigning into a tensor with data of the same shape does not allocate
+    tensor_type D(std::move(B));
+    {
+        AllocationScope scope;
+        D = A + D;
+        D += A;
+        D -= A - D;
+        BOOST_CHECK( scope.count() == 0 );
+        BOOST_CHECK( D[255] == 7.f );
+    }
+
+    // A moved-from tensor allocates its new data once
+    {
+        AllocationScope scope;
+        B = A + D;
+        BOOST_CHECK( scope.count() == 1 );
+        BOOST_CHECK( B.size() == 256 );
+        BOOST_CHECK( B[0] == 8.f );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
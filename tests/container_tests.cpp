@@ -13,6 +13,24 @@
     #include "../tensor/tensor_container.hpp"
 #endif
 
+#include <cstdint>
+#include <memory>
+
+// Allocator which counts the number of allocations, to check that custom allocators are used
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+    using value_type = T;
+    
+    template <typename U> struct rebind { using other = CountingAllocator<U>; };
+    
+    static size_t& allocations() { static size_t count = 0; return count; }
+    
+    CountingAllocator() {}
+    template <typename U> CountingAllocator(const CountingAllocator<U>&) {}
+    
+    T* allocate(size_t n) { ++allocations(); return std::allocator<T>::allocate(n); }
+};
+
 BOOST_AUTO_TEST_SUITE( TensorContainerSuite)
 
 // TODO: Add tests that conver entire container functionality
@@ -33,4 +51,33 @@ BOOST_AUTO_TEST_CASE( canCreateDynamicContainer )
     BOOST_CHECK( A.size() == 0 );
 }
 
+BOOST_AUTO_TEST_CASE( dynamicContainerDataIsAligned )
+{
+    ftl::TensorContainer<float>::data_container data(13);
+    
+    BOOST_CHECK( reinterpret_cast<uintptr_t>(data.data()) % ftl::default_alignment == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( canUseAlignedAllocatorWithOtherAlignments )
+{
+    ftl::AlignedAllocator<double, 256> allocator;
+    double* data = allocator.allocate(3);
+    
+    BOOST_CHECK( reinterpret_cast<uintptr_t>(data) % 256 == 0 );
+    allocator.deallocate(data, 3);
+}
+
+BOOST_AUTO_TEST_CASE( canCreateDynamicContainerWithCustomAllocator )
+{
+    using container_type = ftl::TensorContainer<ftl::Policies<int, CountingAllocator<int>>>;
+    
+    const size_t allocations = CountingAllocator<int>::allocations();
+    container_type::data_container data(10);
+    container_type A(data);
+    
+    BOOST_CHECK( (std::is_same<container_type::data_type, int>::value) );
+    BOOST_CHECK( A.size() == 10 );
+    BOOST_CHECK( CountingAllocator<int>::allocations() > allocations );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,175 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   contraction_tests.cpp
+/// @brief  Test suite for tensor contraction tests
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE ContractionTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+BOOST_AUTO_TEST_SUITE( ContractionSuite )
+
+BOOST_AUTO_TEST_CASE( canMultiplyMatrices )
+{
+    // Sizes which are not multiples of the register tile and span more than one cache block
+    const size_t m = 67, k = 301, n = 45;
+    ftl::DynamicTensorCpu<double> A({m, k});
+    ftl::DynamicTensorCpu<double> B({k, n});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<double>(i % 13) - 6.0;
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<double>(i % 7) * 0.5;
+
+    ftl::DynamicTensorCpu<double> C = ftl::contract(A, B, {{1, 0}});
+
+    BOOST_CHECK( C.rank() == 2 );
+    BOOST_CHECK( C.size(0) == m );
+    BOOST_CHECK( C.size(1) == n );
+
+    bool correct = true;
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            double expected = 0.0;
+            for (size_t p = 0; p < k; ++p) expected += A(i, p) * B(p, j);
+            correct = correct && C(i, j) == expected;
+        }
+    }
+    BOOST_CHECK( correct );
+}
+
+BOOST_AUTO_TEST_CASE( canContractHigherRankTensorsOverMultiplePairs )
+{
+    ftl::DynamicTensorCpu<float> A({3, 4, 5});
+    ftl::DynamicTensorCpu<float> B({5, 2, 3});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i % 5);
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<float>(i % 3) - 1.f;
+
+    // C(j, b) = sum_{i, l} A(i, j, l) * B(l, b, i)
+    ftl::DynamicTensorCpu<float> C = ftl::contract(A, B, {{2, 0}, {0, 2}});
+
+    BOOST_CHECK( C.rank() == 2 );
+    BOOST_CHECK( C.size(0) == 4 );
+    BOOST_CHECK( C.size(1) == 2 );
+
+    bool correct = true;
+    for (size_t j = 0; j < 4; ++j) {
+        for (size_t b = 0; b < 2; ++b) {
+            float expected = 0.f;
+            for (size_t i = 0; i < 3; ++i)
+                for (size_t l = 0; l < 5; ++l) expected += A(i, j, l) * B(l, b, i);
+            correct = correct && C(j, b) == expected;
+        }
+    }
+    BOOST_CHECK( correct );
+
+    // Contracting all the dimensions gives a single element
+    ftl::DynamicTensorCpu<float> D = ftl::contract(A, A, {{0, 0}, {1, 1}, {2, 2}});
+    float expected = 0.f;
+    for (size_t i = 0; i < A.size(); ++i) expected += A[i] * A[i];
+    BOOST_CHECK( D.size() == 1 );
+    BOOST_CHECK( D[0] == expected );
+}
+
+BOOST_AUTO_TEST_CASE( invalidContractionsThrow )
+{
+    ftl::DynamicTensorCpu<float> A({3, 4});
+    ftl::DynamicTensorCpu<float> B({5, 3});
+
+    BOOST_CHECK_THROW( ftl::contract(A, B, {{1, 0}}), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::contract(A, B, {{2, 0}}), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::contract(A, B, {{0, 1}, {0, 1}}), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( canContractEmptyTensors )
+{
+    ftl::DynamicTensorCpu<float> A({0, 3});
+    ftl::DynamicTensorCpu<float> B({3, 4});
+    ftl::DynamicTensorCpu<float> C({4, 0});
+    ftl::DynamicTensorCpu<float> D({0, 5});
+    for (size_t i = 0; i < B.size(); ++i) B[i] = 1.f;
+
+    // An empty result, and a result with nothing to sum over (which is zero)
+    ftl::DynamicTensorCpu<float> E = ftl::contract(A, B, {{1, 0}});
+    ftl::DynamicTensorCpu<float> F = ftl::contract(C, D, {{1, 0}});
+    BOOST_CHECK( E.size() == 0 && E.size(0) == 0 && E.size(1) == 4 );
+    BOOST_CHECK( F.size() == 20 && F[0] == 0.f && F[19] == 0.f );
+}
+
+BOOST_AUTO_TEST_CASE( staticContractionHasStaticResult )
+{
+    ftl::StaticTensorCpu<float, 3, 4, 2> A;
+    ftl::StaticTensorCpu<float, 4, 5> B;
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i);
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<float>(i % 4);
+
+    auto C = ftl::contract<ftl::IndexPair<1, 0>>(A, B);
+    static_assert(std::is_same<decltype(C), ftl::StaticTensorCpu<float, 3, 2, 5>>::value,
+                  "Contraction of static tensors must have a static shape");
+
+    float expected = 0.f;
+    for (size_t p = 0; p < 4; ++p) expected += A(2, p, 1) * B(p, 3);
+    BOOST_CHECK( C(2, 1, 3) == expected );
+
+    // With a dynamic operand the result is dynamic
+    ftl::DynamicTensorCpu<float> D({4, 5});
+    for (size_t i = 0; i < D.size(); ++i) D[i] = B[i];
+    auto E = ftl::contract<ftl::IndexPair<1, 0>>(A, D);
+    static_assert(std::is_same<decltype(E), ftl::DynamicTensorCpu<float>>::value,
+                  "Contraction with a dynamic tensor must have a dynamic shape");
+    BOOST_CHECK( E(2, 1, 3) == expected );
+}
+
+BOOST_AUTO_TEST_CASE( canContractViewsAndRowMajorTensors )
+{
+    ftl::DynamicTensorCpu<double> A({6, 8});
+    ftl::DynamicTensorCpu<double> B({8, 3}, ftl::RowMajor());
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<double>(i);
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<double>(i % 5);
+
+    // Every second row of A, by B
+    auto a = A.slice(ftl::Range(0, 6, 2), ftl::all);
+    ftl::DynamicTensorCpu<double> C = ftl::contract(a, B, {{1, 0}});
+
+    BOOST_CHECK( C.size(0) == 3 );
+    BOOST_CHECK( C.size(1) == 3 );
+
+    double expected = 0.0;
+    for (size_t p = 0; p < 8; ++p) expected += A(4, p) * B(p, 1);
+    BOOST_CHECK( C(2, 1) == expected );
+}
+
+BOOST_AUTO_TEST_CASE( canContractInParallel )
+{
+    const size_t m = 40, k = 50, n = 90;
+    ftl::DynamicTensorCpu<float> A({m, k});
+    ftl::DynamicTensorCpu<float> B({k, n});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i % 11) * 0.25f;
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<float>(i % 9) - 4.f;
+
+    // Use a small grain size so that the columns of the result are split between the threads
+    const size_t grain_size = ftl::ThreadPool::instance().grain_size();
+    ftl::ThreadPool::instance().set_grain_size(64);
+    ftl::DynamicTensorCpu<float> C = ftl::contract(A, B, {{1, 0}});
+    ftl::DynamicTensorCpu<float> D = ftl::contract(B, A, {{0, 1}});
+    ftl::ThreadPool::instance().set_grain_size(grain_size);
+
+    bool correct = true;
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            float expected = 0.f;
+            for (size_t p = 0; p < k; ++p) expected += A(i, p) * B(p, j);
+            correct = correct && std::abs(C(i, j) - expected) <= 1e-4f * std::abs(expected) + 1e-4f
+                              && std::abs(D(j, i) - expected) <= 1e-4f * std::abs(expected) + 1e-4f;
+        }
+    }
+    BOOST_CHECK( correct );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,237 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   elementwise_tests.cpp
+/// @brief  Test suite for elementwise operations (arithmetic, minimum and maximum, and elementary functions)
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE ElementwiseTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE( ElementwiseSuite )
+
+// Gets the error of a result in units in the last place of the (correctly rounded) reference result
+template <typename Dtype>
+long double ulp_error(const Dtype result, const long double reference)
+{
+    const Dtype rounded = static_cast<Dtype>(reference);
+    if (std::isinf(rounded)) return result == rounded ? 0 : std::numeric_limits<long double>::infinity();
+
+    const Dtype magnitude = std::fabs(rounded);
+    const long double ulp = magnitude < std::numeric_limits<Dtype>::min()
+                          ? std::numeric_limits<Dtype>::denorm_min()
+                          : std::nextafter(magnitude, std::numeric_limits<Dtype>::infinity()) - magnitude;
+    return std::fabs(static_cast<long double>(result) - reference) / ulp;
+}
+
+// Gets the largest error of a function of the elements of a tensor of evenly spaced values in [lo, hi],
+// where the size is not a multiple of any packet size so that the scalar head and tail are also tested
+template <typename Dtype, typename Function, typename Reference>
+long double max_ulp_error(const Dtype lo, const Dtype hi, Function function, Reference reference)
+{
+    const size_t elements = 100003;
+    ftl::DynamicTensorCpu<Dtype> A( {elements} );
+    for (size_t i = 0; i < elements; ++i) A[i] = lo + (hi - lo) * static_cast<Dtype>(i) / (elements - 1);
+
+    ftl::DynamicTensorCpu<Dtype> B = function(A);
+
+    long double error = 0;
+    for (size_t i = 0; i < elements; ++i)
+        error = std::max(error, ulp_error(B[i], reference(static_cast<long double>(A[i]))));
+    return error;
+}
+
+long double reference_sigmoid(const long double x) { return 1.0L / (1.0L + std::exp(-x)); }
+
+// The bounds of the accurate approximations for both float and double
+template <typename Dtype>
+void checkAccurateBounds(const Dtype exp_lo, const Dtype exp_hi)
+{
+    using tensor = ftl::DynamicTensorCpu<Dtype>;
+    long double (*expl)(long double)  = std::exp;
+    long double (*logl)(long double)  = std::log;
+    long double (*tanhl)(long double) = std::tanh;
+
+    BOOST_CHECK( max_ulp_error<Dtype>(exp_lo, exp_hi, [] (const tensor& x) { return ftl::exp(x); }, expl) <= 2 );
+    BOOST_CHECK( max_ulp_error<Dtype>(-2, 2, [] (const tensor& x) { return ftl::exp(x); }, expl) <= 2 );
+    BOOST_CHECK( max_ulp_error<Dtype>(1e-30, 1e30, [] (const tensor& x) { return ftl::log(x); }, logl) <= 1 );
+    BOOST_CHECK( max_ulp_error<Dtype>(0.25, 4, [] (const tensor& x) { return ftl::log(x); }, logl) <= 1 );
+    BOOST_CHECK( max_ulp_error<Dtype>(-12, 12, [] (const tensor& x) { return ftl::tanh(x); }, tanhl) <= 4 );
+    BOOST_CHECK( max_ulp_error<Dtype>(-0.01, 0.01, [] (const tensor& x) { return ftl::tanh(x); }, tanhl) <= 4 );
+    BOOST_CHECK( max_ulp_error<Dtype>(-90, 40, [] (const tensor& x) { return ftl::sigmoid(x); },
+                                      reference_sigmoid) <= 3 );
+}
+
+// The bounds (in ulp) of the fast approximations, which depend on the type
+template <typename Dtype>
+void checkFastBounds(const Dtype exp_bound, const Dtype tanh_bound, const Dtype log_bound)
+{
+    using tensor = ftl::DynamicTensorCpu<Dtype>;
+    long double (*expl)(long double)  = std::exp;
+    long double (*logl)(long double)  = std::log;
+    long double (*tanhl)(long double) = std::tanh;
+
+    BOOST_CHECK( max_ulp_error<Dtype>(-80, 80, [] (const tensor& x) { return ftl::exp(x, ftl::fast_math); },
+                                      expl) <= exp_bound );
+    BOOST_CHECK( max_ulp_error<Dtype>(0.25, 4, [] (const tensor& x) { return ftl::log(x, ftl::fast_math); },
+                                      logl) <= log_bound );
+    BOOST_CHECK( max_ulp_error<Dtype>(-12, 12, [] (const tensor& x) { return ftl::tanh(x, ftl::fast_math); },
+                                      tanhl) <= tanh_bound );
+    BOOST_CHECK( max_ulp_error<Dtype>(-80, 40, [] (const tensor& x) { return ftl::sigmoid(x, ftl::fast_math); },
+                                      reference_sigmoid) <= exp_bound );
+}
+
+// -------------------------------------------- ARITHMETIC -------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( canMultiplyAndDivideStaticTensors )
+{
+    ftl::Tensor<float, ftl::CPU, 2, 2> A{ 1.f, 2.f, 3.f, 4.f };
+    ftl::Tensor<float, ftl::CPU, 2, 2> B{ 2.f, 4.f, 6.f, 8.f };
+
+    ftl::Tensor<float, ftl::CPU, 2, 2> C = A * B;
+    ftl::Tensor<float, ftl::CPU, 2, 2> D = B / A;
+
+    for (size_t i = 0; i < 4; ++i) {
+        BOOST_CHECK( C[i] == 2.f * (i + 1) * (i + 1) );
+        BOOST_CHECK( D[i] == 2.f );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( canUseArithmeticOnDynamicIntegerTensors )
+{
+    ftl::Tensor<int, ftl::CPU> A{ 3, 7 };
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i) - 10;
+
+    ftl::Tensor<int, ftl::CPU> B = ftl::abs(A) * A / 3 + (-A) - 2 * A;
+
+    for (size_t i = 0; i < A.size(); ++i) BOOST_CHECK( B[i] == std::abs(A[i]) * A[i] / 3 - A[i] - 2 * A[i] );
+}
+
+BOOST_AUTO_TEST_CASE( canUseScalarsOnEitherSideOfAnOperator )
+{
+    ftl::DynamicTensorCpu<double> A( {37} );
+    for (size_t i = 0; i < A.size(); ++i) A[i] = 0.5 * i + 1.0;
+
+    ftl::DynamicTensorCpu<double> B = (2 * A + 1) - (A - 1) * 3 + 8 / A - A / 4 - (1 - A);
+
+    for (size_t i = 0; i < A.size(); ++i)
+        BOOST_CHECK( B[i] == (2 * A[i] + 1) - (A[i] - 1) * 3 + 8 / A[i] - A[i] / 4 - (1 - A[i]) );
+}
+
+BOOST_AUTO_TEST_CASE( canTakeElementwiseMinimumsAndMaximums )
+{
+    ftl::DynamicTensorCpu<float> A( {37} ), B( {37} );
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = static_cast<float>(i) - 18.f; B[i] = 18.f - i; }
+
+    ftl::DynamicTensorCpu<float> C = ftl::minimum(A, B) + ftl::maximum(A, 0.f) - ftl::minimum(B, 6.f);
+
+    for (size_t i = 0; i < A.size(); ++i)
+        BOOST_CHECK( C[i] == std::min(A[i], B[i]) + std::max(A[i], 0.f) - std::min(B[i], 6.f) );
+}
+
+BOOST_AUTO_TEST_CASE( elementwiseOperationsOnDifferentShapesThrow )
+{
+    ftl::DynamicTensorCpu<float> A( {2, 3} ), B( {3, 2} ), C( {2, 2, 3} );
+
+    BOOST_CHECK_THROW( A * B, std::invalid_argument );
+    BOOST_CHECK_THROW( A / C, std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::maximum(A, B), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::pow(A, C), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( elementwiseExpressionsAreEvaluatedInOnePass )
+{
+    ftl::DynamicTensorCpu<float> X( {1001} ), W( {1001} ), B( {1001} );
+    for (size_t i = 0; i < X.size(); ++i) { X[i] = i / 100.f - 5.f; W[i] = 0.5f; B[i] = 0.25f; }
+
+    // The intermediate results are never stored, so the expression can be assigned to one of its tensors
+    X = ftl::tanh(W * X + B) * ftl::sigmoid(X) - ftl::sqrt(ftl::abs(X));
+
+    for (size_t i = 0; i < X.size(); ++i) {
+        const double x = i / 100.f - 5.f;
+        const double y = std::tanh(0.5 * x + 0.25) / (1.0 + std::exp(-x)) - std::sqrt(std::abs(x));
+        BOOST_CHECK( std::abs(X[i] - y) <= 1e-5 );
+    }
+}
+
+// ----------------------------------------- ELEMENTARY FUNCTIONS ------------------------------------------
+
+BOOST_AUTO_TEST_CASE( elementaryFunctionsAreWithinTheirErrorBoundsForFloats )
+{
+    checkAccurateBounds<float>(-103.f, 88.7f);
+}
+
+BOOST_AUTO_TEST_CASE( elementaryFunctionsAreWithinTheirErrorBoundsForDoubles )
+{
+    checkAccurateBounds<double>(-745.0, 709.7);
+}
+
+BOOST_AUTO_TEST_CASE( fastElementaryFunctionsAreWithinTheirErrorBounds )
+{
+    checkFastBounds<float>(64.f, 128.f, 64.f);
+    checkFastBounds<double>(65536.0, 262144.0, 524288.0);
+}
+
+BOOST_AUTO_TEST_CASE( logIsAccurateForDenormals )
+{
+    long double (*logl)(long double) = std::log;
+    using tensor = ftl::DynamicTensorCpu<float>;
+
+    BOOST_CHECK( max_ulp_error<float>(1e-44f, 1e-37f, [] (const tensor& x) { return ftl::log(x); }, logl) <= 1 );
+}
+
+BOOST_AUTO_TEST_CASE( elementaryFunctionsHandleSpecialValues )
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    ftl::Tensor<float, ftl::CPU, 6> A{ 0.f, -0.f, inf, -inf, nan, -1.f };
+
+    ftl::Tensor<float, ftl::CPU, 6> E = ftl::exp(A);
+    ftl::Tensor<float, ftl::CPU, 6> L = ftl::log(A);
+    ftl::Tensor<float, ftl::CPU, 6> T = ftl::tanh(A);
+    ftl::Tensor<float, ftl::CPU, 6> S = ftl::sigmoid(A);
+
+    BOOST_CHECK( E[0] == 1.f && E[1] == 1.f && E[2] == inf && E[3] == 0.f && E[4] != E[4] );
+    BOOST_CHECK( L[0] == -inf && L[1] == -inf && L[2] == inf && L[3] != L[3] && L[4] != L[4] && L[5] != L[5] );
+    BOOST_CHECK( T[0] == 0.f && std::signbit(T[1]) && T[2] == 1.f && T[3] == -1.f && T[4] != T[4] );
+    BOOST_CHECK( S[0] == 0.5f && S[2] == 1.f && S[3] == 0.f && S[4] != S[4] );
+
+    // Overflow and underflow
+    ftl::Tensor<double, ftl::CPU, 4> B{ 710.0, -746.0, 1000.0, -1000.0 };
+    ftl::Tensor<double, ftl::CPU, 4> F = ftl::exp(B);
+    BOOST_CHECK( F[0] == std::numeric_limits<double>::infinity() && F[1] == 0.0 );
+    BOOST_CHECK( F[2] == std::numeric_limits<double>::infinity() && F[3] == 0.0 );
+}
+
+BOOST_AUTO_TEST_CASE( canRaiseToPowers )
+{
+    ftl::Tensor<double, ftl::CPU, 8> X{ 2.0, -2.0, -2.0, -2.0, 0.0, 0.0, 1.0, 9.0 };
+    ftl::Tensor<double, ftl::CPU, 8> Y{ 10.0, 3.0, 4.0, 0.5, 2.0, -1.0, std::nan(""), 0.5 };
+
+    ftl::Tensor<double, ftl::CPU, 8> P = ftl::pow(X, Y);
+
+    BOOST_CHECK( std::abs(P[0] - 1024.0) <= 1e-12 );
+    BOOST_CHECK( std::abs(P[1] + 8.0) <= 1e-14 );
+    BOOST_CHECK( std::abs(P[2] - 16.0) <= 1e-14 );
+    BOOST_CHECK( P[3] != P[3] );                                                // Not a real number
+    BOOST_CHECK( P[4] == 0.0 );
+    BOOST_CHECK( P[5] == std::numeric_limits<double>::infinity() );
+    BOOST_CHECK( P[6] == 1.0 );
+    BOOST_CHECK( std::abs(P[7] - 3.0) <= 1e-15 );
+
+    // Powers of zero are one, and a scalar exponent can be used
+    ftl::Tensor<float, ftl::CPU, 3> Z{ 0.f, std::nanf(""), -5.f };
+    ftl::Tensor<float, ftl::CPU, 3> Q = ftl::pow(Z, 0.f) + ftl::pow(ftl::abs(Z), 2.f, ftl::fast_math);
+    BOOST_CHECK( Q[0] == 1.f && Q[1] != Q[1] && std::abs(Q[2] - 26.f) <= 1e-4f );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
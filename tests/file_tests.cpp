@@ -0,0 +1,98 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   file_tests.cpp
+/// @brief  Test suite for tensors stored in files and evaluated a tile at a time
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE FileTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/file_tensor.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+using Tile = ftl::DynamicTensorCpu<float>;
+
+BOOST_AUTO_TEST_SUITE( FileSuite )
+
+BOOST_AUTO_TEST_CASE( canWriteAndReadTilesOfAFile )
+{
+    {
+        // Tiles of 3 slabs of 5x7 elements, so the last of the 8 tiles has 2 slabs
+        ftl::FileTensor<float> A("ftl_file_tests_a.bin", {5, 7, 23}, ftl::FileMode::create, 3 * 35 * sizeof(float));
+        BOOST_CHECK( A.size()       == 805 );
+        BOOST_CHECK( A.tile_slabs() == 3 );
+        BOOST_CHECK( A.num_tiles()  == 8 );
+        BOOST_CHECK( A.tile_dim_sizes(7)[2] == 2 );
+
+        // A created file is zero
+        Tile first = A.read_tile(0);
+        BOOST_CHECK( first.size() == 105 && ftl::norm_inf(first) == 0.f );
+
+        for (size_t t = 0; t < A.num_tiles(); ++t) {
+            Tile tile = A.read_tile(t);
+            for (size_t i = 0; i < tile.size(); ++i) tile[i] = static_cast<float>(t * 105 + i);
+            A.write_tile(t, tile);
+        }
+        BOOST_CHECK_THROW( A.write_tile(0, Tile({5, 7, 2})), std::invalid_argument );
+        BOOST_CHECK_THROW( A.read_tile(8), std::out_of_range );
+    }
+
+    // Reopening the file with a different tiling reads the same (column-major) elements
+    ftl::FileTensor<float> A("ftl_file_tests_a.bin", {5, 7, 23}, ftl::FileMode::read, 10 * 35 * sizeof(float));
+    BOOST_CHECK( A.num_tiles() == 3 );
+    Tile last = A.read_tile(2);
+    BOOST_CHECK( last.size(2) == 3 );
+    BOOST_CHECK( last(4, 6, 2) == static_cast<float>(805 - 1) );
+    BOOST_CHECK( last(0, 0, 0) == static_cast<float>(20 * 35) );
+    BOOST_CHECK_THROW( A.write_tile(0, A.read_tile(0)), std::logic_error );
+
+    BOOST_CHECK_THROW( ftl::FileTensor<float>("ftl_file_tests_a.bin", {5, 7, 24}), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::FileTensor<float>("ftl_file_tests_missing.bin", {5}), std::runtime_error );
+    std::remove("ftl_file_tests_a.bin");
+}
+
+BOOST_AUTO_TEST_CASE( canEvaluateExpressionsOfFilesTileByTile )
+{
+    const size_t tile_bytes = 4 * 6 * 5 * sizeof(float);
+    ftl::FileTensor<float>  A("ftl_file_tests_a.bin", {4, 6, 37}, ftl::FileMode::create, tile_bytes);
+    ftl::FileTensor<float>  B("ftl_file_tests_b.bin", {4, 6, 37}, ftl::FileMode::create, tile_bytes);
+    ftl::FileTensor<float>  D("ftl_file_tests_d.bin", {4, 6, 37}, ftl::FileMode::create, 3 * tile_bytes);
+    ftl::DynamicTensorCpu<float> bias({4});
+    for (size_t i = 0; i < 4; ++i) bias[i] = static_cast<float>(i) * 0.5f;
+
+    // The inputs are tiled differently to the output
+    ftl::evaluate_tiled(A, [] (const Tile& a) { return a * 0.f + 1.f; }, A);
+    for (size_t t = 0; t < B.num_tiles(); ++t) {
+        Tile tile = B.read_tile(t);
+        for (size_t i = 0; i < tile.size(); ++i) tile[i] = static_cast<float>(t * 120 + i);
+        B.write_tile(t, tile);
+    }
+
+    ftl::evaluate_tiled(D, [&bias] (const Tile& a, const Tile& b) { return (a + b) * 2.f + bias; }, A, B);
+    ftl::evaluate_tiled(D, [] (const Tile& d) { return d - 1.f; }, D);
+
+    bool correct = true;
+    for (size_t t = 0; t < D.num_tiles(); ++t) {
+        const Tile tile = D.read_tile(t);
+        for (size_t i = 0; i < tile.size(); ++i) {
+            const size_t index = t * D.tile_slabs() * 24 + i;
+            correct &= tile[i] == (1.f + static_cast<float>(index)) * 2.f + bias[index % 4] - 1.f;
+        }
+    }
+    BOOST_CHECK( correct );
+
+    ftl::FileTensor<float> E("ftl_file_tests_e.bin", {4, 6, 36}, ftl::FileMode::create);
+    BOOST_CHECK_THROW( ftl::evaluate_tiled(E, [] (const Tile& a) { return a; }, A), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::evaluate_tiled(D, [] (const Tile& a) { return a.slice(0, ftl::all, ftl::all); }, A),
+                       std::invalid_argument );
+    for (const char* name : { "a", "b", "d", "e" })
+        std::remove((std::string("ftl_file_tests_") + name + ".bin").c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
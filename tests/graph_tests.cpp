@@ -0,0 +1,85 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   graph_tests.cpp
+/// @brief  Test suite for computation graphs which are optimized and compiled at runtime
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE GraphTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/graph.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE( GraphSuite )
+
+BOOST_AUTO_TEST_CASE( compilingAGraphMergesCommonSubexpressionsAndFoldsConstants )
+{
+    ftl::Graph<float> graph;
+    auto x = graph.input(), y = graph.input();
+
+    // x * y + 1 is recorded three times (once as y * x), and tanh of it twice, but each is evaluated once
+    auto h = ftl::tanh(x * y + 1.f);
+    auto g = ftl::tanh(y * x + 1.f);
+    auto f = graph.compile({ h * g + h, ftl::sigmoid(x * y + 1.f) });
+    BOOST_CHECK( f.num_instructions() == 6 );
+
+    // Constants are folded, identities removed, and unused nodes aren't evaluated
+    auto c = graph.constant(2.f) * graph.constant(3.f) - 6.f;
+    ftl::exp(x);
+    auto e = graph.compile({ (x + c) * 1.f / ftl::sqrt(graph.constant(1.f)) - -(-y) });
+    BOOST_CHECK( e.num_instructions() == 1 );
+
+    ftl::Graph<float> other;
+    BOOST_CHECK_THROW( x + other.input(), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( compiledGraphsGiveTheResultsOfExpressionsForNewInputs )
+{
+    ftl::Graph<double> graph;
+    auto x = graph.input(), y = graph.input();
+    auto h = ftl::tanh(x * y + 1.0);
+    auto f = graph.compile({ h * h + ftl::pow(y, 2.0), ftl::maximum(ftl::abs(x - y), 0.5) / 2.0, x });
+
+    // Two inputs, three constants (2.0 is used twice), and the ten operations share two buffers
+    BOOST_CHECK( f.num_instructions() == 10 && f.num_slots() == 7 );
+
+    // Sizes which aren't multiples of the block, and which are evaluated by several threads
+    for (const size_t size : { 3, 1000, 20000 }) {
+        ftl::DynamicTensorCpu<double> X({size, 1}), Y({size, 1});
+        for (size_t i = 0; i < size; ++i) {
+            X[i] = std::sin(static_cast<double>(i)) * 2.0;
+            Y[i] = std::cos(static_cast<double>(i) * 0.5);
+        }
+        ftl::DynamicTensorCpu<double> H = ftl::tanh(X * Y + 1.0);
+        ftl::DynamicTensorCpu<double> F = H * H + ftl::pow(Y, 2.0);
+        ftl::DynamicTensorCpu<double> G = ftl::maximum(ftl::abs(X - Y), 0.5) / 2.0;
+
+        auto results = f({ X, Y });
+        BOOST_CHECK( results.size() == 3 && results[0].dim_sizes() == X.dim_sizes() );
+        double error = 0;
+        for (size_t i = 0; i < size; ++i) {
+            error = std::max(error, std::fabs(results[0][i] - F[i]) + std::fabs(results[1][i] - G[i]));
+            error = std::max(error, std::fabs(results[2][i] - X[i]));
+        }
+        BOOST_CHECK( error < 1e-12 );
+
+        // Evaluating in place
+        f.run({ X, Y }, { X, Y, results[2] });
+        error = 0;
+        for (size_t i = 0; i < size; ++i)
+            error = std::max(error, std::fabs(X[i] - F[i]) + std::fabs(Y[i] - G[i]));
+        BOOST_CHECK( error < 1e-12 );
+    }
+
+    ftl::DynamicTensorCpu<double> A({3, 4}), B({4, 3});
+    BOOST_CHECK_THROW( f({ A, B }), std::invalid_argument );
+    BOOST_CHECK_THROW( f({ A }), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   half_tests.cpp
+/// @brief  Test suite for the 16 bit floating point types and casts of tensor expressions
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE HalfTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/tensor_cast.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( HalfSuite )
+
+BOOST_AUTO_TEST_CASE( halfAndBfloat16RoundToNearestEven )
+{
+    // Exact values, ties (to even), subnormals, overflow, infinities and NaN
+    BOOST_CHECK( ftl::half(1.f).bits == 0x3C00 && ftl::half(-2.f).bits == 0xC000 );
+    BOOST_CHECK( ftl::half(1.f + std::ldexp(1.f, -11)).bits == 0x3C00 );
+    BOOST_CHECK( ftl::half(1.f + 3.f * std::ldexp(1.f, -11)).bits == 0x3C02 );
+    BOOST_CHECK( ftl::half(std::ldexp(1.f, -24)).bits == 0x0001 && ftl::half(std::ldexp(1.f, -26)).bits == 0 );
+    BOOST_CHECK( ftl::half(65504.f).bits == 0x7BFF && ftl::half(65520.f).bits == 0x7C00 );
+    BOOST_CHECK( ftl::half(-std::numeric_limits<float>::infinity()).bits == 0xFC00 );
+    BOOST_CHECK( std::isnan(static_cast<float>(ftl::half(std::numeric_limits<float>::quiet_NaN()))) );
+
+    bool exact = true;
+    for (unsigned bits = 0; bits < 0x10000; ++bits) {
+        const ftl::half h = ftl::half::from_bits(static_cast<std::uint16_t>(bits));
+        if ((bits & 0x7C00) != 0x7C00 || (bits & 0x03FF) == 0) exact &= ftl::half(static_cast<float>(h)).bits == bits;
+    }
+    BOOST_CHECK( exact );
+    BOOST_CHECK( static_cast<float>(ftl::half::from_bits(0x0200)) == std::ldexp(1.f, -15) );
+
+    BOOST_CHECK( ftl::bfloat16(1.f).bits == 0x3F80 && static_cast<float>(ftl::bfloat16(-3.f)) == -3.f );
+    BOOST_CHECK( ftl::bfloat16(1.f + std::ldexp(1.f, -8)).bits == 0x3F80 );
+    BOOST_CHECK( ftl::bfloat16(1.f + 3.f * std::ldexp(1.f, -8)).bits == 0x3F82 );
+    BOOST_CHECK( std::isnan(static_cast<float>(ftl::bfloat16(std::numeric_limits<float>::quiet_NaN()))) );
+    BOOST_CHECK( (-ftl::half(3.f)).bits == 0xC200 );
+}
+
+BOOST_AUTO_TEST_CASE( castsConvertTheElementsOfExpressions )
+{
+    // Sizes which don't fill whole blocks or packets, so that the scalar tails are converted too
+    ftl::DynamicTensorCpu<float> A({37, 29});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = std::sin(static_cast<float>(i)) * 100.f;
+    A[3] = std::numeric_limits<float>::infinity();
+    A[40] = std::numeric_limits<float>::quiet_NaN();
+
+    ftl::DynamicTensorCpu<ftl::half>     H = ftl::cast<ftl::half>(A);
+    ftl::DynamicTensorCpu<ftl::bfloat16> B = ftl::cast<ftl::bfloat16>(A * 2.f);
+    ftl::DynamicTensorCpu<float>         F = ftl::cast<float>(H) + ftl::cast<float>(B);
+    ftl::DynamicTensorCpu<double>        D = ftl::cast<double>(H);
+    BOOST_CHECK( H.dim_sizes() == A.dim_sizes() && F.size() == A.size() );
+
+    bool equal = true;
+    for (size_t i = 0; i < A.size(); ++i) {
+        if (i == 40) continue;
+        equal &= H[i].bits == ftl::half(A[i]).bits && B[i].bits == ftl::bfloat16(A[i] * 2.f).bits;
+        equal &= F[i] == static_cast<float>(H[i]) + static_cast<float>(B[i]);
+        equal &= D[i] == static_cast<double>(static_cast<float>(H[i]));
+    }
+    BOOST_CHECK( equal );
+    BOOST_CHECK( std::isnan(static_cast<float>(H[40])) && std::isnan(static_cast<float>(B[40])) && std::isnan(F[40]) );
+
+    // Casts of views, and of static tensors
+    ftl::DynamicTensorCpu<float> S = ftl::cast<float>(H.slice(ftl::Range(1, 37, 3), ftl::all));
+    BOOST_CHECK( S.size(0) == 12 && S(2, 5) == static_cast<float>(H(7, 5)) );
+
+    ftl::StaticTensorCpu<double, 3, 4> T;
+    for (size_t i = 0; i < T.size(); ++i) T[i] = static_cast<double>(i) + 0.25;
+    ftl::StaticTensorCpu<int, 3, 4> I = ftl::cast<int>(T);
+    BOOST_CHECK( I(2, 3) == 11 && I(1, 0) == 1 );
+}
+
+BOOST_AUTO_TEST_CASE( reductionsAndContractionsOfHalvesAccumulateInFloats )
+{
+    // Sums which are larger than 2048 can't be accumulated in halves (adding 1 has no effect)
+    ftl::DynamicTensorCpu<ftl::half> A({100, 50});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = 1.f;
+    BOOST_CHECK( static_cast<float>(ftl::sum(A)) == 5000.f && static_cast<float>(ftl::mean(A)) == 1.f );
+
+    ftl::DynamicTensorCpu<ftl::half> R = ftl::sum(A, 1), C = ftl::sum(A, 0);
+    BOOST_CHECK( R.size() == 100 && static_cast<float>(R[99]) == 50.f );
+    BOOST_CHECK( C.size() == 50 && static_cast<float>(C[0]) == 100.f );
+
+    ftl::DynamicTensorCpu<ftl::bfloat16> P({3000});
+    for (size_t i = 0; i < P.size(); ++i) P[i] = 1.f;
+    BOOST_CHECK( static_cast<float>(ftl::sum(P)) == 3008.f );                 // 3000 rounded to bfloat16
+
+    // Contractions give the rounded float results
+    ftl::DynamicTensorCpu<float> X({40, 3000}), Y({3000, 20});
+    for (size_t i = 0; i < X.size(); ++i) X[i] = static_cast<float>(i % 7) * 0.25f;
+    for (size_t i = 0; i < Y.size(); ++i) Y[i] = static_cast<float>(i % 5) - 2.f;
+    ftl::DynamicTensorCpu<ftl::half> HX = ftl::cast<ftl::half>(X), HY = ftl::cast<ftl::half>(Y);
+    ftl::DynamicTensorCpu<ftl::half> Z = ftl::contract(HX, HY, {{1, 0}});
+    ftl::DynamicTensorCpu<float>     expected = ftl::contract(X, Y, {{1, 0}});
+
+    bool equal = Z.dim_sizes() == expected.dim_sizes();
+    for (size_t i = 0; i < Z.size(); ++i) equal &= Z[i].bits == ftl::half(expected[i]).bits;
+    BOOST_CHECK( equal );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
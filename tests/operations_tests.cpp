@@ -13,9 +13,19 @@
 #include "../tensor/tensor_operations.hpp"
 
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 BOOST_AUTO_TEST_SUITE( OperationsSuite )
 
+// Builds an expression in its own stack frame, so that the interior nodes are temporaries of that frame
+template <typename Tensor>
+auto make_pipeline(const Tensor& a, const Tensor& b, const Tensor& c) -> decltype((a + b) - (c + a))
+{
+    return (a + b) - (c + a);
+}
+
 // -------------------------------------------- ADDITION ---------------------------------------------------
 
 BOOST_AUTO_TEST_CASE( canAdd2StaticTensors )
@@ -68,10 +78,11 @@ BOOST_AUTO_TEST_CASE( canAddAStaticAndDynamicTensorToGetAStaticTensor )
     // Initialize B with values of 10
     B.initialize(10, 10);
 
-    // Addition takes the traits of the first tensor in the addition (A)
-    // So C and D are static tensors since A is a static tensor
+    // The static shape of A is propagated to the addition, so C and D are static
     auto C = A + B;
     ftl::Tensor<int, ftl::CPU, 2, 2> D = A + B;
+    static_assert(std::is_same<decltype(C)::traits, ftl::TensorTraits<int, ftl::CPU, 2, 2>>::value,
+                  "Adding a static and a dynamic tensor must give a static result");
     
     BOOST_CHECK( C[0] == 11 );
     BOOST_CHECK( D[0] == 11 );
@@ -84,7 +95,7 @@ BOOST_AUTO_TEST_CASE( canAddAStaticAndDynamicTensorToGetAStaticTensor )
     
 }
 
-BOOST_AUTO_TEST_CASE( canAddADynamicAndStaticTensorToGetADynamicTensor )
+BOOST_AUTO_TEST_CASE( canAddADynamicAndStaticTensorToGetAStaticTensor )
 {
     ftl::Tensor<int, ftl::CPU> A{ 2, 2 };
     ftl::Tensor<int, ftl::CPU, 2, 2> B{ 1, 2, 3, 4 };
@@ -92,10 +103,12 @@ BOOST_AUTO_TEST_CASE( canAddADynamicAndStaticTensorToGetADynamicTensor )
     // Initialize A with values of 10
     A.initialize(10, 10);
 
-    // Addition takes the traits of the first tensor in the addition (A)
-    // So C and D are dynamic tensors since A is a dynamic tensor
+    // The static shape of B is propagated to the addition, with the data type of A, and the result can still
+    // be assigned to a dynamic tensor
     auto C = A + B;
     ftl::Tensor<int, ftl::CPU> D = A + B;
+    static_assert(std::is_same<decltype(C)::traits, ftl::TensorTraits<int, ftl::CPU, 2, 2>>::value,
+                  "Adding a dynamic and a static tensor must give a static result");
     
     BOOST_CHECK( C[0] == 11 );
     BOOST_CHECK( D[0] == 11 );
@@ -107,6 +120,32 @@ BOOST_AUTO_TEST_CASE( canAddADynamicAndStaticTensorToGetADynamicTensor )
     BOOST_CHECK( D[3] == 14 ); 
 }
 
+BOOST_AUTO_TEST_CASE( dynamicOperandsAreCheckedAgainstTheStaticShape )
+{
+    ftl::StaticTensorCpu<float, 4, 3> S;
+    ftl::DynamicTensorCpu<float> A({4, 3});
+    ftl::DynamicTensorCpu<float> B({4, 2});
+    ftl::DynamicTensorCpu<float> bias({4});
+    for (size_t i = 0; i < S.size(); ++i) { S[i] = 1.f * i; A[i] = 2.f; }
+    for (size_t i = 0; i < bias.size(); ++i) bias[i] = 10.f * i;
+
+    // The checks are made once, when the expression is created, in either order
+    BOOST_CHECK_THROW( S + B, std::invalid_argument );
+    BOOST_CHECK_THROW( B - S, std::invalid_argument );
+
+    // Static through the whole tree, with a dynamic operand broadcast to the static shape
+    auto e = (A + S) - bias;
+    static_assert(std::is_same<decltype(e)::traits, ftl::TensorTraits<float, ftl::CPU, 4, 3>>::value,
+                  "Static shapes must be propagated through the expression tree");
+    BOOST_CHECK( e.size() == 12 );
+    ftl::StaticTensorCpu<float, 4, 3> T = e;
+    BOOST_CHECK( T(3, 2) == 2.f + S(3, 2) - 30.f );
+
+    // A static operand can't be broadcast to a larger dynamic shape, since the static shape is the result
+    ftl::DynamicTensorCpu<float> C({4, 3, 2});
+    BOOST_CHECK_THROW( S + C, std::invalid_argument );
+}
+
 // ---------------------------------------------- SUBTRACTION -----------------------------------------------
 
 BOOST_AUTO_TEST_CASE( canSubtract2StaticTensors )
@@ -131,4 +170,226 @@ BOOST_AUTO_TEST_CASE( canSubtract2StaticTensors )
     BOOST_CHECK( D(1, 1) == -4 );
 }
 
+// ----------------------------------------- CHAINED EXPRESSIONS -------------------------------------------
+
+BOOST_AUTO_TEST_CASE( canStoreChainedExpressionsAndEvaluateLater )
+{
+    ftl::DynamicTensorCpu<float> A({3, 5});
+    ftl::DynamicTensorCpu<float> B({3, 5});
+    ftl::DynamicTensorCpu<float> C({3, 5});
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = 1.f * i; B[i] = 2.f * i; C[i] = 4.f; }
+
+    // The interior nodes are destroyed with the frame of make_pipeline, so must be held by value
+    auto e = make_pipeline(A, B, C);
+    ftl::DynamicTensorCpu<float> D = e;
+    BOOST_CHECK( D[7] == 2.f * 7 - 4.f );
+
+    // Leaf tensors are held by reference, so the stored expression sees new values
+    for (size_t i = 0; i < B.size(); ++i) B[i] = 3.f;
+    ftl::DynamicTensorCpu<float> E = e;
+    BOOST_CHECK( E[7] == -1.f );
+    BOOST_CHECK( e[2] == -1.f );
+
+    // A view which is a temporary is held by value
+    auto f = A.slice(ftl::all, 1) + C.slice(ftl::all, 2);
+    ftl::DynamicTensorCpu<float> F = f;
+    BOOST_CHECK( F[2] == A(2, 1) + 4.f );
+}
+
+BOOST_AUTO_TEST_CASE( expressionElementsAreReturnedByValue )
+{
+    using tensor_type   = ftl::StaticTensorCpu<int, 2, 2>;
+    using pipeline_type = std::decay<decltype(make_pipeline(std::declval<const tensor_type&>(),
+                                                            std::declval<const tensor_type&>(),
+                                                            std::declval<const tensor_type&>()))>::type;
+    using base_type     = ftl::TensorExpression<pipeline_type, pipeline_type::traits>;
+
+    static_assert(std::is_same<decltype(std::declval<const base_type&>()[0]), int>::value,
+                  "Elements of an expression must be returned by value");
+
+    tensor_type A{ 1, 2, 3, 4 };
+    tensor_type B{ 4, 3, 2, 1 };
+    tensor_type C{ 1, 1, 1, 1 };
+    auto e = make_pipeline(A, B, C);
+    const base_type& base = e;
+    BOOST_CHECK( base[0] == 3 );
+    BOOST_CHECK( base[3] == 0 );
+}
+
+// --------------------------------------------- BROADCASTING ----------------------------------------------
+
+BOOST_AUTO_TEST_CASE( canBroadcastABiasVectorAcrossARank4Tensor )
+{
+    // The missing trailing dimensions of the bias have a size of 1
+    ftl::DynamicTensorCpu<float> A({8, 3, 5, 2});
+    ftl::DynamicTensorCpu<float> bias({8});
+    for (size_t i = 0; i < A.size(); ++i)    A[i]    = static_cast<float>(i);
+    for (size_t i = 0; i < bias.size(); ++i) bias[i] = 1000.f * i;
+
+    ftl::DynamicTensorCpu<float> B = A + bias;
+    ftl::DynamicTensorCpu<float> C = bias - A;
+    BOOST_CHECK( B.rank() == 4 );
+    BOOST_CHECK( C.size() == A.size() );
+    BOOST_CHECK( B(5, 2, 4, 1) == A(5, 2, 4, 1) + 5000.f );
+    BOOST_CHECK( C(7, 0, 3, 0) == 7000.f - A(7, 0, 3, 0) );
+
+    ftl::StaticTensorCpu<float, 8, 3, 5, 2> S;
+    ftl::StaticTensorCpu<float, 8> s;
+    for (size_t i = 0; i < S.size(); ++i) S[i] = static_cast<float>(i);
+    for (size_t i = 0; i < s.size(); ++i) s[i] = 1000.f * i;
+
+    // Both shapes are static, so the result is static with the broadcast shape
+    auto e = s + S;
+    static_assert(std::is_same<decltype(e)::traits, ftl::TensorTraits<float, ftl::CPU, 8, 3, 5, 2>>::value,
+                  "Broadcasting static tensors must give the static broadcast shape");
+    ftl::StaticTensorCpu<float, 8, 3, 5, 2> T = e;
+    bool matches = true;
+    for (size_t i = 0; i < T.size(); ++i) matches = matches && T[i] == S[i] + s[i % 8];
+    BOOST_CHECK( matches );
+}
+
+BOOST_AUTO_TEST_CASE( canBroadcastDimensionsOfSize1 )
+{
+    // A column (3 x 1) and a row (1 x 37) give a 3 x 37 result, with packets which span the columns
+    ftl::DynamicTensorCpu<double> column({3, 1});
+    ftl::DynamicTensorCpu<double> row({1, 37});
+    for (size_t i = 0; i < column.size(); ++i) column[i] = 100.0 * i;
+    for (size_t i = 0; i < row.size(); ++i)    row[i]    = 1.0 * i;
+
+    ftl::DynamicTensorCpu<double> A = column + row;
+    BOOST_CHECK( A.size(0) == 3 );
+    BOOST_CHECK( A.size(1) == 37 );
+    bool matches = true;
+    for (size_t j = 0; j < 37; ++j)
+        for (size_t i = 0; i < 3; ++i) matches = matches && A(i, j) == 100.0 * i + j;
+    BOOST_CHECK( matches );
+
+    // A vector along the middle dimension of a rank 3 tensor
+    ftl::DynamicTensorCpu<int> B({4, 5, 6});
+    ftl::DynamicTensorCpu<int> v({1, 5});
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<int>(i);
+    for (size_t i = 0; i < v.size(); ++i) v[i] = 1000 * static_cast<int>(i);
+    ftl::DynamicTensorCpu<int> C = B - v;
+    matches = true;
+    for (size_t k = 0; k < 6; ++k)
+        for (size_t j = 0; j < 5; ++j)
+            for (size_t i = 0; i < 4; ++i) matches = matches && C(i, j, k) == B(i, j, k) - 1000 * int(j);
+    BOOST_CHECK( matches );
+}
+
+BOOST_AUTO_TEST_CASE( broadcastingMismatchedDimensionsThrows )
+{
+    ftl::DynamicTensorCpu<float> A({4, 3});
+    ftl::DynamicTensorCpu<float> B({3});
+    ftl::DynamicTensorCpu<float> C({4, 2});
+    BOOST_CHECK_THROW( A + B, std::invalid_argument );
+    BOOST_CHECK_THROW( C - A, std::invalid_argument );
+
+    // A static tensor can't be broadcast to a dynamic shape which doesn't match
+    ftl::StaticTensorCpu<float, 4, 3> S;
+    BOOST_CHECK_THROW( S + C, std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( compoundOperatorsBroadcastTheExpression )
+{
+    ftl::DynamicTensorCpu<float> A({5, 7});
+    ftl::DynamicTensorCpu<float> bias({5});
+    for (size_t i = 0; i < A.size(); ++i)    A[i]    = 1.f;
+    for (size_t i = 0; i < bias.size(); ++i) bias[i] = 1.f * i;
+
+    const float* data = A.data().data();
+    A += bias;
+    BOOST_CHECK( A.data().data() == data );
+    BOOST_CHECK( A(3, 6) == 4.f );
+    A -= bias;
+    BOOST_CHECK( A(3, 6) == 1.f );
+
+    // The tensor itself can't be broadcast to the shape of the expression
+    BOOST_CHECK_THROW( bias += A, std::invalid_argument );
+
+    ftl::StaticTensorCpu<int, 4, 2> S{ 1, 2, 3, 4, 5, 6, 7, 8 };
+    ftl::StaticTensorCpu<int, 1, 2> s{ 10, 20 };
+    S += s;
+    BOOST_CHECK( S(3, 0) == 14 );
+    BOOST_CHECK( S(0, 1) == 25 );
+}
+
+// ---------------------------------------------- ASSIGNMENT ------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( canAssignInPlaceWithoutAllocating )
+{
+    ftl::DynamicTensorCpu<float> A({4, 9});
+    ftl::DynamicTensorCpu<float> B({4, 9});
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = 1.f * i; B[i] = 2.f; }
+
+    const float* data = A.data().data();
+    A = A + B;
+    A += B;
+    A -= B - A;
+
+    // A = 2 * (i + 4) - 2 = 2i + 6, using the same memory
+    BOOST_CHECK( A.data().data() == data );
+    BOOST_CHECK( A[0]  == 6.f );
+    BOOST_CHECK( A[35] == 76.f );
+
+    // Assigning an expression with a different shape reshapes the tensor
+    ftl::DynamicTensorCpu<float> C({2, 3});
+    ftl::DynamicTensorCpu<float> D({2, 3});
+    for (size_t i = 0; i < C.size(); ++i) { C[i] = 1.f; D[i] = 1.f * i; }
+    A = C + D;
+    BOOST_CHECK( A.rank() == 2 );
+    BOOST_CHECK( A.size() == 6 );
+    BOOST_CHECK( A(1, 2) == 6.f );
+
+    BOOST_CHECK_THROW( B += C, std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( canUseCompoundOperatorsOnStaticTensors )
+{
+    ftl::StaticTensorCpu<int, 2, 3> A{ 1, 2, 3, 4, 5, 6 };
+    ftl::StaticTensorCpu<int, 2, 3> B{ 1, 1, 1, 1, 1, 1 };
+    ftl::StaticTensorCpu<ftl::Policies<int, ftl::RowMajor>, 2, 3> R;
+    R = A + B;
+
+    A += B;
+    A += A - B;
+    BOOST_CHECK( A[0] == 3 );
+    BOOST_CHECK( A[5] == 13 );
+
+    // Row-major tensors are written through their layout
+    R -= B;
+    BOOST_CHECK( R(1, 0) == 2 );
+    BOOST_CHECK( R(0, 2) == 5 );
+
+    // Dynamic expressions are checked at runtime, even if they have the same number of elements
+    ftl::DynamicTensorCpu<int> C({3, 2});
+    ftl::DynamicTensorCpu<int> D({2, 3});
+    BOOST_CHECK_THROW( A = C, std::invalid_argument );
+    BOOST_CHECK_THROW( A += C, std::invalid_argument );
+    BOOST_CHECK_THROW( A -= C, std::invalid_argument );
+    BOOST_CHECK_NO_THROW( A = D );
+}
+
+BOOST_AUTO_TEST_CASE( overlappingAssignmentIsBuffered )
+{
+    // Shifting the elements right reads elements which have already been written, so needs a temporary
+    ftl::DynamicTensorCpu<int> A({40});
+    ftl::DynamicTensorCpu<int> B({39});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i);
+    for (size_t i = 0; i < B.size(); ++i) B[i] = 100;
+
+    A.slice(ftl::Range(1, 40)) = A.slice(ftl::Range(0, 39)) + B;
+    BOOST_CHECK( A[0]  == 0 );
+    BOOST_CHECK( A[1]  == 100 );
+    BOOST_CHECK( A[2]  == 101 );
+    BOOST_CHECK( A[39] == 138 );
+
+    ftl::StaticTensorCpu<float, 16> S;
+    for (size_t i = 0; i < S.size(); ++i) S[i] = static_cast<float>(i);
+    S.slice(ftl::StaticRange<2, 16>()) = S.slice(ftl::StaticRange<0, 14>());
+    BOOST_CHECK( S[1]  == 1.f );
+    BOOST_CHECK( S[2]  == 0.f );
+    BOOST_CHECK( S[15] == 13.f );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   permute_tests.cpp
+/// @brief  Test suite for permuting the dimensions of tensors
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE PermuteTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/permute.hpp"
+
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE( PermuteSuite )
+
+BOOST_AUTO_TEST_CASE( permutedViewsReferToTheElementsOfTheTensor )
+{
+    ftl::DynamicTensorCpu<int> A({2, 3, 4});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i);
+
+    auto V = ftl::permuted(A, {2, 0, 1});
+    BOOST_CHECK( V.size(0) == 4 && V.size(1) == 2 && V.size(2) == 3 );
+    BOOST_CHECK( V(3, 1, 2) == A(1, 2, 3) && V(0, 1, 0) == A(1, 0, 0) );
+
+    // Assigning to a view of the transpose
+    ftl::DynamicTensorCpu<int> B({3, 5}), C({5, 3});
+    for (size_t i = 0; i < C.size(); ++i) C[i] = static_cast<int>(i) * 3;
+    ftl::permuted(B, {1, 0}) = C;
+    BOOST_CHECK( B(2, 4) == C(4, 2) && B(1, 3) == C(3, 1) );
+
+    // Views of views, and views of static tensors
+    const ftl::DynamicTensorCpu<int>& D = A;
+    BOOST_CHECK( ftl::permuted(ftl::permuted(D, {1, 2, 0}), {2, 0, 1})(1, 2, 3) == A(1, 2, 3) );
+
+    ftl::StaticTensorCpu<int, 2, 3, 4> S;
+    for (size_t i = 0; i < S.size(); ++i) S[i] = static_cast<int>(i);
+    auto W = ftl::permuted<2, 0, 1>(S);
+    W(3, 1, 2) = -1;
+    BOOST_CHECK( W.size(0) == 4 && S(1, 2, 3) == -1 );
+
+    BOOST_CHECK_THROW( ftl::permuted(A, {0, 1}), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::permuted(A, {0, 1, 1}), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::permuted(A, {0, 3, 1}), std::invalid_argument );
+    ftl::DynamicTensorCpu<int> T({8, 8}, ftl::Tiled<4, 4>());
+    BOOST_CHECK_THROW( ftl::permute(T, {1, 0}), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( permutingCopiesTheElementsInThePermutedOrder )
+{
+    // Sizes which aren't multiples of the blocks, or of the squares which are transposed in registers, so
+    // that transposes, copies of runs and gathers are all used
+    ftl::DynamicTensorCpu<float> A({37, 5, 70});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i);
+
+    for (const auto& order : { std::vector<size_t>{2, 0, 1}, std::vector<size_t>{0, 2, 1},
+                               std::vector<size_t>{1, 2, 0}, std::vector<size_t>{0, 1, 2} }) {
+        ftl::DynamicTensorCpu<float> B = ftl::permute(A, order);
+        auto V = ftl::permuted(A, order);
+        bool equal = B.dim_sizes() == V.dim_sizes();
+        for (size_t k = 0; k < B.size(2); ++k)
+            for (size_t j = 0; j < B.size(1); ++j)
+                for (size_t i = 0; i < B.size(0); ++i) equal &= B(i, j, k) == V(i, j, k);
+        BOOST_CHECK( equal );
+    }
+
+    // A view with strided rows and a dimension of size 1
+    ftl::DynamicTensorCpu<double> C({67, 1, 41});
+    for (size_t i = 0; i < C.size(); ++i) C[i] = static_cast<double>(i) * 0.5;
+    auto S = C.slice(ftl::Range(1, 67, 2), ftl::all, ftl::all);
+    ftl::DynamicTensorCpu<double> D = ftl::permute(S, {2, 1, 0});
+    bool equal = D.size(0) == 41 && D.size(1) == 1 && D.size(2) == 33;
+    for (size_t k = 0; k < 33; ++k)
+        for (size_t i = 0; i < 41; ++i) equal &= D(i, 0, k) == C(2 * k + 1, 0, i);
+    BOOST_CHECK( equal );
+
+    ftl::StaticTensorCpu<ftl::Policies<double, ftl::RowMajor>, 9, 13> E;
+    for (size_t i = 0; i < E.size(); ++i) E[i] = static_cast<double>(i);
+    auto F = ftl::permute<1, 0>(E);
+    equal = F.size(0) == 13 && F.size(1) == 9;
+    for (size_t j = 0; j < 9; ++j)
+        for (size_t i = 0; i < 13; ++i) equal &= F(i, j) == E(j, i);
+    BOOST_CHECK( equal );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   quantized_tests.cpp
+/// @brief  Test suite for quantized tensors, their expressions and their contractions
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE QuantizedTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/quantized.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE( QuantizedSuite )
+
+BOOST_AUTO_TEST_CASE( expressionsAreQuantizedAndDequantized )
+{
+    // Sizes which don't fill whole blocks or registers, so that the scalar tails are quantized too
+    ftl::DynamicTensorCpu<float> A({37, 29});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = std::sin(static_cast<float>(i)) * 10.f;
+    A[5] = 1000.f; A[6] = -1000.f; A[7] = 0.25f; A[8] = 0.75f;
+    A[9] = std::numeric_limits<float>::quiet_NaN();
+
+    // Clamped to the range of the type, ties rounded to even, and NaN clamped to the minimum
+    ftl::QuantizedTensorCpu<std::int8_t>  Q = ftl::quantize<std::int8_t>(A, 0.5f);
+    ftl::QuantizedTensorCpu<std::uint8_t> U = ftl::quantize<std::uint8_t>(A * 2.f, 0.25f, 100);
+    BOOST_CHECK( Q[5] == 127 && Q[6] == -128 && Q[7] == 0 && Q[8] == 2 && Q[9] == -128 );
+    BOOST_CHECK( U[5] == 255 && U[6] == 0 && U[7] == 102 && U[9] == 0 );
+
+    bool equal = true;
+    for (size_t i = 10; i < A.size(); ++i) {
+        equal &= Q[i] == static_cast<std::int8_t>(std::nearbyint(A[i] * 2.f));
+        equal &= U[i] == static_cast<std::uint8_t>(std::min(255.f, std::max(0.f, std::nearbyint(A[i] * 8.f) + 100.f)));
+    }
+    BOOST_CHECK( equal );
+
+    // Dequantized values in expressions, which are evaluated a packet or a block at a time
+    ftl::DynamicTensorCpu<float> D = ftl::dequantize(Q), E = ftl::dequantize(Q) + ftl::dequantize(U) * 2.f;
+    equal = true;
+    for (size_t i = 0; i < A.size(); ++i) {
+        equal &= D[i] == static_cast<float>(Q[i]) * 0.5f;
+        equal &= E[i] == static_cast<float>(Q[i]) * 0.5f + (static_cast<float>(U[i]) - 100.f) * 0.25f * 2.f;
+    }
+    BOOST_CHECK( equal );
+
+    // Per-axis quantization, with a scale and zero point for each column
+    std::vector<float>        scales(29);
+    std::vector<std::int32_t> zero_points(29);
+    for (size_t j = 0; j < 29; ++j) { scales[j] = 0.1f * static_cast<float>(j + 1); zero_points[j] = 128 + j; }
+    ftl::QuantizedTensorCpu<std::uint8_t> P = ftl::quantize<std::uint8_t>(A, 1, scales, zero_points);
+    ftl::DynamicTensorCpu<float> F = ftl::dequantize(P);
+    BOOST_CHECK( P.axis() == 1 && P.scales().size() == 29 );
+    BOOST_CHECK( F(20, 3) == (static_cast<float>(P[20 + 3 * 37]) - 131.f) * scales[3] );
+    BOOST_CHECK( std::fabs(F(20, 3) - A(20, 3)) <= scales[3] * 0.5f );
+
+    BOOST_CHECK_THROW( ftl::quantize<std::int8_t>(A, 0.f), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::quantize<std::int8_t>(A, 1.f, 200), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::quantize<std::uint8_t>(A, 2, scales, zero_points), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::quantize<std::uint8_t>(A, 0, scales, zero_points), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( quantizationsAreCalibratedFromTheRange )
+{
+    ftl::DynamicTensorCpu<float> A({40, 3});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = std::cos(static_cast<float>(i)) * static_cast<float>(i / 40 + 1);
+
+    // Symmetric for int8_t, and asymmetric (with zero represented exactly) for uint8_t
+    ftl::QuantizedTensorCpu<std::int8_t>  Q(A);
+    ftl::QuantizedTensorCpu<std::uint8_t> U(A + 3.f);
+    ftl::QuantizedTensorCpu<std::int8_t>  C(A, 1);
+    BOOST_CHECK( Q.zero_points()[0] == 0 && std::fabs(Q.scales()[0] * 127.f - ftl::norm_inf(A)) < 1e-5f );
+    BOOST_CHECK( U.zero_points()[0] == 0 && std::fabs(U.scales()[0] * 255.f - ftl::max(A + 3.f)) < 1e-5f );
+    BOOST_CHECK( C.scales().size() == 3 && C.scales()[2] > C.scales()[0] );
+
+    ftl::DynamicTensorCpu<float> D = ftl::dequantize(Q), E = ftl::dequantize(C);
+    bool close = true;
+    for (size_t i = 0; i < A.size(); ++i) {
+        close &= std::fabs(D[i] - A[i]) <= Q.scales()[0] * 0.5f * 1.0001f;
+        close &= std::fabs(E[i] - A[i]) <= C.scales()[i / 40] * 0.5f * 1.0001f;
+    }
+    BOOST_CHECK( close );
+
+    ftl::DynamicTensorCpu<float> Z({4, 4});
+    for (size_t i = 0; i < Z.size(); ++i) Z[i] = 0.f;
+    ftl::QuantizedTensorCpu<std::uint8_t> R(Z);
+    BOOST_CHECK( R.scales()[0] == 1.f && R.zero_points()[0] == 0 && R[3] == 0 );
+
+    Z[2] = std::numeric_limits<float>::infinity();
+    BOOST_CHECK_THROW( ftl::QuantizedTensorCpu<std::int8_t>{Z}, std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( quantizedContractionsAccumulateIntegers )
+{
+    // Sizes which aren't multiples of the tiles or of the depth of the kernel
+    ftl::DynamicTensorCpu<float> X({37, 70}), Y({70, 11}), W({11, 5, 70});
+    for (size_t i = 0; i < X.size(); ++i) X[i] = std::sin(static_cast<float>(i) * 0.7f) * 3.f;
+    for (size_t i = 0; i < Y.size(); ++i) Y[i] = std::cos(static_cast<float>(i) * 0.3f) + 0.5f;
+    for (size_t i = 0; i < W.size(); ++i) W[i] = std::sin(static_cast<float>(i) * 0.1f) * 2.f;
+
+    // Each combination of signed and unsigned operands, with nonzero zero points, per-axis scales on a free
+    // dimension, and a contraction over the last dimension of the second operand
+    const ftl::QuantizedTensorCpu<std::int8_t>  XS = ftl::quantize<std::int8_t>(X, 0.05f, 3);
+    const ftl::QuantizedTensorCpu<std::uint8_t> XU(X);
+    const ftl::QuantizedTensorCpu<std::int8_t>  YS(Y, 1);
+    const ftl::QuantizedTensorCpu<std::uint8_t> YU(Y);
+    const ftl::QuantizedTensorCpu<std::uint8_t> WU(W, 0);
+
+    auto check = [] (const ftl::DynamicTensorCpu<float>& result, const ftl::DynamicTensorCpu<float>& expected)
+    {
+        bool close = result.dim_sizes() == expected.dim_sizes();
+        for (size_t i = 0; i < result.size(); ++i)
+            close &= std::fabs(result[i] - expected[i]) <= 1e-4f * (1.f + std::fabs(expected[i]));
+        return close;
+    };
+
+    const ftl::DynamicTensorCpu<float> DXS = ftl::dequantize(XS), DXU = ftl::dequantize(XU);
+    const ftl::DynamicTensorCpu<float> DYS = ftl::dequantize(YS), DYU = ftl::dequantize(YU);
+    const ftl::DynamicTensorCpu<float> DWU = ftl::dequantize(WU);
+    BOOST_CHECK( check(ftl::contract(XS, YS, {{1, 0}}), ftl::contract(DXS, DYS, {{1, 0}})) );
+    BOOST_CHECK( check(ftl::contract(XS, YU, {{1, 0}}), ftl::contract(DXS, DYU, {{1, 0}})) );
+    BOOST_CHECK( check(ftl::contract(XU, YS, {{1, 0}}), ftl::contract(DXU, DYS, {{1, 0}})) );
+    BOOST_CHECK( check(ftl::contract(XU, YU, {{1, 0}}), ftl::contract(DXU, DYU, {{1, 0}})) );
+    BOOST_CHECK( check(ftl::contract(XS, WU, {{1, 2}}), ftl::contract(DXS, DWU, {{1, 2}})) );
+    BOOST_CHECK( check(ftl::contract(WU, XU, {{2, 1}}), ftl::contract(DWU, DXU, {{2, 1}})) );
+
+    BOOST_CHECK_THROW( ftl::contract(XS, YS, {{0, 1}}), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::contract(YS, XS, {{1, 0}}), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,225 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   reduction_tests.cpp
+/// @brief  Test suite for reductions over all the elements of tensors and along a dimension
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE ReductionTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE( ReductionSuite )
+
+BOOST_AUTO_TEST_CASE( canReduceAllElements )
+{
+    // Size which is not a multiple of the packet size or the block size
+    ftl::DynamicTensorCpu<double> A({37, 29});
+    double sum = 0.0, product = 1.0, norm1 = 0.0, norm2 = 0.0;
+    for (size_t i = 0; i < A.size(); ++i) {
+        A[i]     = static_cast<double>(i % 17) - 8.0;
+        sum     += A[i];
+        norm1   += std::abs(A[i]);
+        norm2   += A[i] * A[i];
+    }
+    for (size_t i = 0; i < 20; ++i) product *= A[i + 1];
+    A[500] = -20.0; A[900] = 30.0;
+    sum   += -20.0 - (static_cast<double>(500 % 17) - 8.0) + 30.0 - (static_cast<double>(900 % 17) - 8.0);
+    norm1 += 20.0  - std::abs(static_cast<double>(500 % 17) - 8.0) + 30.0 - std::abs(static_cast<double>(900 % 17) - 8.0);
+    norm2 += 400.0 - std::pow(static_cast<double>(500 % 17) - 8.0, 2) + 900.0 - std::pow(static_cast<double>(900 % 17) - 8.0, 2);
+
+    BOOST_CHECK( ftl::sum(A)      == sum );
+    BOOST_CHECK( ftl::min(A)      == -20.0 );
+    BOOST_CHECK( ftl::max(A)      == 30.0 );
+    BOOST_CHECK( ftl::argmin(A)   == 500 );
+    BOOST_CHECK( ftl::argmax(A)   == 900 );
+    BOOST_CHECK( ftl::norm1(A)    == norm1 );
+    BOOST_CHECK( ftl::norm_inf(A) == 30.0 );
+    BOOST_CHECK( std::abs(ftl::norm2(A) - std::sqrt(norm2)) < 1e-12 );
+    BOOST_CHECK( std::abs(ftl::mean(A) - sum / A.size()) < 1e-12 );
+
+    ftl::StaticTensorCpu<int, 4, 5> B;
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<int>(i % 3) + 1;
+    int product_b = 1;
+    for (size_t i = 0; i < B.size(); ++i) product_b *= B[i];
+    BOOST_CHECK( ftl::prod(B) == product_b );
+    BOOST_CHECK( ftl::sum(B)  == 39 );
+    BOOST_CHECK( ftl::argmax(B) == 2 );
+
+    // Reductions of expressions and of non-contiguous views
+    BOOST_CHECK( ftl::sum(A + A) == 2.0 * sum );
+    auto rows = A.slice(ftl::Range(0, 37, 2), ftl::all);
+    double expected = 0.0;
+    for (size_t j = 0; j < 29; ++j)
+        for (size_t i = 0; i < 37; i += 2) expected += A(i, j);
+    BOOST_CHECK( ftl::sum(rows) == expected );
+}
+
+BOOST_AUTO_TEST_CASE( pairwiseSumsAreAccurate )
+{
+    // Adding 0.1f sequentially four million times has a relative error of about 1e-2, pairwise it is tiny
+    const size_t n = 1 << 22;
+    ftl::DynamicTensorCpu<float> A({n});
+    for (size_t i = 0; i < n; ++i) A[i] = 0.1f;
+
+    const double exact = 0.1f * static_cast<double>(n);
+    BOOST_CHECK( std::abs(ftl::sum(A) - exact) / exact < 1e-5 );
+    BOOST_CHECK( std::abs(ftl::mean(A) - 0.1f) < 1e-6f );
+
+    // The same along a dimension
+    ftl::DynamicTensorCpu<float> B({4, 1 << 18});
+    for (size_t i = 0; i < B.size(); ++i) B[i] = 0.1f;
+    ftl::DynamicTensorCpu<float> sums = ftl::sum(B, 1);
+    BOOST_CHECK( std::abs(sums[3] - 0.1 * (1 << 18)) / (0.1 * (1 << 18)) < 1e-5 );
+}
+
+BOOST_AUTO_TEST_CASE( canReduceAlongEachDimension )
+{
+    ftl::DynamicTensorCpu<float> A({5, 70, 3});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>((i * 7) % 23) - 11.f;
+
+    ftl::DynamicTensorCpu<float> S0 = ftl::sum(A, 0);
+    ftl::DynamicTensorCpu<float> S1 = ftl::sum(A, 1);
+    ftl::DynamicTensorCpu<float> M2 = ftl::max(A, 2);
+    ftl::DynamicTensorCpu<size_t> I1 = ftl::argmin(A, 1);
+
+    BOOST_CHECK( S0.rank() == 2 && S0.size(0) == 70 && S0.size(1) == 3 );
+    BOOST_CHECK( S1.rank() == 2 && S1.size(0) == 5  && S1.size(1) == 3 );
+    BOOST_CHECK( M2.rank() == 2 && M2.size(0) == 5  && M2.size(1) == 70 );
+    BOOST_CHECK( I1.size(0) == 5 && I1.size(1) == 3 );
+
+    bool correct = true;
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t k = 0; k < 3; ++k) {
+            float sum = 0.f, best = A(i, 0, k);
+            size_t index = 0;
+            for (size_t j = 0; j < 70; ++j) {
+                sum += A(i, j, k);
+                if (A(i, j, k) < best) { best = A(i, j, k); index = j; }
+            }
+            correct = correct && S1(i, k) == sum && I1(i, k) == index;
+        }
+    }
+    for (size_t j = 0; j < 70; ++j) {
+        for (size_t k = 0; k < 3; ++k) {
+            float sum = 0.f;
+            for (size_t i = 0; i < 5; ++i) sum += A(i, j, k);
+            correct = correct && S0(j, k) == sum;
+        }
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 70; ++j) {
+            const float best = std::max(A(i, j, 0), std::max(A(i, j, 1), A(i, j, 2)));
+            correct = correct && M2(i, j) == best;
+        }
+    }
+    BOOST_CHECK( correct );
+
+    // Reducing a vector gives a single element, and the dimension must exist
+    ftl::DynamicTensorCpu<float> v({10});
+    for (size_t i = 0; i < 10; ++i) v[i] = static_cast<float>(i);
+    ftl::DynamicTensorCpu<float> total = ftl::sum(v, 0);
+    BOOST_CHECK( total.size() == 1 && total[0] == 45.f );
+    BOOST_CHECK_THROW( ftl::sum(A, 3), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( axisReductionsAreLazyExpressions )
+{
+    ftl::StaticTensorCpu<double, 6, 40> A;
+    ftl::DynamicTensorCpu<double> B({6});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<double>(i % 9);
+    for (size_t i = 0; i < B.size(); ++i) B[i] = 1.0;
+
+    // Elements of the reduction are computed on access, and the reduction can be used in other expressions
+    auto norms = ftl::norm2(A, 1);
+    auto means = ftl::mean(A, 1) + B;
+    ftl::DynamicTensorCpu<double> C = means;
+
+    bool correct = true;
+    for (size_t i = 0; i < 6; ++i) {
+        double sum = 0.0, squares = 0.0;
+        for (size_t j = 0; j < 40; ++j) { sum += A(i, j); squares += A(i, j) * A(i, j); }
+        correct = correct && std::abs(C(i) - (sum / 40.0 + 1.0)) < 1e-12
+                          && std::abs(norms[i] - std::sqrt(squares)) < 1e-12;
+    }
+    BOOST_CHECK( correct );
+
+    // Assigning the reduction of a tensor to itself uses a temporary
+    ftl::DynamicTensorCpu<double> D({4, 4});
+    for (size_t i = 0; i < D.size(); ++i) D[i] = static_cast<double>(i);
+    D = ftl::sum(D, 0);
+    BOOST_CHECK( D.size() == 4 );
+    BOOST_CHECK( D[0] == 6.0 && D[3] == 54.0 );
+}
+
+BOOST_AUTO_TEST_CASE( canReduceLargeTensorsInParallel )
+{
+    ftl::DynamicTensorCpu<float> A({300, 500});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i % 11) * 0.5f;
+
+    const size_t grain_size = ftl::ThreadPool::instance().grain_size();
+    ftl::ThreadPool::instance().set_grain_size(256);
+    const float total = ftl::sum(A);
+    ftl::DynamicTensorCpu<float> S0 = ftl::sum(A, 0);
+    ftl::DynamicTensorCpu<float> S1 = ftl::sum(A, 1);
+    ftl::DynamicTensorCpu<size_t> I0 = ftl::argmax(A, 0);
+    ftl::ThreadPool::instance().set_grain_size(grain_size);
+
+    double expected = 0.0;
+    for (size_t i = 0; i < A.size(); ++i) expected += A[i];
+    BOOST_CHECK( std::abs(total - expected) <= 1e-6 * expected );
+
+    bool correct = true;
+    for (size_t j = 0; j < 500; ++j) {
+        float sum = 0.f;
+        for (size_t i = 0; i < 300; ++i) sum += A(i, j);
+        correct = correct && std::abs(S0(j) - sum) <= 1e-5f * sum && A(I0(j), j) == 5.f;
+    }
+    for (size_t i = 0; i < 300; ++i) {
+        float sum = 0.f;
+        for (size_t j = 0; j < 500; ++j) sum += A(i, j);
+        correct = correct && std::abs(S1(i) - sum) <= 1e-5f * sum;
+    }
+    BOOST_CHECK( correct );
+}
+
+BOOST_AUTO_TEST_CASE( indicesOfBestElementsFindTheFirstNaN )
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    ftl::DynamicTensorCpu<float> A({3, 4});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i % 5);
+    A(1, 1) = nan; A(2, 1) = nan; A(0, 3) = nan;
+
+    // NaN is the best element for both the minimum and the maximum, and the first NaN is found
+    BOOST_CHECK( ftl::argmin(A) == 4 );
+    BOOST_CHECK( ftl::argmax(A) == 4 );
+
+    ftl::DynamicTensorCpu<size_t> I0 = ftl::argmax(A, 0);
+    ftl::DynamicTensorCpu<size_t> I1 = ftl::argmin(A, 1);
+    BOOST_CHECK( I0[0] == 2 && I0[1] == 1 && I0[2] == 2 && I0[3] == 0 );
+    BOOST_CHECK( I1[0] == 3 && I1[1] == 1 && I1[2] == 1 );
+
+    // Across the chunks of a parallel search, the first of equal elements (or NaNs) is found
+    ftl::DynamicTensorCpu<float> B({1 << 16});
+    for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<float>(i % 1000);
+    const size_t grain_size = ftl::ThreadPool::instance().grain_size();
+    ftl::ThreadPool::instance().set_grain_size(256);
+    const size_t max_index = ftl::argmax(B);
+    const size_t min_index = ftl::argmin(B);
+    B[50000] = nan; B[60000] = nan;
+    const size_t nan_index = ftl::argmin(B);
+    ftl::ThreadPool::instance().set_grain_size(grain_size);
+
+    BOOST_CHECK( max_index == 999 );
+    BOOST_CHECK( min_index == 0 );
+    BOOST_CHECK( nan_index == 50000 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,140 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   serialization_tests.cpp
+/// @brief  Test suite for saving tensors to files and loading them
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE SerializationTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/serialization.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+BOOST_AUTO_TEST_SUITE( SerializationSuite )
+
+BOOST_AUTO_TEST_CASE( canSaveAndLoadTensors )
+{
+    // Chunks of 2 slabs, so there are 10 chunks and the last one has a single slab
+    ftl::DynamicTensorCpu<float> A({7, 5, 19});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i) * 0.25f - 100.f;
+    ftl::save("ftl_serialization_a.bin", A, 2 * 35 * sizeof(float));
+
+    ftl::DynamicTensorCpu<float> B = ftl::load<float>("ftl_serialization_a.bin");
+    BOOST_CHECK( B.dim_sizes() == A.dim_sizes() );
+    bool equal = true;
+    for (size_t i = 0; i < A.size(); ++i) equal &= B[i] == A[i];
+    BOOST_CHECK( equal );
+
+    // Tensors which aren't contiguous, and expressions, are evaluated a chunk at a time
+    ftl::DynamicTensorCpu<int> C({3, 4}, ftl::RowMajor());
+    for (size_t i = 0; i < C.size(); ++i) C[i] = static_cast<int>(i);
+    ftl::save("ftl_serialization_c.bin", C + C);
+    ftl::StaticTensorCpu<int, 3, 4> D;
+    ftl::load("ftl_serialization_c.bin", D);
+    ftl::StaticTensorCpu<ftl::Policies<int, ftl::RowMajor>, 3, 4> E;
+    ftl::load("ftl_serialization_c.bin", E);
+    for (size_t i = 0; i < C.size(); ++i) {
+        BOOST_CHECK( D[i] == 2 * C[i] );
+        BOOST_CHECK( E[i] == 2 * C[i] );
+    }
+
+    // A static tensor saved from its memory and loaded into a dynamic tensor
+    ftl::save("ftl_serialization_c.bin", D);
+    ftl::DynamicTensorCpu<int> F(2);
+    ftl::load("ftl_serialization_c.bin", F);
+    BOOST_CHECK( F.size(0) == 3 && F.size(1) == 4 && F(2, 3) == D(2, 3) );
+
+    BOOST_CHECK_THROW( ftl::load<double>("ftl_serialization_a.bin"), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::load<int>("ftl_serialization_a.bin"), std::invalid_argument );
+    ftl::StaticTensorCpu<int, 4, 3> G;
+    BOOST_CHECK_THROW( ftl::load("ftl_serialization_c.bin", G), std::invalid_argument );
+    std::remove("ftl_serialization_c.bin");
+    std::remove("ftl_serialization_a.bin");
+}
+
+BOOST_AUTO_TEST_CASE( canLoadARangeOfTheLastDimensionFromTheChunksWhichHoldIt )
+{
+    ftl::DynamicTensorCpu<double> A({6, 31});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<double>(i);
+    ftl::save("ftl_serialization_a.bin", A, 4 * 6 * sizeof(double));
+
+    // Ranges which start and end inside chunks, and which cover whole chunks
+    for (const size_t first : { 0, 3, 4, 13, 30 }) {
+        const size_t slabs = std::min<size_t>(9, 31 - first);
+        ftl::DynamicTensorCpu<double> B = ftl::load_slabs<double>("ftl_serialization_a.bin", first, slabs);
+        BOOST_CHECK( B.size(0) == 6 && B.size(1) == slabs );
+        bool equal = true;
+        for (size_t j = 0; j < slabs; ++j)
+            for (size_t i = 0; i < 6; ++i) equal &= B(i, j) == A(i, first + j);
+        BOOST_CHECK( equal );
+    }
+    BOOST_CHECK_THROW( ftl::load_slabs<double>("ftl_serialization_a.bin", 25, 7), std::out_of_range );
+
+    // Corrupting the first chunk (which starts on the first page boundary) is found when it is read, but not
+    // when only other chunks are read
+    {
+        std::fstream file("ftl_serialization_a.bin", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(4096 + 3);
+        file.put('x');
+    }
+    BOOST_CHECK_THROW( ftl::load<double>("ftl_serialization_a.bin"), std::runtime_error );
+    BOOST_CHECK_THROW( ftl::load_slabs<double>("ftl_serialization_a.bin", 3, 2), std::runtime_error );
+    BOOST_CHECK( ftl::load_slabs<double>("ftl_serialization_a.bin", 4, 20)(5, 19) == A(5, 23) );
+    std::remove("ftl_serialization_a.bin");
+}
+
+BOOST_AUTO_TEST_CASE( corruptChunkTablesAreFoundBeforeAnyChunkIsRead )
+{
+    ftl::DynamicTensorCpu<float> A({5, 9});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i);
+    ftl::save("ftl_serialization_a.bin", A, 2 * 5 * sizeof(float));
+
+    // The chunk table follows the header (56 bytes) and the dimension sizes (2 x 8 bytes), and each entry is
+    // the offset, the number of bytes and the checksum of a chunk
+    const auto corrupt = [] (std::streamoff position, std::uint64_t value)
+    {
+        std::fstream file("ftl_serialization_b.bin", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(position);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    const auto copy = [] ()
+    {
+        std::ifstream in("ftl_serialization_a.bin", std::ios::binary);
+        std::ofstream out("ftl_serialization_b.bin", std::ios::binary);
+        out << in.rdbuf();
+    };
+
+    copy(); corrupt(56 + 16 + 8, 4096);                             // The bytes of the first chunk
+    BOOST_CHECK_THROW( ftl::load<float>("ftl_serialization_b.bin"), std::runtime_error );
+    copy(); corrupt(56 + 16 + 4 * 24 + 8, 2 * 5 * sizeof(float));   // The (shorter) last chunk
+    BOOST_CHECK_THROW( ftl::load<float>("ftl_serialization_b.bin"), std::runtime_error );
+    copy(); corrupt(56 + 16, std::uint64_t(1) << 40);               // The offset of the first chunk
+    BOOST_CHECK_THROW( ftl::load<float>("ftl_serialization_b.bin"), std::runtime_error );
+    copy(); corrupt(40, 0);                                         // The number of slabs in a chunk
+    BOOST_CHECK_THROW( ftl::load_slabs<float>("ftl_serialization_b.bin", 0, 1), std::runtime_error );
+    copy(); corrupt(48, 4);                                         // The number of chunks
+    BOOST_CHECK_THROW( ftl::load<float>("ftl_serialization_b.bin"), std::runtime_error );
+    copy(); corrupt(24, 0);                                         // The rank (and the layout)
+    BOOST_CHECK_THROW( ftl::load<float>("ftl_serialization_b.bin"), std::runtime_error );
+
+    // A file which was cut short, in the chunk table and in the chunks
+    for (const size_t bytes : { 100, 4096 + 50 }) {
+        copy();
+        BOOST_CHECK( truncate("ftl_serialization_b.bin", bytes) == 0 );
+        BOOST_CHECK_THROW( ftl::load<float>("ftl_serialization_b.bin"), std::runtime_error );
+    }
+    std::remove("ftl_serialization_b.bin");
+    std::remove("ftl_serialization_a.bin");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
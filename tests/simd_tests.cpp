@@ -0,0 +1,68 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   simd_tests.cpp
+/// @brief  Test suite for simd packet tests 
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE SimdTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+BOOST_AUTO_TEST_SUITE( SimdSuite )
+
+BOOST_AUTO_TEST_CASE( canLoadAndStoreAPacket )
+{
+    using packet = ftl::simd::Packet<float>;
+    
+    float in[32], out[32];
+    for (int i = 0; i < 32; ++i) { in[i] = static_cast<float>(i); out[i] = 0.f; }
+    
+    // Use an offset of 1 so that the data is not aligned
+    packet::storeu(out + 1, packet::add(packet::loadu(in + 1), packet::set1(1.f)));
+    
+    for (size_t i = 1; i <= packet::size; ++i) BOOST_CHECK( out[i] == in[i] + 1.f );
+    BOOST_CHECK( out[packet::size + 1] == 0.f );
+}
+
+BOOST_AUTO_TEST_CASE( canGetPacketFromAnExpression )
+{
+    using packet = ftl::simd::Packet<int>;
+    
+    ftl::Tensor<int, ftl::CPU, 4, 8> A, B;
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = i; B[i] = 2 * i; }
+    
+    int out[packet::size];
+    packet::storeu(out, (B - A).packet(4));
+    
+    for (size_t i = 0; i < packet::size; ++i) BOOST_CHECK( out[i] == static_cast<int>(i + 4) );
+}
+
+BOOST_AUTO_TEST_CASE( vectorizedEvaluationHandlesTheScalarTail )
+{
+    // 37 is not a multiple of any packet size, so there is a scalar tail for all instruction sets 
+    ftl::DynamicTensorCpu<float> A( {37} ), B( {37} ), C( {37} );
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = i; B[i] = 0.5f * i; C[i] = 1.f; }
+    
+    ftl::DynamicTensorCpu<float> D = A + B - C;
+    
+    BOOST_CHECK( D.size() == 37 );
+    for (size_t i = 0; i < D.size(); ++i) BOOST_CHECK( D[i] == 1.5f * i - 1.f );
+}
+
+BOOST_AUTO_TEST_CASE( expressionsOfMixedTypesAreEvaluatedCorrectly )
+{
+    ftl::Tensor<double, ftl::CPU, 3, 7> A;
+    ftl::Tensor<int   , ftl::CPU, 3, 7> B;
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = 0.25 * i; B[i] = i; }
+    
+    // The data types differ so the expression can't use packets -- it must still be correct
+    ftl::Tensor<double, ftl::CPU, 3, 7> C = A + B;
+    
+    for (size_t i = 0; i < C.size(); ++i) BOOST_CHECK( C[i] == 1.25 * i );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
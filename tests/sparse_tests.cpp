@@ -0,0 +1,140 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   sparse_tests.cpp
+/// @brief  Test suite for sparse tensors and their operations with dense tensors
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE SparseTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/sparse.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+
+// A sparse tensor with about one element in density (with some repeated), and a dense tensor with its values
+ftl::CooTensorCpu<double> random_sparse(const std::vector<size_t>& dim_sizes, size_t density)
+{
+    ftl::CooTensorCpu<double> coo(dim_sizes);
+    std::uint32_t state = 12345;
+    auto next = [&state] () { state = state * 1664525u + 1013904223u; return state >> 8; };
+    for (size_t n = 0; n < coo.size() / density; ++n) {
+        std::vector<size_t> index;
+        for (const size_t size : dim_sizes) index.push_back(next() % size);
+        coo.insert(index, static_cast<double>(next() % 1000) / 100.0 - 5.0);
+    }
+    return coo;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( SparseSuite )
+
+BOOST_AUTO_TEST_CASE( sparseTensorsConvertToAndFromDenseTensors )
+{
+    ftl::CooTensorCpu<float> coo({4, 3, 5});
+    coo.insert({1, 2, 3}, 2.f);
+    coo.insert({0, 0, 4}, -1.f);
+    coo.insert({1, 2, 3}, 0.5f);
+    coo.insert({3, 1, 0}, 7.f);
+    BOOST_CHECK( coo.nnz() == 4 && coo.size() == 60 );
+
+    // Repeated nonzeros are added
+    ftl::CsfTensorCpu<float> csf(coo);
+    BOOST_CHECK( csf.nnz() == 3 && csf.num_nodes(0) == 3 );
+    ftl::DynamicTensorCpu<float> A = csf.dense();
+    BOOST_CHECK( A(1, 2, 3) == 2.5f && A(0, 0, 4) == -1.f && A(3, 1, 0) == 7.f && A(2, 2, 2) == 0.f );
+    ftl::DynamicTensorCpu<float> B = coo.dense();
+    bool equal = true;
+    for (size_t i = 0; i < A.size(); ++i) equal &= A[i] == B[i];
+    BOOST_CHECK( equal );
+
+    // From dense expressions, and back through COO
+    ftl::CsfTensorCpu<float> C(A + A);
+    ftl::DynamicTensorCpu<float> D = C.coo().dense();
+    BOOST_CHECK( C.nnz() == 3 && D(1, 2, 3) == 5.f && D(3, 1, 0) == 14.f );
+
+    ftl::DynamicTensorCpu<double> E({300, 200});
+    for (size_t i = 0; i < E.size(); ++i) E[i] = i % 97 == 0 ? static_cast<double>(i) : 0.0;
+    ftl::CooTensorCpu<double> F(E);
+    BOOST_CHECK( F.nnz() == (E.size() - 1) / 97 && F.index(0, 0) == 97 && F.index(F.nnz() - 1, 1) == 199 );
+
+    BOOST_CHECK_THROW( coo.insert({4, 0, 0}, 1.f), std::out_of_range );
+    BOOST_CHECK_THROW( coo.insert({0, 0}, 1.f), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::CsfTensorCpu<float>(coo, {0, 0, 1}), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::CooTensorCpu<float>{ftl::DynamicTensorCpu<float>(0)}, std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( sparseAndDenseTensorsCanBeAddedAndMultiplied )
+{
+    const ftl::CsfTensorCpu<double> S(random_sparse({20, 30, 10}, 50));
+    const ftl::DynamicTensorCpu<double> X = S.dense();
+    ftl::DynamicTensorCpu<double> Y({20, 30, 10});
+    for (size_t i = 0; i < Y.size(); ++i) Y[i] = std::sin(static_cast<double>(i));
+
+    ftl::DynamicTensorCpu<double> sum = S + Y * 2.0, difference = Y - S, other = S - Y;
+    ftl::CsfTensorCpu<double> product = Y * S;
+    ftl::DynamicTensorCpu<double> P = product.dense();
+    BOOST_CHECK( product.nnz() == S.nnz() );
+
+    bool equal = true;
+    for (size_t i = 0; i < X.size(); ++i) {
+        equal &= sum[i] == X[i] + Y[i] * 2.0 && difference[i] == Y[i] - X[i] && other[i] == X[i] - Y[i];
+        equal &= P[i] == X[i] * Y[i];
+    }
+    BOOST_CHECK( equal );
+
+    ftl::DynamicTensorCpu<double> Z({20, 30});
+    BOOST_CHECK_THROW( S + Z, std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( sparseTensorsCanBeContractedWithDenseTensors )
+{
+    const ftl::CsfTensorCpu<double> S(random_sparse({20, 30, 10}, 40));
+    const ftl::DynamicTensorCpu<double> X = S.dense();
+
+    // Each dimension of the sparse tensor, contracted with either dimension of a dense matrix, from both sides
+    const size_t sizes[] = { 20, 30, 10 };
+    for (size_t dim = 0; dim < 3; ++dim) {
+        for (size_t other = 0; other < 2; ++other) {
+            ftl::DynamicTensorCpu<double> M = other == 0 ? ftl::DynamicTensorCpu<double>({sizes[dim], 7})
+                                                         : ftl::DynamicTensorCpu<double>({7, sizes[dim]});
+            for (size_t i = 0; i < M.size(); ++i) M[i] = std::cos(static_cast<double>(i) * 0.3);
+
+            const ftl::DynamicTensorCpu<double> R = ftl::contract(S, M, {{dim, other}});
+            const ftl::DynamicTensorCpu<double> expected = ftl::contract(X, M, {{dim, other}});
+            const ftl::DynamicTensorCpu<double> Q = ftl::contract(M, S, {{other, dim}});
+            const ftl::DynamicTensorCpu<double> expected_q = ftl::contract(M, X, {{other, dim}});
+
+            double error = 0;
+            for (size_t i = 0; i < R.size(); ++i) error = std::max(error, std::fabs(R[i] - expected[i]));
+            for (size_t i = 0; i < Q.size(); ++i) error = std::max(error, std::fabs(Q[i] - expected_q[i]));
+            BOOST_CHECK( R.dim_sizes() == expected.dim_sizes() && Q.dim_sizes() == expected_q.dim_sizes() );
+            BOOST_CHECK( error < 1e-10 );
+        }
+    }
+
+    // A sparse vector with a dense vector and a dense matrix
+    const ftl::CsfTensorCpu<double> v(random_sparse({100}, 10));
+    ftl::DynamicTensorCpu<double> w({100}), N({100, 3});
+    for (size_t i = 0; i < N.size(); ++i) N[i] = static_cast<double>(i % 13);
+    for (size_t i = 0; i < w.size(); ++i) w[i] = static_cast<double>(i % 7);
+    const ftl::DynamicTensorCpu<double> dot = ftl::contract(v, w, {{0, 0}});
+    const ftl::DynamicTensorCpu<double> row = ftl::contract(v, N, {{0, 0}});
+    const ftl::DynamicTensorCpu<double> expected_dot = ftl::contract(v.dense(), w, {{0, 0}});
+    const ftl::DynamicTensorCpu<double> expected_row = ftl::contract(v.dense(), N, {{0, 0}});
+    BOOST_CHECK( dot.size() == 1 && std::fabs(dot[0] - expected_dot[0]) < 1e-10 );
+    BOOST_CHECK( row.size() == 3 && std::fabs(row[2] - expected_row[2]) < 1e-10 );
+
+    BOOST_CHECK_THROW( ftl::contract(S, X, {{0, 0}, {1, 1}}), std::invalid_argument );
+    BOOST_CHECK_THROW( ftl::contract(S, N, {{0, 0}}), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,10 @@
 #include "../tensor/tensor.hpp"
 #include "../tensor/tensor_operations.hpp"
 
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
 BOOST_AUTO_TEST_SUITE( TensorSuite)
     
 BOOST_AUTO_TEST_CASE( canCreateDynamicTensor )
@@ -39,7 +43,7 @@ BOOST_AUTO_TEST_CASE( canCreateDynamicTensorFromDimensionSizesAdnData )
     
     // Use the data to create the tensor -- will have rank 2
     ftl::Tensor<float, ftl::CPU> A(dimension_sizes, data);
-    auto tensor_data = A.data();      
+    const auto& tensor_data = A.data();
     
     BOOST_CHECK( A.size() == 6 );
     BOOST_CHECK( A.rank() == 2 );
@@ -73,6 +77,40 @@ BOOST_AUTO_TEST_CASE( canGetSizeOfASpecificDimensionOfADynamicTensor )
     BOOST_CHECK( A.size(2) == 3 );
 }
 
+BOOST_AUTO_TEST_CASE( dynamicTensorDataIsAligned )
+{
+    ftl::DynamicTensorCpu<float> A( {3, 5} ), B( {3, 5} );
+    ftl::DynamicTensorCpu<float> C = A + B;
+    
+    BOOST_CHECK( reinterpret_cast<uintptr_t>(A.data().data()) % ftl::default_alignment == 0 );
+    BOOST_CHECK( reinterpret_cast<uintptr_t>(C.data().data()) % ftl::default_alignment == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( canCreateDynamicTensorWithCustomAllocator )
+{
+    // Use an allocator with a different alignment than the default
+    using allocator_type = ftl::AlignedAllocator<double, 128>;
+    
+    ftl::DynamicTensorCpu<double, allocator_type> A( {2, 2} ), B( {2, 2} );
+    A(1, 1) = 4.0; B(1, 1) = 2.0;
+    ftl::DynamicTensorCpu<double, allocator_type> C = A + B;
+    
+    BOOST_CHECK( (std::is_same<decltype(A.get_allocator()), allocator_type>::value) );
+    BOOST_CHECK( reinterpret_cast<uintptr_t>(A.data().data()) % 128 == 0 );
+    BOOST_CHECK( C(1, 1) == 6.0 );
+
+    // Data from a container with the default allocator is copied, and must fill the dimensions
+    using tensor_type = ftl::DynamicTensorCpu<double, allocator_type>;
+    const std::vector<double> data = { 1.0, 2.0, 3.0, 4.0 };
+    tensor_type D(tensor_type::dim_container{2, 2}, data);
+    BOOST_CHECK( D(1, 1) == 4.0 );
+    BOOST_CHECK_THROW( tensor_type(tensor_type::dim_container{2, 3}, data), std::invalid_argument );
+    
+    // The default allocator gives the same type as when no allocator is given
+    BOOST_CHECK( (std::is_same<ftl::DynamicTensorCpu<int, ftl::AlignedAllocator<int>>, 
+                               ftl::DynamicTensorCpu<int>                            >::value) );
+}
+
 // -------------------------------------------- STATIC CPU --------------------------------------------------
 
 BOOST_AUTO_TEST_CASE( canCreateDefaultStaticTensor )
@@ -201,4 +239,329 @@ BOOST_AUTO_TEST_CASE( canGetSizeOfASpecificDimensionOfAStaticTensor )
     BOOST_CHECK( A.size(1) == 2 );
     BOOST_CHECK( A.size(2) == 3 );
 }
+
+BOOST_AUTO_TEST_CASE( canCreateRowMajorStaticTensor )
+{
+    // Data is given in row-major order, so the last dimension changes fastest
+    ftl::StaticTensorCpu<ftl::Policies<int, ftl::RowMajor>, 2, 3> A{ 11, 12, 13,
+                                                                     21, 22, 23 };
+    
+    BOOST_CHECK( !A.contiguous() );
+    BOOST_CHECK( A(0, 2) == 13 );
+    BOOST_CHECK( A(1, 0) == 21 );
+    
+    // The linear index is column-major for all layouts
+    BOOST_CHECK( A[1] == 21 );
+    BOOST_CHECK( A[4] == 13 );
+}
+
+BOOST_AUTO_TEST_CASE( canCreateRowMajorDynamicTensor )
+{
+    ftl::DynamicTensorCpu<int> A({2, 3}, ftl::RowMajor());
+    
+    BOOST_CHECK( !A.contiguous() );
+    BOOST_CHECK( A.layout().strides()[0] == 3 );
+    BOOST_CHECK( A.layout().strides()[1] == 1 );
+    
+    A(1, 0) = 21;
+    A(0, 2) = 13;
+    
+    BOOST_CHECK( A.data()[3] == 21 );
+    BOOST_CHECK( A.data()[2] == 13 );
+    BOOST_CHECK( A[1] == 21 );
+    BOOST_CHECK( A[4] == 13 );
+}
+
+BOOST_AUTO_TEST_CASE( canCreateDynamicTensorWithPaddedStrides )
+{
+    // A 2x3 column-major tensor where each column is padded to 4 elements
+    ftl::DynamicLayout layout(std::vector<size_t>{2, 3}, std::vector<size_t>{1, 4});
+    std::vector<float, ftl::AlignedAllocator<float>> data{ 1.f, 2.f, 0.f, 0.f, 
+                                                           3.f, 4.f, 0.f, 0.f, 
+                                                           5.f, 6.f, 0.f, 0.f };
+    
+    ftl::DynamicTensorCpu<float> A(layout, std::move(data));
+    
+    BOOST_CHECK( A.size() == 6 );
+    BOOST_CHECK( layout.storage_size() == 10 );
+    BOOST_CHECK( A(1, 1) == 4.f );
+    BOOST_CHECK( A(0, 2) == 5.f );
+    BOOST_CHECK( A[5] == 6.f );
+}
+
+BOOST_AUTO_TEST_CASE( canAddTensorsWithDifferentLayouts )
+{
+    ftl::DynamicTensorCpu<float> A({3, 40});
+    ftl::DynamicTensorCpu<float> B({3, 40}, ftl::RowMajor());
+    
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 40; ++j) {
+            A(i, j) = static_cast<float>(i);
+            B(i, j) = static_cast<float>(j);
+        }
+    }
+    
+    ftl::DynamicTensorCpu<float> C = A + B;
+    
+    BOOST_CHECK( C.contiguous() );
+    BOOST_CHECK( C(2, 0)  == 2.f  );
+    BOOST_CHECK( C(1, 39) == 40.f );
+    BOOST_CHECK( C(0, 17) == 17.f );
+}
+
+BOOST_AUTO_TEST_CASE( staticLayoutComputesStridesAtCompileTime )
+{
+    using column_major = ftl::StaticLayout<ftl::ColumnMajor, 2, 3, 4>;
+    using row_major    = ftl::StaticLayout<ftl::RowMajor, 2, 3, 4>;
+    
+    static_assert(column_major::contiguous                                  , "Column-major must be contiguous");
+    static_assert(!row_major::contiguous                                    , "Row-major isn't contiguous"     );
+    static_assert(ftl::StaticMapper::indices_to_index<column_major>(1, 2, 3) == 1 + 2 * 2 + 3 * 6, "Bad offset");
+    static_assert(ftl::StaticMapper::indices_to_index<row_major>(1, 2, 3)    == 1 * 12 + 2 * 4 + 3, "Bad offset");
+    static_assert(row_major::offset(1) == 12                                , "Bad linear offset"              );
+    
+    BOOST_CHECK( column_major::offset(23) == 23 );
+}
+
+BOOST_AUTO_TEST_CASE( tiledLayoutsMapTheElementsOfATileTogether )
+{
+    // 3 x 2 tiles of 2 x 2 elements, in column-major order
+    using tiled = ftl::StaticLayout<ftl::Tiled<2, 2>, 5, 3>;
+    static_assert(tiled::tiled && !tiled::contiguous && tiled::storage_size == 24, "Bad tiled layout");
+    static_assert(ftl::StaticMapper::indices_to_index<tiled>(1, 1) == 3 , "Bad offset in a tile");
+    static_assert(ftl::StaticMapper::indices_to_index<tiled>(3, 1) == 7 , "Bad offset in the second tile");
+    static_assert(ftl::StaticMapper::indices_to_index<tiled>(0, 2) == 12, "Bad offset in the second column");
+    static_assert(tiled::offset(14) == 20                                , "Bad linear offset");
+
+    // 4 x 4 tiles in Z-order, and 4 x 1 tiles where only the first dimension has bits in the code
+    using morton = ftl::StaticLayout<ftl::MortonTiled<2, 2>, 8, 8>;
+    static_assert(morton::storage_size == 64, "Bad Morton layout");
+    static_assert(ftl::StaticMapper::indices_to_index<morton>(2, 2) == 12, "Bad Morton offset");
+    static_assert(ftl::StaticMapper::indices_to_index<morton>(0, 4) == 32, "Bad Morton offset");
+    static_assert(ftl::StaticMapper::indices_to_index<morton>(7, 7) == 63, "Bad Morton offset");
+    static_assert(ftl::StaticLayout<ftl::MortonTiled<2, 2>, 8, 2>::storage_size == 16, "Bad Morton padding");
+
+    // Dynamic layouts compute the same mappings at runtime
+    ftl::DynamicLayout dynamic_tiled(std::vector<size_t>{5, 3}, ftl::Tiled<2, 2>());
+    ftl::DynamicLayout dynamic_morton(std::vector<size_t>{8, 8, 1}, ftl::MortonTiled<2, 2>());
+    BOOST_CHECK( dynamic_tiled.tiled() && !dynamic_tiled.contiguous() && dynamic_tiled.storage_size() == 24 );
+    BOOST_CHECK( dynamic_morton.storage_size() == 64 );
+    for (size_t i = 0; i < 15; ++i) BOOST_CHECK( dynamic_tiled.offset(i) == tiled::offset(i) );
+    for (size_t i = 0; i < 64; ++i) BOOST_CHECK( dynamic_morton.offset(i) == morton::offset(i) );
+
+    // With 3 tiles in the third dimension, its bits are interleaved with the others (at bits 2 and 5 of the
+    // tile index), and the memory ends with the tile with the largest code (3, 3, 2)
+    ftl::DynamicLayout dynamic_morton_3d(std::vector<size_t>{8, 8, 3}, ftl::MortonTiled<2, 2>());
+    BOOST_CHECK( ftl::DynamicMapper::indices_to_index(dynamic_morton_3d, 0, 0, 1) == 4 * 4 );
+    BOOST_CHECK( ftl::DynamicMapper::indices_to_index(dynamic_morton_3d, 3, 0, 2) == 4 * 32 + 4 + 1 );
+    BOOST_CHECK( dynamic_morton_3d.storage_size() == 4 * (59 + 1) );
+    BOOST_CHECK_THROW( ftl::DynamicLayout(std::vector<size_t>{4, 4}, ftl::Tiled<3>()), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_CASE( tiledTensorsAreEvaluatedATileAtATime )
+{
+    ftl::DynamicTensorCpu<float> B({37, 23, 5}), C({37, 23, 5});
+    for (size_t i = 0; i < B.size(); ++i) { B[i] = static_cast<float>(i); C[i] = static_cast<float>(i % 7); }
+
+    ftl::DynamicTensorCpu<float> A({37, 23, 5}, ftl::MortonTiled<8, 4>());
+    ftl::DynamicTensorCpu<float> T({37, 23, 5}, ftl::Tiled<4, 4, 2>());
+    A = B + C;
+    T = A - C;
+    A = A + A;
+    BOOST_CHECK( !A.contiguous() && A.layout().tiled() && T.data().size() == 40 * 24 * 6 );
+    bool equal = true;
+    for (size_t k = 0; k < 5; ++k)
+        for (size_t j = 0; j < 23; ++j)
+            for (size_t i = 0; i < 37; ++i) {
+                equal &= A(i, j, k) == 2.f * (B(i, j, k) + C(i, j, k));
+                equal &= T(i, j, k) == B(i, j, k);
+            }
+    BOOST_CHECK( equal );
+
+    // Tiled tensors are read in logical order, so can be used with any other tensors
+    ftl::DynamicTensorCpu<float> D = T * 2.f;
+    BOOST_CHECK( D.contiguous() && D(36, 22, 4) == 2.f * B(36, 22, 4) );
+    BOOST_CHECK_THROW( T.slice(ftl::all, 1, ftl::all), std::invalid_argument );
+
+    ftl::StaticTensorCpu<ftl::Policies<float, ftl::Tiled<4, 4>>, 7, 6> S;
+    S = B.slice(ftl::Range(0, 7), ftl::Range(0, 6), 0) + 1.f;
+    BOOST_CHECK( S(6, 5) == B(6, 5, 0) + 1.f && S[8] == B(1, 1, 0) + 1.f );
+    static_assert(sizeof(S) == 8 * 8 * sizeof(float), "Static tiled tensors must hold whole tiles");
+
+    // The padding of the tiles isn't part of the tensor, so isn't reduced
+    ftl::StaticTensorCpu<ftl::Policies<float, ftl::Tiled<4, 4>>, 7, 6> O;
+    O = S * 0.f + 1.f;
+    BOOST_CHECK( O.size() == 42 && ftl::sum(O) == 42.f && ftl::max(S) == S(6, 5) );
+}
+
+BOOST_AUTO_TEST_CASE( smallStaticTensorsCanBeUsedInConstantExpressions )
+{
+    constexpr ftl::StaticTensorCpu<float, 3, 3> R{ 0.f, 1.f, 0.f, -1.f, 0.f, 0.f, 0.f, 0.f, 1.f };
+    constexpr ftl::StaticTensorCpu<ftl::Policies<int, ftl::RowMajor>, 2, 3> M{ 1, 2, 3, 4, 5, 6 };
+
+    static_assert(R.rank() == 2 && R.size() == 9 && R.size(1) == 3, "Static shapes must be constant");
+    static_assert(R.dim_sizes()[0] == 3                             , "Dimension sizes must be constant");
+    static_assert(R(1, 0) == 1.f && R(0, 1) == -1.f && R[8] == 1.f  , "Elements must be constant");
+    static_assert(M(1, 0) == 4 && M(0, 2) == 3 && M[1] == 4         , "Mapped elements must be constant");
+
+    // The dimension sizes are built at compile time, so only the elements are stored
+    static_assert(sizeof(ftl::StaticTensorCpu<float, 3, 3>) == 9 * sizeof(float), "Tensors must only store data");
+    BOOST_CHECK( R(2, 2) == 1.f );
+}
+
+BOOST_AUTO_TEST_CASE( smallStaticExpressionsAreEvaluatedUnrolled )
+{
+    // 27 elements leave a tail which doesn't fill a packet
+    ftl::StaticTensorCpu<float, 3, 3, 3> A, B;
+    ftl::StaticTensorCpu<int, 3, 3, 3>   I;
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = 1.f * i; B[i] = 2.f; I[i] = static_cast<int>(i); }
+
+    ftl::StaticTensorCpu<float, 3, 3, 3> C = A * B - A;
+    bool matches = true;
+    for (size_t i = 0; i < C.size(); ++i) matches = matches && C[i] == 1.f * i;
+    BOOST_CHECK( matches );
+
+    // In place, through a view (not contiguous), and with a different data type
+    C += A.slice(ftl::all, ftl::all, ftl::all);
+    C -= B.slice(ftl::StaticRange<0, 3>(), ftl::all, ftl::all);
+    C = C - A.slice(ftl::Range(0, 3), ftl::all, ftl::all);
+    ftl::StaticTensorCpu<double, 3, 3, 3> D = I;
+    matches = true;
+    for (size_t i = 0; i < C.size(); ++i) matches = matches && C[i] == 1.f * i - 2.f && D[i] == 1.0 * i;
+    BOOST_CHECK( matches );
+
+    // Row-major tensors are written through their layout
+    ftl::StaticTensorCpu<ftl::Policies<float, ftl::RowMajor>, 3, 3, 3> R = A + B;
+    BOOST_CHECK( R(2, 1, 0) == A(2, 1, 0) + 2.f );
+    BOOST_CHECK( R(0, 2, 1) == A(0, 2, 1) + 2.f );
+}
+
+BOOST_AUTO_TEST_CASE( largeStaticTensorsStoreTheirDataOnTheHeap )
+{
+    // 1 MiB of data is more than FTL_MAX_INLINE_BYTES, so the tensor only holds a pointer to aligned data
+    using large_tensor = ftl::StaticTensorCpu<int, 512, 512>;
+    static_assert(sizeof(large_tensor) == sizeof(int*), "Large static tensors must store their data on the heap");
+    static_assert(sizeof(ftl::StaticTensorCpu<ftl::Policies<int, ftl::InlineStorage>, 2, 2>) == 4 * sizeof(int),
+                  "Inline storage must store the data in the tensor");
+
+    large_tensor A, B;
+    BOOST_CHECK( reinterpret_cast<uintptr_t>(A.data().data()) % 64 == 0 );
+    BOOST_CHECK( A[1000] == 0 );
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = static_cast<int>(i); B[i] = 1; }
+
+    // The shape and the mapping are still static
+    large_tensor C = A + B;
+    BOOST_CHECK( C(3, 2) == 3 + 2 * 512 + 1 );
+    BOOST_CHECK_THROW( C = ftl::DynamicTensorCpu<int>({512, 511}), std::invalid_argument );
+
+    // Copies copy the data and moves move it
+    large_tensor D(C);
+    D[0] = -1;
+    BOOST_CHECK( C[0] == 1 );
+    const int* data = D.data().data();
+    large_tensor E(std::move(D));
+    BOOST_CHECK( E.data().data() == data );
+    D = E;
+    BOOST_CHECK( D[0] == -1 );
+
+    // Overlapping assignment goes through a temporary
+    C.slice(ftl::Range(1, 512), ftl::all) = C.slice(ftl::Range(0, 511), ftl::all);
+    BOOST_CHECK( C(1, 0) == 1 );
+    BOOST_CHECK( C(511, 3) == 510 + 3 * 512 + 1 );
+}
+
+BOOST_AUTO_TEST_CASE( staticTensorStorageCanBeChosenPerType )
+{
+    // Heap storage for a small tensor, with a row-major layout and from a literal list
+    using heap_tensor = ftl::StaticTensorCpu<ftl::Policies<float, ftl::RowMajor, ftl::HeapStorage>, 2, 3>;
+    static_assert(sizeof(heap_tensor) == sizeof(float*), "Heap storage must store the data on the heap");
+
+    heap_tensor A{ 1.f, 2.f, 3.f, 4.f, 5.f, 6.f };
+    heap_tensor B;
+    BOOST_CHECK( A(0, 2) == 3.f );
+    BOOST_CHECK( A(1, 0) == 4.f );
+    BOOST_CHECK( B[5] == 0.f );
+
+    B = A + A;
+    B += A;
+    BOOST_CHECK( B(1, 2) == 18.f );
+}
+
+BOOST_AUTO_TEST_CASE( philoxGivesTheKnownAnswers )
+{
+    // Known answers of Philox4x32-10 from the Random123 distribution (counter, key -> words)
+    std::uint32_t words[4 * ftl::detail::Philox::batch_size];
+    ftl::detail::Philox::generate(0, 1, 0, 0, words);
+    BOOST_CHECK( words[0] == 0x6627e8d5u && words[1] == 0xe169c58du && words[2] == 0xbc57ac4cu && words[3] == 0x9b00dbd8u );
+    ftl::detail::Philox::generate(~0ull, 1, ~0ull, ~0ull, words);
+    BOOST_CHECK( words[0] == 0x408f276du && words[1] == 0x41c83b0eu && words[2] == 0xa20bc7c6u && words[3] == 0x6d5451fdu );
+    ftl::detail::Philox::generate(0x85a308d3243f6a88ull, 1, 0x0370734413198a2eull, 0x299f31d0a4093822ull, words);
+    BOOST_CHECK( words[0] == 0xd16cfe09u && words[1] == 0x94fdccebu && words[2] == 0x5001e420u && words[3] == 0x24126ea1u );
+}
+
+BOOST_AUTO_TEST_CASE( randomInitializationIsReproducibleForAnyNumberOfThreads )
+{
+    ftl::ThreadPool& pool       = ftl::ThreadPool::instance();
+    const size_t     threads    = pool.num_threads();
+    const size_t     grain_size = pool.grain_size();
+
+    ftl::DynamicTensorCpu<float> A({301, 333}), B({301, 333}), C({301, 333}, ftl::RowMajor());
+    pool.resize(1);
+    A.initialize(ftl::Normal<float>(0.f, 1.f), 42);
+    pool.resize(4);
+    pool.set_grain_size(1000);
+    B.initialize(ftl::Normal<float>(0.f, 1.f), 42);
+    C.initialize(ftl::Normal<float>(0.f, 1.f), 42);
+    pool.set_grain_size(grain_size);
+    pool.resize(threads);
+
+    bool same = true;
+    for (size_t i = 0; i < A.size(); ++i) same &= A[i] == B[i] && A[i] == C[i];
+    BOOST_CHECK( same );
+
+    // Static tensors give the same values as dynamic tensors, and other streams and seeds give other values
+    ftl::StaticTensorCpu<float, 7, 5> D;
+    D.initialize(ftl::Normal<float>(0.f, 1.f), 42);
+    BOOST_CHECK( D[0] == A[0] && D[34] == A[34] );
+    B.initialize(ftl::Normal<float>(0.f, 1.f), 42, 1);
+    C.initialize(ftl::Normal<float>(0.f, 1.f), 43);
+    BOOST_CHECK( B[0] != A[0] && B[1000] != A[1000] );
+    BOOST_CHECK( C[0] != A[0] && C[1000] != A[1000] );
+}
+
+BOOST_AUTO_TEST_CASE( randomInitializationHasTheDistributionInTheDataType )
+{
+    ftl::DynamicTensorCpu<float> A({1000, 1000});
+    A.initialize(ftl::Normal<float>(2.f, 3.f), 7);
+    BOOST_CHECK( std::abs(ftl::mean(A) - 2.f) < 0.02f );
+    BOOST_CHECK( std::abs(ftl::norm2(A - 2.f) / 1000.f - 3.f) < 0.02f );
+
+    ftl::DynamicTensorCpu<double> B({1001, 999});
+    B.initialize(ftl::Uniform<double>(-1.0, 3.0), 7);
+    BOOST_CHECK( ftl::min(B) >= -1.0 && ftl::max(B) < 3.0 );
+    BOOST_CHECK( std::abs(ftl::mean(B) - 1.0) < 0.01 );
+    B.initialize(ftl::Normal<double>(), 8);
+    BOOST_CHECK( std::abs(ftl::mean(B)) < 0.01 );
+
+    // Integers are uniform over [min, max], including max
+    ftl::DynamicTensorCpu<int> C({10001});
+    C.initialize(ftl::Uniform<int>(-3, 3), 7);
+    size_t counts[7] = { 0 };
+    for (size_t i = 0; i < C.size(); ++i) {
+        BOOST_REQUIRE( C[i] >= -3 && C[i] <= 3 );
+        ++counts[C[i] + 3];
+    }
+    for (const size_t count : counts) BOOST_CHECK( count > 1300 && count < 1560 );
+
+    ftl::StaticTensorCpu<std::int64_t, 101> D;
+    D.initialize(ftl::Uniform<std::int64_t>(-(std::int64_t(1) << 40), std::int64_t(1) << 40), 7);
+    BOOST_CHECK( ftl::max(D) > (std::int64_t(1) << 39) && ftl::min(D) < -(std::int64_t(1) << 39) );
+    ftl::StaticTensorCpu<std::uint8_t, 3, 3> E;
+    E.initialize(ftl::Uniform<std::uint8_t>(0, 255), 7);
+    E.initialize(5, 5);
+    BOOST_CHECK( E(2, 2) == 5 );
+
+    BOOST_CHECK_THROW( ftl::Uniform<float>(1.f, 0.f), std::invalid_argument );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   thread_pool_tests.cpp
+/// @brief  Test suite for thread pool tests 
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE ThreadPoolTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE( ThreadPoolSuite )
+
+BOOST_AUTO_TEST_CASE( parallelForExecutesEachElementOnce )
+{
+    ftl::ThreadPool pool(4, 16);
+    std::vector<int> counts(1003, 0);
+    
+    pool.parallel_for(0, counts.size(), [&counts] (size_t begin, size_t end) 
+    {
+        for (size_t i = begin; i < end; ++i) ++counts[i];
+    }, 8);
+    
+    BOOST_CHECK( pool.num_threads() == 4 );
+    for (auto count : counts) BOOST_CHECK( count == 1 );
+}
+
+BOOST_AUTO_TEST_CASE( smallRangesAreExecutedSerially )
+{
+    ftl::ThreadPool pool(4, 100);
+    std::atomic<int> calls(0);
+    
+    // Less than twice the grain size so there must only be a single chunk
+    pool.parallel_for(0, 150, [&calls] (size_t begin, size_t end) { ++calls; });
+    
+    BOOST_CHECK( calls == 1 );
+}
+
+BOOST_AUTO_TEST_CASE( exceptionsArePropagatedToTheCaller )
+{
+    ftl::ThreadPool pool(3, 1);
+    
+    BOOST_CHECK_THROW( pool.parallel_for(0, 100, [] (size_t begin, size_t end) 
+                       {
+                           if (begin == 0) throw std::runtime_error("chunk failed");
+                       }), 
+                       std::runtime_error );
+                       
+    // The pool must still be usable
+    std::atomic<size_t> total(0);
+    pool.parallel_for(0, 100, [&total] (size_t begin, size_t end) { total += end - begin; });
+    BOOST_CHECK( total == 100 );
+}
+
+BOOST_AUTO_TEST_CASE( canResizeAndPinThePool )
+{
+    ftl::ThreadPool pool(2, 1);
+    pool.resize(5);
+    pool.pin_threads(true);
+    
+    std::atomic<size_t> total(0);
+    pool.parallel_for(0, 1000, [&total] (size_t begin, size_t end) { total += end - begin; });
+    
+    BOOST_CHECK( pool.num_threads() == 5 );
+    BOOST_CHECK( pool.pinned() );
+    BOOST_CHECK( total == 1000 );
+}
+
+BOOST_AUTO_TEST_CASE( canEvaluateExpressionsInParallel )
+{
+    ftl::ThreadPool& pool       = ftl::ThreadPool::instance();
+    const size_t     grain_size = pool.grain_size();
+    const size_t     threads    = pool.num_threads();
+    pool.set_grain_size(64);
+    pool.resize(4);
+    
+    ftl::DynamicTensorCpu<float> A( {31, 33} ), B( {31, 33} ), C( {31, 33} );
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = i; B[i] = 2.f * i; C[i] = 0.5f * i; }
+    
+    ftl::DynamicTensorCpu<float> D = A + B - C;
+    pool.set_grain_size(grain_size);
+    pool.resize(threads);
+    
+    for (size_t i = 0; i < D.size(); ++i) BOOST_CHECK( D[i] == 2.5f * i );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
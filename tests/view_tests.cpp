@@ -0,0 +1,187 @@
+// ----------------------------------------------------------------------------------------------------------
+/// @file   view_tests.cpp
+/// @brief  Test suite for tensor view (slicing) tests
+// ----------------------------------------------------------------------------------------------------------
+
+#define BOOST_TEST_DYN_LINK
+#ifdef STAND_ALONE
+    #define BOOST_TEST_MODULE ViewTests
+#endif
+#include <boost/test/unit_test.hpp>
+
+#include "../tensor/tensor.hpp"
+#include "../tensor/tensor_operations.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+
+BOOST_AUTO_TEST_SUITE( ViewSuite )
+
+BOOST_AUTO_TEST_CASE( canSliceDynamicTensorWithFixedIndex )
+{
+    ftl::DynamicTensorCpu<int> A({2, 3, 4});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i);
+
+    // Fix the second dimension, which removes it from the view
+    auto view = A.slice(ftl::all, 1, ftl::all);
+
+    BOOST_CHECK( view.rank() == 2 );
+    BOOST_CHECK( view.size(0) == 2 );
+    BOOST_CHECK( view.size(1) == 4 );
+    BOOST_CHECK( view.size() == 8 );
+    BOOST_CHECK( view(1, 3) == A(1, 1, 3) );
+    BOOST_CHECK( view[3] == A(1, 1, 1) );
+
+    // The view refers to the tensor data
+    view(0, 2) = -1;
+    BOOST_CHECK( A(0, 1, 2) == -1 );
+}
+
+BOOST_AUTO_TEST_CASE( canSliceDynamicTensorWithRangeAndStep )
+{
+    ftl::DynamicTensorCpu<int> A({10, 6});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i);
+
+    auto view = A.slice(ftl::Range(2, 10, 3), ftl::Range(1, 4));
+
+    BOOST_CHECK( view.size(0) == 3 );         // Elements 2, 5, 8
+    BOOST_CHECK( view.size(1) == 3 );         // Elements 1, 2, 3
+    BOOST_CHECK( !view.contiguous() );
+    BOOST_CHECK( view(0, 0) == A(2, 1) );
+    BOOST_CHECK( view(2, 2) == A(8, 3) );
+    BOOST_CHECK( view[4]    == A(5, 2) );
+}
+
+BOOST_AUTO_TEST_CASE( canSliceAView )
+{
+    ftl::DynamicTensorCpu<int> A({4, 4, 4});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i);
+
+    auto view  = A.slice(ftl::Range(0, 4, 2), ftl::all, 3);
+    auto inner = view.slice(1, ftl::Range(1, 3));
+
+    BOOST_CHECK( inner.rank() == 1 );
+    BOOST_CHECK( inner.size() == 2 );
+    BOOST_CHECK( inner[0] == A(2, 1, 3) );
+    BOOST_CHECK( inner[1] == A(2, 2, 3) );
+}
+
+BOOST_AUTO_TEST_CASE( canAssignExpressionToNonContiguousView )
+{
+    // Per-channel assignment of a rank 4 tensor
+    ftl::DynamicTensorCpu<float> A({5, 3, 7, 2});
+    ftl::DynamicTensorCpu<float> B({5, 7, 2});
+    ftl::DynamicTensorCpu<float> C({5, 7, 2});
+
+    for (size_t i = 0; i < A.size(); ++i) A[i] = 0.f;
+    for (size_t i = 0; i < B.size(); ++i) { B[i] = static_cast<float>(i); C[i] = 1.f; }
+
+    // Use a small grain size so that the strided evaluation is split between threads
+    const size_t grain_size = ftl::ThreadPool::instance().grain_size();
+    ftl::ThreadPool::instance().set_grain_size(8);
+    A.slice(ftl::all, 1, ftl::all, ftl::all) = B + C;
+    ftl::ThreadPool::instance().set_grain_size(grain_size);
+
+    BOOST_CHECK( A(4, 1, 6, 1) == B(4, 6, 1) + 1.f );
+    BOOST_CHECK( A(2, 1, 3, 0) == B(2, 3, 0) + 1.f );
+    BOOST_CHECK( A(2, 0, 3, 0) == 0.f );
+    BOOST_CHECK( A(2, 2, 3, 0) == 0.f );
+}
+
+BOOST_AUTO_TEST_CASE( canUseViewsInExpressions )
+{
+    ftl::DynamicTensorCpu<float> A({8, 4});
+    ftl::DynamicTensorCpu<float> B({8, 4});
+    for (size_t i = 0; i < A.size(); ++i) { A[i] = static_cast<float>(i); B[i] = 2.f * i; }
+
+    // Last column of A (contiguous) and first column of B, then every second row of B with the top of A
+    auto a = A.slice(ftl::Range(0, 8), 3);
+    auto b = B.slice(ftl::Range(0, 8), 0);
+    ftl::DynamicTensorCpu<float> C = a + b;
+    ftl::DynamicTensorCpu<float> D = B.slice(ftl::Range(0, 8, 2), ftl::all) 
+                                   - A.slice(ftl::Range(0, 4), ftl::all);
+
+    BOOST_CHECK( a.contiguous() );
+    BOOST_CHECK( C.size() == 8 );
+    BOOST_CHECK( C[5] == A(5, 3) + B(5, 0) );
+    BOOST_CHECK( D.size() == 16 );
+    BOOST_CHECK( D(3, 2) == B(6, 2) - A(3, 2) );
+}
+
+BOOST_AUTO_TEST_CASE( canSliceAConstantTensor )
+{
+    ftl::DynamicTensorCpu<int> A({3, 3});
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i);
+
+    const ftl::DynamicTensorCpu<int>& B = A;
+    auto view = B.slice(2, ftl::all);
+
+    BOOST_CHECK( (std::is_same<decltype(view.data()), const int*>::value) );
+    BOOST_CHECK( view[1] == A(2, 1) );
+}
+
+BOOST_AUTO_TEST_CASE( staticViewsHaveStaticShapes )
+{
+    ftl::StaticTensorCpu<float, 4, 3, 8> A;
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<float>(i);
+
+    size_t channel = 2;
+    auto view = A.slice(ftl::all, channel, ftl::StaticRange<1, 8, 2>());
+
+    using view_type = decltype(view);
+    static_assert(std::is_same<view_type::traits, ftl::TensorTraits<float, ftl::CPU, 4, 4>>::value,
+                  "View of a static tensor must have a static shape");
+    static_assert(view_type::layout_type::num_elements == 16, "View has the wrong size");
+    static_assert(!view_type::layout_type::contiguous, "View must not be contiguous");
+
+    BOOST_CHECK( view(3, 0) == A(3, 2, 1) );
+    BOOST_CHECK( view(1, 3) == A(1, 2, 7) );
+
+    // Contiguous static view, which is assigned to with packets
+    auto plane = A.slice(ftl::all, ftl::all, 5);
+    static_assert(decltype(plane)::layout_type::contiguous, "View must be contiguous");
+
+    ftl::StaticTensorCpu<float, 4, 3> B, C;
+    for (size_t i = 0; i < B.size(); ++i) { B[i] = 1.f; C[i] = 1.f; }
+    plane = B + C;
+
+    BOOST_CHECK( A(3, 2, 5) == 2.f );
+    BOOST_CHECK( A(3, 2, 4) == static_cast<float>(3 + 2 * 4 + 4 * 12) );
+}
+
+BOOST_AUTO_TEST_CASE( staticTensorWithRuntimeRangeGivesDynamicView )
+{
+    ftl::StaticTensorCpu<int, 6, 2> A;
+    for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<int>(i);
+
+    auto view = A.slice(ftl::Range(1, 6, 2), ftl::all);
+
+    static_assert(std::is_same<decltype(view)::traits, ftl::TensorTraits<int, ftl::CPU>>::value,
+                  "View with a runtime range must have a dynamic shape");
+    BOOST_CHECK( view.size(0) == 3 );
+    BOOST_CHECK( view(2, 1) == A(5, 1) );
+}
+
+BOOST_AUTO_TEST_CASE( invalidSlicesAndAssignmentsThrow )
+{
+    ftl::DynamicTensorCpu<float> A({4, 6});
+    ftl::StaticTensorCpu<float, 4, 6> B;
+    ftl::DynamicTensorCpu<float> C({3, 4});
+
+    // Specifiers for the wrong number of dimensions, indices out of range, and ranges with no step
+    BOOST_CHECK_THROW( A.slice(1, ftl::all, ftl::all), std::invalid_argument );
+    BOOST_CHECK_THROW( A.slice(4, ftl::all), std::out_of_range );
+    BOOST_CHECK_THROW( B.slice(ftl::all, 6), std::out_of_range );
+    BOOST_CHECK_THROW( A.slice(ftl::Range(0, 4, 0), ftl::all), std::invalid_argument );
+
+    // Expressions with a different shape to the view, even with the same number of elements
+    auto rows    = A.slice(ftl::Range(0, 4, 2), ftl::all);
+    auto columns = B.slice(ftl::all, ftl::StaticRange<0, 3>());
+    auto row     = A.slice(0, ftl::all);
+    BOOST_CHECK_THROW( rows = C, std::invalid_argument );
+    BOOST_CHECK_THROW( columns = C + C, std::invalid_argument );
+    BOOST_CHECK_THROW( row = A.slice(ftl::all, 0), std::invalid_argument );
+    BOOST_CHECK_NO_THROW( rows = A.slice(ftl::Range(1, 4, 2), ftl::all) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()